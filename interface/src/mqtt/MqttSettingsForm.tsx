@@ -187,6 +187,31 @@ class MqttSettingsForm extends React.Component<MqttSettingsFormProps> {
           <MenuItem value={1}>Nested on a single topic</MenuItem>
           <MenuItem value={2}>As individual topics</MenuItem>
         </SelectValidator>
+        <SelectValidator
+          name="payload_format"
+          label="Device Data Payload Format"
+          value={data.ha_enabled ? 1 : data.payload_format}
+          fullWidth
+          variant="outlined"
+          onChange={handleValueChange('payload_format')}
+          margin="normal"
+        >
+          <MenuItem value={1}>JSON</MenuItem>
+          {/* Home Assistant Discovery only reads JSON, so it is always used then */}
+          <MenuItem value={2} disabled={data.ha_enabled}>
+            MessagePack (not with Home Assistant Discovery)
+          </MenuItem>
+        </SelectValidator>
+        <BlockFormControlLabel
+          control={
+            <Checkbox
+              checked={data.publish_single}
+              onChange={handleValueChange('publish_single')}
+              value="publish_single"
+            />
+          }
+          label="Publish changed values to their own topic"
+        />
         <BlockFormControlLabel
           control={
             <Checkbox
@@ -358,6 +383,28 @@ class MqttSettingsForm extends React.Component<MqttSettingsFormProps> {
           onChange={handleValueChange('publish_time_other')}
           margin="normal"
         />
+        <TextValidator
+          validators={[
+            'required',
+            'isNumber',
+            'minNumber:0',
+            'maxNumber:65535'
+          ]}
+          errorMessages={[
+            'Publish budget is required',
+            'Must be a number',
+            'Must be 0 or greater',
+            'Max value is 65535'
+          ]}
+          name="publish_budget"
+          label="Publish Budget (bytes per second, 0=no limit)"
+          fullWidth
+          variant="outlined"
+          value={data.publish_budget}
+          type="number"
+          onChange={handleValueChange('publish_budget')}
+          margin="normal"
+        />
         <FormActions>
           <FormButton
             startIcon={<SaveIcon />}
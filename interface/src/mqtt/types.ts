@@ -39,5 +39,8 @@ export interface MqttSettings {
   ha_enabled: boolean;
   ha_climate_format: number;
   nested_format: number;
+  payload_format: number;
+  publish_single: boolean;
   send_response: boolean;
+  publish_budget: number;
 }
@@ -108,7 +108,16 @@ class LogEventController extends Component<
       })
       .then((arrayBuffer) => {
         const json: any = decoder.decode(arrayBuffer);
-        this.setState({ events: json.events });
+        const fetched: LogEvent[] = json.events;
+        // the event source runs independently, keep what it already delivered after the fetched log
+        const fetched_id = fetched.length ? fetched[fetched.length - 1].i : 0;
+        this.setState((state) => ({
+          events: [
+            ...fetched,
+            ...state.events.filter((e) => e.i > fetched_id)
+          ],
+          last_id: Math.max(state.last_id, fetched_id)
+        }));
       })
       .catch((error) => {
         this.setState({ events: [] });
@@ -158,10 +167,14 @@ class LogEventController extends Component<
   onMessage = (event: MessageEvent) => {
     const rawData = event.data;
     if (typeof rawData === 'string' || rawData instanceof String) {
-      const event = JSON.parse(rawData as string) as LogEvent;
-      if (event.i > this.state.last_id) {
-        this.setState({ last_id: event.i });
-        this.setState((state) => ({ events: [...state.events, event] }));
+      // the backend sends all pending messages of a tick as an array
+      const data = JSON.parse(rawData as string);
+      const received: LogEvent[] = Array.isArray(data) ? data : [data];
+      const last_id = this.state.last_id;
+      const events = received.filter((e) => e.i > last_id);
+      if (events.length) {
+        this.setState({ last_id: events[events.length - 1].i });
+        this.setState((state) => ({ events: [...state.events, ...events] }));
       }
     }
   };
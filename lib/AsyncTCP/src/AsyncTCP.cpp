@@ -44,7 +44,8 @@ typedef enum {
     LWIP_TCP_CLEAR,
     LWIP_TCP_ACCEPT,
     LWIP_TCP_CONNECTED,
-    LWIP_TCP_DNS
+    LWIP_TCP_DNS,
+    LWIP_TCP_RUN
 } lwip_event_t;
 
 typedef struct {
@@ -81,6 +82,9 @@ typedef struct {
             const char * name;
             ip_addr_t    addr;
         } dns;
+        struct {
+            void (*fn)(void *);
+        } run;
     };
 } lwip_event_packet_t;
 
@@ -189,6 +193,8 @@ static void _handle_async_event(lwip_event_packet_t * e) {
     } else if (e->event == LWIP_TCP_DNS) {
         //ets_printf("D: 0x%08x %s = %s\n", e->arg, e->dns.name, ipaddr_ntoa(&e->dns.addr));
         AsyncClient::_s_dns_found(e->dns.name, &e->dns.addr, e->arg);
+    } else if (e->event == LWIP_TCP_RUN) {
+        e->run.fn(e->arg);
     }
     free((void *)(e));
 }
@@ -234,6 +240,25 @@ static bool _start_async_task() {
     return true;
 }
 
+bool asyncTCPRun(void (*fn)(void *), void * arg) {
+    if (!_async_queue || !fn || !arg) {
+        return false;
+    }
+    lwip_event_packet_t * e = (lwip_event_packet_t *)malloc(sizeof(lwip_event_packet_t));
+    if (!e) {
+        return false;
+    }
+    e->event  = LWIP_TCP_RUN;
+    e->arg    = arg;
+    e->run.fn = fn;
+    // don't block the caller, it falls back to the next poll
+    if (xQueueSend(_async_queue, &e, 0) != pdPASS) {
+        free((void *)(e));
+        return false;
+    }
+    return true;
+}
+
 /*
  * LwIP Callbacks
  * */
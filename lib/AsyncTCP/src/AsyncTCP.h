@@ -41,6 +41,9 @@ extern "C" {
 
 class AsyncClient;
 
+//runs fn(arg) on the async_tcp task, from any other task. Returns false if it couldn't be queued
+bool asyncTCPRun(void (*fn)(void *), void * arg);
+
 #define ASYNC_MAX_ACK_TIME 5000
 #define ASYNC_WRITE_FLAG_COPY 0x01 //will allocate new buffer to hold the data while sending (else will hold reference to the data given)
 #define ASYNC_WRITE_FLAG_MORE 0x02 //will not send PSH flag, meaning that there should be more data to be sent before the application should react.
@@ -175,7 +175,10 @@ void MqttSettings::read(MqttSettings & settings, JsonObject & root) {
     root["ha_climate_format"]       = settings.ha_climate_format;
     root["ha_enabled"]              = settings.ha_enabled;
     root["nested_format"]           = settings.nested_format;
+    root["payload_format"]          = settings.payload_format;
+    root["publish_single"]          = settings.publish_single;
     root["send_response"]           = settings.send_response;
+    root["publish_budget"]          = settings.publish_budget;
 }
 
 StateUpdateResult MqttSettings::update(JsonObject & root, MqttSettings & settings) {
@@ -205,7 +208,15 @@ StateUpdateResult MqttSettings::update(JsonObject & root, MqttSettings & setting
     newSettings.ha_climate_format = root["ha_climate_format"] | EMSESP_DEFAULT_HA_CLIMATE_FORMAT;
     newSettings.ha_enabled        = root["ha_enabled"] | EMSESP_DEFAULT_HA_ENABLED;
     newSettings.nested_format     = root["nested_format"] | EMSESP_DEFAULT_NESTED_FORMAT;
+    newSettings.payload_format    = root["payload_format"] | EMSESP_DEFAULT_PAYLOAD_FORMAT;
+    newSettings.publish_single    = root["publish_single"] | EMSESP_DEFAULT_PUBLISH_SINGLE;
     newSettings.send_response     = root["send_response"] | EMSESP_DEFAULT_SEND_RESPONSE;
+    newSettings.publish_budget    = root["publish_budget"] | EMSESP_DEFAULT_PUBLISH_BUDGET;
+
+    // Home Assistant can only read JSON payloads, so MessagePack can't be used with the discovery
+    if (newSettings.ha_enabled) {
+        newSettings.payload_format = 1; // json
+    }
 
     if (newSettings.enabled != settings.enabled) {
         changed = true;
@@ -220,6 +231,10 @@ StateUpdateResult MqttSettings::update(JsonObject & root, MqttSettings & setting
         changed = true;
     }
 
+    if (newSettings.publish_single != settings.publish_single) {
+        changed = true;
+    }
+
     if (newSettings.send_response != settings.send_response) {
         changed = true;
     }
@@ -269,6 +284,15 @@ StateUpdateResult MqttSettings::update(JsonObject & root, MqttSettings & setting
         changed = true;
     }
 
+    // no need to reconnect
+    if (newSettings.publish_budget != settings.publish_budget) {
+        emsesp::EMSESP::mqtt_.set_publish_budget(newSettings.publish_budget);
+    }
+
+    if (newSettings.payload_format != settings.payload_format) {
+        emsesp::EMSESP::mqtt_.payload_format(newSettings.payload_format);
+    }
+
     if (changed) {
         emsesp::EMSESP::mqtt_.reset_mqtt();
     }
@@ -89,7 +89,10 @@ class MqttSettings {
     uint8_t  ha_climate_format;
     bool     ha_enabled;
     uint8_t  nested_format;
+    uint8_t  payload_format;
+    bool     publish_single;
     bool     send_response;
+    uint16_t publish_budget;
 
     static void              read(MqttSettings & settings, JsonObject & root);
     static StateUpdateResult update(JsonObject & root, MqttSettings & settings);
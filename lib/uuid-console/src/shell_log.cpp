@@ -33,19 +33,6 @@ namespace console {
 static const char       __pstr__logger_name[] __attribute__((__aligned__(sizeof(uint32_t)))) PROGMEM = "shell";
 const uuid::log::Logger Shell::logger_{reinterpret_cast<const __FlashStringHelper *>(__pstr__logger_name), uuid::log::Facility::LPR};
 
-Shell::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
-}
-
-void Shell::operator<<(std::shared_ptr<uuid::log::Message> message) {
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
-
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
-}
-
 uuid::log::Level Shell::log_level() const {
     return uuid::log::Logger::get_log_level(this);
 }
@@ -60,39 +47,37 @@ size_t Shell::maximum_log_messages() const {
 
 void Shell::maximum_log_messages(size_t count) {
     maximum_log_messages_ = std::max((size_t)1, count);
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
 }
 
 void Shell::output_logs() {
-    if (!log_messages_.empty()) {
+    const uuid::log::Message * message = peek_message(maximum_log_messages_);
+
+    if (message != nullptr) {
         if (mode_ != Mode::DELAY) {
             erase_current_line();
             prompt_displayed_ = false;
         }
 
-        while (!log_messages_.empty()) {
-            auto message = std::move(log_messages_.front());
-            log_messages_.pop_front();
+        for (; message != nullptr; message = peek_message(maximum_log_messages_)) {
+            pop_message();
 
-            print(uuid::log::format_timestamp_ms(message.content_->uptime_ms, 3));
-            printf(F(" %c %lu: [%S] "), uuid::log::format_level_char(message.content_->level), message.id_, message.content_->name);
+            print(uuid::log::format_timestamp_ms(message->uptime_ms, 3));
+            printf(F(" %c %lu: [%S] "), uuid::log::format_level_char(message->level), log_message_id_++, message->name);
 
-            if ((message.content_->level == uuid::log::Level::ERR) || (message.content_->level == uuid::log::Level::WARNING)) {
+            if ((message->level == uuid::log::Level::ERR) || (message->level == uuid::log::Level::WARNING)) {
                 print(COLOR_RED);
-                println(message.content_->text);
+                println(message->text());
                 print(COLOR_RESET);
-            } else if (message.content_->level == uuid::log::Level::INFO) {
+            } else if (message->level == uuid::log::Level::INFO) {
                 print(COLOR_YELLOW);
-                println(message.content_->text);
+                println(message->text());
                 print(COLOR_RESET);
-            } else if (message.content_->level == uuid::log::Level::DEBUG) {
+            } else if (message->level == uuid::log::Level::DEBUG) {
                 print(COLOR_CYAN);
-                println(message.content_->text);
+                println(message->text());
                 print(COLOR_RESET);
             } else {
-                println(message.content_->text);
+                println(message->text());
             }
 
             ::yield();
@@ -20,11 +20,13 @@
 
 #include <Arduino.h>
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdint>
+#include <cstring>
 #include <list>
-#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -33,15 +35,351 @@ namespace uuid {
 
 namespace log {
 
-std::map<Handler *, Level> Logger::handlers_;
-Level                      Logger::level_ = Level::OFF;
+std::vector<std::pair<Handler *, Level>> Logger::handlers_;
+Level                                    Logger::level_                = Level::OFF;
+std::vector<Message>                     Logger::messages_;
+size_t                                   Logger::maximum_log_messages_ = Logger::MAX_LOG_MESSAGES;
+size_t                                   Logger::used_                 = 0;
+size_t                                   Logger::head_                 = 0;
+unsigned long                            Logger::next_id_              = 0;
+std::mutex                               Logger::mutex_;
+
+namespace {
+
+/* Type of a format string argument. */
+enum class ArgType : uint8_t {
+    NONE,
+    INT,
+    LONG,
+    LONG_LONG,
+    SIZE,
+    DOUBLE,
+    STRING,
+    POINTER,
+    UNSUPPORTED,
+};
+
+/* Longest conversion specification that can be formatted from copied arguments. */
+constexpr size_t MAX_SPEC_LENGTH = 15;
+
+/*
+ * Parse the conversion specification at pos (the character after the
+ * '%') and move pos past it.
+ */
+ArgType parse_spec(PGM_P format, size_t & pos) {
+    char c = pgm_read_byte(format + pos);
+
+    while (c == '-' || c == '+' || c == ' ' || c == '#' || c == '0') {
+        c = pgm_read_byte(format + ++pos);
+    }
+    while (c >= '0' && c <= '9') {
+        c = pgm_read_byte(format + ++pos);
+    }
+    if (c == '.') {
+        c = pgm_read_byte(format + ++pos);
+        while (c >= '0' && c <= '9') {
+            c = pgm_read_byte(format + ++pos);
+        }
+    }
+
+    char length = '\0';
+    if (c == 'h' || c == 'l' || c == 'z' || c == 'j' || c == 't' || c == 'L') {
+        length = c;
+        c      = pgm_read_byte(format + ++pos);
+        if (length == 'l' && c == 'l') {
+            length = 'q';
+            c      = pgm_read_byte(format + ++pos);
+        } else if (length == 'h' && c == 'h') {
+            c = pgm_read_byte(format + ++pos);
+        }
+    }
+
+    if (c == '\0') {
+        return ArgType::UNSUPPORTED;
+    }
+    pos++;
+
+    switch (c) {
+    case '%':
+        return ArgType::NONE;
+
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        if (length == 'l') {
+            return ArgType::LONG;
+        } else if (length == 'q' || length == 'j') {
+            return ArgType::LONG_LONG;
+        } else if (length == 'z' || length == 't') {
+            return ArgType::SIZE;
+        } else if (length == 'L') {
+            return ArgType::UNSUPPORTED;
+        }
+        return ArgType::INT;
+
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        return (length == '\0') ? ArgType::DOUBLE : ArgType::UNSUPPORTED;
+
+    case 'c':
+        return (length == '\0') ? ArgType::INT : ArgType::UNSUPPORTED;
+
+    case 's':
+        return (length == '\0') ? ArgType::STRING : ArgType::UNSUPPORTED;
+
+    case 'p':
+        return ArgType::POINTER;
+
+    default:
+        return ArgType::UNSUPPORTED;
+    }
+}
+
+template <typename T>
+bool copy_arg(uint8_t * args, uint8_t & size, T value) {
+    if (size + sizeof(T) > Message::MAX_ARGS_SIZE) {
+        return false;
+    }
+
+    memcpy(&args[size], &value, sizeof(T));
+    size += sizeof(T);
+    return true;
+}
+
+template <typename T>
+T read_arg(const uint8_t * args, size_t & pos) {
+    T value;
+
+    memcpy(&value, &args[pos], sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+} // namespace
 
 Message::Message(uint64_t uptime_ms, Level level, Facility facility, const __FlashStringHelper * name, const std::string && text)
     : uptime_ms(uptime_ms)
     , level(level)
     , facility(facility)
     , name(name)
-    , text(std::move(text)) {
+    , text_(std::move(text)) {
+}
+
+void Message::set(uint64_t uptime_ms, Level level, Facility facility, const __FlashStringHelper * name, const __FlashStringHelper * format, va_list ap) {
+    va_list copy;
+
+    this->uptime_ms = uptime_ms;
+    this->level     = level;
+    this->facility  = facility;
+    this->name      = name;
+    format_         = nullptr;
+    args_size_      = 0;
+
+    va_copy(copy, ap);
+    if (copy_args(format, copy)) {
+        format_ = format;
+    } else {
+        char text[Logger::MAX_LOG_LENGTH + 1];
+
+        if (vsnprintf_P(text, sizeof(text), reinterpret_cast<PGM_P>(format), ap) > 0) {
+            text_ = text;
+        } else {
+            text_.clear();
+        }
+    }
+    va_end(copy);
+}
+
+void Message::set(uint64_t uptime_ms, Level level, Facility facility, const __FlashStringHelper * name, const char * text) {
+    this->uptime_ms = uptime_ms;
+    this->level     = level;
+    this->facility  = facility;
+    this->name      = name;
+    format_         = nullptr;
+    text_           = text;
+}
+
+bool Message::copy_args(const __FlashStringHelper * format, va_list ap) {
+    PGM_P  fmt = reinterpret_cast<PGM_P>(format);
+    size_t pos = 0;
+
+    for (char c = pgm_read_byte(fmt); c != '\0'; c = pgm_read_byte(fmt + pos)) {
+        size_t start = pos++;
+
+        if (c != '%') {
+            continue;
+        }
+
+        bool ok;
+        switch (parse_spec(fmt, pos)) {
+        case ArgType::NONE:
+            ok = true;
+            break;
+
+        case ArgType::INT:
+            ok = copy_arg(args_, args_size_, va_arg(ap, int));
+            break;
+
+        case ArgType::LONG:
+            ok = copy_arg(args_, args_size_, va_arg(ap, long));
+            break;
+
+        case ArgType::LONG_LONG:
+            ok = copy_arg(args_, args_size_, va_arg(ap, long long));
+            break;
+
+        case ArgType::SIZE:
+            ok = copy_arg(args_, args_size_, va_arg(ap, size_t));
+            break;
+
+        case ArgType::DOUBLE:
+            ok = copy_arg(args_, args_size_, va_arg(ap, double));
+            break;
+
+        case ArgType::POINTER:
+            ok = copy_arg(args_, args_size_, va_arg(ap, void *));
+            break;
+
+        case ArgType::STRING: {
+            const char * value = va_arg(ap, const char *);
+            if (value == nullptr) {
+                value = "(null)";
+            }
+            size_t len = strlen(value);
+
+            ok = (args_size_ + len + 1 <= MAX_ARGS_SIZE);
+            if (ok) {
+                memcpy(&args_[args_size_], value, len);
+                args_size_ += len;
+                args_[args_size_++] = '\0';
+            }
+            break;
+        }
+
+        case ArgType::UNSUPPORTED:
+        default:
+            ok = false;
+            break;
+        }
+
+        if (!ok || (pos - start > MAX_SPEC_LENGTH)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Message::format() {
+    PGM_P  fmt = reinterpret_cast<PGM_P>(format_);
+    char   text[Logger::MAX_LOG_LENGTH + 1];
+    size_t len = 0;
+    size_t pos = 0;
+    size_t arg = 0;
+
+    for (char c = pgm_read_byte(fmt); c != '\0' && len < Logger::MAX_LOG_LENGTH; c = pgm_read_byte(fmt + pos)) {
+        size_t start = pos++;
+
+        if (c != '%') {
+            text[len++] = c;
+            continue;
+        }
+
+        ArgType type = parse_spec(fmt, pos);
+        char    spec[MAX_SPEC_LENGTH + 1];
+        for (size_t i = start; i < pos; i++) {
+            spec[i - start] = pgm_read_byte(fmt + i);
+        }
+        spec[pos - start] = '\0';
+
+        char * out  = &text[len];
+        size_t room = sizeof(text) - len;
+        int    n    = 0;
+
+        switch (type) {
+        case ArgType::NONE:
+            n = snprintf(out, room, "%%");
+            break;
+
+        case ArgType::INT:
+            n = snprintf(out, room, spec, read_arg<int>(args_, arg));
+            break;
+
+        case ArgType::LONG:
+            n = snprintf(out, room, spec, read_arg<long>(args_, arg));
+            break;
+
+        case ArgType::LONG_LONG:
+            n = snprintf(out, room, spec, read_arg<long long>(args_, arg));
+            break;
+
+        case ArgType::SIZE:
+            n = snprintf(out, room, spec, read_arg<size_t>(args_, arg));
+            break;
+
+        case ArgType::DOUBLE:
+            n = snprintf(out, room, spec, read_arg<double>(args_, arg));
+            break;
+
+        case ArgType::POINTER:
+            n = snprintf(out, room, spec, read_arg<void *>(args_, arg));
+            break;
+
+        case ArgType::STRING: {
+            const char * value = reinterpret_cast<const char *>(&args_[arg]);
+            size_t       size  = strlen(value);
+
+            if (pos - start == 2) {
+                // plain %s, no need for snprintf
+                n = std::min(size, room - 1);
+                memcpy(out, value, n);
+            } else {
+                n = snprintf(out, room, spec, value);
+            }
+            arg += size + 1;
+            break;
+        }
+
+        case ArgType::UNSUPPORTED:
+        default:
+            break;
+        }
+
+        if (n > 0) {
+            len += std::min(static_cast<size_t>(n), room - 1);
+        }
+    }
+
+    text[len] = '\0';
+    text_     = text;
+    format_   = nullptr;
+}
+
+unsigned long Handler::lag() const {
+    return Logger::next_id() - cursor_;
+}
+
+const Message * Handler::peek_message(size_t maximum) {
+    if (Logger::read_message(this, cursor_, overruns_, message_, maximum)) {
+        return &message_;
+    }
+
+    return nullptr;
+}
+
+bool Handler::peek_message(unsigned long & cursor, Message & message) const {
+    unsigned long overruns = 0;
+
+    return Logger::read_message(this, cursor, overruns, message, 0);
 }
 
 Logger::Logger(const __FlashStringHelper * name, Facility facility)
@@ -51,25 +389,123 @@ Logger::Logger(const __FlashStringHelper * name, Facility facility)
       };
 
 void Logger::register_handler(Handler * handler, Level level) {
-    handlers_[handler] = level;
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    for (auto & entry : handlers_) {
+        if (entry.first == handler) {
+            entry.second = level;
+            refresh_log_level();
+            return;
+        }
+    }
+
+    handler->cursor_ = next_id_;
+    handlers_.emplace_back(handler, level);
     refresh_log_level();
 };
 
 void Logger::unregister_handler(Handler * handler) {
-    handlers_.erase(handler);
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    for (auto it = handlers_.begin(); it != handlers_.end(); ++it) {
+        if (it->first == handler) {
+            handlers_.erase(it);
+            break;
+        }
+    }
     refresh_log_level();
 };
 
 Level Logger::get_log_level(const Handler * handler) {
-    const auto level = handlers_.find(const_cast<Handler *>(handler));
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    return handler_level(handler);
+}
 
-    if (level != handlers_.end()) {
-        return level->second;
+Level Logger::handler_level(const Handler * handler) {
+    for (auto & entry : handlers_) {
+        if (entry.first == handler) {
+            return entry.second;
+        }
     }
 
     return Level::OFF;
 }
 
+size_t Logger::maximum_log_messages() {
+    return maximum_log_messages_;
+}
+
+void Logger::maximum_log_messages(size_t count) {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    count = std::max((size_t)1, count);
+    if (count == maximum_log_messages_) {
+        return;
+    }
+
+    // the buffer is only allocated when the first message is logged
+    if (!messages_.empty()) {
+        std::vector<Message> messages(count);
+        size_t               used = std::min(used_, count);
+
+        for (size_t i = 0; i < used; i++) {
+            messages[i] = std::move(messages_[(head_ + messages_.size() - used + i) % messages_.size()]);
+        }
+        messages_ = std::move(messages);
+        used_     = used;
+        head_     = used % count;
+    }
+
+    maximum_log_messages_ = count;
+}
+
+Message * Logger::message(unsigned long id) {
+    if (id - first_id() >= used_) {
+        return nullptr;
+    }
+
+    return &messages_[(head_ + messages_.size() - (next_id_ - id)) % messages_.size()];
+}
+
+bool Logger::read_message(const Handler * handler, unsigned long & cursor, unsigned long & overruns, Message & message, size_t maximum) {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    unsigned long first = first_id();
+    unsigned long next  = next_id_;
+
+    if (maximum != 0 && next - first > maximum) {
+        first = next - maximum;
+    }
+
+    // identifiers wrap around, so compare the difference
+    if (static_cast<long>(first - cursor) > 0) {
+        overruns += first - cursor;
+        cursor = first;
+    }
+
+    Level level = handler_level(handler);
+    for (; cursor != next; cursor++) {
+        Message * entry = Logger::message(cursor);
+
+        if (entry->level <= level) {
+            // formatted in place so that it only happens once for all handlers
+            if (entry->format_ != nullptr) {
+                entry->format();
+            }
+
+            message.uptime_ms = entry->uptime_ms;
+            message.level     = entry->level;
+            message.facility  = entry->facility;
+            message.name      = entry->name;
+            message.text_     = entry->text_;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void Logger::emerg(const char * format, ...) const {
     if (enabled(Level::EMERG)) {
         va_list ap;
@@ -286,13 +722,17 @@ void Logger::vlog(Level level, const char * format, va_list ap) const {
 }
 
 void Logger::vlog(Level level, Facility facility, const char * format, va_list ap) const {
-    std::vector<char> text(MAX_LOG_LENGTH + 1);
+    // the format string itself may not outlive the call, so it's formatted now
+    char text[MAX_LOG_LENGTH + 1];
 
-    if (vsnprintf(text.data(), text.size(), format, ap) <= 0) {
+    if (vsnprintf(text, sizeof(text), format, ap) <= 0) {
         return;
     }
 
-    dispatch(level, facility, text);
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    add().set(get_uptime_ms(), level, facility, name_, text);
+    added();
 }
 
 void Logger::vlog(Level level, const __FlashStringHelper * format, va_list ap) const {
@@ -300,23 +740,29 @@ void Logger::vlog(Level level, const __FlashStringHelper * format, va_list ap) c
 }
 
 void Logger::vlog(Level level, Facility facility, const __FlashStringHelper * format, va_list ap) const {
-    std::vector<char> text(MAX_LOG_LENGTH + 1);
-
-    if (vsnprintf_P(text.data(), text.size(), reinterpret_cast<PGM_P>(format), ap) <= 0) {
+    if (pgm_read_byte(reinterpret_cast<PGM_P>(format)) == '\0') {
         return;
     }
 
-    dispatch(level, facility, text);
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    add().set(get_uptime_ms(), level, facility, name_, format, ap);
+    added();
 }
 
-void Logger::dispatch(Level level, Facility facility, std::vector<char> & text) const {
-    std::shared_ptr<Message> message = std::make_shared<Message>(get_uptime_ms(), level, facility, name_, text.data());
-    text.resize(0);
+Message & Logger::add() {
+    if (messages_.empty()) {
+        messages_.resize(maximum_log_messages_);
+    }
 
-    for (auto & handler : handlers_) {
-        if (level <= handler.second) {
-            *handler.first << message;
-        }
+    return messages_[head_];
+}
+
+void Logger::added() {
+    next_id_++;
+    head_ = (head_ + 1) % messages_.size();
+    if (used_ < messages_.size()) {
+        used_++;
     }
 }
 
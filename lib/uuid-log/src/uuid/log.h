@@ -26,7 +26,9 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <uuid/common.h>
@@ -212,15 +214,24 @@ std::vector<std::string> levels_lowercase();
  */
 bool parse_level_lowercase(const std::string & name, Level & level);
 
+class Logger;
+
 /**
  * Log message text with timestamp and logger attributes.
  *
- * These will be created when a message is logged and then passed to
- * all registered handlers.
+ * These are kept in a fixed size buffer that is shared by all
+ * registered handlers, see Logger::maximum_log_messages().
  *
  * @since 1.0.0
  */
 struct Message {
+    /**
+	 * Create an empty log message for the log buffer (not directly
+	 * useful).
+	 *
+	 * @since 2.2.0
+	 */
+    Message() = default;
     /**
 	 * Create a new log message (not directly useful).
 	 *
@@ -232,7 +243,12 @@ struct Message {
 	 * @since 1.0.0
 	 */
     Message(uint64_t uptime_ms, Level level, Facility facility, const __FlashStringHelper * name, const std::string && text);
-    ~Message() = default;
+    /**
+	 * Maximum size of the copied format string arguments.
+	 *
+	 * @since 2.2.0
+	 */
+    static constexpr size_t MAX_ARGS_SIZE = 64;
 
     /**
 	 * System uptime at the time the message was logged.
@@ -240,28 +256,28 @@ struct Message {
 	 * @see uuid::get_uptime_ms()
 	 * @since 1.0.0
 	 */
-    const uint64_t uptime_ms;
+    uint64_t uptime_ms = 0;
 
     /**
 	 * Severity level of the message.
 	 *
 	 * @since 1.0.0
 	 */
-    const Level level;
+    Level level = Level::OFF;
 
     /**
 	 * Facility type of the process that logged the message.
 	 *
 	 * @since 1.0.0
 	 */
-    const Facility facility;
+    Facility facility = Facility::KERN;
 
     /**
 	 * Name of the logger used (flash string).
 	 *
 	 * @since 1.0.0
 	 */
-    const __FlashStringHelper * name;
+    const __FlashStringHelper * name = nullptr;
 
     /**
 	 * Formatted log message text.
@@ -269,14 +285,81 @@ struct Message {
 	 * Does not include any of the other message attributes, those must
 	 * be added by the handler when outputting messages.
 	 *
-	 * @since 1.0.0
+	 * The message is formatted when a handler first reads it from the
+	 * log buffer, so the cost is only paid by handlers that output it.
+	 *
+	 * @return Log message text.
+	 * @since 2.2.0
 	 */
-    const std::string text;
+    const std::string & text() const {
+        return text_;
+    }
+
+  private:
+    friend class Logger;
+
+    /**
+	 * Replace the contents of the message with a message that is
+	 * formatted when the text is first used.
+	 *
+	 * The arguments are copied into the message, so they don't need
+	 * to outlive the call. If they don't fit or the format string has
+	 * conversions that can't be copied, the message is formatted
+	 * immediately instead.
+	 *
+	 * @param[in] uptime_ms System uptime, see uuid::get_uptime_ms().
+	 * @param[in] level Severity level of the message.
+	 * @param[in] facility Facility type of the process logging the message.
+	 * @param[in] name Logger name (flash string).
+	 * @param[in] format Format string (flash string).
+	 * @param[in] ap Variable arguments pointer for format string.
+	 * @since 2.2.0
+	 */
+    void set(uint64_t uptime_ms, Level level, Facility facility, const __FlashStringHelper * name, const __FlashStringHelper * format, va_list ap);
+    /**
+	 * Replace the contents of the message with formatted text.
+	 *
+	 * The memory used for the previous text is reused.
+	 *
+	 * @param[in] uptime_ms System uptime, see uuid::get_uptime_ms().
+	 * @param[in] level Severity level of the message.
+	 * @param[in] facility Facility type of the process logging the message.
+	 * @param[in] name Logger name (flash string).
+	 * @param[in] text Log message text.
+	 * @since 2.2.0
+	 */
+    void set(uint64_t uptime_ms, Level level, Facility facility, const __FlashStringHelper * name, const char * text);
+
+    /**
+	 * Copy the format string arguments into the message.
+	 *
+	 * @param[in] format Format string (flash string).
+	 * @param[in] ap Variable arguments pointer for format string.
+	 * @return True if all of the arguments have been copied.
+	 * @since 2.2.0
+	 */
+    bool copy_args(const __FlashStringHelper * format, va_list ap);
+
+    /**
+	 * Format the message text from the copied arguments.
+	 *
+	 * @since 2.2.0
+	 */
+    void format();
+
+    std::string                 text_;                /*!< Formatted log message text. @since 2.2.0 */
+    const __FlashStringHelper * format_    = nullptr; /*!< Format string (flash string) until the text is formatted. @since 2.2.0 */
+    uint8_t                     args_size_ = 0;       /*!< Size of the copied arguments. @since 2.2.0 */
+    uint8_t                     args_[MAX_ARGS_SIZE]; /*!< Copied format string arguments. @since 2.2.0 */
 };
 
 /**
  * Logger handler used to process log messages.
  *
+ * Each handler reads the shared log buffer through its own cursor,
+ * normally from a loop function so that log messages have minimal
+ * impact at the time of use.
+ *
  * @since 1.0.0
  */
 class Handler {
@@ -284,22 +367,73 @@ class Handler {
     virtual ~Handler() = default;
 
     /**
-	 * Add a new log message.
+	 * Get the number of messages in the log buffer that have not
+	 * been read by this handler yet, of any level.
 	 *
-	 * This should normally be put in a queue instead of being
-	 * processed immediately so that log messages have minimal impact
-	 * at the time of use.
-	 *
-	 * Queues should have a maximum size and discard the oldest message
-	 * when full.
+	 * @return The number of unread messages.
+	 * @since 2.2.0
+	 */
+    unsigned long lag() const;
+    /**
+	 * Get the number of messages that were discarded from the log
+	 * buffer, or skipped because of the maximum, before this handler
+	 * read them.
 	 *
-	 * @param[in] message New log message, shared by all handlers.
-	 * @since 1.0.0
+	 * @return The number of lost messages.
+	 * @since 2.2.0
 	 */
-    virtual void operator<<(std::shared_ptr<Message> message) = 0;
+    unsigned long overruns() const {
+        return overruns_;
+    }
 
   protected:
     Handler() = default;
+
+    /**
+	 * Get the next unread message at the log level of this handler.
+	 *
+	 * Messages at other levels are skipped. The message is copied out
+	 * of the log buffer, so it stays valid until the next call even
+	 * when other tasks log messages at the same time.
+	 *
+	 * @param[in] maximum Maximum number of the newest messages to
+	 *                    read, older unread messages are skipped
+	 *                    (0 = no limit).
+	 * @return The next message or nullptr if there isn't one. Its
+	 *         identifier is cursor_.
+	 * @since 2.2.0
+	 */
+    const Message * peek_message(size_t maximum = 0);
+    /**
+	 * Get the next message at the log level of this handler, using a
+	 * cursor of the caller instead of the one of the handler.
+	 *
+	 * For reading the log buffer from another task than the one
+	 * that outputs the messages of the handler.
+	 *
+	 * @param[in,out] cursor Identifier of the next message to read,
+	 *                       moved on to the message found.
+	 * @param[out] message Copy of the message.
+	 * @return True if there was a message.
+	 * @since 2.2.0
+	 */
+    bool peek_message(unsigned long & cursor, Message & message) const;
+    /**
+	 * Mark the message returned by peek_message() as read.
+	 *
+	 * @since 2.2.0
+	 */
+    void pop_message() {
+        cursor_++;
+    }
+
+    unsigned long cursor_   = 0; /*!< Identifier of the next message to read. @since 2.2.0 */
+    unsigned long overruns_ = 0; /*!< Number of messages lost before they were read. @since 2.2.0 */
+
+  private:
+    friend class Logger;
+
+    Message message_; /*!< Copy of the message returned by peek_message(). @since 2.2.0 */
 };
 
 /**
@@ -334,10 +468,18 @@ class Logger {
     Logger(const __FlashStringHelper * name, Facility facility = Facility::LOCAL0);
     ~Logger() = default;
 
+    /**
+	 * Default number of messages in the log buffer.
+	 *
+	 * @since 2.2.0
+	 */
+    static constexpr size_t MAX_LOG_MESSAGES = 100;
+
     /**
 	 * Register a log handler.
 	 *
-	 * Call again to change the log level.
+	 * Call again to change the log level. A new handler starts
+	 * reading at the next message that is logged.
 	 *
 	 * Do not call this function from a static initializer.
 	 *
@@ -376,6 +518,45 @@ class Logger {
 	 */
     static Level get_log_level(const Handler * handler);
 
+    /**
+	 * Get the number of messages in the log buffer.
+	 *
+	 * @return The maximum number of messages kept for the handlers.
+	 * @since 2.2.0
+	 */
+    static size_t maximum_log_messages();
+    /**
+	 * Set the number of messages in the log buffer, shared by all
+	 * handlers.
+	 *
+	 * Defaults to Logger::MAX_LOG_MESSAGES. The newest messages are
+	 * kept.
+	 *
+	 * @param[in] count The maximum number of messages kept for the
+	 *                  handlers.
+	 * @since 2.2.0
+	 */
+    static void maximum_log_messages(size_t count);
+
+    /**
+	 * Get the identifier of the oldest message in the log buffer.
+	 *
+	 * @return Identifier of the oldest message, same as next_id()
+	 *         when the buffer is empty.
+	 * @since 2.2.0
+	 */
+    static unsigned long first_id() {
+        return next_id_ - used_;
+    }
+    /**
+	 * Get the identifier that the next message will have.
+	 *
+	 * @return Identifier of the next message.
+	 * @since 2.2.0
+	 */
+    static unsigned long next_id() {
+        return next_id_;
+    }
     /**
 	 * Determine if the current log level is enabled by any registered
 	 * handlers.
@@ -562,6 +743,8 @@ class Logger {
     void log(Level level, Facility facility, const __FlashStringHelper * format, ...) const /* __attribute__((format (printf, 4, 5))) */;
 
   private:
+    friend class Handler;
+
     /**
 	 * Refresh the minimum global log level across all handlers.
 	 *
@@ -610,21 +793,64 @@ class Logger {
     void vlog(Level level, Facility facility, const __FlashStringHelper * format, va_list ap) const;
 
     /**
-	 * Dispatch a log message to all handlers that are registered to
-	 * handle messages of the specified level.
+	 * Get a message from the log buffer, with mutex_ locked.
 	 *
-	 * Automatically sets the timestamp of the message to the current
-	 * system uptime.
+	 * @param[in] id Identifier of the message.
+	 * @return The message or nullptr if it is no longer (or not yet)
+	 *         in the buffer.
+	 * @since 2.2.0
+	 */
+    static Message * message(unsigned long id);
+    /**
+	 * Copy the next message at the log level of a handler out of the
+	 * log buffer, formatting it first if that hasn't been done yet.
 	 *
-	 * @param[in] level Severity level of the message.
-	 * @param[in] facility Facility type of the process logging the message.
-	 * @param[in] text Log message text.
-	 * @since 1.0.0
+	 * @param[in] handler Handler reading the message.
+	 * @param[in,out] cursor Identifier of the next message to read.
+	 * @param[in,out] overruns Number of messages lost before they
+	 *                         were read.
+	 * @param[out] message Copy of the message.
+	 * @param[in] maximum Maximum number of the newest messages to
+	 *                    read (0 = no limit).
+	 * @return True if there was a message.
+	 * @since 2.2.0
+	 */
+    static bool read_message(const Handler * handler, unsigned long & cursor, unsigned long & overruns, Message & message, size_t maximum);
+    /**
+	 * Get the log level of a handler, with mutex_ locked.
+	 *
+	 * @param[in] handler Handler object that may handle log messages.
+	 * @return The current log level of the specified handler.
+	 * @since 2.2.0
+	 */
+    static Level handler_level(const Handler * handler);
+
+    /**
+	 * Get the slot for a new message in the log buffer, replacing
+	 * the oldest message if it is full.
+	 *
+	 * The message is only visible to handlers after a call to
+	 * added().
+	 *
+	 * @return Message to fill in.
+	 * @since 2.2.0
+	 */
+    static Message & add();
+    /**
+	 * Make the message from add() visible to handlers.
+	 *
+	 * @since 2.2.0
 	 */
-    void dispatch(Level level, Facility facility, std::vector<char> & text) const;
+    static void added();
 
-    static std::map<Handler *, Level> handlers_; /*!< Registered log handlers. @since 1.0.0 */
-    static Level                      level_;    /*!< Minimum global log level across all handlers. @since 1.0.0 */
+    static std::vector<std::pair<Handler *, Level>> handlers_;             /*!< Registered log handlers, there are only ever a few. @since 2.2.0 */
+    static Level                                    level_;                /*!< Minimum global log level across all handlers. @since 1.0.0 */
+    static std::vector<Message>                     messages_;             /*!< Log buffer, allocated when the first message is logged. @since 2.2.0 */
+    static size_t                                   maximum_log_messages_; /*!< Size of the log buffer. @since 2.2.0 */
+    static size_t                                   used_;                 /*!< Number of messages in the log buffer. @since 2.2.0 */
+    static size_t                                   head_;                 /*!< Position in the log buffer for the next message. @since 2.2.0 */
+    static unsigned long                            next_id_;              /*!< Identifier of the next message. @since 2.2.0 */
+    static std::mutex                               mutex_;                /*!< Guards the log buffer and the handlers, messages are logged and read on several tasks. @since 2.2.0 */
 
     const __FlashStringHelper * name_;     /*!< Logger name (flash string). @since 1.0.0 */
     const Facility              facility_; /*!< Default logging facility for messages. @since 1.0.0 */
@@ -89,7 +89,7 @@ namespace uuid {
 namespace syslog {
 
 uuid::log::Logger SyslogService::logger_{FPSTR(__pstr__logger_name), uuid::log::Facility::SYSLOG};
-bool              SyslogService::QueuedLogMessage::time_good_ = false;
+bool              SyslogService::time_good_ = false;
 
 SyslogService::~SyslogService() {
     uuid::log::Logger::unregister_handler(this);
@@ -103,27 +103,7 @@ uuid::log::Level SyslogService::log_level() const {
     return uuid::log::Logger::get_log_level(this);
 }
 
-void SyslogService::remove_queued_messages(uuid::log::Level level) {
-    unsigned long offset = 0;
-
-    for (auto it = log_messages_.begin(); it != log_messages_.end();) {
-        if (it->content_->level > level) {
-            offset++;
-            it = log_messages_.erase(it);
-        } else {
-            it->id_ -= offset;
-            it++;
-        }
-    }
-
-    log_message_id_ -= offset;
-}
-
 void SyslogService::log_level(uuid::log::Level level) {
-    if (!started_) {
-        remove_queued_messages(level);
-    }
-
     static bool level_set     = false;
     bool        level_changed = !level_set || (level != log_level());
     level_set                 = true;
@@ -143,10 +123,6 @@ size_t SyslogService::maximum_log_messages() const {
 
 void SyslogService::maximum_log_messages(size_t count) {
     maximum_log_messages_ = std::max((size_t)1, count);
-
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
 }
 
 std::pair<IPAddress, uint16_t> SyslogService::destination() const {
@@ -159,7 +135,6 @@ void SyslogService::destination(IPAddress host, uint16_t port) {
 
     if ((uint32_t)ip_ == (uint32_t)0) {
         started_ = false;
-        remove_queued_messages(log_level());
         host_.clear();
     }
 }
@@ -167,7 +142,6 @@ void SyslogService::destination(IPAddress host, uint16_t port) {
 void SyslogService::destination(const char * host, uint16_t port) {
     if (host == nullptr || host[0] == '\0') {
         started_ = false;
-        remove_queued_messages(log_level());
         ip_ = (IPAddress)(uint32_t)0;
         host_.clear();
         return;
@@ -178,7 +152,6 @@ void SyslogService::destination(const char * host, uint16_t port) {
         host_.clear();
         if ((uint32_t)ip_ == (uint32_t)0) {
             started_ = false;
-            remove_queued_messages(log_level());
         }
     } else {
         ip_ = (IPAddress)(uint32_t)0;
@@ -205,53 +178,15 @@ void SyslogService::mark_interval(unsigned long interval) {
     mark_interval_ = (uint64_t)interval * 1000;
 }
 
-SyslogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
-    // Added by proddy - check for Ethernet too. This assumes the network has already started.
-    if (time_good_ || emsesp::EMSESP::system_.network_connected()) {
-#if UUID_SYSLOG_HAVE_GETTIMEOFDAY
-        if (gettimeofday(&time_, nullptr) != 0) {
-            time_.tv_sec = (time_t)-1;
-        }
-#else
-        time_.tv_sec  = time(nullptr);
-        time_.tv_usec = 0;
-#endif
-        if (time_.tv_sec >= 0 && time_.tv_sec < 18140 * 86400) {
-            time_.tv_sec = (time_t)-1;
-        }
-
-        if (time_.tv_sec != (time_t)-1) {
-            time_good_ = true;
-        }
-    } else {
-        time_.tv_sec = (time_t)-1;
-    }
-}
-
-void SyslogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_overflow_ = true;
-        log_messages_.pop_front();
-    }
-
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
-}
-
 void SyslogService::loop() {
-    while (!log_messages_.empty() && can_transmit()) {
-        auto message = log_messages_.front();
+    const uuid::log::Message * message;
 
-        started_               = true;
-        log_messages_overflow_ = false;
-        auto ok                = transmit(message);
+    while ((message = peek_message(maximum_log_messages_)) != nullptr && can_transmit()) {
+        started_ = true;
+        auto ok  = transmit(*message, log_message_id_);
         if (ok) {
-            // The transmit() may have called yield() allowing
-            // other messages to have been added to the queue.
-            if (!log_messages_overflow_) {
-                log_messages_.pop_front();
-            }
+            pop_message();
+            log_message_id_++;
             last_message_ = uuid::get_uptime_ms();
         }
 
@@ -262,15 +197,19 @@ void SyslogService::loop() {
         }
     }
 
-    if (started_ && mark_interval_ != 0 && log_messages_.empty()) {
+    if (started_ && mark_interval_ != 0 && lag() == 0) {
         if (uuid::get_uptime_ms() - last_message_ >= mark_interval_) {
             // This is generated manually because the log level may not
             // be high enough to receive INFO messages.
-            operator<<(std::make_shared<uuid::log::Message>(uuid::get_uptime_ms(),
-                                                            uuid::log::Level::INFO,
-                                                            uuid::log::Facility::SYSLOG,
-                                                            reinterpret_cast<const __FlashStringHelper *>(__pstr__logger_name),
-                                                            uuid::read_flash_string(F("-- MARK --"))));
+            uuid::log::Message mark{uuid::get_uptime_ms(),
+                                    uuid::log::Level::INFO,
+                                    uuid::log::Facility::SYSLOG,
+                                    reinterpret_cast<const __FlashStringHelper *>(__pstr__logger_name),
+                                    uuid::read_flash_string(F("-- MARK --"))};
+            if (can_transmit() && transmit(mark, log_message_id_)) {
+                log_message_id_++;
+                last_message_ = uuid::get_uptime_ms();
+            }
         }
     }
 }
@@ -406,16 +345,47 @@ bool SyslogService::can_transmit() {
     return true;
 }
 
-bool SyslogService::transmit(const QueuedLogMessage & message) {
-    struct tm tm;
-    int8_t    tzh = 0;
-    int8_t    tzm = 0;
+bool SyslogService::transmit(const uuid::log::Message & message, unsigned long id) {
+    struct timeval time;
+    struct tm      tm;
+    int8_t         tzh = 0;
+    int8_t         tzm = 0;
+
+    // Added by proddy - check for Ethernet too. This assumes the network has already started.
+    time.tv_sec = (time_t)-1;
+    if (time_good_ || emsesp::EMSESP::system_.network_connected()) {
+#if UUID_SYSLOG_HAVE_GETTIMEOFDAY
+        if (gettimeofday(&time, nullptr) != 0) {
+            time.tv_sec = (time_t)-1;
+        }
+#else
+        time.tv_sec  = ::time(nullptr);
+        time.tv_usec = 0;
+#endif
+        if (time.tv_sec >= 0 && time.tv_sec < 18140 * 86400) {
+            time.tv_sec = (time_t)-1;
+        }
+
+        if (time.tv_sec != (time_t)-1) {
+            time_good_ = true;
+
+            // the message is read from the log buffer later, so go back to when it was logged
+            uint64_t age  = uuid::get_uptime_ms() - message.uptime_ms;
+            long     usec = (long)time.tv_usec - (long)(age % 1000) * 1000;
+            time.tv_sec -= age / 1000;
+            if (usec < 0) {
+                usec += 1000000;
+                time.tv_sec--;
+            }
+            time.tv_usec = usec;
+        }
+    }
 
     tm.tm_year = 0;
-    if (message.time_.tv_sec != (time_t)-1) {
+    if (time.tv_sec != (time_t)-1) {
         struct tm utc;
-        gmtime_r(&message.time_.tv_sec, &utc);
-        localtime_r(&message.time_.tv_sec, &tm);
+        gmtime_r(&time.tv_sec, &utc);
+        localtime_r(&time.tv_sec, &tm);
         int16_t diff = 60 * (tm.tm_hour - utc.tm_hour) + tm.tm_min - utc.tm_min;
         diff         = diff > 720 ? diff - 1440 : diff < -720 ? diff + 1440 : diff;
         tzh          = diff / 60;
@@ -427,22 +397,22 @@ bool SyslogService::transmit(const QueuedLogMessage & message) {
         return false;
     }
 
-    udp_.printf_P(PSTR("<%u>1 "), ((unsigned int)message.content_->facility * 8) + std::min(7U, (unsigned int)message.content_->level));
+    udp_.printf_P(PSTR("<%u>1 "), ((unsigned int)message.facility * 8) + std::min(7U, (unsigned int)message.level));
     if (tm.tm_year != 0) {
-        udp_.printf_P(PSTR("%04u-%02u-%02uT%02u:%02u:%02u.%06u%+02d:%02d"), tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, (uint32_t)message.time_.tv_usec, tzh, tzm);
+        udp_.printf_P(PSTR("%04u-%02u-%02uT%02u:%02u:%02u.%06u%+02d:%02d"), tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, (uint32_t)time.tv_usec, tzh, tzm);
     } else {
         udp_.print('-');
     }
 
-    udp_.printf_P(PSTR(" %s %s - - - "), hostname_.c_str(), uuid::read_flash_string(message.content_->name).c_str());
+    udp_.printf_P(PSTR(" %s %s - - - "), hostname_.c_str(), uuid::read_flash_string(message.name).c_str());
 
     char id_c_str[15];
-    snprintf_P(id_c_str, sizeof(id_c_str), PSTR(" %lu: "), message.id_);
-    std::string msgstr = uuid::log::format_timestamp_ms(message.content_->uptime_ms, 3) +
+    snprintf_P(id_c_str, sizeof(id_c_str), PSTR(" %lu: "), id);
+    std::string msgstr = uuid::log::format_timestamp_ms(message.uptime_ms, 3) +
                          ' ' +
-                         uuid::log::format_level_char(message.content_->level) +
+                         uuid::log::format_level_char(message.level) +
                          id_c_str +
-                         message.content_->text;
+                         message.text();
     for (uint16_t i = 0; i < msgstr.length(); i++) {
         if (msgstr.at(i) & 0x80) {
             udp_.print("\xEF\xBB\xBF");
@@ -29,7 +29,6 @@
 #include <time.h>
 
 #include <atomic>
-#include <list>
 #include <memory>
 #include <string>
 
@@ -74,8 +73,7 @@ class SyslogService : public uuid::log::Handler {
     /**
 	 * Get the current log level.
 	 *
-	 * This only affects newly received log messages, not messages that
-	 * have already been queued.
+	 * This affects all log messages that have not been sent yet.
 	 *
 	 * @return The current log level.
 	 * @since 2.0.0
@@ -84,9 +82,7 @@ class SyslogService : public uuid::log::Handler {
     /**
 	 * Set the current log level.
 	 *
-	 * Unless this is the first time the log level is being set, this
-	 * only affects newly received log messages, not messages that have
-	 * already been queued.
+	 * This affects all log messages that have not been sent yet.
 	 *
 	 * @param[in] level Minimum log level that will be sent to the
 	 *                  syslog server.
@@ -104,7 +100,10 @@ class SyslogService : public uuid::log::Handler {
     /**
 	 * Set the maximum number of queued log messages.
 	 *
-	 * Defaults to SyslogService::MAX_LOG_MESSAGES.
+	 * Defaults to SyslogService::MAX_LOG_MESSAGES. Older messages in the
+	 * shared log buffer are skipped when the service falls further
+	 * behind, and it can't be more than
+	 * uuid::log::Logger::maximum_log_messages().
 	 *
 	 * @since 2.0.0
 	 */
@@ -171,25 +170,12 @@ class SyslogService : public uuid::log::Handler {
 	 */
     void loop();
 
-    /**
-	 * Add a new log message.
-	 *
-	 * This will be put in a queue for output at the next loop()
-	 * process. The queue has a maximum size of
-	 * get_maximum_log_messages() and will discard the oldest message
-	 * first.
-	 *
-	 * @param[in] message New log message, shared by all handlers.
-	 * @since 1.0.0
-	 */
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message);
-
     /**
 	* added MichaelDvP
 	* query status variables
     */
     size_t queued() {
-        return log_messages_.size();
+        return lag();
     }
     bool started() {
         return started_;
@@ -199,43 +185,6 @@ class SyslogService : public uuid::log::Handler {
     }
 
   private:
-    /**
-	 * Log message that has been queued.
-	 *
-	 * Contains an identifier sequence to indicate when log messages
-	 * could not be output because the queue discarded one or more
-	 * messages.
-	 *
-	 * @since 1.0.0
-	 */
-    class QueuedLogMessage {
-      public:
-        /**
-		 * Create a queued log message.
-		 *
-		 * @param[in] id Identifier to use for the log message on the queue.
-		 * @param[in] content Log message content.
-		 * @since 1.0.0
-		 */
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                                   id_;      /*!< Sequential identifier for this log message. @since 1.0.0 */
-        struct timeval                                  time_;    /*!< Time message was received. @since 1.0.0 */
-        const std::shared_ptr<const uuid::log::Message> content_; /*!< Log message content. @since 1.0.0 */
-
-      private:
-        static bool time_good_; /*!< System time appears to be valid. @since 1.0.0 */
-    };
-
-    /**
-	 * Remove messages that were queued before the log level was set.
-	 *
-	 * @param[in] level New log level
-	 * @since 1.0.0
-	 */
-    void remove_queued_messages(uuid::log::Level level);
-
     /**
 	 * Check if it is possible to transmit to the server.
 	 *
@@ -249,27 +198,27 @@ class SyslogService : public uuid::log::Handler {
 	 * Attempt to transmit one message to the server.
 	 *
 	 * @param[in] message Log message to be sent.
+	 * @param[in] id Sequential identifier for this log message.
 	 * @return True if the message was successfully set, otherwise
 	 *         false.
 	 * @since 1.0.0
 	 */
-    bool transmit(const QueuedLogMessage & message);
-
-    static uuid::log::Logger logger_; /*!< uuid::log::Logger instance for syslog services. @since 1.0.0 */
-
-    bool                        started_ = false;                         /*!< Flag to indicate that messages have started being transmitted. @since 1.0.0 */
-    WiFiUDP                     udp_;                                     /*!< UDP client. @since 1.0.0 */
-    IPAddress                   ip_;                                      /*!< Host-IP to send messages to. @since 1.0.0 */
-    std::string                 host_;                                    /*!< Host to send messages to. */
-    uint16_t                    port_          = DEFAULT_PORT;            /*!< Port to send messages to. @since 1.0.0 */
-    uint64_t                    last_transmit_ = 0;                       /*!< Last transmit time. @since 1.0.0 */
-    std::string                 hostname_{'-'};                           /*!< Local hostname. @since 1.0.0 */
-    size_t                      maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum number of log messages to buffer before they are output. @since 1.0.0 */
-    unsigned long               log_message_id_       = 0;                /*!< The next identifier to use for queued log messages. @since 1.0.0 */
-    std::list<QueuedLogMessage> log_messages_;                            /*!< Queued log messages, in the order they were received. @since 1.0.0 */
-    std::atomic<bool>           log_messages_overflow_{false};            /*!< Check if log messages have overflowed the buffer. @since 1.0.0 */
-    uint64_t                    mark_interval_ = 0;                       /*!< Mark interval in milliseconds. @since 2.0.0 */
-    uint64_t                    last_message_  = 0;                       /*!< Last message/mark time. @since 2.0.0 */
+    bool transmit(const uuid::log::Message & message, unsigned long id);
+
+    static uuid::log::Logger logger_;    /*!< uuid::log::Logger instance for syslog services. @since 1.0.0 */
+    static bool              time_good_; /*!< System time appears to be valid. @since 1.0.0 */
+
+    bool          started_ = false;                         /*!< Flag to indicate that messages have started being transmitted. @since 1.0.0 */
+    WiFiUDP       udp_;                                     /*!< UDP client. @since 1.0.0 */
+    IPAddress     ip_;                                      /*!< Host-IP to send messages to. @since 1.0.0 */
+    std::string   host_;                                    /*!< Host to send messages to. */
+    uint16_t      port_          = DEFAULT_PORT;            /*!< Port to send messages to. @since 1.0.0 */
+    uint64_t      last_transmit_ = 0;                       /*!< Last transmit time. @since 1.0.0 */
+    std::string   hostname_{'-'};                           /*!< Local hostname. @since 1.0.0 */
+    size_t        maximum_log_messages_ = MAX_LOG_MESSAGES; /*!< Maximum number of log messages to buffer before they are output. @since 1.0.0 */
+    unsigned long log_message_id_       = 0;                /*!< The next identifier to use for sent log messages. @since 1.0.0 */
+    uint64_t      mark_interval_ = 0;                       /*!< Mark interval in milliseconds. @since 2.0.0 */
+    uint64_t      last_message_  = 0;                       /*!< Last message/mark time. @since 2.0.0 */
 };
 
 } // namespace syslog
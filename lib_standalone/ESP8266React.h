@@ -36,10 +36,14 @@ class DummySettings {
     bool     mqtt_retain       = false;
     bool     enabled           = true;
     uint8_t  nested_format     = 1; // 1=nested 2=single
+    uint8_t  payload_format    = 1; // 1=json 2=MessagePack
+    bool     publish_single    = false;
     uint8_t  ha_climate_format = 1;
     bool     ha_enabled        = true;
     String   base              = "ems-esp";
     bool     send_response     = true;
+    uint16_t publish_budget    = 10000; // bytes per second
+    bool     cleanSession      = true;
 
     String   hostname                = "ems-esp";
     String   jwtSecret               = "ems-esp";
@@ -225,6 +225,9 @@ const mqtt_settings = {
   ha_climate_format: 1,
   ha_enabled: true,
   nested_format: 1,
+  payload_format: 1,
+  publish_single: false,
+  publish_budget: 10000,
   send_response: true,
 }
 const mqtt_status = {
@@ -793,12 +796,16 @@ const streamLog = (req, res) => {
   let interval = setInterval(function generateAndSendLog() {
     count = count + 1
 
-    const data = {
-      time: '000+00:00:00.000',
-      level: 3,
-      name: 'system',
-      message: 'this is message #' + count,
-    }
+    // like the backend, all pending messages are sent as one array
+    const data = [
+      {
+        t: '000+00:00:00.000',
+        l: 3,
+        i: count,
+        n: 'system',
+        m: 'this is message #' + count,
+      },
+    ]
 
     res.sendEventStreamData(data)
   }, 1000)
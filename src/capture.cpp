@@ -0,0 +1,283 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capture.h"
+
+#if defined(EMSESP_STANDALONE)
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#endif
+
+namespace emsesp {
+
+std::vector<uint8_t> Capture::buffer_;
+volatile size_t      Capture::size_       = 0;
+std::atomic<bool>    Capture::recording_{false};
+std::atomic<bool>    Capture::adding_{false};
+uint32_t             Capture::start_time_ = 0;
+
+// clears the buffer and starts recording
+void Capture::start() {
+    recording_ = false;
+    while (adding_) {
+    }
+    buffer_.resize(MAX_SIZE);
+    buffer_[0] = 'E';
+    buffer_[1] = 'M';
+    buffer_[2] = 'S';
+    buffer_[3] = 'C';
+    buffer_[4] = VERSION;
+
+    size_       = HEADER_SIZE;
+    start_time_ = ::millis(); // uptime is only updated once per loop
+    recording_  = true;
+}
+
+// keeps what was recorded and gives back the rest of the buffer
+void Capture::stop() {
+    recording_ = false;
+    while (adding_) {
+    }
+    buffer_.resize(size_);
+    buffer_.shrink_to_fit();
+}
+
+// adds a record with the frame, recording stops when the buffer is full
+void Capture::add(const uint8_t * data, const uint8_t length) {
+    size_t pos = size_;
+    if (pos + RECORD_SIZE + length > buffer_.size()) {
+        recording_ = false;
+        return;
+    }
+
+    uint32_t time  = ::millis() - start_time_;
+    buffer_[pos++] = time;
+    buffer_[pos++] = time >> 8;
+    buffer_[pos++] = time >> 16;
+    buffer_[pos++] = time >> 24;
+    buffer_[pos++] = length;
+    memcpy(&buffer_[pos], data, length);
+    size_ = pos + length;
+}
+
+// # frames in the capture, empty records are skipped like in a replay
+uint32_t Capture::frames() {
+    uint32_t frames = 0;
+    size_t   pos    = HEADER_SIZE;
+    while (pos + RECORD_SIZE <= size_) {
+        uint8_t length = buffer_[pos + 4];
+        pos += RECORD_SIZE + length;
+        if (pos > size_) {
+            break;
+        }
+        if (length) {
+            frames++;
+        }
+    }
+    return frames;
+}
+
+// writes the capture to a file, on the ESP32 this is LittleFS
+bool Capture::save(const char * filename) {
+    if (recording_ || (size_ <= HEADER_SIZE)) {
+        return false;
+    }
+
+#if defined(EMSESP_STANDALONE)
+    FILE * file = fopen(filename, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = (fwrite(buffer_.data(), 1, size_, file) == size_);
+    fclose(file);
+#else
+    File file = LITTLEFS.open(filename, "w");
+    if (!file) {
+        return false;
+    }
+    bool ok = (file.write(buffer_.data(), size_) == size_);
+    file.close();
+#endif
+
+    // it's in the file now, so the memory is given back
+    if (ok) {
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+        size_ = 0;
+    }
+    return ok;
+}
+
+// prints the capture in hex, 32 bytes per line
+void Capture::show(uuid::console::Shell & shell) {
+    if (recording_) {
+        shell.printfln(F("Capture is still recording (%lu bytes)"), (unsigned long)size_);
+        return;
+    }
+    if (size_ <= HEADER_SIZE) {
+        shell.printfln(F("Capture is empty"));
+        return;
+    }
+
+    char line[65];
+    for (size_t pos = 0; pos < size_; pos += 32) {
+        uint8_t n = 0;
+        for (size_t i = pos; (i < size_) && (i < pos + 32); i++) {
+            Helpers::hextoa(&line[n], buffer_[i]);
+            n += 2;
+        }
+        line[n] = '\0';
+        shell.println(line);
+    }
+}
+
+#if defined(EMSESP_STANDALONE)
+// reads a capture from a file, e.g. one saved on the ESP32 and copied over
+bool Capture::load(const char * filename) {
+    FILE * file = fopen(filename, "rb");
+    if (!file) {
+        return false;
+    }
+
+    recording_ = false;
+    buffer_.clear();
+    uint8_t buf[256];
+    size_t  n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        buffer_.insert(buffer_.end(), buf, buf + n);
+    }
+    fclose(file);
+
+    size_ = buffer_.size();
+    if ((size_ < HEADER_SIZE) || memcmp(buffer_.data(), "EMSC", 4) || (buffer_[4] != VERSION)) {
+        size_ = 0;
+        return false;
+    }
+    return true;
+}
+
+// bytes allocated on the heap, used for the high-water mark
+static size_t heap_used() {
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#elif defined(__GLIBC__)
+    return mallinfo().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// feeds the capture through the UART entry point and processes each frame like the main loop does
+// with wire_speed the timing of the capture is kept, otherwise it runs as fast as possible
+// reports the throughput, the time spent per stage and the heap high-water mark
+uint32_t Capture::replay(uuid::console::Shell & shell, const bool wire_speed, const uint16_t loops) {
+    recording_ = false;
+    if (size_ <= HEADER_SIZE) {
+        shell.printfln(F("Capture is empty"));
+        return 0;
+    }
+
+    // as fast as possible shouldn't include the logging
+    uint8_t          watch     = EMSESP::watch();
+    uuid::log::Level log_level = shell.log_level();
+    if (!wire_speed) {
+        EMSESP::watch(EMSESP::WATCH_OFF);
+        shell.log_level(uuid::log::Level::NOTICE);
+    }
+
+    uint8_t  frame[256];
+    uint32_t frames      = 0;
+    uint64_t rx_ns       = 0;
+    uint64_t rx_max      = 0;
+    uint64_t process_ns  = 0;
+    uint64_t process_max = 0;
+    size_t   heap_start  = heap_used();
+    size_t   heap_max    = heap_start;
+    uint32_t skip_start  = EMSESP::rx_skip_count();
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint16_t loop = 0; loop < loops; loop++) {
+        auto   loop_start = std::chrono::steady_clock::now();
+        size_t pos        = HEADER_SIZE;
+        while (pos + RECORD_SIZE <= size_) {
+            uint32_t time   = buffer_[pos] | (buffer_[pos + 1] << 8) | (buffer_[pos + 2] << 16) | ((uint32_t)buffer_[pos + 3] << 24);
+            uint8_t  length = buffer_[pos + 4];
+            pos += RECORD_SIZE;
+            if (pos + length > size_) {
+                break;
+            }
+            memcpy(frame, &buffer_[pos], length);
+            pos += length;
+            if (length == 0) {
+                continue;
+            }
+
+            if (wire_speed) {
+                std::this_thread::sleep_until(loop_start + std::chrono::milliseconds(time));
+            }
+
+            auto t0 = std::chrono::steady_clock::now();
+            EMSESP::incoming_telegram(frame, length);
+            auto t1 = std::chrono::steady_clock::now();
+            EMSESP::rxservice_.loop();
+            auto t2 = std::chrono::steady_clock::now();
+
+            uint64_t rx      = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            uint64_t process = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+            rx_ns      += rx;
+            process_ns += process;
+            rx_max      = std::max(rx_max, rx);
+            process_max = std::max(process_max, process);
+            heap_max    = std::max(heap_max, heap_used());
+            frames++;
+        }
+    }
+    auto total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    // publish everything once, like after a publish interval
+    auto t0 = std::chrono::steady_clock::now();
+    EMSESP::publish_all();
+    auto publish_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    heap_max        = std::max(heap_max, heap_used());
+
+    EMSESP::watch(watch);
+    shell.log_level(log_level);
+
+    if (frames == 0) {
+        shell.printfln(F("No frames in capture"));
+        return 0;
+    }
+
+    shell.printfln(F("Replayed %lu frames in %.1f ms, %.0f telegrams/sec"),
+                   (unsigned long)frames,
+                   (double)total_ns / 1000000,
+                   (double)frames * 1000000000 / total_ns);
+    shell.printfln(F("Stage rx (uart to Rx queue): avg %.2f us, max %.2f us"), (double)rx_ns / frames / 1000, (double)rx_max / 1000);
+    shell.printfln(F("Stage process (Rx queue to device values): avg %.2f us, max %.2f us"), (double)process_ns / frames / 1000, (double)process_max / 1000);
+    shell.printfln(F("Unchanged broadcasts not processed: %lu"), (unsigned long)(EMSESP::rx_skip_count() - skip_start));
+    shell.printfln(F("Stage publish (all device values to MQTT queue): %.2f us"), (double)publish_ns / 1000);
+    shell.printfln(F("Heap high-water: %lu bytes above start"), (unsigned long)(heap_max - heap_start));
+    return frames;
+}
+#endif
+
+} // namespace emsesp
@@ -0,0 +1,91 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_CAPTURE_H
+#define EMSESP_CAPTURE_H
+
+#include "emsesp.h"
+
+#include <atomic>
+
+namespace emsesp {
+
+// records the raw frames from the EMS bus, including polls and echoes, so they can be replayed in the standalone build
+//
+// capture format, all numbers little-endian:
+//   header : "EMSC" and a version byte
+//   record : uint32_t time in ms since the start of the capture, uint8_t length, followed by the raw frame including the CRC
+//
+// the capture is saved to the filesystem with 'capture save', or shown in hex with 'capture show'
+// which can be copied from a telnet session and converted back to a binary file with 'xxd -r -p'
+class Capture {
+  public:
+    static void start();
+    static void stop();
+    static bool save(const char * filename);
+    static void show(uuid::console::Shell & shell);
+
+    // called for every frame from the UART, before anything else is done with it
+    static void record(const uint8_t * data, const uint8_t length) {
+        if (recording_) {
+            adding_ = true;
+            if (recording_) { // stop() may have come in between, then it doesn't wait for us
+                add(data, length);
+            }
+            adding_ = false;
+        }
+    }
+
+    static bool recording() {
+        return recording_;
+    }
+
+    static size_t size() {
+        return size_;
+    }
+
+    static uint32_t frames();
+
+#if defined(EMSESP_STANDALONE)
+    static bool load(const char * filename);
+    // returns the # frames replayed
+    static uint32_t replay(uuid::console::Shell & shell, const bool wire_speed, const uint16_t loops = 1);
+#endif
+
+    static constexpr const char * FILENAME = "/capture.bin";
+
+  private:
+    static constexpr uint8_t  VERSION     = 1;
+    static constexpr uint8_t  HEADER_SIZE = 5;
+    static constexpr uint8_t  RECORD_SIZE = 5;     // without the frame itself
+    static constexpr uint16_t MAX_SIZE    = 16384; // buffer is allocated when starting a capture
+
+    static void add(const uint8_t * data, const uint8_t length);
+
+    // the buffer doesn't grow while recording, so frames can be added from the UART task
+    // stop() waits for a frame that is still being added before it shrinks the buffer
+    static std::vector<uint8_t> buffer_;
+    static volatile size_t      size_;
+    static std::atomic<bool>    recording_;
+    static std::atomic<bool>    adding_;
+    static uint32_t             start_time_;
+};
+
+} // namespace emsesp
+
+#endif
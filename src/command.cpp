@@ -25,6 +25,8 @@ namespace emsesp {
 uuid::log::Logger Command::logger_{F_(command), uuid::log::Facility::DAEMON};
 
 std::vector<Command::CmdFunction> Command::cmdfunctions_;
+std::vector<Command::CmdIndex>    Command::cmd_index_;
+std::string                       Command::cmd_keys_;
 
 // takes a path and a json body, parses the data and calls the command
 // the path is leading so if duplicate keys are in the input JSON it will be ignored
@@ -61,9 +63,6 @@ uint8_t Command::process(const char * path, const bool is_admin, const JsonObjec
         return message(CommandRet::ERROR, "missing command in path", output);
     }
 
-    std::string cmd_s;
-    int8_t      id_n = -1; // default hc
-
     // check for a device as first item in the path
     // if its not a known device (thermostat, boiler etc) look for any special MQTT subscriptions
     const char * device_s = nullptr;
@@ -85,16 +84,35 @@ uint8_t Command::process(const char * path, const bool is_admin, const JsonObjec
     }
 
     // the next value on the path should be the command
-    const char * command_p = nullptr;
+    // concatenate the path into one string as it could be in the format 'hc/XXX'
+    char command[50];
     if (num_paths == 2) {
-        command_p = p.paths()[1].c_str();
+        strlcpy(command, p.paths()[1].c_str(), sizeof(command));
     } else if (num_paths >= 3) {
-        // concatenate the path into one string as it could be in the format 'hc/XXX'
-        char command[50];
         snprintf(command, sizeof(command), "%s/%s", p.paths()[1].c_str(), p.paths()[2].c_str());
-        command_p = command;
     } else {
+        command[0] = '\0';
+    }
+
+    return process(device_type, command, is_admin, input, output);
+}
+
+// calls the command of a device, which can be prefixed with the hc or wwc
+// if the command is empty it's taken from the JSON input, or defaults to info or values
+// this is used directly by MQTT, where the device is already known from the topic
+uint8_t Command::process(const uint8_t device_type, const char * command, const bool is_admin, const JsonObject & input, JsonObject & output) {
+    if (!device_has_commands(device_type)) {
+        return message(CommandRet::ERROR, "unknown device", output);
+    }
+
+    // a command with a path like 'hc1/seltemp' must be valid, otherwise there is a default
+    bool        has_path  = (strchr(command, '/') != nullptr);
+    const char * command_p = command;
+    int8_t      id_n      = -1; // default hc
+
+    if (!*command_p) {
         // take it from the JSON
+        command_p = nullptr;
         if (input.containsKey("entity")) {
             command_p = input["entity"];
         } else if (input.containsKey("cmd")) {
@@ -108,7 +126,7 @@ uint8_t Command::process(const char * path, const bool is_admin, const JsonObjec
     if (command_p == nullptr) {
         // handle dead endpoints like api/system or api/boiler
         // default to 'info' for SYSTEM and DALLASENSOR, the other devices to 'values' for shortname version
-        if (num_paths < 3) {
+        if (!has_path) {
             if (device_type < EMSdevice::DeviceType::BOILER) {
                 command_p = "info";
             } else {
@@ -277,6 +295,7 @@ uint8_t Command::call(const uint8_t device_type, const char * cmd, const char *
             return_code = ((cf->cmdfunction_json_)(value, id, output)) ? CommandRet::OK : CommandRet::ERROR;
         }
         if (cf->cmdfunction_) {
+            EMSESP::rx_fingerprint_clear(); // a setter may change values locally, the next broadcast should correct them
             return_code = ((cf->cmdfunction_)(value, id)) ? CommandRet::OK : CommandRet::ERROR;
         }
 
@@ -306,6 +325,8 @@ void Command::add(const uint8_t device_type, const __FlashStringHelper * cmd, co
     }
 
     cmdfunctions_.emplace_back(device_type, flags, cmd, cb, nullptr, description); // callback for json is nullptr
+    add_index(device_type, cmd);
+    Mqtt::add_command_topic(device_type);
 }
 
 // add a command to the list, which does return a json object as output
@@ -317,6 +338,25 @@ void Command::add(const uint8_t device_type, const __FlashStringHelper * cmd, co
     }
 
     cmdfunctions_.emplace_back(device_type, (CommandFlag::MQTT_SUB_FLAG_NOSUB | flags), cmd, nullptr, cb, description); // callback for json is included
+    add_index(device_type, cmd);
+    Mqtt::add_command_topic(device_type);
+}
+
+// add the last added command to the index, the name is stored once in lowercase
+void Command::add_index(const uint8_t device_type, const __FlashStringHelper * cmd) {
+    uint16_t key = cmd_keys_.size();
+    cmd_keys_ += Helpers::toLower(read_flash_string(cmd));
+    cmd_keys_ += '\0';
+
+    cmd_index_.emplace(find_index(device_type, &cmd_keys_[key]), device_type, key, cmdfunctions_.size() - 1);
+}
+
+// returns the first index entry for the device type that is not less than the lowercase key
+// use an empty key to get the start of the commands for a device type
+std::vector<Command::CmdIndex>::const_iterator Command::find_index(const uint8_t device_type, const char * key) {
+    return std::lower_bound(cmd_index_.cbegin(), cmd_index_.cend(), key, [device_type](const CmdIndex & ci, const char * key) {
+        return (ci.device_type_ < device_type) || ((ci.device_type_ == device_type) && (strcmp(&cmd_keys_[ci.key_], key) < 0));
+    });
 }
 
 // see if a command exists for that device type
@@ -333,10 +373,9 @@ Command::CmdFunction * Command::find_command(const uint8_t device_type, const ch
         *p = tolower(*p);
     }
 
-    for (auto & cf : cmdfunctions_) {
-        if (!strcmp(lowerCmd, Helpers::toLower(read_flash_string(cf.cmd_)).c_str()) && (cf.device_type_ == device_type)) {
-            return &cf;
-        }
+    auto it = find_index(device_type, lowerCmd);
+    if ((it != cmd_index_.cend()) && (it->device_type_ == device_type) && !strcmp(&cmd_keys_[it->key_], lowerCmd)) {
+        return &cmdfunctions_[it->cmd_];
     }
 
     return nullptr; // command not found
@@ -349,20 +388,11 @@ bool Command::list(const uint8_t device_type, JsonObject & output) {
         return false;
     }
 
-    // create a list of commands, sort them
-    std::list<std::string> sorted_cmds;
-    for (const auto & cf : cmdfunctions_) {
-        if ((cf.device_type_ == device_type) && !cf.has_flags(CommandFlag::HIDDEN)) {
-            sorted_cmds.push_back(read_flash_string(cf.cmd_));
-        }
-    }
-    sorted_cmds.sort();
-
-    for (auto & cl : sorted_cmds) {
-        for (const auto & cf : cmdfunctions_) {
-            if ((cf.device_type_ == device_type) && !cf.has_flags(CommandFlag::HIDDEN) && cf.description_ && (cl == read_flash_string(cf.cmd_))) {
-                output[cl] = cf.description_;
-            }
+    // the index is already sorted by name
+    for (auto it = find_index(device_type, ""); (it != cmd_index_.cend()) && (it->device_type_ == device_type); ++it) {
+        const auto & cf = cmdfunctions_[it->cmd_];
+        if (!cf.has_flags(CommandFlag::HIDDEN) && cf.description_) {
+            output[cf.cmd_] = cf.description_;
         }
     }
 
@@ -376,20 +406,17 @@ void Command::show(uuid::console::Shell & shell, uint8_t device_type, bool verbo
         return;
     }
 
-    // create a list of commands, sort them
-    std::list<std::string> sorted_cmds;
-    for (const auto & cf : cmdfunctions_) {
-        if ((cf.device_type_ == device_type) && !cf.has_flags(CommandFlag::HIDDEN)) {
-            sorted_cmds.push_back(read_flash_string(cf.cmd_));
-        }
-    }
-    sorted_cmds.sort();
+    // the index is already sorted by name
+    auto first = find_index(device_type, "");
 
     // if not in verbose mode, just print them on a single line
     if (!verbose) {
-        for (auto & cl : sorted_cmds) {
-            shell.print(cl);
-            shell.print(" ");
+        for (auto it = first; (it != cmd_index_.cend()) && (it->device_type_ == device_type); ++it) {
+            const auto & cf = cmdfunctions_[it->cmd_];
+            if (!cf.has_flags(CommandFlag::HIDDEN)) {
+                shell.print(cf.cmd_);
+                shell.print(" ");
+            }
         }
         shell.println();
         return;
@@ -397,37 +424,39 @@ void Command::show(uuid::console::Shell & shell, uint8_t device_type, bool verbo
 
     // verbose mode
     shell.println();
-    for (auto & cl : sorted_cmds) {
-        // find and print the description
-        for (const auto & cf : cmdfunctions_) {
-            if ((cf.device_type_ == device_type) && !cf.has_flags(CommandFlag::HIDDEN) && cf.description_ && (cl == read_flash_string(cf.cmd_))) {
-                uint8_t i = cl.length();
-                shell.print("  ");
-                if (cf.has_flags(MQTT_SUB_FLAG_HC)) {
-                    shell.print("[hc<n>.]");
-                    i += 8;
-                } else if (cf.has_flags(MQTT_SUB_FLAG_WWC)) {
-                    shell.print("[wwc<n>.]");
-                    i += 9;
-                }
-                shell.print(cl);
-                // pad with spaces
-                while (i++ < 22) {
-                    shell.print(' ');
-                }
-                shell.print(COLOR_BRIGHT_CYAN);
-                if (cf.has_flags(MQTT_SUB_FLAG_WW)) {
-                    shell.print(EMSdevice::tag_to_string(TAG_DEVICE_DATA_WW));
-                    shell.print(' ');
-                }
-                shell.print(read_flash_string(cf.description_));
-                if (!cf.has_flags(CommandFlag::ADMIN_ONLY)) {
-                    shell.print(' ');
-                    shell.print(COLOR_BRIGHT_RED);
-                    shell.print('*');
-                }
-                shell.print(COLOR_RESET);
+    for (auto it = first; (it != cmd_index_.cend()) && (it->device_type_ == device_type); ++it) {
+        const auto & cf = cmdfunctions_[it->cmd_];
+        if (cf.has_flags(CommandFlag::HIDDEN)) {
+            continue;
+        }
+        // print the description
+        if (cf.description_) {
+            uint8_t i = strlen(&cmd_keys_[it->key_]);
+            shell.print("  ");
+            if (cf.has_flags(MQTT_SUB_FLAG_HC)) {
+                shell.print("[hc<n>.]");
+                i += 8;
+            } else if (cf.has_flags(MQTT_SUB_FLAG_WWC)) {
+                shell.print("[wwc<n>.]");
+                i += 9;
+            }
+            shell.print(cf.cmd_);
+            // pad with spaces
+            while (i++ < 22) {
+                shell.print(' ');
+            }
+            shell.print(COLOR_BRIGHT_CYAN);
+            if (cf.has_flags(MQTT_SUB_FLAG_WW)) {
+                shell.print(EMSdevice::tag_to_string(TAG_DEVICE_DATA_WW));
+                shell.print(' ');
             }
+            shell.print(cf.description_);
+            if (!cf.has_flags(CommandFlag::ADMIN_ONLY)) {
+                shell.print(' ');
+                shell.print(COLOR_BRIGHT_RED);
+                shell.print('*');
+            }
+            shell.print(COLOR_RESET);
         }
         shell.println();
     }
@@ -453,11 +482,8 @@ bool Command::device_has_commands(const uint8_t device_type) {
     for (const auto & emsdevice : EMSESP::emsdevices) {
         if ((emsdevice) && (emsdevice->device_type() == device_type)) {
             // device found, now see if it has any commands
-            for (const auto & cf : cmdfunctions_) {
-                if (cf.device_type_ == device_type) {
-                    return true;
-                }
-            }
+            auto it = find_index(device_type, "");
+            return ((it != cmd_index_.cend()) && (it->device_type_ == device_type));
         }
     }
 
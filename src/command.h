@@ -131,6 +131,7 @@ class Command {
     static bool list(const uint8_t device_type, JsonObject & output);
 
     static uint8_t process(const char * path, const bool is_admin, const JsonObject & input, JsonObject & output);
+    static uint8_t process(const uint8_t device_type, const char * command, const bool is_admin, const JsonObject & input, JsonObject & output);
 
     static const char * parse_command_string(const char * command, int8_t & id);
 
@@ -141,6 +142,25 @@ class Command {
 
     static std::vector<CmdFunction> cmdfunctions_; // the list of commands
 
+    // index of the commands sorted by device type and lowercase name, so a command can be found without creating strings
+    struct CmdIndex {
+        uint8_t  device_type_; // DeviceType::
+        uint16_t key_;         // offset of the lowercase name in cmd_keys_
+        uint16_t cmd_;         // position in cmdfunctions_
+
+        CmdIndex(const uint8_t device_type, const uint16_t key, const uint16_t cmd)
+            : device_type_(device_type)
+            , key_(key)
+            , cmd_(cmd) {
+        }
+    };
+
+    static std::vector<CmdIndex> cmd_index_;
+    static std::string           cmd_keys_; // all lowercase command names, each null terminated
+
+    static std::vector<CmdIndex>::const_iterator find_index(const uint8_t device_type, const char * key);
+    static void                                  add_index(const uint8_t device_type, const __FlashStringHelper * cmd);
+
     inline static uint8_t message(uint8_t error_code, const char * message, JsonObject & output) {
         output.clear();
         output["message"] = (const char *)message;
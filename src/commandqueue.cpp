@@ -0,0 +1,178 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "emsesp.h"
+
+namespace emsesp {
+
+uuid::log::Logger CommandQueue::logger_{F_(command), uuid::log::Facility::DAEMON};
+
+CommandQueue::CommandQueue() {
+    // slot i is free for the producer at position i
+    for (uint8_t i = 0; i < QUEUE_SIZE; i++) {
+        slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool CommandQueue::in_loop_task() const {
+#if defined(EMSESP_STANDALONE)
+    return std::this_thread::get_id() == loop_task_.load(std::memory_order_relaxed);
+#else
+    return xTaskGetCurrentTaskHandle() == loop_task_.load(std::memory_order_relaxed);
+#endif
+}
+
+bool CommandQueue::post(Job job) {
+    if (in_loop_task()) {
+        job();
+        return true;
+    }
+
+    uint32_t pos = head_.load(std::memory_order_relaxed);
+    Slot *   slot;
+    while (true) {
+        slot         = &slots_[pos & (QUEUE_SIZE - 1)];
+        int32_t diff = (int32_t)(slot->sequence_.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            // the slot is free, try to claim the position. On failure pos has the new head
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // the slot still holds a job from the previous lap, so the queue is full
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head_.load(std::memory_order_relaxed); // another producer got there first
+        }
+    }
+
+    slot->job_ = std::move(job);
+    slot->sequence_.store(pos + 1, std::memory_order_release); // publish it to the consumer
+    return true;
+}
+
+void CommandQueue::loop() {
+    // the main loop always runs in the same task. Another task only ever compares it with itself,
+    // so an old value still tells it that it isn't the main loop
+#if defined(EMSESP_STANDALONE)
+    if (loop_task_.load(std::memory_order_relaxed) == std::thread::id()) {
+        loop_task_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+#else
+    if (loop_task_.load(std::memory_order_relaxed) == nullptr) {
+        loop_task_.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+    }
+#endif
+
+    while (true) {
+        Slot & slot = slots_[tail_ & (QUEUE_SIZE - 1)];
+        if (slot.sequence_.load(std::memory_order_acquire) != tail_ + 1) {
+            break; // empty, or the next job isn't published yet
+        }
+        Job job = std::move(slot.job_);
+        slot.job_ = nullptr;
+        slot.sequence_.store(tail_ + QUEUE_SIZE, std::memory_order_release); // free for the producer on the next lap
+        tail_++;
+        job();
+    }
+
+    // the producers can't log, so it's done here
+    uint32_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != dropped_reported_) {
+        LOG_WARNING(F("%lu commands dropped, the command queue was full"), (unsigned long)(dropped - dropped_reported_));
+        dropped_reported_ = dropped;
+    }
+}
+
+void CommandQueue::Completion::respond(AsyncWebServerRequest * request) {
+    request->send(new DeferredResponse(shared_from_this()));
+}
+
+void CommandQueue::Completion::send(const int code, std::string && content) {
+    code_    = code;
+    content_ = std::move(content);
+    ready_.store(true, std::memory_order_release); // publish to the web server task
+
+    auto wake_arg = new std::shared_ptr<Completion>(shared_from_this());
+#if defined(EMSESP_STANDALONE)
+    wake(wake_arg); // there's no web server task
+#else
+    if (!asyncTCPRun(wake, wake_arg)) {
+        delete wake_arg; // it's sent at the next poll
+    }
+#endif
+}
+
+void CommandQueue::Completion::wake(void * arg) {
+    auto completion = static_cast<std::shared_ptr<Completion> *>(arg);
+    if ((*completion)->response_) {
+        (*completion)->response_->start((*completion)->request_);
+    }
+    delete completion;
+}
+
+CommandQueue::DeferredResponse::DeferredResponse(std::shared_ptr<Completion> completion)
+    : completion_(std::move(completion)) {
+    _code        = 200;
+    _contentType = "application/json";
+}
+
+CommandQueue::DeferredResponse::~DeferredResponse() {
+    completion_->response_ = nullptr;
+}
+
+bool CommandQueue::DeferredResponse::_sourceValid() const {
+    return true;
+}
+
+// the head has the status code, so it waits for the content too
+void CommandQueue::DeferredResponse::_respond(AsyncWebServerRequest * request) {
+    completion_->response_ = this;
+    completion_->request_  = request;
+    start(request);
+}
+
+// called on every ack and poll of the connection
+size_t CommandQueue::DeferredResponse::_ack(AsyncWebServerRequest * request, size_t len, uint32_t time) {
+    if (!started_) {
+        start(request);
+        return 0;
+    }
+    return AsyncAbstractResponse::_ack(request, len, time);
+}
+
+size_t CommandQueue::DeferredResponse::_fillBuffer(uint8_t * buf, size_t maxLen) {
+    const std::string & content = completion_->content();
+    size_t              len     = std::min(maxLen, content.size() - filled_);
+    memcpy(buf, content.data() + filled_, len);
+    filled_ += len;
+    return len;
+}
+
+void CommandQueue::DeferredResponse::start(AsyncWebServerRequest * request) {
+    if (started_ || !completion_->ready()) {
+        return;
+    }
+    started_       = true;
+    _code          = completion_->code();
+    _contentLength = completion_->content().size();
+    AsyncAbstractResponse::_respond(request); // sends the head and the first part of the content
+}
+
+} // namespace emsesp
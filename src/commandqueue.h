@@ -0,0 +1,156 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_COMMANDQUEUE_H
+#define EMSESP_COMMANDQUEUE_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <uuid/log.h>
+
+#if defined(EMSESP_STANDALONE)
+#include <thread>
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+namespace emsesp {
+
+// commands from the web server and MQTT client tasks are posted here and run from the main loop,
+// so only the main loop changes the Tx queue and the device values
+//
+// the queue is a bounded lock-free multi-producer/single-consumer ring (Dmitry Vyukov's bounded queue)
+// each slot has a sequence number: a producer claims a position with a compare-exchange on the head
+// and publishes the slot by setting its sequence, the consumer frees it by moving the sequence a lap ahead
+class CommandQueue {
+  public:
+    using Job = std::function<void()>;
+
+    CommandQueue();
+
+    // from any task. A job posted from the main loop itself is run straight away
+    // returns false if the queue is full, then the job is dropped
+    bool post(Job job);
+
+    // runs the posted jobs, from the main loop
+    void loop();
+
+    uint32_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    class DeferredResponse;
+
+    // the response to a web request, built by a job in the main loop
+    // a request may only be used from the web server task, so it's answered there straight away with a
+    // DeferredResponse that sends nothing until the main loop has filled in the content
+    // send() then wakes the web server task to send it. If that can't be queued it goes out at the
+    // next poll of the connection (at most half a second)
+    // if the client has gone, the content is thrown away when the last owner lets go
+    class Completion : public std::enable_shared_from_this<Completion> {
+      public:
+        // from the web server task
+        void respond(AsyncWebServerRequest * request);
+
+        // from the main loop, once
+        void send(const int code, std::string && content = std::string());
+
+        bool ready() const {
+            return ready_.load(std::memory_order_acquire);
+        }
+
+        // only valid when ready
+        int code() const {
+            return code_;
+        }
+        const std::string & content() const {
+            return content_;
+        }
+
+      private:
+        friend class DeferredResponse;
+
+        // on the web server task, arg is a new'd shared_ptr to the Completion
+        static void wake(void * arg);
+
+        std::atomic<bool> ready_{false};
+        int               code_ = 0;
+        std::string       content_;
+
+        // only used from the web server task, cleared when the response is deleted with its request
+        DeferredResponse *      response_ = nullptr;
+        AsyncWebServerRequest * request_  = nullptr;
+    };
+
+    // sends the content of a Completion, from the web server task
+    class DeferredResponse : public AsyncAbstractResponse {
+      public:
+        DeferredResponse(std::shared_ptr<Completion> completion);
+        ~DeferredResponse();
+
+        bool   _sourceValid() const override;
+        void   _respond(AsyncWebServerRequest * request) override;
+        size_t _ack(AsyncWebServerRequest * request, size_t len, uint32_t time) override;
+        size_t _fillBuffer(uint8_t * buf, size_t maxLen) override;
+
+      private:
+        friend class Completion;
+
+        void start(AsyncWebServerRequest * request);
+
+        std::shared_ptr<Completion> completion_;
+        bool                        started_ = false; // true once the head is sent
+        size_t                      filled_  = 0;     // bytes of the content handed to the web server
+    };
+
+  private:
+    static uuid::log::Logger logger_;
+
+    static constexpr uint8_t QUEUE_SIZE = 32; // must be a power of 2
+
+    struct Slot {
+        std::atomic<uint32_t> sequence_;
+        Job                   job_;
+    };
+
+    bool in_loop_task() const;
+
+    Slot                  slots_[QUEUE_SIZE];
+    std::atomic<uint32_t> head_{0};    // next position to claim, shared by the producers
+    uint32_t              tail_ = 0;   // next position to run, only changed by the consumer
+    std::atomic<uint32_t> dropped_{0}; // # jobs dropped because the queue was full
+    uint32_t              dropped_reported_ = 0;
+
+    // set by the first loop(), read by every task in post()
+#if defined(EMSESP_STANDALONE)
+    std::atomic<std::thread::id> loop_task_{std::thread::id()};
+#else
+    std::atomic<TaskHandle_t> loop_task_{nullptr};
+#endif
+};
+
+} // namespace emsesp
+
+#endif
@@ -359,6 +359,46 @@ void EMSESPShell::add_console_commands() {
                               }
                           });
 
+    commands->add_command(ShellContext::MAIN,
+                          CommandFlags::ADMIN,
+                          flash_string_vector{F_(capture)},
+                          flash_string_vector{F_(capture_action_mandatory), F_(name_optional)},
+                          [](Shell & shell, const std::vector<std::string> & arguments) {
+                              const std::string & action   = arguments.front();
+                              const char *        filename = (arguments.size() > 1) ? arguments[1].c_str() : Capture::FILENAME;
+
+                              if (action == "start") {
+                                  Capture::start();
+                                  shell.printfln(F("Capturing EMS bus frames"));
+                              } else if (action == "stop") {
+                                  Capture::stop();
+                                  shell.printfln(F("Capture stopped, %lu bytes"), (unsigned long)Capture::size());
+                              } else if (action == "show") {
+                                  Capture::show(shell);
+                              } else if (action == "save") {
+                                  Capture::stop();
+                                  if (Capture::save(filename)) {
+                                      shell.printfln(F("Capture saved to %s"), filename);
+                                  } else {
+                                      shell.printfln(F("Capture could not be saved"));
+                                  }
+#if defined(EMSESP_STANDALONE)
+                              } else if (action == "load") {
+                                  if (Capture::load(filename)) {
+                                      shell.printfln(F("Capture loaded from %s, %lu bytes"), filename, (unsigned long)Capture::size());
+                                  } else {
+                                      shell.printfln(F("Capture could not be loaded"));
+                                  }
+                              } else if (action == "replay") {
+                                  Capture::replay(shell, false); // as fast as possible
+                              } else if (action == "wire") {
+                                  Capture::replay(shell, true); // with the timing of the capture
+#endif
+                              } else {
+                                  shell.printfln(F("Invalid capture action"));
+                              }
+                          });
+
     commands->add_command(
         ShellContext::MAIN,
         CommandFlags::ADMIN,
@@ -152,10 +152,22 @@
 #define EMSESP_DEFAULT_NESTED_FORMAT 1
 #endif
 
+#ifndef EMSESP_DEFAULT_PAYLOAD_FORMAT
+#define EMSESP_DEFAULT_PAYLOAD_FORMAT 1 // 1=json 2=MessagePack
+#endif
+
+#ifndef EMSESP_DEFAULT_PUBLISH_SINGLE
+#define EMSESP_DEFAULT_PUBLISH_SINGLE false
+#endif
+
 #ifndef EMSESP_DEFAULT_SEND_RESPONSE
 #define EMSESP_DEFAULT_SEND_RESPONSE false
 #endif
 
+#ifndef EMSESP_DEFAULT_PUBLISH_BUDGET
+#define EMSESP_DEFAULT_PUBLISH_BUDGET 10000 // bytes per second, 0 is no limit
+#endif
+
 #ifndef EMSESP_DEFAULT_SOLAR_MAXFLOW
 #define EMSESP_DEFAULT_SOLAR_MAXFLOW 30
 #endif
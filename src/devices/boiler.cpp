@@ -311,14 +311,14 @@ void Boiler::check_active(const bool force) {
     b   = ((boilerState_ & 0x09) == 0x09);
     val = b ? EMS_VALUE_BOOL_ON : EMS_VALUE_BOOL_OFF;
     if (heatingActive_ != val || force) {
-        heatingActive_ = val;
+        has_update(heatingActive_, val);
         char s[7];
         Mqtt::publish(F_(heating_active), Helpers::render_boolean(s, b));
     }
 
     // check if we can use tapactivated in flow systems
     if ((wwType_ == 1) && !Helpers::hasValue(wwTapActivated_, EMS_VALUE_BOOL)) {
-        wwTapActivated_ = 1;
+        has_update(wwTapActivated_, 1);
     }
 
     // check if tap water is active, bits 1 and 4 must be set
@@ -335,7 +335,7 @@ void Boiler::check_active(const bool force) {
 
     val = b ? EMS_VALUE_BOOL_ON : EMS_VALUE_BOOL_OFF;
     if (tapwaterActive_ != val || force) {
-        tapwaterActive_ = val;
+        has_update(tapwaterActive_, val);
         char s[7];
         Mqtt::publish(F_(tapwater_active), Helpers::render_boolean(s, b));
         EMSESP::tap_water_active(b); // let EMS-ESP know, used in the Shower class
@@ -343,66 +343,68 @@ void Boiler::check_active(const bool force) {
 }
 
 // 0x33
-void Boiler::process_UBAParameterWW(std::shared_ptr<const Telegram> telegram) {
-    // has_update(telegram->read_bitvalue(wwEquipt_,0,3));  //  8=boiler has ww
-    has_update(telegram->read_value(wwActivated_, 1)); // 0xFF means on
-    has_update(telegram->read_value(wwSelTemp_, 2));
-    has_update(telegram->read_value(wwHystOn_, 3));         // Hyst on (default -5)
-    has_update(telegram->read_value(wwHystOff_, 4));        // Hyst off (default -1)
-    has_update(telegram->read_value(wwFlowTempOffset_, 5)); // default 40
-    has_update(telegram->read_value(wwCircPump_, 6));       // 0xFF means on
-    has_update(telegram->read_value(wwCircMode_, 7));       // 1=1x3min 6=6x3min 7=continuous
-    has_update(telegram->read_value(wwDisinfectionTemp_, 8));
-    has_update(telegram->read_bitvalue(wwChargeType_, 10, 0)); // 0 = charge pump, 0xff = 3-way valve
-
-    telegram->read_value(wwComfort_, 9);
-    if (wwComfort_ == 0x00) {
-        wwComfort_ = 0; // Hot
-    } else if (wwComfort_ == 0xD8) {
-        wwComfort_ = 1; // Eco
-    } else if (wwComfort_ == 0xEC) {
-        wwComfort_ = 2; // Intelligent
-    } else {
-        wwComfort_ = EMS_VALUE_UINT_NOTSET;
+void Boiler::process_UBAParameterWW(const Telegram & telegram) {
+    // has_update(telegram.read_bitvalue(wwEquipt_,0,3));  //  8=boiler has ww
+    has_update(telegram.read_value(wwActivated_, 1)); // 0xFF means on
+    has_update(telegram.read_value(wwSelTemp_, 2));
+    has_update(telegram.read_value(wwHystOn_, 3));         // Hyst on (default -5)
+    has_update(telegram.read_value(wwHystOff_, 4));        // Hyst off (default -1)
+    has_update(telegram.read_value(wwFlowTempOffset_, 5)); // default 40
+    has_update(telegram.read_value(wwCircPump_, 6));       // 0xFF means on
+    has_update(telegram.read_value(wwCircMode_, 7));       // 1=1x3min 6=6x3min 7=continuous
+    has_update(telegram.read_value(wwDisinfectionTemp_, 8));
+    has_update(telegram.read_bitvalue(wwChargeType_, 10, 0)); // 0 = charge pump, 0xff = 3-way valve
+
+    uint8_t comfort = EMS_VALUE_UINT_NOTSET;
+    if (telegram.read_value(comfort, 9)) {
+        if (comfort == 0x00) {
+            has_update(wwComfort_, 0); // Hot
+        } else if (comfort == 0xD8) {
+            has_update(wwComfort_, 1); // Eco
+        } else if (comfort == 0xEC) {
+            has_update(wwComfort_, 2); // Intelligent
+        } else {
+            has_update(wwComfort_, EMS_VALUE_UINT_NOTSET);
+        }
     }
 }
 
 // 0x18
-void Boiler::process_UBAMonitorFast(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(selFlowTemp_, 0));
-    has_update(telegram->read_value(curFlowTemp_, 1));
-    has_update(telegram->read_value(selBurnPow_, 3)); // burn power max setting
-    has_update(telegram->read_value(curBurnPow_, 4));
-    has_update(telegram->read_value(boilerState_, 5));
-
-    has_update(telegram->read_bitvalue(burnGas_, 7, 0));
-    has_update(telegram->read_bitvalue(fanWork_, 7, 2));
-    has_update(telegram->read_bitvalue(ignWork_, 7, 3));
-    has_update(telegram->read_bitvalue(heatingPump_, 7, 5));
-    has_update(telegram->read_bitvalue(wwHeat_, 7, 6));
-    has_update(telegram->read_bitvalue(wwCirc_, 7, 7));
+void Boiler::process_UBAMonitorFast(const Telegram & telegram) {
+    has_update(telegram.read_value(selFlowTemp_, 0));
+    has_update(telegram.read_value(curFlowTemp_, 1));
+    has_update(telegram.read_value(selBurnPow_, 3)); // burn power max setting
+    has_update(telegram.read_value(curBurnPow_, 4));
+    has_update(telegram.read_value(boilerState_, 5));
+
+    has_update(telegram.read_bitvalue(burnGas_, 7, 0));
+    has_update(telegram.read_bitvalue(fanWork_, 7, 2));
+    has_update(telegram.read_bitvalue(ignWork_, 7, 3));
+    has_update(telegram.read_bitvalue(heatingPump_, 7, 5));
+    has_update(telegram.read_bitvalue(wwHeat_, 7, 6));
+    has_update(telegram.read_bitvalue(wwCirc_, 7, 7));
 
     // warm water storage sensors (if present)
     // wwStorageTemp2 is also used by some brands as the boiler temperature - see https://github.com/emsesp/EMS-ESP/issues/206
-    has_update(telegram->read_value(wwStorageTemp1_, 9));  // 0x8300 if not available
-    has_update(telegram->read_value(wwStorageTemp2_, 11)); // 0x8000 if not available - this is boiler temp
+    has_update(telegram.read_value(wwStorageTemp1_, 9));  // 0x8300 if not available
+    has_update(telegram.read_value(wwStorageTemp2_, 11)); // 0x8000 if not available - this is boiler temp
 
-    has_update(telegram->read_value(retTemp_, 13));
-    has_update(telegram->read_value(flameCurr_, 15));
+    has_update(telegram.read_value(retTemp_, 13));
+    has_update(telegram.read_value(flameCurr_, 15));
 
     // system pressure. FF means missing
-    has_update(telegram->read_value(sysPress_, 17)); // is *10
+    has_update(telegram.read_value(sysPress_, 17)); // is *10
 
     // read the service code / installation status as appears on the display
-    if ((telegram->message_length > 18) && (telegram->offset == 0)) {
-        serviceCode_[0] = (serviceCode_[0] == '~') ? 0xF0 : serviceCode_[0];
-        has_update(telegram->read_value(serviceCode_[0], 18));
-        serviceCode_[0] = (serviceCode_[0] == (char)0xF0) ? '~' : serviceCode_[0];
-        has_update(telegram->read_value(serviceCode_[1], 19));
-        serviceCode_[2] = '\0'; // null terminate string
+    if ((telegram.message_length > 18) && (telegram.offset == 0)) {
+        char code[sizeof(serviceCode_)] = {'\0'}; // null terminated string
+        telegram.read_value(code[0], 18);
+        telegram.read_value(code[1], 19);
+        code[0] = (code[0] == (char)0xF0) ? '~' : code[0];
+        has_update(serviceCode_, code, sizeof(serviceCode_));
     }
 
-    has_update(telegram->read_value(serviceCodeNumber_, 20));
+    has_update(telegram.read_value(serviceCodeNumber_, 20));
 
     check_active(); // do a quick check to see if the hot water or heating is active
 }
@@ -411,34 +413,34 @@ void Boiler::process_UBAMonitorFast(std::shared_ptr<const Telegram> telegram) {
  * UBATotalUptime - type 0x14 - total uptime
  * received only after requested (not broadcasted)
  */
-void Boiler::process_UBATotalUptime(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(UBAuptime_, 0, 3)); // force to 3 bytes
+void Boiler::process_UBATotalUptime(const Telegram & telegram) {
+    has_update(telegram.read_value(UBAuptime_, 0, 3)); // force to 3 bytes
 }
 
 /*
  * UBAParameters - type 0x16
  * data: FF 5A 64 00 0A FA 0F 02 06 64 64 02 08 F8 0F 0F 0F 0F 1E 05 04 09 09 00 28 00 3C
  */
-void Boiler::process_UBAParameters(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(heatingActivated_, 0));
-    has_update(telegram->read_value(heatingTemp_, 1));
-    has_update(telegram->read_value(burnMaxPower_, 2));
-    has_update(telegram->read_value(burnMinPower_, 3));
-    has_update(telegram->read_value(boilHystOff_, 4));
-    has_update(telegram->read_value(boilHystOn_, 5));
-    has_update(telegram->read_value(burnMinPeriod_, 6));
-    // has_update(telegram->read_value(pumpType_, 7)); // 0=off, 02=?
-    has_update(telegram->read_value(pumpDelay_, 8));
-    has_update(telegram->read_value(pumpModMax_, 9));
-    has_update(telegram->read_value(pumpModMin_, 10));
+void Boiler::process_UBAParameters(const Telegram & telegram) {
+    has_update(telegram.read_value(heatingActivated_, 0));
+    has_update(telegram.read_value(heatingTemp_, 1));
+    has_update(telegram.read_value(burnMaxPower_, 2));
+    has_update(telegram.read_value(burnMinPower_, 3));
+    has_update(telegram.read_value(boilHystOff_, 4));
+    has_update(telegram.read_value(boilHystOn_, 5));
+    has_update(telegram.read_value(burnMinPeriod_, 6));
+    // has_update(telegram.read_value(pumpType_, 7)); // 0=off, 02=?
+    has_update(telegram.read_value(pumpDelay_, 8));
+    has_update(telegram.read_value(pumpModMax_, 9));
+    has_update(telegram.read_value(pumpModMin_, 10));
 }
 
 /*
  * UBASettingsWW - type 0x26 - max power on offset 7, #740
  * Boiler(0x08) -> Me(0x0B), ?(0x26), data: 01 05 00 0F 00 1E 58 5A
  */
-void Boiler::process_UBASettingsWW(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwMaxPower_, 7));
+void Boiler::process_UBASettingsWW(const Telegram & telegram) {
+    has_update(telegram.read_value(wwMaxPower_, 7));
 }
 
 /*
@@ -446,22 +448,22 @@ void Boiler::process_UBASettingsWW(std::shared_ptr<const Telegram> telegram) {
  * received every 10 seconds
  * Boiler(0x08) -> Me(0x0B), UBAMonitorWW(0x34), data: 30 01 BA 7D 00 21 00 00 03 00 01 22 2B 00 19 5B
 */
-void Boiler::process_UBAMonitorWW(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwSetTemp_, 0)); // hot water temperature target
-    has_update(telegram->read_value(wwCurTemp_, 1));
-    has_update(telegram->read_value(wwCurTemp2_, 3));
-
-    has_update(telegram->read_value(wwType_, 8));
-    has_update(telegram->read_value(wwCurFlow_, 9));
-    has_update(telegram->read_value(wwWorkM_, 10, 3));  // force to 3 bytes
-    has_update(telegram->read_value(wwStarts_, 13, 3)); // force to 3 bytes
-
-    has_update(telegram->read_bitvalue(wwOneTime_, 5, 1));
-    has_update(telegram->read_bitvalue(wwDisinfect_, 5, 2));
-    has_update(telegram->read_bitvalue(wwCharging_, 5, 3));
-    has_update(telegram->read_bitvalue(wwRecharging_, 5, 4));
-    has_update(telegram->read_bitvalue(wwTempOK_, 5, 5));
-    has_update(telegram->read_bitvalue(wwActive_, 5, 6));
+void Boiler::process_UBAMonitorWW(const Telegram & telegram) {
+    has_update(telegram.read_value(wwSetTemp_, 0)); // hot water temperature target
+    has_update(telegram.read_value(wwCurTemp_, 1));
+    has_update(telegram.read_value(wwCurTemp2_, 3));
+
+    has_update(telegram.read_value(wwType_, 8));
+    has_update(telegram.read_value(wwCurFlow_, 9));
+    has_update(telegram.read_value(wwWorkM_, 10, 3));  // force to 3 bytes
+    has_update(telegram.read_value(wwStarts_, 13, 3)); // force to 3 bytes
+
+    has_update(telegram.read_bitvalue(wwOneTime_, 5, 1));
+    has_update(telegram.read_bitvalue(wwDisinfect_, 5, 2));
+    has_update(telegram.read_bitvalue(wwCharging_, 5, 3));
+    has_update(telegram.read_bitvalue(wwRecharging_, 5, 4));
+    has_update(telegram.read_bitvalue(wwTempOK_, 5, 5));
+    has_update(telegram.read_bitvalue(wwActive_, 5, 6));
 }
 
 /*
@@ -472,32 +474,32 @@ void Boiler::process_UBAMonitorWW(std::shared_ptr<const Telegram> telegram) {
 + * GB125/Logamatic MC110: issue #650: add retTemp & sysPress
 + * 08 00 E4 00 10 20 2D 48 00 C8 38 02 37 3C 27 03 00 00 00 00 00 01 7B 01 8F 11 00 02 37 80 00 02 1B 80 00 7F FF 80 00
  */
-void Boiler::process_UBAMonitorFastPlus(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(selFlowTemp_, 6));
-    has_update(telegram->read_bitvalue(burnGas_, 11, 0));
-    // has_update(telegram->read_bitvalue(heatingPump_, 11, 1)); // heating active? see SlowPlus
-    has_update(telegram->read_bitvalue(wwHeat_, 11, 2));
-    has_update(telegram->read_value(curBurnPow_, 10));
-    has_update(telegram->read_value(selBurnPow_, 9));
-    has_update(telegram->read_value(curFlowTemp_, 7));
-    has_update(telegram->read_value(flameCurr_, 19));
-    has_update(telegram->read_value(retTemp_, 17)); // can be 0 if no sensor, handled in export_values
-    has_update(telegram->read_value(sysPress_, 21));
+void Boiler::process_UBAMonitorFastPlus(const Telegram & telegram) {
+    has_update(telegram.read_value(selFlowTemp_, 6));
+    has_update(telegram.read_bitvalue(burnGas_, 11, 0));
+    // has_update(telegram.read_bitvalue(heatingPump_, 11, 1)); // heating active? see SlowPlus
+    has_update(telegram.read_bitvalue(wwHeat_, 11, 2));
+    has_update(telegram.read_value(curBurnPow_, 10));
+    has_update(telegram.read_value(selBurnPow_, 9));
+    has_update(telegram.read_value(curFlowTemp_, 7));
+    has_update(telegram.read_value(flameCurr_, 19));
+    has_update(telegram.read_value(retTemp_, 17)); // can be 0 if no sensor, handled in export_values
+    has_update(telegram.read_value(sysPress_, 21));
 
     // read 3 char service code / installation status as appears on the display
-    if ((telegram->message_length > 3) && (telegram->offset == 0)) {
-        serviceCode_[0] = (serviceCode_[0] == '~') ? 0xF0 : serviceCode_[0];
-        has_update(telegram->read_value(serviceCode_[0], 1));
-        serviceCode_[0] = (serviceCode_[0] == (char)0xF0) ? '~' : serviceCode_[0];
-        has_update(telegram->read_value(serviceCode_[1], 2));
-        has_update(telegram->read_value(serviceCode_[2], 3));
-        serviceCode_[3] = '\0';
+    if ((telegram.message_length > 3) && (telegram.offset == 0)) {
+        char code[sizeof(serviceCode_)] = {'\0'};
+        telegram.read_value(code[0], 1);
+        telegram.read_value(code[1], 2);
+        telegram.read_value(code[2], 3);
+        code[0] = (code[0] == (char)0xF0) ? '~' : code[0];
+        has_update(serviceCode_, code, sizeof(serviceCode_));
     }
-    has_update(telegram->read_value(serviceCodeNumber_, 4));
+    has_update(telegram.read_value(serviceCodeNumber_, 4));
 
     // at this point do a quick check to see if the hot water or heating is active
     uint8_t state = EMS_VALUE_UINT_NOTSET;
-    if (telegram->read_value(state, 11)) {
+    if (telegram.read_value(state, 11)) {
         boilerState_ = state & 0x01 ? 0x08 : 0;
         boilerState_ |= state & 0x02 ? 0x01 : 0;
         boilerState_ |= state & 0x04 ? 0x02 : 0;
@@ -513,23 +515,23 @@ void Boiler::process_UBAMonitorFastPlus(std::shared_ptr<const Telegram> telegram
  *      08 0B 19 00 FF EA 02 47 80 00 00 00 00 62 03 CA 24 2C D6 23 00 00 00 27 4A B6 03 6E 43 
  *                  00 01 02 03 04 05 06 07 08 09 10 11 12 13 14 15 16 17 17 19 20 21 22 23 24
  */
-void Boiler::process_UBAMonitorSlow(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(outdoorTemp_, 0));
-    has_update(telegram->read_value(boilTemp_, 2));
-    has_update(telegram->read_value(exhaustTemp_, 4));
-    has_update(telegram->read_value(switchTemp_, 25)); // only if there is a mixer module present
-    has_update(telegram->read_value(heatingPumpMod_, 9));
-    has_update(telegram->read_value(burnStarts_, 10, 3));  // force to 3 bytes
-    has_update(telegram->read_value(burnWorkMin_, 13, 3)); // force to 3 bytes
-    has_update(telegram->read_value(heatWorkMin_, 19, 3)); // force to 3 bytes
+void Boiler::process_UBAMonitorSlow(const Telegram & telegram) {
+    has_update(telegram.read_value(outdoorTemp_, 0));
+    has_update(telegram.read_value(boilTemp_, 2));
+    has_update(telegram.read_value(exhaustTemp_, 4));
+    has_update(telegram.read_value(switchTemp_, 25)); // only if there is a mixer module present
+    has_update(telegram.read_value(heatingPumpMod_, 9));
+    has_update(telegram.read_value(burnStarts_, 10, 3));  // force to 3 bytes
+    has_update(telegram.read_value(burnWorkMin_, 13, 3)); // force to 3 bytes
+    has_update(telegram.read_value(heatWorkMin_, 19, 3)); // force to 3 bytes
 }
 
 /*
  * UBAMonitorSlowPlus2 - type 0xE3
  * 88 00 E3 00 04 00 00 00 00 01 00 00 00 00 00 02 22 2B 64 46 01 00 00 61
  */
-void Boiler::process_UBAMonitorSlowPlus2(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(heatingPump2Mod_, 13)); // Heat Pump Modulation
+void Boiler::process_UBAMonitorSlowPlus2(const Telegram & telegram) {
+    has_update(telegram.read_value(heatingPump2Mod_, 13)); // Heat Pump Modulation
 }
 
 /*
@@ -537,16 +539,16 @@ void Boiler::process_UBAMonitorSlowPlus2(std::shared_ptr<const Telegram> telegra
  * Boiler(0x08) -> Me(0x0B), UBAMonitorSlowPlus(0xE5),
  * data: 01 00 20 00 00 78 00 00 00 00 00 1E EB 00 9D 3E 00 00 00 00 6B 5E 00 06 4C 64 00 00 00 00 8A A3
  */
-void Boiler::process_UBAMonitorSlowPlus(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_bitvalue(fanWork_, 2, 2));
-    has_update(telegram->read_bitvalue(ignWork_, 2, 3));
-    has_update(telegram->read_bitvalue(heatingPump_, 2, 5));
-    has_update(telegram->read_bitvalue(wwCirc_, 2, 7));
-    has_update(telegram->read_value(exhaustTemp_, 6));
-    has_update(telegram->read_value(burnStarts_, 10, 3));  // force to 3 bytes
-    has_update(telegram->read_value(burnWorkMin_, 13, 3)); // force to 3 bytes
-    has_update(telegram->read_value(heatWorkMin_, 19, 3)); // force to 3 bytes
-    has_update(telegram->read_value(heatingPumpMod_, 25));
+void Boiler::process_UBAMonitorSlowPlus(const Telegram & telegram) {
+    has_update(telegram.read_bitvalue(fanWork_, 2, 2));
+    has_update(telegram.read_bitvalue(ignWork_, 2, 3));
+    has_update(telegram.read_bitvalue(heatingPump_, 2, 5));
+    has_update(telegram.read_bitvalue(wwCirc_, 2, 7));
+    has_update(telegram.read_value(exhaustTemp_, 6));
+    has_update(telegram.read_value(burnStarts_, 10, 3));  // force to 3 bytes
+    has_update(telegram.read_value(burnWorkMin_, 13, 3)); // force to 3 bytes
+    has_update(telegram.read_value(heatWorkMin_, 19, 3)); // force to 3 bytes
+    has_update(telegram.read_value(heatingPumpMod_, 25));
     // temperature measurements at 4, see #620
 }
 
@@ -558,54 +560,54 @@ void Boiler::process_UBAMonitorSlowPlus(std::shared_ptr<const Telegram> telegram
  * from: issue #732
  *       data: 01 50 1E 5A 46 12 64 00 06 FA 3C 03 05 64 00 00 00 28 00 41 03 00 00 00 00 00 00 00 00 00
  */
-void Boiler::process_UBAParametersPlus(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(heatingActivated_, 0));
-    has_update(telegram->read_value(heatingTemp_, 1));
-    has_update(telegram->read_value(burnMaxPower_, 4));
-    has_update(telegram->read_value(burnMinPower_, 5));
-    has_update(telegram->read_value(boilHystOff_, 8));
-    has_update(telegram->read_value(boilHystOn_, 9));
-    has_update(telegram->read_value(burnMinPeriod_, 10));
-    // has_update(telegram->read_value(pumpType_, 11));   // guess, RC300 manual: power controlled, pressure controlled 1-4?
-    // has_update(telegram->read_value(pumpDelay_, 12));  // guess
-    // has_update(telegram->read_value(pumpModMax_, 13)); // guess
-    // has_update(telegram->read_value(pumpModMin_, 14)); // guess
+void Boiler::process_UBAParametersPlus(const Telegram & telegram) {
+    has_update(telegram.read_value(heatingActivated_, 0));
+    has_update(telegram.read_value(heatingTemp_, 1));
+    has_update(telegram.read_value(burnMaxPower_, 4));
+    has_update(telegram.read_value(burnMinPower_, 5));
+    has_update(telegram.read_value(boilHystOff_, 8));
+    has_update(telegram.read_value(boilHystOn_, 9));
+    has_update(telegram.read_value(burnMinPeriod_, 10));
+    // has_update(telegram.read_value(pumpType_, 11));   // guess, RC300 manual: power controlled, pressure controlled 1-4?
+    // has_update(telegram.read_value(pumpDelay_, 12));  // guess
+    // has_update(telegram.read_value(pumpModMax_, 13)); // guess
+    // has_update(telegram.read_value(pumpModMin_, 14)); // guess
 }
 
 // 0xEA
-void Boiler::process_UBAParameterWWPlus(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwActivated_, 5)); // 0x01 means on
-    has_update(telegram->read_value(wwCircPump_, 10)); // 0x01 means yes
-    has_update(telegram->read_value(wwCircMode_, 11)); // 1=1x3min... 6=6x3min, 7=continuous
-    has_update(telegram->read_value(wwDisinfectionTemp_, 12));
-    has_update(telegram->read_value(wwSelTemp_, 6));
-    has_update(telegram->read_value(wwHystOn_, 7));
-    has_update(telegram->read_value(wwHystOff_, 8));
-    has_update(telegram->read_value(wwSelTempOff_, 0)); // confusing description in #96, hopefully this is right
-    has_update(telegram->read_value(wwSelTempSingle_, 16));
-    has_update(telegram->read_value(wwSelTempLow_, 18));
+void Boiler::process_UBAParameterWWPlus(const Telegram & telegram) {
+    has_update(telegram.read_value(wwActivated_, 5)); // 0x01 means on
+    has_update(telegram.read_value(wwCircPump_, 10)); // 0x01 means yes
+    has_update(telegram.read_value(wwCircMode_, 11)); // 1=1x3min... 6=6x3min, 7=continuous
+    has_update(telegram.read_value(wwDisinfectionTemp_, 12));
+    has_update(telegram.read_value(wwSelTemp_, 6));
+    has_update(telegram.read_value(wwHystOn_, 7));
+    has_update(telegram.read_value(wwHystOff_, 8));
+    has_update(telegram.read_value(wwSelTempOff_, 0)); // confusing description in #96, hopefully this is right
+    has_update(telegram.read_value(wwSelTempSingle_, 16));
+    has_update(telegram.read_value(wwSelTempLow_, 18));
 }
 
 // 0xE9 - WW monitor ems+
 // e.g. 08 00 E9 00 37 01 F6 01 ED 00 00 00 00 41 3C 00 00 00 00 00 00 00 00 00 00 00 00 37 00 00 00 (CRC=77) #data=27
-void Boiler::process_UBAMonitorWWPlus(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwSetTemp_, 0));
-    has_update(telegram->read_value(wwCurTemp_, 1));
-    has_update(telegram->read_value(wwCurTemp2_, 3));
-
-    has_update(telegram->read_value(wwWorkM_, 14, 3));  // force to 3 bytes
-    has_update(telegram->read_value(wwStarts_, 17, 3)); // force to 3 bytes
-
-    has_update(telegram->read_bitvalue(wwOneTime_, 12, 2));
-    has_update(telegram->read_bitvalue(wwDisinfect_, 12, 3));
-    has_update(telegram->read_bitvalue(wwCharging_, 12, 4));
-    has_update(telegram->read_bitvalue(wwRecharging_, 13, 4));
-    has_update(telegram->read_bitvalue(wwTempOK_, 13, 5));
-    has_update(telegram->read_bitvalue(wwCirc_, 13, 2));
-
-    // has_update(telegram->read_value(wwActivated_, 20)); // Activated is in 0xEA, this is something other 0/100%
-    // has_update(telegram->read_value(wwSelTemp_, 10));   // see #96, this is not wwSelTemp (set in EA)
-    // has_update(telegram->read_value(wwDisinfectionTemp_, 9));
+void Boiler::process_UBAMonitorWWPlus(const Telegram & telegram) {
+    has_update(telegram.read_value(wwSetTemp_, 0));
+    has_update(telegram.read_value(wwCurTemp_, 1));
+    has_update(telegram.read_value(wwCurTemp2_, 3));
+
+    has_update(telegram.read_value(wwWorkM_, 14, 3));  // force to 3 bytes
+    has_update(telegram.read_value(wwStarts_, 17, 3)); // force to 3 bytes
+
+    has_update(telegram.read_bitvalue(wwOneTime_, 12, 2));
+    has_update(telegram.read_bitvalue(wwDisinfect_, 12, 3));
+    has_update(telegram.read_bitvalue(wwCharging_, 12, 4));
+    has_update(telegram.read_bitvalue(wwRecharging_, 13, 4));
+    has_update(telegram.read_bitvalue(wwTempOK_, 13, 5));
+    has_update(telegram.read_bitvalue(wwCirc_, 13, 2));
+
+    // has_update(telegram.read_value(wwActivated_, 20)); // Activated is in 0xEA, this is something other 0/100%
+    // has_update(telegram.read_value(wwSelTemp_, 10));   // see #96, this is not wwSelTemp (set in EA)
+    // has_update(telegram.read_value(wwDisinfectionTemp_, 9));
 }
 
 /*
@@ -617,31 +619,31 @@ void Boiler::process_UBAMonitorWWPlus(std::shared_ptr<const Telegram> telegram)
  * 08 00 FF 48 03 95 00 00 01 15 00 00 00 00 00 00 00 F9 29 00
  *  
  */
-void Boiler::process_UBAInformation(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(upTimeControl_, 0));
-    has_update(telegram->read_value(upTimeCompHeating_, 8));
-    has_update(telegram->read_value(upTimeCompCooling_, 16));
-    has_update(telegram->read_value(upTimeCompWw_, 4));
-    has_update(telegram->read_value(upTimeCompPool_, 12));
-
-    has_update(telegram->read_value(totalCompStarts_, 20));
-    has_update(telegram->read_value(heatingStarts_, 28));
-    has_update(telegram->read_value(coolingStarts_, 36));
-    has_update(telegram->read_value(wwStarts2_, 24));
-    has_update(telegram->read_value(poolStarts_, 32));
-
-    has_update(telegram->read_value(nrgConsTotal_, 64));
-
-    has_update(telegram->read_value(auxElecHeatNrgConsTotal_, 40));
-    has_update(telegram->read_value(auxElecHeatNrgConsHeating_, 48));
-    has_update(telegram->read_value(auxElecHeatNrgConsWW_, 44));
-    has_update(telegram->read_value(auxElecHeatNrgConsPool_, 52));
-
-    has_update(telegram->read_value(nrgConsCompTotal_, 56));
-    has_update(telegram->read_value(nrgConsCompHeating_, 68));
-    has_update(telegram->read_value(nrgConsCompWw_, 72));
-    has_update(telegram->read_value(nrgConsCompCooling_, 76));
-    has_update(telegram->read_value(nrgConsCompPool_, 80));
+void Boiler::process_UBAInformation(const Telegram & telegram) {
+    has_update(telegram.read_value(upTimeControl_, 0));
+    has_update(telegram.read_value(upTimeCompHeating_, 8));
+    has_update(telegram.read_value(upTimeCompCooling_, 16));
+    has_update(telegram.read_value(upTimeCompWw_, 4));
+    has_update(telegram.read_value(upTimeCompPool_, 12));
+
+    has_update(telegram.read_value(totalCompStarts_, 20));
+    has_update(telegram.read_value(heatingStarts_, 28));
+    has_update(telegram.read_value(coolingStarts_, 36));
+    has_update(telegram.read_value(wwStarts2_, 24));
+    has_update(telegram.read_value(poolStarts_, 32));
+
+    has_update(telegram.read_value(nrgConsTotal_, 64));
+
+    has_update(telegram.read_value(auxElecHeatNrgConsTotal_, 40));
+    has_update(telegram.read_value(auxElecHeatNrgConsHeating_, 48));
+    has_update(telegram.read_value(auxElecHeatNrgConsWW_, 44));
+    has_update(telegram.read_value(auxElecHeatNrgConsPool_, 52));
+
+    has_update(telegram.read_value(nrgConsCompTotal_, 56));
+    has_update(telegram.read_value(nrgConsCompHeating_, 68));
+    has_update(telegram.read_value(nrgConsCompWw_, 72));
+    has_update(telegram.read_value(nrgConsCompCooling_, 76));
+    has_update(telegram.read_value(nrgConsCompPool_, 80));
 }
 
 /*
@@ -651,12 +653,12 @@ void Boiler::process_UBAInformation(std::shared_ptr<const Telegram> telegram) {
  * 08 00 FF 18 03 94 FF FF FF FF FF FF FF FF FF FF FF FF FF FF FF FF 00 00 00 00 00 00 00 00 00 7E
  * 08 00 FF 31 03 94 00 00 00 00 00 00 00 38
  */
-void Boiler::process_UBAEnergySupplied(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(nrgSuppTotal_, 4));
-    has_update(telegram->read_value(nrgSuppHeating_, 12));
-    has_update(telegram->read_value(nrgSuppWw_, 8));
-    has_update(telegram->read_value(nrgSuppCooling_, 16));
-    has_update(telegram->read_value(nrgSuppPool_, 20));
+void Boiler::process_UBAEnergySupplied(const Telegram & telegram) {
+    has_update(telegram.read_value(nrgSuppTotal_, 4));
+    has_update(telegram.read_value(nrgSuppHeating_, 12));
+    has_update(telegram.read_value(nrgSuppWw_, 8));
+    has_update(telegram.read_value(nrgSuppCooling_, 16));
+    has_update(telegram.read_value(nrgSuppPool_, 20));
 }
 
 // Heatpump power - type 0x48D
@@ -664,66 +666,45 @@ void Boiler::process_UBAEnergySupplied(std::shared_ptr<const Telegram> telegram)
 //XR1A050001   A05 Pump Heat circuit (1.0 ) 1 >> 1 & 0x01 ?
 //XR1A040001   A04 Pump Cold circuit (1.0 ) 1 & 0x1 ?
 
-void Boiler::process_HpPower(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(hpPower_, 11));
-    has_update(telegram->read_bitvalue(hpCompOn_, 3, 4));
-    has_update(telegram->read_value(hpBrinePumpSpd_, 5));
-    has_update(telegram->read_value(hpCompSpd_, 17));
-    has_update(telegram->read_value(hpCircSpd_, 4));
-    has_update(telegram->read_bitvalue(hpSwitchValve_, 0, 6));
-    has_update(telegram->read_value(hpActivity_, 7));
-
-    hpHeatingOn_ = 0;
-    hpCoolingOn_ = 0;
-    hpWwOn_      = 0;
-    hpPoolOn_    = 0;
-
-    switch (hpActivity_) {
-    case 1: {
-        hpHeatingOn_ = 0xFF;
-        break;
-    }
-    case 2: {
-        hpCoolingOn_ = 0xFF;
-        break;
-    }
-    case 3: {
-        hpWwOn_ = 0xFF;
-        ;
-        break;
-    }
-    case 4: {
-        hpPoolOn_ = 0xFF;
-        ;
-        break;
-    }
-    }
+void Boiler::process_HpPower(const Telegram & telegram) {
+    has_update(telegram.read_value(hpPower_, 11));
+    has_update(telegram.read_bitvalue(hpCompOn_, 3, 4));
+    has_update(telegram.read_value(hpBrinePumpSpd_, 5));
+    has_update(telegram.read_value(hpCompSpd_, 17));
+    has_update(telegram.read_value(hpCircSpd_, 4));
+    has_update(telegram.read_bitvalue(hpSwitchValve_, 0, 6));
+    has_update(telegram.read_value(hpActivity_, 7));
+
+    has_update(hpHeatingOn_, (hpActivity_ == 1) ? 0xFF : 0);
+    has_update(hpCoolingOn_, (hpActivity_ == 2) ? 0xFF : 0);
+    has_update(hpWwOn_, (hpActivity_ == 3) ? 0xFF : 0);
+    has_update(hpPoolOn_, (hpActivity_ == 4) ? 0xFF : 0);
 }
 
 // Heatpump outdoor unit - type 0x48F
-void Boiler::process_HpOutdoor(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(hpTc0_, 6));
-    has_update(telegram->read_value(hpTc1_, 4));
-    has_update(telegram->read_value(hpTc3_, 2));
-    has_update(telegram->read_value(hpTr3_, 16));
-    has_update(telegram->read_value(hpTr4_, 18));
-    has_update(telegram->read_value(hpTr5_, 20));
-    has_update(telegram->read_value(hpTr6_, 0));
-    has_update(telegram->read_value(hpTr7_, 30));
-    has_update(telegram->read_value(hpTl2_, 12));
-    has_update(telegram->read_value(hpPl1_, 26));
-    has_update(telegram->read_value(hpPh1_, 28));
-    has_update(telegram->read_value(hpBrineIn_, 8));
-    has_update(telegram->read_value(hpBrineOut_, 10));
-    has_update(telegram->read_value(hpSuctionGas_, 20));
-    has_update(telegram->read_value(hpHotGas_, 0));
+void Boiler::process_HpOutdoor(const Telegram & telegram) {
+    has_update(telegram.read_value(hpTc0_, 6));
+    has_update(telegram.read_value(hpTc1_, 4));
+    has_update(telegram.read_value(hpTc3_, 2));
+    has_update(telegram.read_value(hpTr3_, 16));
+    has_update(telegram.read_value(hpTr4_, 18));
+    has_update(telegram.read_value(hpTr5_, 20));
+    has_update(telegram.read_value(hpTr6_, 0));
+    has_update(telegram.read_value(hpTr7_, 30));
+    has_update(telegram.read_value(hpTl2_, 12));
+    has_update(telegram.read_value(hpPl1_, 26));
+    has_update(telegram.read_value(hpPh1_, 28));
+    has_update(telegram.read_value(hpBrineIn_, 8));
+    has_update(telegram.read_value(hpBrineOut_, 10));
+    has_update(telegram.read_value(hpSuctionGas_, 20));
+    has_update(telegram.read_value(hpHotGas_, 0));
 }
 
 // Heatpump pool unit - type 0x48A
 // 08 00 FF 00 03 8A 01 4C 01 0C 00 00 0A 00 1E 00 00 01 00 04 4A 00
 
-void Boiler::process_HpPool(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(poolSetTemp_, 1));
+void Boiler::process_HpPool(const Telegram & telegram) {
+    has_update(telegram.read_value(poolSetTemp_, 1));
 }
 
 
@@ -731,30 +712,30 @@ void Boiler::process_HpPool(std::shared_ptr<const Telegram> telegram) {
 // 0x2A - MC110Status
 // e.g. 88 00 2A 00 00 00 00 00 00 00 00 00 D2 00 00 80 00 00 01 08 80 00 02 47 00
 // see https://github.com/emsesp/EMS-ESP/issues/397
-void Boiler::process_MC110Status(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwMixerTemp_, 14));
-    has_update(telegram->read_value(wwTankMiddleTemp_, 18));
+void Boiler::process_MC110Status(const Telegram & telegram) {
+    has_update(telegram.read_value(wwMixerTemp_, 14));
+    has_update(telegram.read_value(wwTankMiddleTemp_, 18));
 }
 
 /*
  * UBAOutdoorTemp - type 0xD1 - external temperature EMS+
  */
-void Boiler::process_UBAOutdoorTemp(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(outdoorTemp_, 0));
+void Boiler::process_UBAOutdoorTemp(const Telegram & telegram) {
+    has_update(telegram.read_value(outdoorTemp_, 0));
 }
 
 // UBASetPoint 0x1A
-void Boiler::process_UBASetPoints(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(setFlowTemp_, 0));    // boiler set temp from thermostat
-    has_update(telegram->read_value(setBurnPow_, 1));     // max json power in %
-    has_update(telegram->read_value(wwSetPumpPower_, 2)); // ww pump speed/power?
+void Boiler::process_UBASetPoints(const Telegram & telegram) {
+    has_update(telegram.read_value(setFlowTemp_, 0));    // boiler set temp from thermostat
+    has_update(telegram.read_value(setBurnPow_, 1));     // max json power in %
+    has_update(telegram.read_value(wwSetPumpPower_, 2)); // ww pump speed/power?
 }
 
 // 0x6DC, ff for cascaded heatsources (hs)
-void Boiler::process_CascadeMessage(std::shared_ptr<const Telegram> telegram) {
+void Boiler::process_CascadeMessage(const Telegram & telegram) {
     // uint8_t  hsActivated;
-    // has_update(telegram->read_value(hsActivated, 0));
-    telegram->read_value(burnWorkMin_, 3); // this is in seconds
+    // has_update(telegram.read_value(hsActivated, 0));
+    telegram.read_value(burnWorkMin_, 3); // this is in seconds
     burnWorkMin_ /= 60;
 }
 
@@ -762,7 +743,7 @@ void Boiler::process_CascadeMessage(std::shared_ptr<const Telegram> telegram) {
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
 // 0x35 - not yet implemented
-void Boiler::process_UBAFlags(std::shared_ptr<const Telegram> telegram) {
+void Boiler::process_UBAFlags(const Telegram & telegram) {
 }
 
 #pragma GCC diagnostic pop
@@ -770,53 +751,55 @@ void Boiler::process_UBAFlags(std::shared_ptr<const Telegram> telegram) {
 // 0x1C
 // 08 00 1C 94 0B 0A 1D 31 08 00 80 00 00 00 -> message for 29.11.2020
 // 08 00 1C 94 0B 0A 1D 31 00 00 00 00 00 00 -> message reset
-void Boiler::process_UBAMaintenanceStatus(std::shared_ptr<const Telegram> telegram) {
+void Boiler::process_UBAMaintenanceStatus(const Telegram & telegram) {
     // 5. byte: Maintenance due (0 = no, 3 = yes, due to operating hours, 8 = yes, due to date)
     uint8_t message_code = maintenanceMessage_[2] - '0';
-    has_update(telegram->read_value(message_code, 5));
+    has_update(telegram.read_value(message_code, 5));
 
     if (message_code > 0) {
-        snprintf(maintenanceMessage_, sizeof(maintenanceMessage_), "H%02d", message_code);
+        char message[sizeof(maintenanceMessage_)];
+        snprintf(message, sizeof(message), "H%02d", message_code);
+        has_update(maintenanceMessage_, message, sizeof(maintenanceMessage_));
     } else {
         // No message. All Ok. But set a blank message so value is still in the MQTT payload to avoid HA giving warnings
-        maintenanceMessage_[0] = ' ';
-        maintenanceMessage_[1] = '\0';
+        has_update(maintenanceMessage_, " ", sizeof(maintenanceMessage_));
     }
 }
 
 // 0x10, 0x11
-void Boiler::process_UBAErrorMessage(std::shared_ptr<const Telegram> telegram) {
-    if (telegram->offset > 0 || telegram->message_length < 9) {
+void Boiler::process_UBAErrorMessage(const Telegram & telegram) {
+    if (telegram.offset > 0 || telegram.message_length < 9) {
         return;
     }
     // data: displaycode(2), errornumber(2), year, month, hour, day, minute, duration(2), src-addr
-    if (telegram->message_data[4] & 0x80) { // valid date
+    if (telegram.message_data[4] & 0x80) { // valid date
 
         static uint32_t lastCodeDate_ = 0; // last code date
         char            code[3];
         uint16_t        codeNo;
-        code[0] = telegram->message_data[0];
-        code[1] = telegram->message_data[1];
+        code[0] = telegram.message_data[0];
+        code[1] = telegram.message_data[1];
         code[2] = 0;
-        telegram->read_value(codeNo, 2);
-        uint16_t year  = (telegram->message_data[4] & 0x7F) + 2000;
-        uint8_t  month = telegram->message_data[5];
-        uint8_t  day   = telegram->message_data[7];
-        uint8_t  hour  = telegram->message_data[6];
-        uint8_t  min   = telegram->message_data[8];
+        telegram.read_value(codeNo, 2);
+        uint16_t year  = (telegram.message_data[4] & 0x7F) + 2000;
+        uint8_t  month = telegram.message_data[5];
+        uint8_t  day   = telegram.message_data[7];
+        uint8_t  hour  = telegram.message_data[6];
+        uint8_t  min   = telegram.message_data[8];
         uint32_t date  = (year - 2000) * 535680UL + month * 44640UL + day * 1440UL + hour * 60 + min;
         // store only the newest code from telegrams 10 and 11
         if (date > lastCodeDate_) {
             snprintf(lastCode_, sizeof(lastCode_), "%s(%d) %02d.%02d.%d %02d:%02d", code, codeNo, day, month, year, hour, min);
             lastCodeDate_ = date;
+            has_update(lastCode_);
         }
     }
 }
 
 // 0xC2
-void Boiler::process_UBAErrorMessage2(std::shared_ptr<const Telegram> telegram) {
+void Boiler::process_UBAErrorMessage2(const Telegram & telegram) {
     // not sure why this test is in , so removing
-    // if (telegram->offset > 0 || telegram->message_length < 14) {
+    // if (telegram.offset > 0 || telegram.message_length < 14) {
     //     return;
     // }
     char     code[4];
@@ -824,60 +807,64 @@ void Boiler::process_UBAErrorMessage2(std::shared_ptr<const Telegram> telegram)
     char     start_time[17];
     char     end_time[17];
 
-    if (!(telegram->message_data[10] & 0x80)) { // no valid start date means no error?
+    if (!(telegram.message_data[10] & 0x80)) { // no valid start date means no error?
         return;
     }
 
-    code[0] = telegram->message_data[5];
-    code[1] = telegram->message_data[6];
-    code[2] = telegram->message_data[7];
+    code[0] = telegram.message_data[5];
+    code[1] = telegram.message_data[6];
+    code[2] = telegram.message_data[7];
     code[3] = 0;
-    telegram->read_value(codeNo, 8);
+    telegram.read_value(codeNo, 8);
 
-    uint16_t start_year  = (telegram->message_data[10] & 0x7F) + 2000;
-    uint8_t  start_month = telegram->message_data[11];
-    uint8_t  start_day   = telegram->message_data[13];
-    uint8_t  start_hour  = telegram->message_data[12];
-    uint8_t  start_min   = telegram->message_data[14];
+    uint16_t start_year  = (telegram.message_data[10] & 0x7F) + 2000;
+    uint8_t  start_month = telegram.message_data[11];
+    uint8_t  start_day   = telegram.message_data[13];
+    uint8_t  start_hour  = telegram.message_data[12];
+    uint8_t  start_min   = telegram.message_data[14];
     snprintf(start_time, sizeof(start_time), "%d.%02d.%02d %02d:%02d", start_year, start_month, start_day, start_hour, start_min);
 
-    uint16_t end_year  = (telegram->message_data[15] & 0x7F) + 2000;
-    uint8_t  end_month = telegram->message_data[16];
-    uint8_t  end_day   = telegram->message_data[18];
-    uint8_t  end_hour  = telegram->message_data[17];
-    uint8_t  end_min   = telegram->message_data[19];
+    uint16_t end_year  = (telegram.message_data[15] & 0x7F) + 2000;
+    uint8_t  end_month = telegram.message_data[16];
+    uint8_t  end_day   = telegram.message_data[18];
+    uint8_t  end_hour  = telegram.message_data[17];
+    uint8_t  end_min   = telegram.message_data[19];
 
-    if (telegram->message_data[15] & 0x80) { // valid end date
+    if (telegram.message_data[15] & 0x80) { // valid end date
         snprintf(end_time, sizeof(end_time), "%d.%02d.%02d %02d:%02d", end_year, end_month, end_day, end_hour, end_min);
     } else { // no valid end date means error still persists
         snprintf(end_time, sizeof(end_time), "%s", "none");
     }
 
-    snprintf(lastCode_, sizeof(lastCode_), "%s/%d start: %s, end: %s", code, codeNo, start_time, end_time);
+    char lastcode[sizeof(lastCode_)];
+    snprintf(lastcode, sizeof(lastcode), "%s/%d start: %s, end: %s", code, codeNo, start_time, end_time);
+    has_update(lastCode_, lastcode, sizeof(lastCode_));
 }
 
 
 // 0x15
-void Boiler::process_UBAMaintenanceData(std::shared_ptr<const Telegram> telegram) {
-    if (telegram->offset > 0 || telegram->message_length < 5) {
+void Boiler::process_UBAMaintenanceData(const Telegram & telegram) {
+    if (telegram.offset > 0 || telegram.message_length < 5) {
         return;
     }
 
     // first byte: Maintenance messages (0 = none, 1 = by operating hours, 2 = by date)
-    has_update(telegram->read_value(maintenanceType_, 0));
+    has_update(telegram.read_value(maintenanceType_, 0));
 
     uint8_t time = (maintenanceTime_ == EMS_VALUE_USHORT_NOTSET) ? EMS_VALUE_UINT_NOTSET : maintenanceTime_ / 100;
-    has_update(telegram->read_value(time, 1));
-    maintenanceTime_ = (time == EMS_VALUE_UINT_NOTSET) ? EMS_VALUE_USHORT_NOTSET : time * 100;
-    // telegram->read_value(maintenanceTime_, 1, 1);
+    telegram.read_value(time, 1);
+    has_update(maintenanceTime_, (time == EMS_VALUE_UINT_NOTSET) ? EMS_VALUE_USHORT_NOTSET : time * 100);
+    // telegram.read_value(maintenanceTime_, 1, 1);
     // maintenanceTime_ = maintenanceTime * 100;
 
     // date only
-    uint8_t day   = telegram->message_data[2];
-    uint8_t month = telegram->message_data[3];
-    uint8_t year  = telegram->message_data[4];
+    uint8_t day   = telegram.message_data[2];
+    uint8_t month = telegram.message_data[3];
+    uint8_t year  = telegram.message_data[4];
     if (day > 0 && month > 0) {
-        snprintf(maintenanceDate_, sizeof(maintenanceDate_), "%02d.%02d.%04d", day, month, year + 2000);
+        char date[sizeof(maintenanceDate_)];
+        snprintf(date, sizeof(date), "%02d.%02d.%04d", day, month, year + 2000);
+        has_update(maintenanceDate_, date, sizeof(maintenanceDate_));
     }
 }
 
@@ -1292,11 +1279,11 @@ bool Boiler::set_tapwarmwater_activated(const char * value, const int8_t id) {
         message_data[1] = 0x00; // burner output 0%
         message_data[3] = 0x64; // boiler pump capacity 100%
         message_data[4] = 0xFF; // 3-way valve hot water only
-        wwTapActivated_ = 0;
+        has_update(wwTapActivated_, 0);
     } else {
         // get out of test mode. Send all zeros.
         // telegram: 0B 08 1D 00 00
-        wwTapActivated_ = 1;
+        has_update(wwTapActivated_, 1);
     }
 
     write_command(EMS_TYPE_UBAFunctionTest, 0, message_data, sizeof(message_data), 0);
@@ -197,33 +197,33 @@ class Boiler : public EMSdevice {
     // Pool unit
     int8_t poolSetTemp_;
 
-    void process_UBAParameterWW(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMonitorFast(std::shared_ptr<const Telegram> telegram);
-    void process_UBATotalUptime(std::shared_ptr<const Telegram> telegram);
-    void process_UBAParameters(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMonitorWW(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMonitorFastPlus(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMonitorSlow(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMonitorSlowPlus(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMonitorSlowPlus2(std::shared_ptr<const Telegram> telegram);
-    void process_UBAParametersPlus(std::shared_ptr<const Telegram> telegram);
-    void process_UBAParameterWWPlus(std::shared_ptr<const Telegram> telegram);
-    void process_UBAOutdoorTemp(std::shared_ptr<const Telegram> telegram);
-    void process_UBASetPoints(std::shared_ptr<const Telegram> telegram);
-    void process_UBAFlags(std::shared_ptr<const Telegram> telegram);
-    void process_MC110Status(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMaintenanceStatus(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMaintenanceData(std::shared_ptr<const Telegram> telegram);
-    void process_UBAErrorMessage(std::shared_ptr<const Telegram> telegram);
-    void process_UBAErrorMessage2(std::shared_ptr<const Telegram> telegram);
-    void process_UBAMonitorWWPlus(std::shared_ptr<const Telegram> telegram);
-    void process_UBAInformation(std::shared_ptr<const Telegram> telegram);
-    void process_UBAEnergySupplied(std::shared_ptr<const Telegram> telegram);
-    void process_CascadeMessage(std::shared_ptr<const Telegram> telegram);
-    void process_UBASettingsWW(std::shared_ptr<const Telegram> telegram);
-    void process_HpPower(std::shared_ptr<const Telegram> telegram);
-    void process_HpOutdoor(std::shared_ptr<const Telegram> telegram);
-    void process_HpPool(std::shared_ptr<const Telegram> telegram);
+    void process_UBAParameterWW(const Telegram & telegram);
+    void process_UBAMonitorFast(const Telegram & telegram);
+    void process_UBATotalUptime(const Telegram & telegram);
+    void process_UBAParameters(const Telegram & telegram);
+    void process_UBAMonitorWW(const Telegram & telegram);
+    void process_UBAMonitorFastPlus(const Telegram & telegram);
+    void process_UBAMonitorSlow(const Telegram & telegram);
+    void process_UBAMonitorSlowPlus(const Telegram & telegram);
+    void process_UBAMonitorSlowPlus2(const Telegram & telegram);
+    void process_UBAParametersPlus(const Telegram & telegram);
+    void process_UBAParameterWWPlus(const Telegram & telegram);
+    void process_UBAOutdoorTemp(const Telegram & telegram);
+    void process_UBASetPoints(const Telegram & telegram);
+    void process_UBAFlags(const Telegram & telegram);
+    void process_MC110Status(const Telegram & telegram);
+    void process_UBAMaintenanceStatus(const Telegram & telegram);
+    void process_UBAMaintenanceData(const Telegram & telegram);
+    void process_UBAErrorMessage(const Telegram & telegram);
+    void process_UBAErrorMessage2(const Telegram & telegram);
+    void process_UBAMonitorWWPlus(const Telegram & telegram);
+    void process_UBAInformation(const Telegram & telegram);
+    void process_UBAEnergySupplied(const Telegram & telegram);
+    void process_CascadeMessage(const Telegram & telegram);
+    void process_UBASettingsWW(const Telegram & telegram);
+    void process_HpPower(const Telegram & telegram);
+    void process_HpOutdoor(const Telegram & telegram);
+    void process_HpPool(const Telegram & telegram);
 
     // commands - none of these use the additional id parameter
     bool set_ww_mode(const char * value, const int8_t id);
@@ -39,8 +39,8 @@ bool Generic::publish_ha_device_config() {
 }
 
 // type 0x435 rf remote sensor
-void Generic::process_RFSensorMessage(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(rfTemp_, 0)); // is * 10
+void Generic::process_RFSensorMessage(const Telegram & telegram) {
+    has_update(telegram.read_value(rfTemp_, 0)); // is * 10
 }
 
 } // namespace emsesp
\ No newline at end of file
@@ -34,7 +34,7 @@ class Generic : public EMSdevice {
 
     int16_t rfTemp_;
 
-    void process_RFSensorMessage(std::shared_ptr<const Telegram> telegram);
+    void process_RFSensorMessage(const Telegram & telegram);
 };
 
 } // namespace emsesp
@@ -72,9 +72,9 @@ bool Heatpump::publish_ha_device_config() {
  * Type 0x47B - HeatPump Monitor 2
  * e.g. "38 10 FF 00 03 7B 08 24 00 4B"
  */
-void Heatpump::process_HPMonitor2(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(dewTemperature_, 0));
-    has_update(telegram->read_value(airHumidity_, 1));
+void Heatpump::process_HPMonitor2(const Telegram & telegram) {
+    has_update(telegram.read_value(dewTemperature_, 0));
+    has_update(telegram.read_value(airHumidity_, 1));
 }
 
 #pragma GCC diagnostic push
@@ -84,7 +84,7 @@ void Heatpump::process_HPMonitor2(std::shared_ptr<const Telegram> telegram) {
  * Type 0x42B- HeatPump Monitor 1
  * e.g. "38 10 FF 00 03 2B 00 D1 08 2A 01"
  */
-void Heatpump::process_HPMonitor1(std::shared_ptr<const Telegram> telegram) {
+void Heatpump::process_HPMonitor1(const Telegram & telegram) {
     // still to implement
 }
 
@@ -36,8 +36,8 @@ class Heatpump : public EMSdevice {
     uint8_t dewTemperature_;
     uint8_t id_;
 
-    void process_HPMonitor1(std::shared_ptr<const Telegram> telegram);
-    void process_HPMonitor2(std::shared_ptr<const Telegram> telegram);
+    void process_HPMonitor1(const Telegram & telegram);
+    void process_HPMonitor2(const Telegram & telegram);
 };
 
 } // namespace emsesp
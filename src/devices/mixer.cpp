@@ -166,76 +166,76 @@ bool Mixer::publish_ha_device_config() {
 // heating circuits 0x02D7, 0x02D8 etc...
 // e.g.  A0 00 FF 00 01 D7 00 00 00 80 00 00 00 00 03 C5
 //       A0 0B FF 00 01 D7 00 00 00 80 00 00 00 00 03 80
-void Mixer::process_MMPLUSStatusMessage_HC(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(flowTempHc_, 3)); // is * 10
-    has_update(telegram->read_value(flowSetTemp_, 5));
-    has_update(telegram->read_bitvalue(pumpStatus_, 0, 0));
-    has_update(telegram->read_value(status_, 2)); // valve status
+void Mixer::process_MMPLUSStatusMessage_HC(const Telegram & telegram) {
+    has_update(telegram.read_value(flowTempHc_, 3)); // is * 10
+    has_update(telegram.read_value(flowSetTemp_, 5));
+    has_update(telegram.read_bitvalue(pumpStatus_, 0, 0));
+    has_update(telegram.read_value(status_, 2)); // valve status
 }
 
 // Mixer warm water loading/DHW - 0x0331, 0x0332
 // e.g. A9 00 FF 00 02 32 02 6C 00 3C 00 3C 3C 46 02 03 03 00 3C // on 0x28
 //      A8 00 FF 00 02 31 02 35 00 3C 00 3C 3C 46 02 03 03 00 3C // in 0x29
-void Mixer::process_MMPLUSStatusMessage_WWC(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(flowTempHc_, 0)); // is * 10
-    has_update(telegram->read_bitvalue(pumpStatus_, 2, 0));
-    has_update(telegram->read_value(status_, 11)); // temp status
+void Mixer::process_MMPLUSStatusMessage_WWC(const Telegram & telegram) {
+    has_update(telegram.read_value(flowTempHc_, 0)); // is * 10
+    has_update(telegram.read_bitvalue(pumpStatus_, 2, 0));
+    has_update(telegram.read_value(status_, 11)); // temp status
 }
 
 // Mixer IPM - 0x010C
 // e.g.  A0 00 FF 00 00 0C 01 00 00 00 00 00 54
 //       A1 00 FF 00 00 0C 02 04 00 01 1D 00 82
-void Mixer::process_IPMStatusMessage(std::shared_ptr<const Telegram> telegram) {
+void Mixer::process_IPMStatusMessage(const Telegram & telegram) {
     // check if circuit is active, 0-off, 1-unmixed, 2-mixed
     uint8_t ismixed = 0;
-    telegram->read_value(ismixed, 0);
+    telegram.read_value(ismixed, 0);
     if (ismixed == 0) {
         return;
     }
 
     // do we have a mixed circuit
     if (ismixed == 2) {
-        has_update(telegram->read_value(flowTempHc_, 3)); // is * 10
-        has_update(telegram->read_value(status_, 2));     // valve status
+        has_update(telegram.read_value(flowTempHc_, 3)); // is * 10
+        has_update(telegram.read_value(status_, 2));     // valve status
     }
 
-    has_update(telegram->read_bitvalue(pumpStatus_, 1, 0)); // pump is also in unmixed circuits
-    has_update(telegram->read_value(flowSetTemp_, 5));      // flowSettemp is also in unmixed circuits, see #711
+    has_update(telegram.read_bitvalue(pumpStatus_, 1, 0)); // pump is also in unmixed circuits
+    has_update(telegram.read_value(flowSetTemp_, 5));      // flowSettemp is also in unmixed circuits, see #711
 }
 
 // Mixer IPM - 0x001E Temperature Message in unmixed circuits
 // in unmixed circuits FlowTemp in 10C is zero, this is the measured flowtemp in header
-void Mixer::process_IPMTempMessage(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(flowTempVf_, 0)); // TC1, is * 10
+void Mixer::process_IPMTempMessage(const Telegram & telegram) {
+    has_update(telegram.read_value(flowTempVf_, 0)); // TC1, is * 10
 }
 
 // Mixer on a MM10 - 0xAB
 // e.g. Mixer Module -> All, type 0xAB, telegram: 21 00 AB 00 2D 01 BE 64 04 01 00 (CRC=15) #data=7
 // see also https://github.com/emsesp/EMS-ESP/issues/386
-void Mixer::process_MMStatusMessage(std::shared_ptr<const Telegram> telegram) {
+void Mixer::process_MMStatusMessage(const Telegram & telegram) {
     // the heating circuit is determine by which device_id it is, 0x20 - 0x23
     // 0x21 is position 2. 0x20 is typically reserved for the WM10 switch module
     // see https://github.com/emsesp/EMS-ESP/issues/270 and https://github.com/emsesp/EMS-ESP/issues/386#issuecomment-629610918
 
-    has_update(telegram->read_value(flowTempHc_, 1));       // is * 10
-    has_update(telegram->read_bitvalue(pumpStatus_, 3, 2)); // is 0 or 0x64 (100%), check only bit 2
-    has_update(telegram->read_value(flowSetTemp_, 0));
-    has_update(telegram->read_value(status_, 4)); // valve status -100 to 100
+    has_update(telegram.read_value(flowTempHc_, 1));       // is * 10
+    has_update(telegram.read_bitvalue(pumpStatus_, 3, 2)); // is 0 or 0x64 (100%), check only bit 2
+    has_update(telegram.read_value(flowSetTemp_, 0));
+    has_update(telegram.read_value(status_, 4)); // valve status -100 to 100
 }
 
 // Pool mixer MP100, - 0x5BA
-void Mixer::process_HpPoolStatus(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(poolTemp_, 0));
-    has_update(telegram->read_value(poolShuntStatus__, 2));
-    has_update(telegram->read_value(poolShunt_, 3)); // 0-100% how much is the shunt open?
-    poolShuntStatus_ = poolShunt_ == 100 ? 3 : (poolShunt_ == 0 ? 4 : poolShuntStatus__);
+void Mixer::process_HpPoolStatus(const Telegram & telegram) {
+    has_update(telegram.read_value(poolTemp_, 0));
+    has_update(telegram.read_value(poolShuntStatus__, 2));
+    has_update(telegram.read_value(poolShunt_, 3)); // 0-100% how much is the shunt open?
+    has_update(poolShuntStatus_, poolShunt_ == 100 ? 3 : (poolShunt_ == 0 ? 4 : poolShuntStatus__));
 }
 
 // Mixer on a MM10 - 0xAA
 // e.g. Thermostat -> Mixer Module, type 0xAA, telegram: 10 21 AA 00 FF 0C 0A 11 0A 32 xx
-void Mixer::process_MMConfigMessage(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(activated_, 0));    // on = 0xFF
-    has_update(telegram->read_value(setValveTime_, 1)); // valve runtime in 10 sec, max 120 s
+void Mixer::process_MMConfigMessage(const Telegram & telegram) {
+    has_update(telegram.read_value(activated_, 0));    // on = 0xFF
+    has_update(telegram.read_value(setValveTime_, 1)); // valve runtime in 10 sec, max 120 s
 }
 
 #pragma GCC diagnostic push
@@ -243,13 +243,13 @@ void Mixer::process_MMConfigMessage(std::shared_ptr<const Telegram> telegram) {
 
 // Mixer on a MM10 - 0xAC
 // e.g. Thermostat -> Mixer Module, type 0xAC, telegram: 10 21 AC 00 1E 64 01 AB
-void Mixer::process_MMSetMessage(std::shared_ptr<const Telegram> telegram) {
+void Mixer::process_MMSetMessage(const Telegram & telegram) {
     // pos 0: flowtemp setpoint 1E = 30°C
     // pos 1: position in %
 }
 
 // Thermostat(0x10) -> Mixer(0x21), ?(0x23), data: 1A 64 00 90 21 23 00 1A 64 00 89
-void Mixer::process_IPMSetMessage(std::shared_ptr<const Telegram> telegram) {
+void Mixer::process_IPMSetMessage(const Telegram & telegram) {
     // pos 0: flowtemp setpoint 1A = 26°C
     // pos 1: position in %?
 }
@@ -32,15 +32,15 @@ class Mixer : public EMSdevice {
   private:
     static uuid::log::Logger logger_;
 
-    void process_MMPLUSStatusMessage_HC(std::shared_ptr<const Telegram> telegram);
-    void process_MMPLUSStatusMessage_WWC(std::shared_ptr<const Telegram> telegram);
-    void process_IPMStatusMessage(std::shared_ptr<const Telegram> telegram);
-    void process_IPMTempMessage(std::shared_ptr<const Telegram> telegram);
-    void process_IPMSetMessage(std::shared_ptr<const Telegram> telegram);
-    void process_MMStatusMessage(std::shared_ptr<const Telegram> telegram);
-    void process_MMConfigMessage(std::shared_ptr<const Telegram> telegram);
-    void process_MMSetMessage(std::shared_ptr<const Telegram> telegram);
-    void process_HpPoolStatus(std::shared_ptr<const Telegram> telegram);
+    void process_MMPLUSStatusMessage_HC(const Telegram & telegram);
+    void process_MMPLUSStatusMessage_WWC(const Telegram & telegram);
+    void process_IPMStatusMessage(const Telegram & telegram);
+    void process_IPMTempMessage(const Telegram & telegram);
+    void process_IPMSetMessage(const Telegram & telegram);
+    void process_MMStatusMessage(const Telegram & telegram);
+    void process_MMConfigMessage(const Telegram & telegram);
+    void process_MMSetMessage(const Telegram & telegram);
+    void process_HpPoolStatus(const Telegram & telegram);
 
     bool set_flowSetTemp(const char * value, const int8_t id);
     bool set_pump(const char * value, const int8_t id);
@@ -211,30 +211,30 @@ bool Solar::publish_ha_device_config() {
 
 // SM10Monitor - type 0x96
 // Solar(0x30) -> All(0x00), (0x96), data: FF 18 19 0A 02 5A 27 0A 05 2D 1E 0F 64 28 0A
-void Solar::process_SM10Config(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(solarIsEnabled_, 0)); // FF on
-    has_update(telegram->read_value(solarPumpMinMod_, 2));
-    has_update(telegram->read_value(solarPumpTurnonDiff_, 7));
-    has_update(telegram->read_value(solarPumpTurnoffDiff_, 8));
-    has_update(telegram->read_value(tankMaxTemp_, 5));
-    has_update(telegram->read_value(wwMinTemp_, 6));
+void Solar::process_SM10Config(const Telegram & telegram) {
+    has_update(telegram.read_value(solarIsEnabled_, 0)); // FF on
+    has_update(telegram.read_value(solarPumpMinMod_, 2));
+    has_update(telegram.read_value(solarPumpTurnonDiff_, 7));
+    has_update(telegram.read_value(solarPumpTurnoffDiff_, 8));
+    has_update(telegram.read_value(tankMaxTemp_, 5));
+    has_update(telegram.read_value(wwMinTemp_, 6));
 }
 
 // SM10Monitor - type 0x97
-void Solar::process_SM10Monitor(std::shared_ptr<const Telegram> telegram) {
+void Solar::process_SM10Monitor(const Telegram & telegram) {
     uint8_t solarpumpmod = solarPumpModulation_;
 
-    has_update(telegram->read_bitvalue(collectorShutdown_, 0, 3));
-    has_update(telegram->read_bitvalue(tankHeated_, 0, 2));    // tankMaxTemp reached
-    has_update(telegram->read_value(collectorTemp_, 2));       // collector temp from SM10, is *10
-    has_update(telegram->read_value(tankBottomTemp_, 5));      // tank bottom temp from SM10, is *10
-    has_update(telegram->read_value(solarPumpModulation_, 4)); // modulation solar pump
-    has_update(telegram->read_bitvalue(solarPump_, 7, 1));
-    has_update(telegram->read_value(pumpWorkTime_, 8, 3));
+    has_update(telegram.read_bitvalue(collectorShutdown_, 0, 3));
+    has_update(telegram.read_bitvalue(tankHeated_, 0, 2));    // tankMaxTemp reached
+    has_update(telegram.read_value(collectorTemp_, 2));       // collector temp from SM10, is *10
+    has_update(telegram.read_value(tankBottomTemp_, 5));      // tank bottom temp from SM10, is *10
+    has_update(telegram.read_value(solarPumpModulation_, 4)); // modulation solar pump
+    has_update(telegram.read_bitvalue(solarPump_, 7, 1));
+    has_update(telegram.read_value(pumpWorkTime_, 8, 3));
 
     // mask out pump-boosts
     if (solarpumpmod == 0 && solarPumpModulation_ == 100) {
-        solarPumpModulation_ = solarPumpMinMod_; // set to minimum
+        has_update(solarPumpModulation_, solarPumpMinMod_); // set to minimum
     }
 
     if (!Helpers::hasValue(maxFlow_)) {
@@ -242,10 +242,10 @@ void Solar::process_SM10Monitor(std::shared_ptr<const Telegram> telegram) {
     }
 
     // solar publishes every minute, do not count reads by other devices
-    if (telegram->dest == 0) {
+    if (telegram.dest == 0) {
         // water 4.184 J/gK, glycol ~2.6-2.8 J/gK, no aceotrope
         // solarPower_ = (collectorTemp_ - tankBottomTemp_) * solarPumpModulation_ * maxFlow_ * 10 / 1434; // water
-        solarPower_ = (collectorTemp_ - tankBottomTemp_) * solarPumpModulation_ * maxFlow_ * 10 / 1665; //40% glycol@40°C
+        has_update(solarPower_, (collectorTemp_ - tankBottomTemp_) * solarPumpModulation_ * maxFlow_ * 10 / 1665); //40% glycol@40°C
         if (energy.size() >= 60) {
             energy.pop_front();
         }
@@ -254,7 +254,7 @@ void Solar::process_SM10Monitor(std::shared_ptr<const Telegram> telegram) {
         for (auto e : energy) {
             sum += e;
         }
-        energyLastHour_ = sum / 6; // counts in 0.1 Wh
+        has_update(energyLastHour_, sum / 6); // counts in 0.1 Wh
     }
 }
 
@@ -262,29 +262,29 @@ void Solar::process_SM10Monitor(std::shared_ptr<const Telegram> telegram) {
  * process_SM100SystemConfig - type 0x0358 EMS+ - for MS/SM100 and MS/SM200
  * e.g. B0 0B FF 00 02 58 FF 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 FF 00 FF 01 00 00
  */
-void Solar::process_SM100SystemConfig(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(heatTransferSystem_, 5, 1));
-    has_update(telegram->read_value(externalTank_, 9, 1));
-    has_update(telegram->read_value(thermalDisinfect_, 10, 1));
-    has_update(telegram->read_value(heatMetering_, 14, 1));
-    has_update(telegram->read_value(solarIsEnabled_, 19, 1));
+void Solar::process_SM100SystemConfig(const Telegram & telegram) {
+    has_update(telegram.read_value(heatTransferSystem_, 5, 1));
+    has_update(telegram.read_value(externalTank_, 9, 1));
+    has_update(telegram.read_value(thermalDisinfect_, 10, 1));
+    has_update(telegram.read_value(heatMetering_, 14, 1));
+    has_update(telegram.read_value(solarIsEnabled_, 19, 1));
 }
 
 /*
  * process_SM100SolarCircuitConfig - type 0x035A EMS+ - for MS/SM100 and MS/SM200
  * e.g. B0 0B FF 00 02 5A 64 05 00 58 14 01 01 32 64 00 00 00 5A 0C
  */
-void Solar::process_SM100SolarCircuitConfig(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(collectorMaxTemp_, 0, 1));
-    has_update(telegram->read_value(tankMaxTemp_, 3, 1));
-    has_update(telegram->read_value(collectorMinTemp_, 4, 1));
-    has_update(telegram->read_value(solarPumpMode_, 5, 1));
-    has_update(telegram->read_value(solarPumpMinMod_, 6, 1));
-    has_update(telegram->read_value(solarPumpTurnoffDiff_, 7, 1));
-    has_update(telegram->read_value(solarPumpTurnonDiff_, 8, 1));
-    has_update(telegram->read_value(solarPumpKick_, 9, 1));
-    has_update(telegram->read_value(plainWaterMode_, 10, 1));
-    has_update(telegram->read_value(doubleMatchFlow_, 11, 1));
+void Solar::process_SM100SolarCircuitConfig(const Telegram & telegram) {
+    has_update(telegram.read_value(collectorMaxTemp_, 0, 1));
+    has_update(telegram.read_value(tankMaxTemp_, 3, 1));
+    has_update(telegram.read_value(collectorMinTemp_, 4, 1));
+    has_update(telegram.read_value(solarPumpMode_, 5, 1));
+    has_update(telegram.read_value(solarPumpMinMod_, 6, 1));
+    has_update(telegram.read_value(solarPumpTurnoffDiff_, 7, 1));
+    has_update(telegram.read_value(solarPumpTurnonDiff_, 8, 1));
+    has_update(telegram.read_value(solarPumpKick_, 9, 1));
+    has_update(telegram.read_value(plainWaterMode_, 10, 1));
+    has_update(telegram.read_value(doubleMatchFlow_, 11, 1));
 }
 
 /* process_SM100ParamCfg - type 0xF9 EMS 1.0
@@ -302,19 +302,19 @@ void Solar::process_SM100SolarCircuitConfig(std::shared_ptr<const Telegram> tele
  *
  * e.g. B0 0B F9 00 00 02 5A 00 00 6E
  */
-void Solar::process_SM100ParamCfg(std::shared_ptr<const Telegram> telegram) {
+void Solar::process_SM100ParamCfg(const Telegram & telegram) {
     uint16_t t_id = EMS_VALUE_USHORT_NOTSET;
     uint8_t  of   = EMS_VALUE_UINT_NOTSET;
     int32_t  min  = EMS_VALUE_USHORT_NOTSET;
     int32_t  def  = EMS_VALUE_USHORT_NOTSET;
     int32_t  max  = EMS_VALUE_USHORT_NOTSET;
     int32_t  cur  = EMS_VALUE_USHORT_NOTSET;
-    has_update(telegram->read_value(t_id, 1));
-    has_update(telegram->read_value(of, 3));
-    has_update(telegram->read_value(min, 5));
-    has_update(telegram->read_value(def, 9));
-    has_update(telegram->read_value(max, 13));
-    has_update(telegram->read_value(cur, 17));
+    has_update(telegram.read_value(t_id, 1));
+    has_update(telegram.read_value(of, 3));
+    has_update(telegram.read_value(min, 5));
+    has_update(telegram.read_value(def, 9));
+    has_update(telegram.read_value(max, 13));
+    has_update(telegram.read_value(cur, 17));
 
     // LOG_DEBUG(F("SM100ParamCfg param=0x%04X, offset=%d, min=%d, default=%d, max=%d, current=%d"), t_id, of, min, def, max, cur));
 }
@@ -330,27 +330,27 @@ void Solar::process_SM100ParamCfg(std::shared_ptr<const Telegram> telegram) {
  * bytes 16+17 = TS5 Temperature sensor 2 cylinder, bottom, or swimming pool
  * bytes 20+21 = TS6 Temperature sensor external heat exchanger
  */
-void Solar::process_SM100Monitor(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(collectorTemp_, 0));      // is *10 - TS1: Temperature sensor for collector array 1
-    has_update(telegram->read_value(tankBottomTemp_, 2));     // is *10 - TS2: Temperature sensor 1 cylinder, bottom
-    has_update(telegram->read_value(tankBottomTemp2_, 16));   // is *10 - TS5: Temperature sensor 2 cylinder, bottom, or swimming pool
-    has_update(telegram->read_value(heatExchangerTemp_, 20)); // is *10 - TS6: Heat exchanger temperature sensor
+void Solar::process_SM100Monitor(const Telegram & telegram) {
+    has_update(telegram.read_value(collectorTemp_, 0));      // is *10 - TS1: Temperature sensor for collector array 1
+    has_update(telegram.read_value(tankBottomTemp_, 2));     // is *10 - TS2: Temperature sensor 1 cylinder, bottom
+    has_update(telegram.read_value(tankBottomTemp2_, 16));   // is *10 - TS5: Temperature sensor 2 cylinder, bottom, or swimming pool
+    has_update(telegram.read_value(heatExchangerTemp_, 20)); // is *10 - TS6: Heat exchanger temperature sensor
 }
 
 // SM100wwTemperature - 0x07D6
 // Solar Module(0x2A) -> (0x00), (0x7D6), data: 01 C1 00 00 02 5B 01 AF 01 AD 80 00 01 90
-void Solar::process_SM100wwTemperature(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwTemp_1_, 0));
-    has_update(telegram->read_value(wwTemp_3_, 4));
-    has_update(telegram->read_value(wwTemp_4_, 6));
-    has_update(telegram->read_value(wwTemp_5_, 8));
-    has_update(telegram->read_value(wwTemp_7_, 12));
+void Solar::process_SM100wwTemperature(const Telegram & telegram) {
+    has_update(telegram.read_value(wwTemp_1_, 0));
+    has_update(telegram.read_value(wwTemp_3_, 4));
+    has_update(telegram.read_value(wwTemp_4_, 6));
+    has_update(telegram.read_value(wwTemp_5_, 8));
+    has_update(telegram.read_value(wwTemp_7_, 12));
 }
 
 // SM100wwStatus - 0x07AA
 // Solar Module(0x2A) -> (0x00), (0x7AA), data: 64 00 04 00 03 00 28 01 0F
-void Solar::process_SM100wwStatus(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwPump_, 0));
+void Solar::process_SM100wwStatus(const Telegram & telegram) {
+    has_update(telegram.read_value(wwPump_, 0));
 }
 
 #pragma GCC diagnostic push
@@ -358,13 +358,13 @@ void Solar::process_SM100wwStatus(std::shared_ptr<const Telegram> telegram) {
 
 // SM100Monitor2 - 0x0363
 // e.g. B0 00 FF 00 02 63 80 00 80 00 00 00 80 00 80 00 80 00 00 80 00 5A
-void Solar::process_SM100Monitor2(std::shared_ptr<const Telegram> telegram) {
+void Solar::process_SM100Monitor2(const Telegram & telegram) {
     // not implemented yet
 }
 
 // SM100wwCommand - 0x07AB
 // Thermostat(0x10) -> Solar Module(0x2A), (0x7AB), data: 01 00 01
-void Solar::process_SM100wwCommand(std::shared_ptr<const Telegram> telegram) {
+void Solar::process_SM100wwCommand(const Telegram & telegram) {
     // not implemented yet
 }
 
@@ -372,10 +372,10 @@ void Solar::process_SM100wwCommand(std::shared_ptr<const Telegram> telegram) {
 
 // SM100Config - 0x0366
 // e.g. B0 00 FF 00 02 66     01 62 00 13 40 14
-void Solar::process_SM100Config(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(availabilityFlag_, 0));
-    has_update(telegram->read_value(configFlag_, 1));
-    has_update(telegram->read_value(userFlag_, 2));
+void Solar::process_SM100Config(const Telegram & telegram) {
+    has_update(telegram.read_value(availabilityFlag_, 0));
+    has_update(telegram.read_value(configFlag_, 1));
+    has_update(telegram.read_value(userFlag_, 2));
 }
 
 /*
@@ -384,21 +384,21 @@ void Solar::process_SM100Config(std::shared_ptr<const Telegram> telegram) {
  - PS5: Cylinder primary pump when using an external heat exchanger
  * e.g. 30 00 FF 09 02 64 64 = 100%
  */
-void Solar::process_SM100Status(std::shared_ptr<const Telegram> telegram) {
+void Solar::process_SM100Status(const Telegram & telegram) {
     uint8_t solarpumpmod    = solarPumpModulation_;
     uint8_t cylinderpumpmod = cylinderPumpModulation_;
-    has_update(telegram->read_value(cylinderPumpModulation_, 8));
-    has_update(telegram->read_value(solarPumpModulation_, 9));
+    has_update(telegram.read_value(cylinderPumpModulation_, 8));
+    has_update(telegram.read_value(solarPumpModulation_, 9));
 
     if (solarpumpmod == 0 && solarPumpModulation_ == 100) { // mask out boosts
-        solarPumpModulation_ = solarPumpMinMod_;            // set to minimum
+        has_update(solarPumpModulation_, solarPumpMinMod_); // set to minimum
     }
 
     if (cylinderpumpmod == 0 && cylinderPumpModulation_ == 100) { // mask out boosts
-        cylinderPumpModulation_ = solarPumpMinMod_;               // set to minimum
+        has_update(cylinderPumpModulation_, solarPumpMinMod_);    // set to minimum
     }
-    has_update(telegram->read_bitvalue(tankHeated_, 3, 1));        // issue #422
-    has_update(telegram->read_bitvalue(collectorShutdown_, 3, 0)); // collector shutdown
+    has_update(telegram.read_bitvalue(tankHeated_, 3, 1));        // issue #422
+    has_update(telegram.read_bitvalue(collectorShutdown_, 3, 0)); // collector shutdown
 }
 
 /*
@@ -407,60 +407,60 @@ void Solar::process_SM100Status(std::shared_ptr<const Telegram> telegram) {
  * byte 4 = VS2 3-way valve for cylinder 2 : test=01, on=04 and off=03
  * byte 10 = PS1 Solar circuit pump for collector array 1: test=b0001(1), on=b0100(4) and off=b0011(3)
  */
-void Solar::process_SM100Status2(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_bitvalue(valveStatus_, 4, 2)); // on if bit 2 set
-    has_update(telegram->read_bitvalue(solarPump_, 10, 2));  // on if bit 2 set
+void Solar::process_SM100Status2(const Telegram & telegram) {
+    has_update(telegram.read_bitvalue(valveStatus_, 4, 2)); // on if bit 2 set
+    has_update(telegram.read_bitvalue(solarPump_, 10, 2));  // on if bit 2 set
 }
 
 /*
  * SM100CollectorConfig - type 0x0380 EMS+  - for SM100 and SM200
  * e.g. B0 0B FF 00 02 80 50 64 00 00 29 01 00 00 01
  */
-void Solar::process_SM100CollectorConfig(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(climateZone_, 0));
-    has_update(telegram->read_value(collector1Area_, 3));
-    has_update(telegram->read_enumvalue(collector1Type_, 5, 1));
+void Solar::process_SM100CollectorConfig(const Telegram & telegram) {
+    has_update(telegram.read_value(climateZone_, 0));
+    has_update(telegram.read_value(collector1Area_, 3));
+    has_update(telegram.read_enumvalue(collector1Type_, 5, 1));
 }
 
 /*
  * SM100Energy - type 0x038E EMS+ for energy readings
  * e.g. 30 00 FF 00 02 8E 00 00 00 00 00 00 06 C5 00 00 76 35
  */
-void Solar::process_SM100Energy(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(energyLastHour_, 0)); // last hour / 10 in Wh
-    has_update(telegram->read_value(energyToday_, 4));    // todays in Wh
-    has_update(telegram->read_value(energyTotal_, 8));    // total / 10 in kWh
+void Solar::process_SM100Energy(const Telegram & telegram) {
+    has_update(telegram.read_value(energyLastHour_, 0)); // last hour / 10 in Wh
+    has_update(telegram.read_value(energyToday_, 4));    // todays in Wh
+    has_update(telegram.read_value(energyTotal_, 8));    // total / 10 in kWh
 }
 
 /*
  * SM100Time - type 0x0391 EMS+ for pump working time
  */
-void Solar::process_SM100Time(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(pumpWorkTime_, 1, 3));
+void Solar::process_SM100Time(const Telegram & telegram) {
+    has_update(telegram.read_value(pumpWorkTime_, 1, 3));
 }
 
 /*
  * Junkers ISM1 Solar Module - type 0x0103 EMS+ for energy readings
  *  e.g. B0 00 FF 00 00 03 32 00 00 00 00 13 00 D6 00 00 00 FB D0 F0
  */
-void Solar::process_ISM1StatusMessage(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(collectorTemp_, 4));  // Collector Temperature
-    has_update(telegram->read_value(tankBottomTemp_, 6)); // Temperature Bottom of Solar Boiler tank
+void Solar::process_ISM1StatusMessage(const Telegram & telegram) {
+    has_update(telegram.read_value(collectorTemp_, 4));  // Collector Temperature
+    has_update(telegram.read_value(tankBottomTemp_, 6)); // Temperature Bottom of Solar Boiler tank
     uint16_t Wh = energyLastHour_ / 10;
-    has_update(telegram->read_value(Wh, 2)); // Solar Energy produced in last hour only ushort, is not * 10
-    energyLastHour_ = Wh * 10;               // set to *10
+    telegram.read_value(Wh, 2);           // Solar Energy produced in last hour only ushort, is not * 10
+    has_update(energyLastHour_, Wh * 10); // set to *10
 
-    has_update(telegram->read_bitvalue(solarPump_, 8, 0));         // PS1 Solar pump on (1) or off (0)
-    has_update(telegram->read_value(pumpWorkTime_, 10, 3));        // force to 3 bytes
-    has_update(telegram->read_bitvalue(collectorShutdown_, 9, 0)); // collector shutdown on/off
-    has_update(telegram->read_bitvalue(tankHeated_, 9, 2));        // tank full
+    has_update(telegram.read_bitvalue(solarPump_, 8, 0));         // PS1 Solar pump on (1) or off (0)
+    has_update(telegram.read_value(pumpWorkTime_, 10, 3));        // force to 3 bytes
+    has_update(telegram.read_bitvalue(collectorShutdown_, 9, 0)); // collector shutdown on/off
+    has_update(telegram.read_bitvalue(tankHeated_, 9, 2));        // tank full
 }
 
 /*
  * Junkers ISM1 Solar Module - type 0x0101 EMS+ for setting values
  */
-void Solar::process_ISM1Set(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(tankMaxTemp_, 6));
+void Solar::process_ISM1Set(const Telegram & telegram) {
+    has_update(telegram.read_value(tankMaxTemp_, 6));
 }
 
 /*
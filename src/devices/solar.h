@@ -95,28 +95,28 @@ class Solar : public EMSdevice {
     char    type_[20]; // Solar of WWC
     uint8_t id_;
 
-    void process_SM10Monitor(std::shared_ptr<const Telegram> telegram);
-    void process_SM10Config(std::shared_ptr<const Telegram> telegram);
-    void process_SM100SystemConfig(std::shared_ptr<const Telegram> telegram);
-    void process_SM100SolarCircuitConfig(std::shared_ptr<const Telegram> telegram);
-    void process_SM100ParamCfg(std::shared_ptr<const Telegram> telegram);
-    void process_SM100Monitor(std::shared_ptr<const Telegram> telegram);
-    void process_SM100Monitor2(std::shared_ptr<const Telegram> telegram);
-
-    void process_SM100Config(std::shared_ptr<const Telegram> telegram);
-
-    void process_SM100Status(std::shared_ptr<const Telegram> telegram);
-    void process_SM100Status2(std::shared_ptr<const Telegram> telegram);
-    void process_SM100CollectorConfig(std::shared_ptr<const Telegram> telegram);
-    void process_SM100Energy(std::shared_ptr<const Telegram> telegram);
-    void process_SM100Time(std::shared_ptr<const Telegram> telegram);
-
-    void process_SM100wwTemperature(std::shared_ptr<const Telegram> telegram);
-    void process_SM100wwStatus(std::shared_ptr<const Telegram> telegram);
-    void process_SM100wwCommand(std::shared_ptr<const Telegram> telegram);
-
-    void process_ISM1StatusMessage(std::shared_ptr<const Telegram> telegram);
-    void process_ISM1Set(std::shared_ptr<const Telegram> telegram);
+    void process_SM10Monitor(const Telegram & telegram);
+    void process_SM10Config(const Telegram & telegram);
+    void process_SM100SystemConfig(const Telegram & telegram);
+    void process_SM100SolarCircuitConfig(const Telegram & telegram);
+    void process_SM100ParamCfg(const Telegram & telegram);
+    void process_SM100Monitor(const Telegram & telegram);
+    void process_SM100Monitor2(const Telegram & telegram);
+
+    void process_SM100Config(const Telegram & telegram);
+
+    void process_SM100Status(const Telegram & telegram);
+    void process_SM100Status2(const Telegram & telegram);
+    void process_SM100CollectorConfig(const Telegram & telegram);
+    void process_SM100Energy(const Telegram & telegram);
+    void process_SM100Time(const Telegram & telegram);
+
+    void process_SM100wwTemperature(const Telegram & telegram);
+    void process_SM100wwStatus(const Telegram & telegram);
+    void process_SM100wwCommand(const Telegram & telegram);
+
+    void process_ISM1StatusMessage(const Telegram & telegram);
+    void process_ISM1Set(const Telegram & telegram);
 
 
     bool set_CollectorMaxTemp(const char * value, const int8_t id);
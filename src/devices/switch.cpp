@@ -76,22 +76,22 @@ bool Switch::publish_ha_device_config() {
 
 // message 0x9D switch on/off
 // Thermostat(0x10) -> Switch(0x11), ?(0x9D), data: 00
-void Switch::process_WM10SetMessage(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(activated_, 0));
+void Switch::process_WM10SetMessage(const Telegram & telegram) {
+    has_update(telegram.read_value(activated_, 0));
 }
 
 // message 0x9C holds flowtemp and unknown status value
 // Switch(0x11) -> All(0x00), ?(0x9C), data: 01 BA 00 01 00
-void Switch::process_WM10MonitorMessage(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(flowTempHc_, 0)); // is * 10
-    has_update(telegram->read_value(status_, 2));
-    // has_update(telegram->read_value(status2_, 3)); // unknown
+void Switch::process_WM10MonitorMessage(const Telegram & telegram) {
+    has_update(telegram.read_value(flowTempHc_, 0)); // is * 10
+    has_update(telegram.read_value(status_, 2));
+    // has_update(telegram.read_value(status2_, 3)); // unknown
 }
 
 // message 0x1E flow temperature, same as in 9C, published often, republished also by boiler UBAFast 0x18
 // Switch(0x11) -> Boiler(0x08), ?(0x1E), data: 01 BA
-void Switch::process_WM10TempMessage(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(flowTempHc_, 0)); // is * 10
+void Switch::process_WM10TempMessage(const Telegram & telegram) {
+    has_update(telegram.read_value(flowTempHc_, 0)); // is * 10
 }
 
 } // namespace emsesp
\ No newline at end of file
@@ -32,9 +32,9 @@ class Switch : public EMSdevice {
   private:
     static uuid::log::Logger logger_;
 
-    void process_WM10SetMessage(std::shared_ptr<const Telegram> telegram);
-    void process_WM10MonitorMessage(std::shared_ptr<const Telegram> telegram);
-    void process_WM10TempMessage(std::shared_ptr<const Telegram> telegram);
+    void process_WM10SetMessage(const Telegram & telegram);
+    void process_WM10MonitorMessage(const Telegram & telegram);
+    void process_WM10TempMessage(const Telegram & telegram);
 
     uint16_t flowTempHc_;
     uint8_t  status_;
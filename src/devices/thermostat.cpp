@@ -246,9 +246,10 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(const ui
 // determine which heating circuit the type ID is referring too
 // returns pointer to the HeatingCircuit or nullptr if it can't be found
 // if its a new one, the object will be created and also the fetch flags set
-std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::shared_ptr<const Telegram> telegram) {
+std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(const Telegram & telegram) {
     // only do this for the current master thermostat
     if (device_id() != EMSESP::actual_master_thermostat()) {
+        telegram_unused();
         return nullptr;
     }
 
@@ -257,7 +258,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     bool    toggle_ = false;
     // search monitor message types
     for (uint8_t i = 0; i < monitor_typeids.size(); i++) {
-        if (monitor_typeids[i] == telegram->type_id) {
+        if (monitor_typeids[i] == telegram.type_id) {
             hc_num  = i + 1;
             toggle_ = true;
             break;
@@ -267,7 +268,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     // not found, search status message/set types
     if (hc_num == 0) {
         for (uint8_t i = 0; i < set_typeids.size(); i++) {
-            if (set_typeids[i] == telegram->type_id) {
+            if (set_typeids[i] == telegram.type_id) {
                 hc_num = i + 1;
                 break;
             }
@@ -277,7 +278,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     // not found, search summer message types
     if (hc_num == 0) {
         for (uint8_t i = 0; i < summer_typeids.size(); i++) {
-            if (summer_typeids[i] == telegram->type_id) {
+            if (summer_typeids[i] == telegram.type_id) {
                 hc_num = i + 1;
                 break;
             }
@@ -287,7 +288,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     // not found, search summer message types
     if (hc_num == 0) {
         for (uint8_t i = 0; i < summer2_typeids.size(); i++) {
-            if (summer2_typeids[i] == telegram->type_id) {
+            if (summer2_typeids[i] == telegram.type_id) {
                 hc_num = i + 1;
                 break;
             }
@@ -297,7 +298,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     // not found, search heating_curve message types
     if (hc_num == 0) {
         for (uint8_t i = 0; i < curve_typeids.size(); i++) {
-            if (curve_typeids[i] == telegram->type_id) {
+            if (curve_typeids[i] == telegram.type_id) {
                 hc_num = i + 1;
                 break;
             }
@@ -307,7 +308,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     // not found, search timer message types
     if (hc_num == 0) {
         for (uint8_t i = 0; i < timer_typeids.size(); i++) {
-            if (timer_typeids[i] == telegram->type_id) {
+            if (timer_typeids[i] == telegram.type_id) {
                 hc_num = i + 1;
                 break;
             }
@@ -315,13 +316,14 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     }
 
     // not found, search device-id types for remote thermostats
-    if (telegram->src >= 0x18 && telegram->src <= 0x1B) {
-        hc_num  = telegram->src - 0x17;
+    if (telegram.src >= 0x18 && telegram.src <= 0x1B) {
+        hc_num  = telegram.src - 0x17;
         toggle_ = true;
     }
 
     // still didn't recognize it, ignore it
     if (hc_num == 0) {
+        telegram_unused();
         return nullptr;
     }
 
@@ -334,6 +336,7 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     }
     // register new heatingcircuits only on active monitor telegrams
     if (!toggle_) {
+        telegram_unused();
         return nullptr;
     }
 
@@ -357,6 +360,9 @@ std::shared_ptr<Thermostat::HeatingCircuit> Thermostat::heating_circuit(std::sha
     // register the device values
     register_device_values_hc(new_hc);
 
+    // the other telegrams of the new heating circuit were not used yet, process them again
+    EMSESP::rx_fingerprint_clear(device_id());
+
     // now create the HA topics to send to MQTT for each sensor
     if (Mqtt::ha_enabled()) {
         publish_ha_config_hc(new_hc);
@@ -654,36 +660,36 @@ std::string Thermostat::mode_tostring(uint8_t mode) {
 // type 0xB1 - data from the RC10 thermostat (0x17)
 // set day (curr temp: 16deg, set temp 19deg)
 // Data: 04 23 00 BA 00 00 00 BA
-void Thermostat::process_RC10Monitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC10Monitor(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
     uint8_t mode = 1 << hc->mode;
-    has_update(telegram->read_value(mode, 0));                     // 1: off, 2: night, 4: day
-    hc->mode = mode >> 1;                                          // for enum 0, 1, 2
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 1, 1)); // is * 2, force as single byte
-    has_update(telegram->read_value(hc->curr_roomTemp, 2));        // is * 10
-    has_update(telegram->read_value(hc->reduceminutes, 5));
-    hc->hamode = hc->mode == 2 ? 1 : 0; // set special HA mode
+    has_update(telegram.read_value(mode, 0));                     // 1: off, 2: night, 4: day
+    has_update(hc->mode, mode >> 1);                              // for enum 0, 1, 2
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 1, 1)); // is * 2, force as single byte
+    has_update(telegram.read_value(hc->curr_roomTemp, 2));        // is * 10
+    has_update(telegram.read_value(hc->reduceminutes, 5));
+    has_update(hc->hamode, hc->mode == 2 ? 1 : 0); // set special HA mode
 }
 
 // type 0xB0 - for reading the mode from the RC10 thermostat (0x17)
 // night (temp: 16deg, night temp 14deg, set return day 8h)
 // Data: 00 FF 00 1C 20 08 01
-void Thermostat::process_RC10Set(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC10Set(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
-    has_update(telegram->read_value(ibaClockOffset_, 0));
-    has_update(telegram->read_value(backlight_, 1));
-    has_update(telegram->read_value(wwMode_, 2));
-    has_update(telegram->read_value(hc->nighttemp, 3));
-    has_update(telegram->read_value(hc->daytemp, 4));
-    has_update(telegram->read_value(hc->reducehours, 5));
-    has_update(telegram->read_value(heatingpid_, 6));
+    has_update(telegram.read_value(ibaClockOffset_, 0));
+    has_update(telegram.read_value(backlight_, 1));
+    has_update(telegram.read_value(wwMode_, 2));
+    has_update(telegram.read_value(hc->nighttemp, 3));
+    has_update(telegram.read_value(hc->daytemp, 4));
+    has_update(telegram.read_value(hc->reducehours, 5));
+    has_update(telegram.read_value(heatingpid_, 6));
 }
 
 #pragma GCC diagnostic push
@@ -691,169 +697,169 @@ void Thermostat::process_RC10Set(std::shared_ptr<const Telegram> telegram) {
 
 // type 0xB2, mode setting Data: 04 00
 // not used, we read mode from monitor 0xB1
-void Thermostat::process_RC10Set_2(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC10Set_2(const Telegram & telegram) {
     // std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     // if (hc == nullptr) {
     //     return;
     // }
     // uint8_t mode = 1 << hc->mode;
-    // has_update(telegram->read_value(mode, 0));                     // 1: off, 2: night, 4: day
+    // has_update(telegram.read_value(mode, 0));                     // 1: off, 2: night, 4: day
     // hc->mode = mode >> 1;                                          // for enum 0, 1, 2
 }
 
 #pragma GCC diagnostic pop
 
 // 0xA8 - for reading the mode from the RC20 thermostat (0x17)
-void Thermostat::process_RC20Set(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC20Set(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
-    has_update(telegram->read_value(hc->mode, 23));
-    hc->hamode = hc->mode; // set special HA mode
+    has_update(telegram.read_value(hc->mode, 23));
+    has_update(hc->hamode, hc->mode); // set special HA mode
 }
 
 // type 0xAE - data from the RC20 thermostat (0x17) - not for RC20's
 // 17 00 AE 00 80 12 2E 00 D0 00 00 64 (#data=8)
 // https://github.com/emsesp/EMS-ESP/issues/361
-void Thermostat::process_RC20Monitor_2(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC20Monitor_2(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
-    // has_update(telegram->read_bitvalue(hc->modetype, 0, 7));       // day/night-mode MSB 7th bit is day
+    // has_update(telegram.read_bitvalue(hc->modetype, 0, 7));       // day/night-mode MSB 7th bit is day
     // modes byte 0,1: day: 8002, night: 0000, auto-day:0402, auto-night:0400
-    has_update(telegram->read_bitvalue(hc->modetype, 1, 1));       // day/night
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 2, 1)); // is * 2, force as single byte
-    has_update(telegram->read_value(hc->curr_roomTemp, 3));        // is * 10
+    has_update(telegram.read_bitvalue(hc->modetype, 1, 1));       // day/night
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 2, 1)); // is * 2, force as single byte
+    has_update(telegram.read_value(hc->curr_roomTemp, 3));        // is * 10
     // RC25 extension:
-    has_update(telegram->read_bitvalue(hc->summermode, 1, 0));
+    has_update(telegram.read_bitvalue(hc->summermode, 1, 0));
 }
 
 // 0xAD - for reading the mode from the RC20/ES72 thermostat (0x17)
 // see https://github.com/emsesp/EMS-ESP/issues/334#issuecomment-611698259
 // offset: 01-nighttemp, 02-daytemp, 03-mode, 0B-program(1-9), 0D-setpoint_roomtemp(temporary)
 // RC25(0x17) -> All(0x00), ?(0xAD), data: 01 27 2D 00 44 05 01 FF 28 19 0A 07 00 00 F6 12 5A 11 00 28 05 05 00
-void Thermostat::process_RC20Set_2(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC20Set_2(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
-    has_update(telegram->read_value(hc->nighttemp, 1)); // is * 2,
-    has_update(telegram->read_value(hc->daytemp, 2));   // is * 2,
-    has_update(telegram->read_value(hc->mode, 3));
-    hc->hamode = hc->mode;                                    // set special HA mode
-    has_update(telegram->read_enumvalue(hc->program, 11, 1)); // 1 .. 9 predefined programs
+    has_update(telegram.read_value(hc->nighttemp, 1)); // is * 2,
+    has_update(telegram.read_value(hc->daytemp, 2));   // is * 2,
+    has_update(telegram.read_value(hc->mode, 3));
+    has_update(hc->hamode, hc->mode);                        // set special HA mode
+    has_update(telegram.read_enumvalue(hc->program, 11, 1)); // 1 .. 9 predefined programs
     // RC25 extension:
-    has_update(telegram->read_value(ibaMinExtTemperature_, 14));
-    has_update(telegram->read_value(hc->minflowtemp, 15));
-    has_update(telegram->read_value(hc->maxflowtemp, 16));
-    has_update(telegram->read_value(hc->summertemp, 17));
+    has_update(telegram.read_value(ibaMinExtTemperature_, 14));
+    has_update(telegram.read_value(hc->minflowtemp, 15));
+    has_update(telegram.read_value(hc->maxflowtemp, 16));
+    has_update(telegram.read_value(hc->summertemp, 17));
 }
 
 // 0xAF - for reading the roomtemperature from the RC20/ES72 thermostat (0x18, 0x19, ..)
-void Thermostat::process_RC20Remote(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC20Remote(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
-    has_update(telegram->read_value(hc->curr_roomTemp, 0));
+    has_update(telegram.read_value(hc->curr_roomTemp, 0));
 }
 
 
 // type 0x0165, ff
-void Thermostat::process_JunkersSet(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_JunkersSet(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->daytemp, 17));        // is * 2
-    has_update(telegram->read_value(hc->nighttemp, 16));      // is * 2
-    has_update(telegram->read_value(hc->nofrosttemp, 15));    // is * 2
-    has_update(telegram->read_value(hc->control, 1));         // remote: 0-off, 1-FB10, 2-FB100
-    has_update(telegram->read_enumvalue(hc->program, 13, 1)); // 1-6: 1 = A, 2 = B,...
-    has_update(telegram->read_enumvalue(hc->mode, 14, 1));    // 0 = nofrost, 1 = eco, 2 = heat, 3 = auto
-    hc->hamode = hc->mode ? hc->mode - 1 : 0;                 // set special HA mode: off, on, auto
+    has_update(telegram.read_value(hc->daytemp, 17));        // is * 2
+    has_update(telegram.read_value(hc->nighttemp, 16));      // is * 2
+    has_update(telegram.read_value(hc->nofrosttemp, 15));    // is * 2
+    has_update(telegram.read_value(hc->control, 1));         // remote: 0-off, 1-FB10, 2-FB100
+    has_update(telegram.read_enumvalue(hc->program, 13, 1)); // 1-6: 1 = A, 2 = B,...
+    has_update(telegram.read_enumvalue(hc->mode, 14, 1));    // 0 = nofrost, 1 = eco, 2 = heat, 3 = auto
+    has_update(hc->hamode, hc->mode ? hc->mode - 1 : 0);     // set special HA mode: off, on, auto
 }
 
 // type 0x0179, ff
-void Thermostat::process_JunkersSet2(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_JunkersSet2(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->daytemp, 7));         // is * 2
-    has_update(telegram->read_value(hc->nighttemp, 6));       // is * 2
-    has_update(telegram->read_value(hc->nofrosttemp, 5));     // is * 2
-    has_update(telegram->read_enumvalue(hc->program, 10, 1)); // 1-6: 1 = A, 2 = B,...
-    has_update(telegram->read_enumvalue(hc->mode, 4, 1));     // 0 = nofrost, 1 = eco, 2 = heat, 3 = auto
-    hc->hamode = hc->mode ? hc->mode - 1 : 0;                 // set special HA mode: off, on, auto
+    has_update(telegram.read_value(hc->daytemp, 7));         // is * 2
+    has_update(telegram.read_value(hc->nighttemp, 6));       // is * 2
+    has_update(telegram.read_value(hc->nofrosttemp, 5));     // is * 2
+    has_update(telegram.read_enumvalue(hc->program, 10, 1)); // 1-6: 1 = A, 2 = B,...
+    has_update(telegram.read_enumvalue(hc->mode, 4, 1));     // 0 = nofrost, 1 = eco, 2 = heat, 3 = auto
+    has_update(hc->hamode, hc->mode ? hc->mode - 1 : 0);     // set special HA mode: off, on, auto
 }
 
 // type 0xA3 - for external temp settings from the the RC* thermostats (e.g. RC35)
-void Thermostat::process_RCOutdoorTemp(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(dampedoutdoortemp_, 0));
-    has_update(telegram->read_value(tempsensor1_, 3)); // sensor 1 - is * 10
-    has_update(telegram->read_value(tempsensor2_, 5)); // sensor 2 - is * 10
+void Thermostat::process_RCOutdoorTemp(const Telegram & telegram) {
+    has_update(telegram.read_value(dampedoutdoortemp_, 0));
+    has_update(telegram.read_value(tempsensor1_, 3)); // sensor 1 - is * 10
+    has_update(telegram.read_value(tempsensor2_, 5)); // sensor 2 - is * 10
 }
 
 // 0x91 - data from the RC20 thermostat (0x17) - 15 bytes long
-void Thermostat::process_RC20Monitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC20Monitor(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 1, 1)); // is * 2, force as single byte
-    has_update(telegram->read_value(hc->curr_roomTemp, 2));        // is * 10
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 1, 1)); // is * 2, force as single byte
+    has_update(telegram.read_value(hc->curr_roomTemp, 2));        // is * 10
 }
 
 // type 0x0A - data from the Nefit Easy/TC100 thermostat (0x18) - 31 bytes long
-void Thermostat::process_EasyMonitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_EasyMonitor(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->curr_roomTemp, 8));      // is * 100
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 10)); // is * 100
+    has_update(telegram.read_value(hc->curr_roomTemp, 8));      // is * 100
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 10)); // is * 100
 
-    hc->hamode = 1; // fixed to heat
+    has_update(hc->hamode, 1); // fixed to heat
 }
 
 // Settings Parameters - 0xA5 - RC30_1
-void Thermostat::process_IBASettings(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_IBASettings(const Telegram & telegram) {
     // 22 - display line on RC35
 
     // display on Thermostat: 0 int. temp, 1 int. setpoint, 2 ext. temp., 3 burner temp., 4 ww temp, 5 functioning mode, 6 time, 7 data, 8 smoke temp
-    has_update(telegram->read_value(ibaMainDisplay_, 0));
-    has_update(telegram->read_value(ibaLanguage_, 1));          // language on Thermostat: 0 german, 1 dutch, 2 french, 3 italian
-    has_update(telegram->read_value(ibaCalIntTemperature_, 2)); // offset int. temperature sensor, by * 0.1 Kelvin
-    has_update(telegram->read_value(ibaBuildingType_, 6));      // building type: 0 = light, 1 = medium, 2 = heavy
-    has_update(telegram->read_value(ibaMinExtTemperature_, 5)); // min ext temp for heating curve, in deg., 0xF6=-10, 0x0 = 0, 0xFF=-1
-    has_update(telegram->read_value(ibaClockOffset_, 12));      // offset (in sec) to clock, 0xff = -1 s, 0x02 = 2 s
-    has_update(telegram->read_value(ibaDamping_, 21));          // damping 0-off, 0xff-on
+    has_update(telegram.read_value(ibaMainDisplay_, 0));
+    has_update(telegram.read_value(ibaLanguage_, 1));          // language on Thermostat: 0 german, 1 dutch, 2 french, 3 italian
+    has_update(telegram.read_value(ibaCalIntTemperature_, 2)); // offset int. temperature sensor, by * 0.1 Kelvin
+    has_update(telegram.read_value(ibaBuildingType_, 6));      // building type: 0 = light, 1 = medium, 2 = heavy
+    has_update(telegram.read_value(ibaMinExtTemperature_, 5)); // min ext temp for heating curve, in deg., 0xF6=-10, 0x0 = 0, 0xFF=-1
+    has_update(telegram.read_value(ibaClockOffset_, 12));      // offset (in sec) to clock, 0xff = -1 s, 0x02 = 2 s
+    has_update(telegram.read_value(ibaDamping_, 21));          // damping 0-off, 0xff-on
 }
 
 // Settings WW 0x37 - RC35
-void Thermostat::process_RC35wwSettings(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwProgMode_, 0));     // 0-like hc, 0xFF own prog
-    has_update(telegram->read_value(wwCircProg_, 1));     // 0-like hc, 0xFF own prog
-    has_update(telegram->read_value(wwMode_, 2));         // 0 off, 1-on, 2-auto
-    has_update(telegram->read_value(wwCircMode_, 3));     // 0 off, 1-on, 2-auto
-    has_update(telegram->read_value(wwDisinfect_, 4));    // 0-off, 0xFF on
-    has_update(telegram->read_value(wwDisinfectDay_, 5)); // 0-6 Day of week, 7 every day
-    has_update(telegram->read_value(wwDisinfectHour_, 6));
-    has_update(telegram->read_value(wwMaxTemp_, 8));    // Limiter 60 degrees
-    has_update(telegram->read_value(wwOneTimeKey_, 9)); // 0-off, 0xFF on
+void Thermostat::process_RC35wwSettings(const Telegram & telegram) {
+    has_update(telegram.read_value(wwProgMode_, 0));     // 0-like hc, 0xFF own prog
+    has_update(telegram.read_value(wwCircProg_, 1));     // 0-like hc, 0xFF own prog
+    has_update(telegram.read_value(wwMode_, 2));         // 0 off, 1-on, 2-auto
+    has_update(telegram.read_value(wwCircMode_, 3));     // 0 off, 1-on, 2-auto
+    has_update(telegram.read_value(wwDisinfect_, 4));    // 0-off, 0xFF on
+    has_update(telegram.read_value(wwDisinfectDay_, 5)); // 0-6 Day of week, 7 every day
+    has_update(telegram.read_value(wwDisinfectHour_, 6));
+    has_update(telegram.read_value(wwMaxTemp_, 8));    // Limiter 60 degrees
+    has_update(telegram.read_value(wwOneTimeKey_, 9)); // 0-off, 0xFF on
 }
 
 // type 0x6F - FR10/FR50/FR100/FR110/FR120 Junkers
-void Thermostat::process_JunkersMonitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_JunkersMonitor(const Telegram & telegram) {
     // ignore single byte telegram messages
-    if (telegram->message_length <= 1) {
+    if (telegram.message_length <= 1) {
         return;
     }
 
@@ -862,41 +868,41 @@ void Thermostat::process_JunkersMonitor(std::shared_ptr<const Telegram> telegram
         return;
     }
 
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 2)); // value is * 10
-    has_update(telegram->read_enumvalue(hc->modetype, 0, 1));   // 1 = nofrost, 2 = eco, 3 = heat
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 2)); // value is * 10
+    has_update(telegram.read_enumvalue(hc->modetype, 0, 1));   // 1 = nofrost, 2 = eco, 3 = heat
 
     if ((hc->control == 1) || (hc->control == 2)) {
-        has_update(telegram->read_value(hc->curr_roomTemp, 6)); // roomTemp from remote
+        has_update(telegram.read_value(hc->curr_roomTemp, 6)); // roomTemp from remote
     } else {
-        has_update(telegram->read_value(hc->curr_roomTemp, 4)); // value is * 10
+        has_update(telegram.read_value(hc->curr_roomTemp, 4)); // value is * 10
     }
 }
 
 // type 0x02A5 - data from Worchester CRF200
-void Thermostat::process_CRFMonitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_CRFMonitor(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
-    has_update(telegram->read_value(hc->curr_roomTemp, 0)); // is * 10
-    has_update(telegram->read_bitvalue(hc->modetype, 2, 0));
-    has_update(telegram->read_bitvalue(hc->mode, 2, 4));           // bit 4, mode (auto=0 or off=1)
-    hc->hamode = 2 - 2 * hc->mode;                                 // set special HA mode
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 6, 1)); // is * 2, force as single byte
-    has_update(telegram->read_value(hc->targetflowtemp, 4));
+    has_update(telegram.read_value(hc->curr_roomTemp, 0)); // is * 10
+    has_update(telegram.read_bitvalue(hc->modetype, 2, 0));
+    has_update(telegram.read_bitvalue(hc->mode, 2, 4));           // bit 4, mode (auto=0 or off=1)
+    has_update(hc->hamode, 2 - 2 * hc->mode);                     // set special HA mode
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 6, 1)); // is * 2, force as single byte
+    has_update(telegram.read_value(hc->targetflowtemp, 4));
 }
 
 // type 0x02A5 - data from the Nefit RC1010/3000 thermostat (0x18) and RC300/310s on 0x10
-void Thermostat::process_RC300Monitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC300Monitor(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->curr_roomTemp, 0)); // is * 10
-    has_update(telegram->read_bitvalue(hc->modetype, 10, 1));
-    has_update(telegram->read_bitvalue(hc->mode, 10, 0)); // bit 1, mode (auto=1 or manual=0)
-    hc->hamode = hc->mode + 1;                            // set special HA mode
+    has_update(telegram.read_value(hc->curr_roomTemp, 0)); // is * 10
+    has_update(telegram.read_bitvalue(hc->modetype, 10, 1));
+    has_update(telegram.read_bitvalue(hc->mode, 10, 0)); // bit 1, mode (auto=1 or manual=0)
+    has_update(hc->hamode, hc->mode + 1);                // set special HA mode
 
     // if manual, take the current setpoint temp at pos 6
     // if auto, take the next setpoint temp at pos 7
@@ -905,14 +911,14 @@ void Thermostat::process_RC300Monitor(std::shared_ptr<const Telegram> telegram)
     // pos 3 actual setpoint (optimized), i.e. changes with temporary change, summer/holiday-modes
     // pos 6 actual setpoint according to programmed changes eco/comfort
     // pos 7 next setpoint in the future, time to next setpoint in pos 8/9
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 3, 1)); // is * 2, force as single byte
-    has_update(telegram->read_bitvalue(hc->summermode, 2, 4));
-    has_update(telegram->read_value(hc->targetflowtemp, 4));
-    has_update(telegram->read_value(hc->curroominfl, 27));
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 3, 1)); // is * 2, force as single byte
+    has_update(telegram.read_bitvalue(hc->summermode, 2, 4));
+    has_update(telegram.read_value(hc->targetflowtemp, 4));
+    has_update(telegram.read_value(hc->curroominfl, 27));
 }
 
 // type 0x02B9 EMS+ for reading from RC300/RC310 thermostat
-void Thermostat::process_RC300Set(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC300Set(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
@@ -924,156 +930,156 @@ void Thermostat::process_RC300Set(std::shared_ptr<const Telegram> telegram) {
     // eco is position 4
     // auto is position 8, temporary until next switch
     // actual setpoint taken from RC300Monitor (Michael 12.06.2020)
-    // has_update(telegram->read_value(hc->setpoint_roomTemp, 8, 1);  // single byte conversion, value is * 2 - auto?
-    // has_update(telegram->read_value(hc->setpoint_roomTemp, 10, 1); // single byte conversion, value is * 2 - manual
+    // has_update(telegram.read_value(hc->setpoint_roomTemp, 8, 1);  // single byte conversion, value is * 2 - auto?
+    // has_update(telegram.read_value(hc->setpoint_roomTemp, 10, 1); // single byte conversion, value is * 2 - manual
 
     // check why mode is both in the Monitor and Set for the RC300. It'll be read twice!
-    // has_update(telegram->read_value(hc->mode, 0); // Auto = xFF, Manual = x00 eg. 10 00 FF 08 01 B9 FF
-    has_update(telegram->read_value(hc->daytemp, 2));   // is * 2
-    has_update(telegram->read_value(hc->nighttemp, 4)); // is * 2
-    has_update(telegram->read_value(hc->tempautotemp, 8));
-    has_update(telegram->read_value(hc->manualtemp, 10));     // is * 2
-    has_update(telegram->read_enumvalue(hc->program, 11, 1)); // timer program 1 or 2
+    // has_update(telegram.read_value(hc->mode, 0); // Auto = xFF, Manual = x00 eg. 10 00 FF 08 01 B9 FF
+    has_update(telegram.read_value(hc->daytemp, 2));   // is * 2
+    has_update(telegram.read_value(hc->nighttemp, 4)); // is * 2
+    has_update(telegram.read_value(hc->tempautotemp, 8));
+    has_update(telegram.read_value(hc->manualtemp, 10));     // is * 2
+    has_update(telegram.read_enumvalue(hc->program, 11, 1)); // timer program 1 or 2
 }
 
 // types 0x2AF ff
-void Thermostat::process_RC300Summer(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC300Summer(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->roominfluence, 0));
-    has_update(telegram->read_value(hc->offsettemp, 2));
+    has_update(telegram.read_value(hc->roominfluence, 0));
+    has_update(telegram.read_value(hc->offsettemp, 2));
     // dont use these values if we have telegram 0x471 ff
     if (!is_fetch(summer2_typeids[hc->hc_num() - 1])) {
-        has_update(telegram->read_value(hc->summertemp, 6));
-        has_update(telegram->read_value(hc->summer_setmode, 7));
+        has_update(telegram.read_value(hc->summertemp, 6));
+        has_update(telegram.read_value(hc->summer_setmode, 7));
     }
 
     if (hc->heatingtype < 3) {
-        has_update(telegram->read_value(hc->designtemp, 4));
+        has_update(telegram.read_value(hc->designtemp, 4));
     } else {
-        has_update(telegram->read_value(hc->designtemp, 5));
+        has_update(telegram.read_value(hc->designtemp, 5));
     }
 
-    has_update(telegram->read_value(hc->minflowtemp, 8));
-    has_update(telegram->read_value(hc->fastHeatup, 10));
+    has_update(telegram.read_value(hc->minflowtemp, 8));
+    has_update(telegram.read_value(hc->fastHeatup, 10));
 }
 
 // types 0x471 ff
-void Thermostat::process_RC300Summer2(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC300Summer2(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
-    has_update(telegram->read_value(hc->summer_setmode, 0));
-    has_update(telegram->read_value(hc->summertemp, 1));
+    has_update(telegram.read_value(hc->summer_setmode, 0));
+    has_update(telegram.read_value(hc->summertemp, 1));
 }
 
 // types 0x29B ff
-void Thermostat::process_RC300Curve(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC300Curve(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->controlmode, 0)); // 1-outdoor, 2-simple, 3-MPC, 4-room, 5-power, 6-const
-    has_update(telegram->read_value(hc->heatingtype, 1)); // 1=radiator, 2=convector, 3=floor
-    has_update(telegram->read_value(hc->nofrosttemp, 6));
+    has_update(telegram.read_value(hc->controlmode, 0)); // 1-outdoor, 2-simple, 3-MPC, 4-room, 5-power, 6-const
+    has_update(telegram.read_value(hc->heatingtype, 1)); // 1=radiator, 2=convector, 3=floor
+    has_update(telegram.read_value(hc->nofrosttemp, 6));
 
     if (hc->heatingtype < 3) {
-        has_update(telegram->read_value(hc->maxflowtemp, 8));
+        has_update(telegram.read_value(hc->maxflowtemp, 8));
     } else {
-        has_update(telegram->read_value(hc->maxflowtemp, 7));
+        has_update(telegram.read_value(hc->maxflowtemp, 7));
     }
 }
 
 // types 0x31B (and 0x31C?)
-void Thermostat::process_RC300WWtemp(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(wwSetTemp_, 0));
-    has_update(telegram->read_value(wwSetTempLow_, 1));
+void Thermostat::process_RC300WWtemp(const Telegram & telegram) {
+    has_update(telegram.read_value(wwSetTemp_, 0));
+    has_update(telegram.read_value(wwSetTempLow_, 1));
 }
 
 // type 02F5
 // RC300WWmode(0x2F5), data: 01 FF 04 00 00 00 08 05 00 08 04 00 00 00 00 00 00 00 00 00 01
-void Thermostat::process_RC300WWmode(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC300WWmode(const Telegram & telegram) {
     // circulation pump see: https://github.com/Th3M3/buderus_ems-wiki/blob/master/Einstellungen%20der%20Bedieneinheit%20RC310.md
-    has_update(telegram->read_value(wwCircPump_, 1)); // FF=off, 0=on ?
+    has_update(telegram.read_value(wwCircPump_, 1)); // FF=off, 0=on ?
 
-    has_update(telegram->read_value(wwMode_, 2));            // 0=off, 1=low, 2=high, 3=auto, 4=own prog
-    has_update(telegram->read_value(wwCircMode_, 3));        // 0=off, 1=on, 2=auto, 4=own?
-    has_update(telegram->read_value(wwChargeDuration_, 10)); // value in steps of 15 min
-    has_update(telegram->read_value(wwCharge_, 11));
+    has_update(telegram.read_value(wwMode_, 2));            // 0=off, 1=low, 2=high, 3=auto, 4=own prog
+    has_update(telegram.read_value(wwCircMode_, 3));        // 0=off, 1=on, 2=auto, 4=own?
+    has_update(telegram.read_value(wwChargeDuration_, 10)); // value in steps of 15 min
+    has_update(telegram.read_value(wwCharge_, 11));
 
-    has_update(telegram->read_value(wwDisinfect_, 5));     // 0-off, 0xFF on
-    has_update(telegram->read_value(wwDisinfectHour_, 6)); // value in steps of 15 min
-    has_update(telegram->read_value(wwDisinfectDay_, 7));  // 0-6 Day of week, 7 every day
+    has_update(telegram.read_value(wwDisinfect_, 5));     // 0-off, 0xFF on
+    has_update(telegram.read_value(wwDisinfectHour_, 6)); // value in steps of 15 min
+    has_update(telegram.read_value(wwDisinfectDay_, 7));  // 0-6 Day of week, 7 every day
 }
 
 // types 0x31D and 0x31E
 // RC300WWmode2(0x31D), data: 00 00 09 07
-void Thermostat::process_RC300WWmode2(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC300WWmode2(const Telegram & telegram) {
     // 0x31D for WW system 1, 0x31E for WW system 2
     // pos 1 = holiday mode
     // pos 2 = current status of ww setpoint
     // pos 3 = current status of ww circulation pump
-    if (telegram->type_id == 0x031D) {
-        has_update(telegram->read_value(wwExtra1_, 0)); // 0=no, 1=yes
+    if (telegram.type_id == 0x031D) {
+        has_update(telegram.read_value(wwExtra1_, 0)); // 0=no, 1=yes
     } else {
-        has_update(telegram->read_value(wwExtra2_, 0)); // 0=no, 1=yes
+        has_update(telegram.read_value(wwExtra2_, 0)); // 0=no, 1=yes
     }
 }
 
 // 0x23A damped outdoor temp
-void Thermostat::process_RC300OutdoorTemp(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(dampedoutdoortemp2_, 0)); // is *10
+void Thermostat::process_RC300OutdoorTemp(const Telegram & telegram) {
+    has_update(telegram.read_value(dampedoutdoortemp2_, 0)); // is *10
 }
 
 // 0x240 RC300 parameter
-void Thermostat::process_RC300Settings(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_enumvalue(ibaBuildingType_, 9, 1)); // 1=light, 2=medium, 3=heavy
-    has_update(telegram->read_value(ibaMinExtTemperature_, 10));
+void Thermostat::process_RC300Settings(const Telegram & telegram) {
+    has_update(telegram.read_enumvalue(ibaBuildingType_, 9, 1)); // 1=light, 2=medium, 3=heavy
+    has_update(telegram.read_value(ibaMinExtTemperature_, 10));
 }
 
 // 0x267 RC300 floordrying
-void Thermostat::process_RC300Floordry(std::shared_ptr<const Telegram> telegram) {
-    has_update(telegram->read_value(floordrystatus_, 0));
-    has_update(telegram->read_value(floordrytemp_, 1));
+void Thermostat::process_RC300Floordry(const Telegram & telegram) {
+    has_update(telegram.read_value(floordrystatus_, 0));
+    has_update(telegram.read_value(floordrytemp_, 1));
 }
 
 // type 0x41 - data from the RC30 thermostat(0x10) - 14 bytes long
-void Thermostat::process_RC30Monitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC30Monitor(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 1, 1)); // is * 2, force as single byte
-    has_update(telegram->read_value(hc->curr_roomTemp, 2));
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 1, 1)); // is * 2, force as single byte
+    has_update(telegram.read_value(hc->curr_roomTemp, 2));
 }
 
 // type 0xA7 - for reading the mode from the RC30 thermostat (0x10)
-void Thermostat::process_RC30Set(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC30Set(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->mode, 23));
-    hc->hamode = hc->mode; // set special HA mode
+    has_update(telegram.read_value(hc->mode, 23));
+    has_update(hc->hamode, hc->mode); // set special HA mode
 }
 
 // type 0x3E (HC1), 0x48 (HC2), 0x52 (HC3), 0x5C (HC4) - data from the RC35 thermostat (0x10) - 16 bytes
-void Thermostat::process_RC35Monitor(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC35Monitor(const Telegram & telegram) {
     // exit if the 15th byte (second from last) is 0x00, which I think is calculated flow setpoint temperature
     // with weather controlled RC35s this value is >=5, otherwise can be zero and our setpoint temps will be incorrect
     // see https://github.com/emsesp/EMS-ESP/issues/373#issuecomment-627907301
-    if (telegram->offset > 0 || telegram->message_length < 15) {
+    if (telegram.offset > 0 || telegram.message_length < 15) {
         return;
     }
 
-    if (telegram->message_data[14] == 0x00) {
+    if (telegram.message_data[14] == 0x00) {
         return;
     }
 
@@ -1082,20 +1088,20 @@ void Thermostat::process_RC35Monitor(std::shared_ptr<const Telegram> telegram) {
         return;
     }
 
-    has_update(telegram->read_value(hc->setpoint_roomTemp, 2, 1)); // is * 2, force to single byte, is 0 in summermode
-    has_update(telegram->read_value(hc->curr_roomTemp, 3));        // is * 10 - or 0x7D00 if thermostat is mounted on boiler
+    has_update(telegram.read_value(hc->setpoint_roomTemp, 2, 1)); // is * 2, force to single byte, is 0 in summermode
+    has_update(telegram.read_value(hc->curr_roomTemp, 3));        // is * 10 - or 0x7D00 if thermostat is mounted on boiler
 
-    has_update(telegram->read_bitvalue(hc->modetype, 1, 1));
-    has_update(telegram->read_bitvalue(hc->summermode, 1, 0));
-    has_update(telegram->read_bitvalue(hc->holidaymode, 0, 5));
+    has_update(telegram.read_bitvalue(hc->modetype, 1, 1));
+    has_update(telegram.read_bitvalue(hc->summermode, 1, 0));
+    has_update(telegram.read_bitvalue(hc->holidaymode, 0, 5));
 
-    has_update(telegram->read_value(hc->targetflowtemp, 14));
+    has_update(telegram.read_value(hc->targetflowtemp, 14));
 }
 
 // type 0x3D (HC1), 0x47 (HC2), 0x51 (HC3), 0x5B (HC4) - Working Mode Heating - for reading the mode from the RC35 thermostat (0x10)
-void Thermostat::process_RC35Set(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC35Set(const Telegram & telegram) {
     // check to see we have a valid type. heating: 1 radiator, 2 convectors, 3 floors, 4 room supply
-    if (telegram->offset == 0 && telegram->message_data[0] == 0x00) {
+    if (telegram.offset == 0 && telegram.message_data[0] == 0x00) {
         return;
     }
 
@@ -1104,71 +1110,71 @@ void Thermostat::process_RC35Set(std::shared_ptr<const Telegram> telegram) {
         return;
     }
 
-    has_update(telegram->read_value(hc->heatingtype, 0));   // 0- off, 1-radiator, 2-convector, 3-floor
-    has_update(telegram->read_value(hc->nighttemp, 1));     // is * 2
-    has_update(telegram->read_value(hc->daytemp, 2));       // is * 2
-    has_update(telegram->read_value(hc->holidaytemp, 3));   // is * 2
-    has_update(telegram->read_value(hc->roominfluence, 4)); // is * 1
-    has_update(telegram->read_value(hc->offsettemp, 6));    // is * 2
-    has_update(telegram->read_value(hc->mode, 7));          // night, day, auto
-    hc->hamode = hc->mode;                                  // set special HA mode
-
-    has_update(telegram->read_value(hc->wwprio, 21));         // 0xFF for on
-    has_update(telegram->read_value(hc->summertemp, 22));     // is * 1
-    has_update(telegram->read_value(hc->nofrosttemp, 23));    // is * 1
-    has_update(telegram->read_value(hc->flowtempoffset, 24)); // is * 1, only in mixed circuits
-    has_update(telegram->read_value(hc->reducemode, 25));     // 0-nofrost, 1-reduce, 2-roomhold, 3-outdoorhold
-    has_update(telegram->read_value(hc->control, 26));        // 0-off, 1-RC20 (remote), 2-RC35
-    has_update(telegram->read_value(hc->controlmode, 33));    // 0-outdoortemp, 1-roomtemp
-    has_update(telegram->read_value(hc->tempautotemp, 37));
-    has_update(telegram->read_value(hc->noreducetemp, 38)); // outdoor temperature for no reduce
-    has_update(telegram->read_value(hc->minflowtemp, 16));
+    has_update(telegram.read_value(hc->heatingtype, 0));   // 0- off, 1-radiator, 2-convector, 3-floor
+    has_update(telegram.read_value(hc->nighttemp, 1));     // is * 2
+    has_update(telegram.read_value(hc->daytemp, 2));       // is * 2
+    has_update(telegram.read_value(hc->holidaytemp, 3));   // is * 2
+    has_update(telegram.read_value(hc->roominfluence, 4)); // is * 1
+    has_update(telegram.read_value(hc->offsettemp, 6));    // is * 2
+    has_update(telegram.read_value(hc->mode, 7));          // night, day, auto
+    has_update(hc->hamode, hc->mode);                      // set special HA mode
+
+    has_update(telegram.read_value(hc->wwprio, 21));         // 0xFF for on
+    has_update(telegram.read_value(hc->summertemp, 22));     // is * 1
+    has_update(telegram.read_value(hc->nofrosttemp, 23));    // is * 1
+    has_update(telegram.read_value(hc->flowtempoffset, 24)); // is * 1, only in mixed circuits
+    has_update(telegram.read_value(hc->reducemode, 25));     // 0-nofrost, 1-reduce, 2-roomhold, 3-outdoorhold
+    has_update(telegram.read_value(hc->control, 26));        // 0-off, 1-RC20 (remote), 2-RC35
+    has_update(telegram.read_value(hc->controlmode, 33));    // 0-outdoortemp, 1-roomtemp
+    has_update(telegram.read_value(hc->tempautotemp, 37));
+    has_update(telegram.read_value(hc->noreducetemp, 38)); // outdoor temperature for no reduce
+    has_update(telegram.read_value(hc->minflowtemp, 16));
     if (hc->heatingtype == 3) {
-        has_update(telegram->read_value(hc->designtemp, 36));  // is * 1
-        has_update(telegram->read_value(hc->maxflowtemp, 35)); // is * 1
+        has_update(telegram.read_value(hc->designtemp, 36));  // is * 1
+        has_update(telegram.read_value(hc->maxflowtemp, 35)); // is * 1
     } else {
-        has_update(telegram->read_value(hc->designtemp, 17));  // is * 1
-        has_update(telegram->read_value(hc->maxflowtemp, 15)); // is * 1
+        has_update(telegram.read_value(hc->designtemp, 17));  // is * 1
+        has_update(telegram.read_value(hc->maxflowtemp, 15)); // is * 1
     }
 }
 
 // type 0x3F (HC1), 0x49 (HC2), 0x53 (HC3), 0x5D (HC4) - timer setting
-void Thermostat::process_RC35Timer(std::shared_ptr<const Telegram> telegram) {
+void Thermostat::process_RC35Timer(const Telegram & telegram) {
     std::shared_ptr<Thermostat::HeatingCircuit> hc = heating_circuit(telegram);
     if (hc == nullptr) {
         return;
     }
 
-    has_update(telegram->read_value(hc->program, 84)); // 0 .. 10, 0-userprogram 1, 10-userprogram 2
-    has_update(telegram->read_value(hc->pause, 85));   // time in hours
-    has_update(telegram->read_value(hc->party, 86));   // time in hours
-    if (telegram->message_length + telegram->offset >= 92 && telegram->offset <= 87) {
+    has_update(telegram.read_value(hc->program, 84)); // 0 .. 10, 0-userprogram 1, 10-userprogram 2
+    has_update(telegram.read_value(hc->pause, 85));   // time in hours
+    has_update(telegram.read_value(hc->party, 86));   // time in hours
+    if (telegram.message_length + telegram.offset >= 92 && telegram.offset <= 87) {
         snprintf(hc->vacation,
                  sizeof(hc->vacation),
                  "%02d.%02d.%04d-%02d.%02d.%04d",
-                 telegram->message_data[87 - telegram->offset],
-                 telegram->message_data[88 - telegram->offset],
-                 telegram->message_data[89 - telegram->offset] + 2000,
-                 telegram->message_data[90 - telegram->offset],
-                 telegram->message_data[91 - telegram->offset],
-                 telegram->message_data[92 - telegram->offset] + 2000);
-    }
-    if (telegram->message_length + telegram->offset >= 98 && telegram->offset <= 93) {
+                 telegram.message_data[87 - telegram.offset],
+                 telegram.message_data[88 - telegram.offset],
+                 telegram.message_data[89 - telegram.offset] + 2000,
+                 telegram.message_data[90 - telegram.offset],
+                 telegram.message_data[91 - telegram.offset],
+                 telegram.message_data[92 - telegram.offset] + 2000);
+    }
+    if (telegram.message_length + telegram.offset >= 98 && telegram.offset <= 93) {
         snprintf(hc->holiday,
                  sizeof(hc->holiday),
                  "%02d.%02d.%04d-%02d.%02d.%04d",
-                 telegram->message_data[93 - telegram->offset],
-                 telegram->message_data[94 - telegram->offset],
-                 telegram->message_data[95 - telegram->offset] + 2000,
-                 telegram->message_data[96 - telegram->offset],
-                 telegram->message_data[97 - telegram->offset],
-                 telegram->message_data[98 - telegram->offset] + 2000);
+                 telegram.message_data[93 - telegram.offset],
+                 telegram.message_data[94 - telegram.offset],
+                 telegram.message_data[95 - telegram.offset] + 2000,
+                 telegram.message_data[96 - telegram.offset],
+                 telegram.message_data[97 - telegram.offset],
+                 telegram.message_data[98 - telegram.offset] + 2000);
     }
 }
 
 // process_RCTime - type 0x06 - date and time from a thermostat - 14 bytes long
-void Thermostat::process_RCTime(std::shared_ptr<const Telegram> telegram) {
-    if (telegram->offset > 0 || telegram->message_length < 5) {
+void Thermostat::process_RCTime(const Telegram & telegram) {
+    if (telegram.offset > 0 || telegram.message_length < 5) {
         return;
     }
 
@@ -1176,12 +1182,12 @@ void Thermostat::process_RCTime(std::shared_ptr<const Telegram> telegram) {
         return; // not supported
     }
 
-    if (telegram->message_length < 7) {
+    if (telegram.message_length < 7) {
         return;
     }
 
-    if (telegram->message_data[7] & 0x0C) { // date and time not valid
-        set_datetime("ntp", -1);            // set from NTP
+    if (telegram.message_data[7] & 0x0C) { // date and time not valid
+        set_datetime("ntp", -1);           // set from NTP
         return;
     }
 
@@ -1198,12 +1204,12 @@ void Thermostat::process_RCTime(std::shared_ptr<const Telegram> telegram) {
     snprintf(dateTime_,
              sizeof(dateTime_),
              "%s:%s:%s %s/%s/%s",
-             Helpers::smallitoa(buf1, telegram->message_data[2]),           // hour
-             Helpers::smallitoa(buf2, telegram->message_data[4]),           // minute
-             Helpers::smallitoa(buf3, telegram->message_data[5]),           // second
-             Helpers::smallitoa(buf4, telegram->message_data[3]),           // day
-             Helpers::smallitoa(buf5, telegram->message_data[1]),           // month
-             Helpers::itoa(buf6, (telegram->message_data[0] & 0x7F) + 2000) // year
+             Helpers::smallitoa(buf1, telegram.message_data[2]),           // hour
+             Helpers::smallitoa(buf2, telegram.message_data[4]),           // minute
+             Helpers::smallitoa(buf3, telegram.message_data[5]),           // second
+             Helpers::smallitoa(buf4, telegram.message_data[3]),           // day
+             Helpers::smallitoa(buf5, telegram.message_data[1]),           // month
+             Helpers::itoa(buf6, (telegram.message_data[0] & 0x7F) + 2000) // year
     );
 
     has_update((strcmp(timeold, dateTime_) != 0));
@@ -1212,39 +1218,39 @@ void Thermostat::process_RCTime(std::shared_ptr<const Telegram> telegram) {
 // process_RCError - type 0xA2 - error message - 14 bytes long
 // 10 00 A2 00 41 32 32 03 30 00 02 00 00 00 00 00 00 02 CRC
 //              A  2  2  816
-void Thermostat::process_RCError(std::shared_ptr<const Telegram> telegram) {
-    if (telegram->offset > 0 || telegram->message_length < 5) {
+void Thermostat::process_RCError(const Telegram & telegram) {
+    if (telegram.offset > 0 || telegram.message_length < 5) {
         return;
     }
 
     char buf[4];
-    buf[0] = telegram->message_data[0];
-    buf[1] = telegram->message_data[1];
-    buf[2] = telegram->message_data[2];
+    buf[0] = telegram.message_data[0];
+    buf[1] = telegram.message_data[1];
+    buf[2] = telegram.message_data[2];
     buf[3] = 0;
-    has_update(telegram->read_value(errorNumber_, 3));
+    has_update(telegram.read_value(errorNumber_, 3));
     snprintf(errorCode_, sizeof(errorCode_), "%s(%d)", buf, errorNumber_);
 }
 
 // 0x12 error log
-void Thermostat::process_RCErrorMessage(std::shared_ptr<const Telegram> telegram) {
-    if (telegram->offset > 0 || telegram->message_length < 12) {
+void Thermostat::process_RCErrorMessage(const Telegram & telegram) {
+    if (telegram.offset > 0 || telegram.message_length < 12) {
         return;
     }
 
     // data: displaycode(2), errornumber(2), year, month, hour, day, minute, duration(2), src-addr
-    if (telegram->message_data[4] & 0x80) { // valid date
+    if (telegram.message_data[4] & 0x80) { // valid date
         char     code[3];
         uint16_t codeNo = EMS_VALUE_USHORT_NOTSET;
-        code[0]         = telegram->message_data[0];
-        code[1]         = telegram->message_data[1];
+        code[0]         = telegram.message_data[0];
+        code[1]         = telegram.message_data[1];
         code[2]         = 0;
-        telegram->read_value(codeNo, 2);
-        uint16_t year  = (telegram->message_data[4] & 0x7F) + 2000;
-        uint8_t  month = telegram->message_data[5];
-        uint8_t  day   = telegram->message_data[7];
-        uint8_t  hour  = telegram->message_data[6];
-        uint8_t  min   = telegram->message_data[8];
+        telegram.read_value(codeNo, 2);
+        uint16_t year  = (telegram.message_data[4] & 0x7F) + 2000;
+        uint8_t  month = telegram.message_data[5];
+        uint8_t  day   = telegram.message_data[7];
+        uint8_t  hour  = telegram.message_data[6];
+        uint8_t  min   = telegram.message_data[8];
         snprintf(lastCode_, sizeof(lastCode_), "%s(%d) %02d.%02d.%d %02d:%02d", code, codeNo, day, month, year, hour, min);
     }
 }
@@ -1329,9 +1335,9 @@ bool Thermostat::set_remotetemp(const char * value, const int8_t id) {
     }
 
     if (f > 100 || f < 0) {
-        hc->remotetemp = EMS_VALUE_SHORT_NOTSET;
+        has_update(hc->remotetemp, EMS_VALUE_SHORT_NOTSET);
     } else {
-        hc->remotetemp = (int16_t)(f * 10);
+        has_update(hc->remotetemp, (int16_t)(f * 10));
     }
     Roomctrl::set_remotetemp(hc->hc_num() - 1, hc->remotetemp);
 
@@ -273,7 +273,7 @@ class Thermostat : public EMSdevice {
     static constexpr uint8_t EMS_TYPE_wwSettings  = 0x37; // ww settings
     static constexpr uint8_t EMS_TYPE_time        = 0x06; // time
 
-    std::shared_ptr<Thermostat::HeatingCircuit> heating_circuit(std::shared_ptr<const Telegram> telegram);
+    std::shared_ptr<Thermostat::HeatingCircuit> heating_circuit(const Telegram & telegram);
     std::shared_ptr<Thermostat::HeatingCircuit> heating_circuit(const uint8_t hc_num);
 
     void publish_ha_config_hc(std::shared_ptr<Thermostat::HeatingCircuit> hc);
@@ -281,41 +281,41 @@ class Thermostat : public EMSdevice {
 
     bool thermostat_ha_cmd(const char * message, uint8_t hc_num);
 
-    void process_RCOutdoorTemp(std::shared_ptr<const Telegram> telegram);
-    void process_IBASettings(std::shared_ptr<const Telegram> telegram);
-    void process_RCTime(std::shared_ptr<const Telegram> telegram);
-    void process_RCError(std::shared_ptr<const Telegram> telegram);
-    void process_RCErrorMessage(std::shared_ptr<const Telegram> telegram);
-    void process_RC35wwSettings(std::shared_ptr<const Telegram> telegram);
-    void process_RC35Monitor(std::shared_ptr<const Telegram> telegram);
-    void process_RC35Set(std::shared_ptr<const Telegram> telegram);
-    void process_RC35Timer(std::shared_ptr<const Telegram> telegram);
-    void process_RC30Monitor(std::shared_ptr<const Telegram> telegram);
-    void process_RC30Set(std::shared_ptr<const Telegram> telegram);
-    void process_RC20Monitor(std::shared_ptr<const Telegram> telegram);
-    void process_RC20Set(std::shared_ptr<const Telegram> telegram);
-    void process_RC20Remote(std::shared_ptr<const Telegram> telegram);
-    void process_RC20Monitor_2(std::shared_ptr<const Telegram> telegram);
-    void process_RC20Set_2(std::shared_ptr<const Telegram> telegram);
-    void process_RC10Monitor(std::shared_ptr<const Telegram> telegram);
-    void process_RC10Set(std::shared_ptr<const Telegram> telegram);
-    void process_RC10Set_2(std::shared_ptr<const Telegram> telegram);
-    void process_CRFMonitor(std::shared_ptr<const Telegram> telegram);
-    void process_RC300Monitor(std::shared_ptr<const Telegram> telegram);
-    void process_RC300Set(std::shared_ptr<const Telegram> telegram);
-    void process_RC300Summer(std::shared_ptr<const Telegram> telegram);
-    void process_RC300Summer2(std::shared_ptr<const Telegram> telegram);
-    void process_RC300WWmode(std::shared_ptr<const Telegram> telegram);
-    void process_RC300WWmode2(std::shared_ptr<const Telegram> telegram);
-    void process_RC300WWtemp(std::shared_ptr<const Telegram> telegram);
-    void process_RC300OutdoorTemp(std::shared_ptr<const Telegram> telegram);
-    void process_RC300Settings(std::shared_ptr<const Telegram> telegram);
-    void process_RC300Floordry(std::shared_ptr<const Telegram> telegram);
-    void process_RC300Curve(std::shared_ptr<const Telegram> telegram);
-    void process_JunkersMonitor(std::shared_ptr<const Telegram> telegram);
-    void process_JunkersSet(std::shared_ptr<const Telegram> telegram);
-    void process_JunkersSet2(std::shared_ptr<const Telegram> telegram);
-    void process_EasyMonitor(std::shared_ptr<const Telegram> telegram);
+    void process_RCOutdoorTemp(const Telegram & telegram);
+    void process_IBASettings(const Telegram & telegram);
+    void process_RCTime(const Telegram & telegram);
+    void process_RCError(const Telegram & telegram);
+    void process_RCErrorMessage(const Telegram & telegram);
+    void process_RC35wwSettings(const Telegram & telegram);
+    void process_RC35Monitor(const Telegram & telegram);
+    void process_RC35Set(const Telegram & telegram);
+    void process_RC35Timer(const Telegram & telegram);
+    void process_RC30Monitor(const Telegram & telegram);
+    void process_RC30Set(const Telegram & telegram);
+    void process_RC20Monitor(const Telegram & telegram);
+    void process_RC20Set(const Telegram & telegram);
+    void process_RC20Remote(const Telegram & telegram);
+    void process_RC20Monitor_2(const Telegram & telegram);
+    void process_RC20Set_2(const Telegram & telegram);
+    void process_RC10Monitor(const Telegram & telegram);
+    void process_RC10Set(const Telegram & telegram);
+    void process_RC10Set_2(const Telegram & telegram);
+    void process_CRFMonitor(const Telegram & telegram);
+    void process_RC300Monitor(const Telegram & telegram);
+    void process_RC300Set(const Telegram & telegram);
+    void process_RC300Summer(const Telegram & telegram);
+    void process_RC300Summer2(const Telegram & telegram);
+    void process_RC300WWmode(const Telegram & telegram);
+    void process_RC300WWmode2(const Telegram & telegram);
+    void process_RC300WWtemp(const Telegram & telegram);
+    void process_RC300OutdoorTemp(const Telegram & telegram);
+    void process_RC300Settings(const Telegram & telegram);
+    void process_RC300Floordry(const Telegram & telegram);
+    void process_RC300Curve(const Telegram & telegram);
+    void process_JunkersMonitor(const Telegram & telegram);
+    void process_JunkersSet(const Telegram & telegram);
+    void process_JunkersSet2(const Telegram & telegram);
+    void process_EasyMonitor(const Telegram & telegram);
 
     // internal helper functions
     bool set_mode_n(const uint8_t mode, const uint8_t hc_num);
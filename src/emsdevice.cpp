@@ -21,6 +21,8 @@
 
 namespace emsesp {
 
+EMSdevice * EMSdevice::handling_device_ = nullptr;
+
 // mapping of UOM, to match order in DeviceValueUOM enum emsdevice.h
 // must be an int of 4 bytes, 32bit aligned
 static const __FlashStringHelper * DeviceValueUOM_s[] __attribute__((__aligned__(sizeof(uint32_t)))) PROGMEM = {
@@ -120,10 +122,18 @@ const std::string EMSdevice::tag_to_string(uint8_t tag) {
     return read_flash_string(DeviceValueTAG_s[tag]);
 }
 
+const __FlashStringHelper * EMSdevice::tag_to_flash(uint8_t tag) {
+    return DeviceValueTAG_s[tag];
+}
+
 const std::string EMSdevice::tag_to_mqtt(uint8_t tag) {
     return read_flash_string(DeviceValueTAG_mqtt[tag]);
 }
 
+const __FlashStringHelper * EMSdevice::tag_to_mqtt_flash(uint8_t tag) {
+    return DeviceValueTAG_mqtt[tag];
+}
+
 const std::string EMSdevice::uom_to_string(uint8_t uom) {
     if (uom == DeviceValueUOM::NONE) {
         return std::string{};
@@ -131,6 +141,14 @@ const std::string EMSdevice::uom_to_string(uint8_t uom) {
     return read_flash_string(DeviceValueUOM_s[uom - 1]); // offset by 1 to account for NONE
 }
 
+// returns nullptr if there is no unit
+const __FlashStringHelper * EMSdevice::uom_to_flash(uint8_t uom) {
+    if (uom == DeviceValueUOM::NONE) {
+        return nullptr;
+    }
+    return DeviceValueUOM_s[uom - 1]; // offset by 1 to account for NONE
+}
+
 const std::vector<EMSdevice::DeviceValue> EMSdevice::devicevalues() const {
     return devicevalues_;
 }
@@ -168,58 +186,62 @@ const std::string EMSdevice::brand_to_string() const {
 }
 
 // returns the name of the MQTT topic to use for a specific device, without the base
-const std::string EMSdevice::device_type_2_device_name(const uint8_t device_type) {
+const __FlashStringHelper * EMSdevice::device_type_2_flash(const uint8_t device_type) {
     switch (device_type) {
     case DeviceType::SYSTEM:
-        return read_flash_string(F_(system));
+        return F_(system);
         break;
 
     case DeviceType::BOILER:
-        return read_flash_string(F_(boiler));
+        return F_(boiler);
         break;
 
     case DeviceType::THERMOSTAT:
-        return read_flash_string(F_(thermostat));
+        return F_(thermostat);
         break;
 
     case DeviceType::HEATPUMP:
-        return read_flash_string(F_(heatpump));
+        return F_(heatpump);
         break;
 
     case DeviceType::SOLAR:
-        return read_flash_string(F_(solar));
+        return F_(solar);
         break;
 
     case DeviceType::CONNECT:
-        return read_flash_string(F_(connect));
+        return F_(connect);
         break;
 
     case DeviceType::MIXER:
-        return read_flash_string(F_(mixer));
+        return F_(mixer);
         break;
 
     case DeviceType::DALLASSENSOR:
-        return read_flash_string(F_(dallassensor));
+        return F_(dallassensor);
         break;
 
     case DeviceType::CONTROLLER:
-        return read_flash_string(F_(controller));
+        return F_(controller);
         break;
 
     case DeviceType::SWITCH:
-        return read_flash_string(F_(switch));
+        return F_(switch);
         break;
 
     case DeviceType::GATEWAY:
-        return read_flash_string(F_(gateway));
+        return F_(gateway);
         break;
 
     default:
-        return read_flash_string(F_(unknown));
+        return F_(unknown);
         break;
     }
 }
 
+const std::string EMSdevice::device_type_2_device_name(const uint8_t device_type) {
+    return read_flash_string(device_type_2_flash(device_type));
+}
+
 // returns device_type from a string
 uint8_t EMSdevice::device_name_2_device_type(const char * topic) {
     if (!topic) {
@@ -343,13 +365,43 @@ const std::string EMSdevice::to_string_short() const {
 void EMSdevice::fetch_values() {
     EMSESP::logger().debug(F("Fetching values for device ID 0x%02X"), device_id());
 
-    for (const auto & tf : telegram_functions_) {
+    uint32_t now = uuid::get_uptime();
+    for (auto & tf : telegram_functions_) {
         if (tf.fetch_) {
+            tf.last_fetch_ = now;
             read_command(tf.telegram_type_id_);
         }
     }
 }
 
+// send a read request for the telegram type which is the most overdue
+// types received recently, also when broadcasted by the master, are not due yet
+// returns true if a read request was sent
+bool EMSdevice::fetch_next(const uint32_t now) {
+    TelegramFunction * next    = nullptr;
+    uint32_t           overdue = 0;
+
+    for (auto & tf : telegram_functions_) {
+        if (!tf.fetch_) {
+            continue;
+        }
+        uint32_t age      = now - tf.last_fetch_;
+        uint32_t interval = tf.fetch_interval_ * FETCH_FREQUENCY;
+        if ((age >= interval) && ((next == nullptr) || (age - interval > overdue))) {
+            next    = &tf;
+            overdue = age - interval;
+        }
+    }
+
+    if (next == nullptr) {
+        return false;
+    }
+
+    next->last_fetch_ = now;
+    read_command(next->telegram_type_id_);
+    return true;
+}
+
 // toggle on/off automatic fetch for a telegram id
 void EMSdevice::toggle_fetch(uint16_t telegram_id, bool toggle) {
     EMSESP::logger().debug(F("Toggling fetch for device ID 0x%02X, telegram ID 0x%02X to %d"), device_id(), telegram_id, toggle);
@@ -363,12 +415,8 @@ void EMSdevice::toggle_fetch(uint16_t telegram_id, bool toggle) {
 
 // get status of automatic fetch for a telegram id
 bool EMSdevice::is_fetch(uint16_t telegram_id) {
-    for (auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram_id) {
-            return tf.fetch_;
-        }
-    }
-    return false;
+    auto tf = find_telegram_function(telegram_id);
+    return tf ? tf->fetch_ : false;
 }
 
 // list of registered device entries, adding the HA entity if it exists
@@ -429,6 +477,14 @@ void EMSdevice::show_telegram_handlers(uuid::console::Shell & shell) {
         shell.printf(F("0x%02X "), tf.telegram_type_id_);
     }
     shell.println();
+
+    shell.printf(F(" and fetches type IDs (every n minutes): "));
+    for (const auto & tf : telegram_functions_) {
+        if (tf.fetch_) {
+            shell.printf(F("0x%02X (%d) "), tf.telegram_type_id_, tf.fetch_interval_);
+        }
+    }
+    shell.println();
 }
 
 // list all the telegram type IDs for this device, outputting to a string (max size 200)
@@ -461,9 +517,22 @@ void EMSdevice::show_mqtt_handlers(uuid::console::Shell & shell) {
 
 // register a callback function for a specific telegram type
 void EMSdevice::register_telegram_type(const uint16_t telegram_type_id, const __FlashStringHelper * telegram_type_name, bool fetch, const process_function_p f) {
+    // keep the index sorted by type_id. Duplicates are inserted after existing ones so the first registered wins
+    uint32_t key = ((uint32_t)telegram_type_id << 8) | telegram_functions_.size();
+    telegram_index_.insert(std::upper_bound(telegram_index_.begin(), telegram_index_.end(), key), key);
     telegram_functions_.emplace_back(telegram_type_id, telegram_type_name, fetch, f);
 }
 
+// binary search the index for the handler of a telegram type
+// returns nullptr if not registered
+const EMSdevice::TelegramFunction * EMSdevice::find_telegram_function(const uint16_t telegram_type_id) const {
+    auto it = std::lower_bound(telegram_index_.begin(), telegram_index_.end(), (uint32_t)telegram_type_id << 8);
+    if ((it == telegram_index_.end()) || ((*it >> 8) != telegram_type_id)) {
+        return nullptr;
+    }
+    return &telegram_functions_[*it & 0xFF];
+}
+
 // add to device value library, also know now as a "device entity"
 // arguments are:
 //  tag: to be used to group mqtt together, either as separate topics as a nested object
@@ -516,7 +585,34 @@ void EMSdevice::register_device_value(uint8_t                             tag,
     // if fullname is empty don't set the flag to visible (used for hamode and hatemp)
     uint8_t state = (full_name) ? DeviceValueState::DV_VISIBLE : DeviceValueState::DV_DEFAULT;
 
+    // keep the index sorted by value pointer, so a changed value can be found quickly
+    auto key = std::make_pair((const void *)value_p, (uint16_t)devicevalues_.size());
+    devicevalue_index_.insert(std::upper_bound(devicevalue_index_.begin(), devicevalue_index_.end(), key), key);
     devicevalues_.emplace_back(device_type_, tag, value_p, type, options, options_size, short_name, full_name, uom, 0, has_cmd, min, max, state);
+
+    // resolve the strings once here, so rendering the values doesn't need to read them again
+    auto & dv = devicevalues_.back();
+    if ((options_size == 1) && (type != DeviceValueType::BOOL) && (type != DeviceValueType::STRING) && (type != DeviceValueType::ENUM)) {
+        std::string s = read_flash_string(options[0]);
+        if (s[0] == '*') {
+            dv.factor = Helpers::atoint(&s[1]);
+        } else {
+            dv.divider = Helpers::atoint(s.c_str());
+        }
+    }
+    dv.tag_len        = read_flash_string(tag_to_flash(tag)).length();
+    dv.short_name_len = read_flash_string(short_name).length();
+    dv.full_name_len  = (full_name) ? read_flash_string(full_name).length() : 0;
+}
+
+// flags the device values pointing to value_p as changed, so they are picked up by the next MQTT publish
+// values read into local variables are not registered and ignored
+void EMSdevice::value_changed(const void * value_p) {
+    auto it = std::lower_bound(devicevalue_index_.begin(), devicevalue_index_.end(), std::make_pair(value_p, (uint16_t)0));
+    for (; (it != devicevalue_index_.end()) && (it->first == value_p); ++it) {
+        devicevalues_[it->second].add_state(DeviceValueState::DV_CHANGED);
+        values_changed_ = true;
+    }
 }
 
 // function with min and max values
@@ -615,9 +711,9 @@ const std::string EMSdevice::get_value_uom(const char * key) {
 // this is loosely based of the function generate_values_json used for the MQTT and Console
 // except additional data is stored in the JSON document needed for the Web UI like the UOM and command
 // v = value, u=uom, n=name, c=cmd
-void EMSdevice::generate_values_json_web(JsonObject & output) {
+void EMSdevice::generate_values_json_web(JsonWriter & output) {
     output["type"] = device_type_name();
-    JsonArray data = output.createNestedArray("data");
+    output.nested_array("data");
 
     for (const auto & dv : devicevalues_) {
         // check conditions:
@@ -626,108 +722,121 @@ void EMSdevice::generate_values_json_web(JsonObject & output) {
         //  3. it must have a valid value
 
         // ignore if full_name empty and also commands
-        if (dv.has_state(DeviceValueState::DV_VISIBLE) && (dv.type != DeviceValueType::CMD) && check_dv_hasvalue(dv)) {
-            JsonObject obj; // create the object, if needed
+        if (!dv.has_state(DeviceValueState::DV_VISIBLE) || (dv.type == DeviceValueType::CMD) || !check_dv_hasvalue(dv)) {
+            continue;
+        }
 
-            // handle Booleans (true, false)
-            if (dv.type == DeviceValueType::BOOL) {
-                obj      = data.createNestedObject();
-                obj["v"] = *(bool *)(dv.value_p) ? "on" : "off";
-            }
+        // only add an element if it has a value. Enums must be within the options
+        if ((dv.type == DeviceValueType::ENUM) ? (*(uint8_t *)(dv.value_p) >= dv.options_size)
+                                               : ((dv.type != DeviceValueType::BOOL) && (dv.type != DeviceValueType::STRING) && (dv.type != DeviceValueType::INT)
+                                                  && (dv.type != DeviceValueType::UINT) && (dv.type != DeviceValueType::SHORT)
+                                                  && (dv.type != DeviceValueType::USHORT) && (dv.type != DeviceValueType::ULONG)
+                                                  && (dv.type != DeviceValueType::TIME))) {
+            continue;
+        }
 
-            // handle TEXT strings
-            else if (dv.type == DeviceValueType::STRING) {
-                obj      = data.createNestedObject();
-                obj["v"] = (char *)(dv.value_p);
-            }
+        output.nested_object();
 
-            // handle ENUMs
-            else if ((dv.type == DeviceValueType::ENUM) && (*(uint8_t *)(dv.value_p) < dv.options_size)) {
-                obj      = data.createNestedObject();
-                obj["v"] = dv.options[*(uint8_t *)(dv.value_p)];
-            }
+        // handle Booleans (true, false)
+        if (dv.type == DeviceValueType::BOOL) {
+            output["v"] = *(bool *)(dv.value_p) ? "on" : "off";
+        }
 
-            // handle Integers and Floats
-            else {
-                // If a divider is specified, do the division to 2 decimals places and send back as double/float
-                // otherwise force as an integer whole
-                // the nested if's is necessary due to the way the ArduinoJson templates are pre-processed by the compiler
-                uint8_t divider = 0;
-                uint8_t factor  = 1;
-                if (dv.options_size == 1) {
-                    const char * s = read_flash_string(dv.options[0]).c_str();
-                    if (s[0] == '*') {
-                        factor = Helpers::atoint(&s[1]);
-                    } else {
-                        divider = Helpers::atoint(s);
-                    }
-                }
+        // handle TEXT strings
+        else if (dv.type == DeviceValueType::STRING) {
+            output["v"] = (const char *)(dv.value_p);
+        }
 
-                if (dv.type == DeviceValueType::INT) {
-                    obj      = data.createNestedObject();
-                    obj["v"] = (divider) ? Helpers::round2(*(int8_t *)(dv.value_p), divider) : *(int8_t *)(dv.value_p) * factor;
-                } else if (dv.type == DeviceValueType::UINT) {
-                    obj      = data.createNestedObject();
-                    obj["v"] = (divider) ? Helpers::round2(*(uint8_t *)(dv.value_p), divider) : *(uint8_t *)(dv.value_p) * factor;
-                } else if (dv.type == DeviceValueType::SHORT) {
-                    obj      = data.createNestedObject();
-                    obj["v"] = (divider) ? Helpers::round2(*(int16_t *)(dv.value_p), divider) : *(int16_t *)(dv.value_p) * factor;
-                } else if (dv.type == DeviceValueType::USHORT) {
-                    obj      = data.createNestedObject();
-                    obj["v"] = (divider) ? Helpers::round2(*(uint16_t *)(dv.value_p), divider) : *(uint16_t *)(dv.value_p) * factor;
-                } else if (dv.type == DeviceValueType::ULONG) {
-                    obj      = data.createNestedObject();
-                    obj["v"] = divider ? Helpers::round2(*(uint32_t *)(dv.value_p), divider) : *(uint32_t *)(dv.value_p) * factor;
-                } else if (dv.type == DeviceValueType::TIME) {
-                    uint32_t time_value = *(uint32_t *)(dv.value_p);
-                    obj                 = data.createNestedObject();
-                    obj["v"]            = (divider > 0) ? time_value / divider : time_value * factor; // sometimes we need to divide by 60
-                }
-            }
+        // handle ENUMs
+        else if (dv.type == DeviceValueType::ENUM) {
+            output["v"] = dv.options[*(uint8_t *)(dv.value_p)];
+        }
 
-            // check if we've added a data element then add the remaining elements
-            if (obj.containsKey("v")) {
-                obj["u"] = dv.uom; // add the unit of measure (uom)
+        // handle Integers and Floats
+        else {
+            // If a divider is specified, do the division to 2 decimals places and send back as double/float
+            // otherwise force as an integer whole
+            uint8_t divider = dv.divider;
+            uint8_t factor  = dv.factor;
 
-                // add name, prefixing the tag if it exists
-                if ((dv.tag == DeviceValueTAG::TAG_NONE) || tag_to_string(dv.tag).empty()) {
-                    obj["n"] = dv.full_name;
+            if (dv.type == DeviceValueType::INT) {
+                if (divider) {
+                    output["v"] = Helpers::round2(*(int8_t *)(dv.value_p), divider);
                 } else {
-                    char name[50];
-                    snprintf(name, sizeof(name), "%s %s", tag_to_string(dv.tag).c_str(), read_flash_string(dv.full_name).c_str());
-                    obj["n"] = name;
+                    output["v"] = *(int8_t *)(dv.value_p) * factor;
+                }
+            } else if (dv.type == DeviceValueType::UINT) {
+                if (divider) {
+                    output["v"] = Helpers::round2(*(uint8_t *)(dv.value_p), divider);
+                } else {
+                    output["v"] = *(uint8_t *)(dv.value_p) * factor;
+                }
+            } else if (dv.type == DeviceValueType::SHORT) {
+                if (divider) {
+                    output["v"] = Helpers::round2(*(int16_t *)(dv.value_p), divider);
+                } else {
+                    output["v"] = *(int16_t *)(dv.value_p) * factor;
+                }
+            } else if (dv.type == DeviceValueType::USHORT) {
+                if (divider) {
+                    output["v"] = Helpers::round2(*(uint16_t *)(dv.value_p), divider);
+                } else {
+                    output["v"] = *(uint16_t *)(dv.value_p) * factor;
+                }
+            } else if (dv.type == DeviceValueType::ULONG) {
+                if (divider) {
+                    output["v"] = Helpers::round2(*(uint32_t *)(dv.value_p), divider);
+                } else {
+                    output["v"] = *(uint32_t *)(dv.value_p) * factor;
                 }
+            } else if (dv.type == DeviceValueType::TIME) {
+                uint32_t time_value = *(uint32_t *)(dv.value_p);
+                output["v"]         = (divider > 0) ? time_value / divider : time_value * factor; // sometimes we need to divide by 60
+            }
+        }
 
-                // add commands and options
-                if (dv.has_cmd) {
-                    // add the name of the Command function
-                    if (dv.tag >= DeviceValueTAG::TAG_HC1) {
-                        obj["c"] = tag_to_string(dv.tag) + "/" + read_flash_string(dv.short_name);
-                    } else {
-                        obj["c"] = dv.short_name;
-                    }
-                    // add the Command options
-                    if (dv.type == DeviceValueType::ENUM) {
-                        JsonArray l = obj.createNestedArray("l");
-                        for (uint8_t i = 0; i < dv.options_size; i++) {
-                            if (!read_flash_string(dv.options[i]).empty()) {
-                                l.add(read_flash_string(dv.options[i]));
-                            }
-                        }
-                    }
-                    if (dv.type == DeviceValueType::BOOL) {
-                        JsonArray l = obj.createNestedArray("l");
-                        l.add("off");
-                        l.add("on");
+        output["u"] = dv.uom; // add the unit of measure (uom)
+
+        // add name, prefixing the tag if it exists
+        if (!dv.tag_len) {
+            output["n"] = dv.full_name;
+        } else {
+            char name[50];
+            value_json_name(name, sizeof(name), dv, true, OUTPUT_TARGET::API_VERBOSE);
+            output["n"] = (const char *)name;
+        }
+
+        // add commands and options
+        if (dv.has_cmd) {
+            // add the name of the Command function
+            if (dv.tag >= DeviceValueTAG::TAG_HC1) {
+                output["c"] = tag_to_string(dv.tag) + "/" + read_flash_string(dv.short_name);
+            } else {
+                output["c"] = dv.short_name;
+            }
+            // add the Command options
+            if (dv.type == DeviceValueType::ENUM) {
+                output.nested_array("l");
+                for (uint8_t i = 0; i < dv.options_size; i++) {
+                    if (pgm_read_byte(reinterpret_cast<const char *>(dv.options[i])) != 0) {
+                        output.add(dv.options[i]);
                     }
                 }
+                output.close();
+            }
+            if (dv.type == DeviceValueType::BOOL) {
+                output.nested_array("l");
+                output.add("off");
+                output.add("on");
+                output.close();
             }
         }
+
+        output.close();
     }
 
-#if defined(EMSESP_DEBUG)
-// serializeJson(data, Serial); // debug only
-#endif
+    output.close();
+    output.end();
 }
 
 // builds json with specific single device value information
@@ -750,16 +859,8 @@ bool EMSdevice::get_value_info(JsonObject & output, const char * cmd, const int8
     for (auto & dv : devicevalues_) {
         if (dv.has_state(DeviceValueState::DV_VISIBLE)
             && (strcmp(cmd, Helpers::toLower(read_flash_string(dv.short_name)).c_str()) == 0 && (tag <= 0 || tag == dv.tag))) {
-            uint8_t divider = 0;
-            uint8_t factor  = 1;
-            if (dv.options_size == 1) {
-                const char * s = read_flash_string(dv.options[0]).c_str();
-                if (s[0] == '*') {
-                    factor = Helpers::atoint(&s[1]);
-                } else {
-                    divider = Helpers::atoint(s);
-                }
-            }
+            uint8_t divider = dv.divider;
+            uint8_t factor  = dv.factor;
             const char * type  = "type";
             const char * min   = "min";
             const char * max   = "max";
@@ -935,156 +1036,259 @@ bool EMSdevice::generate_values_json(JsonObject & output, const uint8_t tag_filt
     JsonObject json       = output;
 
     for (auto & dv : devicevalues_) {
-        // check conditions:
-        //  1. it must have a valid value
-        //  2. it must be visible, unless our output destination is MQTT
-        //  3. it must match the given tag filter or have an empty tag
-
-        // check if it exists. We set the value activated once here
-        bool has_value = check_dv_hasvalue(dv);
-        if (has_value) {
-            dv.add_state(DeviceValueState::DV_ACTIVE);
-        } else {
-            dv.remove_state(DeviceValueState::DV_ACTIVE);
-        }
-
-        bool conditions = ((tag_filter == DeviceValueTAG::TAG_NONE) || (tag_filter == dv.tag)) && has_value;
-        if (output_target != OUTPUT_TARGET::MQTT) {
-            conditions &=
-                dv.has_state(DeviceValueState::DV_VISIBLE); // value must be visible if outputting to API (web or console). This is for ID, hamode, hatemp etc
-        }
-
-        if (conditions) {
+        if (value_in_output(dv, tag_filter, output_target)) {
             has_values = true; // we actually have data
 
             // we have a tag if it matches the filter given, and that the tag name is not empty/""
-            bool have_tag = ((dv.tag != tag_filter) && !tag_to_string(dv.tag).empty());
+            bool have_tag = ((dv.tag != tag_filter) && dv.tag_len);
 
             // create the name for the JSON key
             char name[80];
-            if (output_target == OUTPUT_TARGET::API_VERBOSE) {
-                if (have_tag) {
-                    snprintf(name, 80, "%s %s", tag_to_string(dv.tag).c_str(), read_flash_string(dv.full_name).c_str()); // prefix the tag
-                } else {
-                    strcpy(name, read_flash_string(dv.full_name).c_str()); // use full name
-                }
-            } else {
-                strcpy(name, read_flash_string(dv.short_name).c_str()); // use short name
+            value_json_name(name, sizeof(name), dv, have_tag, output_target);
 
-                // if we have a tag, and its different to the last one create a nested object. only for hc, wwc and hs
-                if (dv.tag != old_tag) {
-                    old_tag = dv.tag;
-                    if (nested && have_tag && dv.tag >= DeviceValueTAG::TAG_HC1) {
-                        json = output.createNestedObject(tag_to_string(dv.tag));
-                    }
+            // if we have a tag, and its different to the last one create a nested object. only for hc, wwc and hs
+            if ((output_target != OUTPUT_TARGET::API_VERBOSE) && (dv.tag != old_tag)) {
+                old_tag = dv.tag;
+                if (nested && have_tag && dv.tag >= DeviceValueTAG::TAG_HC1) {
+                    json = output.createNestedObject(tag_to_flash(dv.tag));
                 }
             }
 
-            // handle Booleans (true, false)
-            if (dv.type == DeviceValueType::BOOL) {
-                // see how to render the value depending on the setting
-                uint8_t bool_format = EMSESP::bool_format();
-                if (bool_format == BOOL_FORMAT_ONOFF) {
-                    json[name] = *(uint8_t *)(dv.value_p) ? F_(on) : F_(off);
-                } else if (bool_format == BOOL_FORMAT_ONOFF_CAP) {
-                    json[name] = *(uint8_t *)(dv.value_p) ? F_(ON) : F_(OFF);
-                } else if (bool_format == BOOL_FORMAT_TRUEFALSE) {
-                    json[name] = (bool)(*(uint8_t *)(dv.value_p)) ? true : false;
-                } else {
-                    json[name] = (uint8_t)(*(uint8_t *)(dv.value_p)) ? 1 : 0;
+            value_to_json(json, name, dv, output_target);
+        }
+    }
+
+    return has_values;
+}
+
+// same as above, but streams the values straight into the output buffer without building a json document
+// the caller must call output.end() to close the object
+bool EMSdevice::generate_values_json(JsonWriter & output, const uint8_t tag_filter, const bool nested, const uint8_t output_target) {
+    bool    has_values = false;
+    uint8_t old_tag    = 255; // NAN
+
+    for (auto & dv : devicevalues_) {
+        if (value_in_output(dv, tag_filter, output_target)) {
+            has_values = true;
+
+            bool have_tag = ((dv.tag != tag_filter) && dv.tag_len);
+
+            char name[80];
+            value_json_name(name, sizeof(name), dv, have_tag, output_target);
+
+            if ((output_target != OUTPUT_TARGET::API_VERBOSE) && (dv.tag != old_tag)) {
+                old_tag = dv.tag;
+                if (nested && have_tag && dv.tag >= DeviceValueTAG::TAG_HC1) {
+                    output.nested(tag_to_flash(dv.tag));
                 }
             }
 
-            // handle TEXT strings
-            else if (dv.type == DeviceValueType::STRING) {
-                json[name] = (char *)(dv.value_p);
+            value_to_json(output, name, dv, output_target);
+        }
+    }
+
+    return has_values;
+}
+
+// checks if the value should be part of the output and sets the active state
+bool EMSdevice::value_in_output(DeviceValue & dv, const uint8_t tag_filter, const uint8_t output_target) {
+    // check conditions:
+    //  1. it must have a valid value
+    //  2. it must be visible, unless our output destination is MQTT
+    //  3. it must match the given tag filter or have an empty tag
+
+    // check if it exists. We set the value activated once here
+    bool has_value = check_dv_hasvalue(dv);
+    if (has_value) {
+        dv.add_state(DeviceValueState::DV_ACTIVE);
+    } else {
+        dv.remove_state(DeviceValueState::DV_ACTIVE);
+    }
+
+    bool conditions = ((tag_filter == DeviceValueTAG::TAG_NONE) || (tag_filter == dv.tag)) && has_value;
+    if (output_target != OUTPUT_TARGET::MQTT) {
+        conditions &=
+            dv.has_state(DeviceValueState::DV_VISIBLE); // value must be visible if outputting to API (web or console). This is for ID, hamode, hatemp etc
+    }
+
+    return conditions;
+}
+
+// copies a flash string of known length, always null terminated. Returns the number of chars copied
+static size_t copy_flash_string(char * dest, const size_t size, const __FlashStringHelper * src, const size_t len) {
+    const char * p = reinterpret_cast<const char *>(src);
+    size_t       n = (len < size) ? len : size - 1;
+    for (size_t i = 0; i < n; i++) {
+        dest[i] = pgm_read_byte(p + i);
+    }
+    dest[n] = '\0';
+    return n;
+}
+
+// the json key is the full name for verbose output, prefixed with the tag, otherwise the short name
+// the lengths are known from registering the value, so the names are copied without creating strings
+void EMSdevice::value_json_name(char * name, const size_t len, const DeviceValue & dv, const bool have_tag, const uint8_t output_target) {
+    size_t pos = 0;
+    if (output_target == OUTPUT_TARGET::API_VERBOSE) {
+        if (have_tag) {
+            pos = copy_flash_string(name, len, tag_to_flash(dv.tag), dv.tag_len); // prefix the tag
+            if (pos < len - 1) {
+                name[pos++] = ' ';
             }
+        }
+        pos += copy_flash_string(&name[pos], len - pos, dv.full_name, dv.full_name_len); // use full name
+    } else {
+        copy_flash_string(name, len, dv.short_name, dv.short_name_len); // use short name
+    }
+}
 
-            // handle ENUMs
-            else if (dv.type == DeviceValueType::ENUM) {
-                if (*(uint8_t *)(dv.value_p) < dv.options_size) {
-                    // check for numeric enum-format, but "hamode" always as text
-                    if ((EMSESP::enum_format() == ENUM_FORMAT_NUMBER) && (dv.short_name != FL_(hamode)[0])) {
-                        json[name] = (uint8_t)(*(uint8_t *)(dv.value_p));
-                    } else {
-                        json[name] = dv.options[*(uint8_t *)(dv.value_p)];
-                    }
-                }
+// adds a single device value to the json, rendered for the output target
+// json can be a JsonObject or a JsonWriter
+template <typename Output>
+void EMSdevice::value_to_json(Output & json, char * name, const DeviceValue & dv, const uint8_t output_target) {
+    // handle Booleans (true, false)
+    if (dv.type == DeviceValueType::BOOL) {
+        // see how to render the value depending on the setting
+        uint8_t bool_format = EMSESP::bool_format();
+        if (bool_format == BOOL_FORMAT_ONOFF) {
+            json[name] = *(uint8_t *)(dv.value_p) ? F_(on) : F_(off);
+        } else if (bool_format == BOOL_FORMAT_ONOFF_CAP) {
+            json[name] = *(uint8_t *)(dv.value_p) ? F_(ON) : F_(OFF);
+        } else if (bool_format == BOOL_FORMAT_TRUEFALSE) {
+            json[name] = (bool)(*(uint8_t *)(dv.value_p)) ? true : false;
+        } else {
+            json[name] = (uint8_t)(*(uint8_t *)(dv.value_p)) ? 1 : 0;
+        }
+    }
+
+    // handle TEXT strings
+    else if (dv.type == DeviceValueType::STRING) {
+        json[name] = (char *)(dv.value_p);
+    }
+
+    // handle ENUMs
+    else if (dv.type == DeviceValueType::ENUM) {
+        if (*(uint8_t *)(dv.value_p) < dv.options_size) {
+            // check for numeric enum-format, but "hamode" always as text
+            if ((EMSESP::enum_format() == ENUM_FORMAT_NUMBER) && (dv.short_name != FL_(hamode)[0])) {
+                json[name] = (uint8_t)(*(uint8_t *)(dv.value_p));
+            } else {
+                json[name] = dv.options[*(uint8_t *)(dv.value_p)];
             }
+        }
+    }
 
-            // handle Integers and Floats
-            // If a divider is specified, do the division to 2 decimals places and send back as double/float
-            // otherwise force as a whole integer
-            // note: the strange nested if's is necessary due to the way the ArduinoJson templates are pre-processed by the compiler
-            else {
-                uint8_t divider = 0;
-                uint8_t factor  = 1;
-                if (dv.options_size == 1) {
-                    const char * s = read_flash_string(dv.options[0]).c_str();
-                    if (s[0] == '*') {
-                        factor = Helpers::atoint(&s[1]);
-                    } else {
-                        divider = Helpers::atoint(s);
-                    }
-                }
+    // handle Integers and Floats
+    // If a divider is specified, do the division to 2 decimals places and send back as double/float
+    // otherwise force as a whole integer
+    // note: the strange nested if's is necessary due to the way the ArduinoJson templates are pre-processed by the compiler
+    else {
+        uint8_t divider = dv.divider;
+        uint8_t factor  = dv.factor;
 
-                // always convert temperatures to floats with 1 decimal place
-                bool make_float = (divider || (dv.uom == DeviceValueUOM::DEGREES));
+        // always convert temperatures to floats with 1 decimal place
+        bool make_float = (divider || (dv.uom == DeviceValueUOM::DEGREES));
 
-                if (dv.type == DeviceValueType::INT) {
-                    if (make_float) {
-                        json[name] = Helpers::round2(*(int8_t *)(dv.value_p), divider);
-                    } else {
-                        json[name] = *(int8_t *)(dv.value_p) * factor;
-                    }
-                } else if (dv.type == DeviceValueType::UINT) {
-                    if (make_float) {
-                        json[name] = Helpers::round2(*(uint8_t *)(dv.value_p), divider);
-                    } else {
-                        json[name] = *(uint8_t *)(dv.value_p) * factor;
-                    }
-                } else if (dv.type == DeviceValueType::SHORT) {
-                    if (make_float) {
-                        json[name] = Helpers::round2(*(int16_t *)(dv.value_p), divider);
-                    } else {
-                        json[name] = *(int16_t *)(dv.value_p) * factor;
-                    }
-                } else if (dv.type == DeviceValueType::USHORT) {
-                    if (make_float) {
-                        json[name] = Helpers::round2(*(uint16_t *)(dv.value_p), divider);
-                    } else {
-                        json[name] = *(uint16_t *)(dv.value_p) * factor;
-                    }
-                } else if (dv.type == DeviceValueType::ULONG) {
-                    if (make_float) {
-                        json[name] = Helpers::round2(*(uint32_t *)(dv.value_p), divider);
-                    } else {
-                        json[name] = *(uint32_t *)(dv.value_p) * factor;
-                    }
-                } else if (dv.type == DeviceValueType::TIME) {
-                    uint32_t time_value = *(uint32_t *)(dv.value_p);
-                    time_value          = (divider) ? time_value / divider : time_value * factor; // sometimes we need to divide by 60
-                    if (output_target == EMSdevice::OUTPUT_TARGET::API_VERBOSE) {
-                        char time_s[40];
-                        snprintf(time_s,
-                                 sizeof(time_s),
-                                 "%d %s %d %s %d %s",
-                                 (time_value / 1440),
-                                 read_flash_string(F_(days)).c_str(),
-                                 ((time_value % 1440) / 60),
-                                 read_flash_string(F_(hours)).c_str(),
-                                 (time_value % 60),
-                                 read_flash_string(F_(minutes)).c_str());
-                        json[name] = time_s;
-                    } else {
-                        json[name] = time_value;
-                    }
-                }
+        if (dv.type == DeviceValueType::INT) {
+            if (make_float) {
+                json[name] = Helpers::round2(*(int8_t *)(dv.value_p), divider);
+            } else {
+                json[name] = *(int8_t *)(dv.value_p) * factor;
+            }
+        } else if (dv.type == DeviceValueType::UINT) {
+            if (make_float) {
+                json[name] = Helpers::round2(*(uint8_t *)(dv.value_p), divider);
+            } else {
+                json[name] = *(uint8_t *)(dv.value_p) * factor;
+            }
+        } else if (dv.type == DeviceValueType::SHORT) {
+            if (make_float) {
+                json[name] = Helpers::round2(*(int16_t *)(dv.value_p), divider);
+            } else {
+                json[name] = *(int16_t *)(dv.value_p) * factor;
+            }
+        } else if (dv.type == DeviceValueType::USHORT) {
+            if (make_float) {
+                json[name] = Helpers::round2(*(uint16_t *)(dv.value_p), divider);
+            } else {
+                json[name] = *(uint16_t *)(dv.value_p) * factor;
+            }
+        } else if (dv.type == DeviceValueType::ULONG) {
+            if (make_float) {
+                json[name] = Helpers::round2(*(uint32_t *)(dv.value_p), divider);
+            } else {
+                json[name] = *(uint32_t *)(dv.value_p) * factor;
+            }
+        } else if (dv.type == DeviceValueType::TIME) {
+            uint32_t time_value = *(uint32_t *)(dv.value_p);
+            time_value          = (divider) ? time_value / divider : time_value * factor; // sometimes we need to divide by 60
+            if (output_target == EMSdevice::OUTPUT_TARGET::API_VERBOSE) {
+                char time_s[40];
+                snprintf(time_s,
+                         sizeof(time_s),
+                         "%d %s %d %s %d %s",
+                         (time_value / 1440),
+                         read_flash_string(F_(days)).c_str(),
+                         ((time_value % 1440) / 60),
+                         read_flash_string(F_(hours)).c_str(),
+                         (time_value % 60),
+                         read_flash_string(F_(minutes)).c_str());
+                json[name] = time_s;
+            } else {
+                json[name] = time_value;
             }
         }
     }
+}
 
-    return has_values;
+// publish each value that changed since the last publish to its own topic, e.g. thermostat/hc1/seltemp
+// the payload is the plain value as a string, there is no json
+void EMSdevice::publish_changed_values() {
+    // update the states first, so HA has the config before the values arrive
+    for (auto & dv : devicevalues_) {
+        if (dv.has_state(DeviceValueState::DV_CHANGED)) {
+            if (check_dv_hasvalue(dv)) {
+                dv.add_state(DeviceValueState::DV_ACTIVE);
+            } else {
+                dv.remove_state(DeviceValueState::DV_ACTIVE);
+            }
+        }
+    }
+
+    if (Mqtt::ha_enabled()) {
+        publish_mqtt_ha_entity_config();
+    }
+
+    StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> doc;
+
+    char topic[Mqtt::MQTT_TOPIC_MAX_SIZE];
+    char payload[100];
+    char name[] = "v";
+
+    for (auto & dv : devicevalues_) {
+        if (!dv.has_state(DeviceValueState::DV_CHANGED)) {
+            continue;
+        }
+        dv.remove_state(DeviceValueState::DV_CHANGED);
+
+        if (!dv.has_state(DeviceValueState::DV_ACTIVE)) {
+            continue;
+        }
+
+        JsonObject json = doc.to<JsonObject>();
+        value_to_json(json, name, dv, OUTPUT_TARGET::MQTT);
+        JsonVariant v = json[name];
+        if (v.isNull()) {
+            continue; // e.g. an enum out of range
+        }
+        if (v.is<const char *>()) {
+            strlcpy(payload, v.as<const char *>(), sizeof(payload));
+        } else {
+            serializeJson(v, payload, sizeof(payload));
+        }
+
+        Mqtt::publish(Mqtt::single_topic(topic, sizeof(topic), device_type(), dv.tag, dv.short_name), payload);
+    }
 }
 
 // create the Home Assistant configs for each value
@@ -1135,18 +1339,28 @@ void EMSdevice::ha_config_clear() {
     ha_config_done(false);
 }
 
+// mark all config topics in HA as not sent, without removing them
+// the ones which are unchanged since the last restart are then skipped
+void EMSdevice::ha_config_reset() {
+    for (auto & dv : devicevalues_) {
+        dv.remove_state(DV_HA_CONFIG_CREATED);
+    }
+    ha_config_done(false);
+}
+
 // return the name of the telegram type
-const std::string EMSdevice::telegram_type_name(std::shared_ptr<const Telegram> telegram) {
+const std::string EMSdevice::telegram_type_name(const Telegram & telegram) {
     // see if it's one of the common ones, like Version
-    if (telegram->type_id == EMS_TYPE_VERSION) {
+    if (telegram.type_id == EMS_TYPE_VERSION) {
         return read_flash_string(F("Version"));
-    } else if (telegram->type_id == EMS_TYPE_UBADevices) {
+    } else if (telegram.type_id == EMS_TYPE_UBADevices) {
         return read_flash_string(F("UBADevices"));
     }
 
-    for (const auto & tf : telegram_functions_) {
-        if ((tf.telegram_type_id_ == telegram->type_id) && (telegram->type_id != 0xFF)) {
-            return read_flash_string(tf.telegram_type_name_);
+    if (telegram.type_id != 0xFF) {
+        auto tf = find_telegram_function(telegram.type_id);
+        if (tf) {
+            return read_flash_string(tf->telegram_type_name_);
         }
     }
 
@@ -1155,25 +1369,42 @@ const std::string EMSdevice::telegram_type_name(std::shared_ptr<const Telegram>
 
 // take a telegram_type_id and call the matching handler
 // return true if match found
-bool EMSdevice::handle_telegram(std::shared_ptr<const Telegram> telegram) {
-    for (const auto & tf : telegram_functions_) {
-        if (tf.telegram_type_id_ == telegram->type_id) {
-            // if the data block is empty, assume that this telegram is not recognized by the bus master
-            // so remove it from the automatic fetch list
-            if (telegram->message_length == 0 && telegram->offset == 0) {
-                EMSESP::logger().debug(F("This telegram (%s) is not recognized by the EMS bus"), read_flash_string(tf.telegram_type_name_).c_str());
-                toggle_fetch(tf.telegram_type_id_, false);
-                return false;
-            }
+// with unchanged the data is the same as last time, so the process function isn't called
+bool EMSdevice::handle_telegram(const Telegram & telegram, const bool unchanged) {
+    auto tf = find_telegram_function(telegram.type_id);
+    if (tf == nullptr) {
+        return false; // type not found
+    }
 
-            if (telegram->message_length > 0) {
-                tf.process_function_(telegram);
-            }
+    // if the data block is empty, assume that this telegram is not recognized by the bus master
+    // so remove it from the automatic fetch list
+    if (telegram.message_length == 0 && telegram.offset == 0) {
+        EMSESP::logger().debug(F("This telegram (%s) is not recognized by the EMS bus"), read_flash_string(tf->telegram_type_name_).c_str());
+        toggle_fetch(tf->telegram_type_id_, false);
+        return false;
+    }
 
-            return true;
+    if (telegram.message_length > 0) {
+        values_changed_ = false;
+        telegram_used_  = true;
+        if (!unchanged) {
+            handling_device_ = this; // so the read_* functions can flag which values changed
+            (this->*tf->process_function_)(telegram);
+            handling_device_ = nullptr;
+        }
+
+        // fetch types with changing values every minute, and back off for types that don't change
+        // a telegram can come in parts, only the first part makes the interval longer
+        if (values_changed_) {
+            tf->fetch_interval_ = 1;
+        } else if ((telegram.offset == 0) && (tf->fetch_interval_ < FETCH_INTERVAL_MAX)) {
+            tf->fetch_interval_ = std::min(tf->fetch_interval_ * 2, (int)FETCH_INTERVAL_MAX);
         }
     }
-    return false; // type not found
+
+    tf->last_fetch_ = uuid::get_uptime(); // we have fresh data, no need to fetch it
+
+    return true;
 }
 
 // send Tx write with a data block
@@ -1243,4 +1474,67 @@ bool EMSdevice::check_dv_hasvalue(const DeviceValue & dv) {
     return has_value;
 }
 
+#if defined(EMSESP_DEBUG)
+// benchmark helpers, see test/test.cpp
+// the handler lookup without the index, to compare against
+bool EMSdevice::has_telegram_type_linear(const uint16_t telegram_type_id) const {
+    for (const auto & tf : telegram_functions_) {
+        if (tf.telegram_type_id_ == telegram_type_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// resolves the json key, tag and divider of each value like generate_values_json does, returning a checksum
+// cached uses the fields set in register_device_value, otherwise the flash strings are read for every value like before
+uint32_t EMSdevice::resolve_values(const bool cached, const uint8_t output_target) {
+    uint32_t sum = 0;
+    char     name[80];
+
+    for (const auto & dv : devicevalues_) {
+        if (!dv.full_name) {
+            continue;
+        }
+
+        bool    numeric = (dv.type != DeviceValueType::BOOL) && (dv.type != DeviceValueType::STRING) && (dv.type != DeviceValueType::ENUM);
+        bool    have_tag;
+        uint8_t divider = 0;
+        uint8_t factor  = 1;
+
+        if (cached) {
+            have_tag = dv.tag_len;
+            value_json_name(name, sizeof(name), dv, have_tag, output_target);
+            if (numeric) {
+                divider = dv.divider;
+                factor  = dv.factor;
+            }
+        } else {
+            have_tag = !tag_to_string(dv.tag).empty();
+            if (output_target == OUTPUT_TARGET::API_VERBOSE) {
+                if (have_tag) {
+                    snprintf(name, sizeof(name), "%s %s", tag_to_string(dv.tag).c_str(), read_flash_string(dv.full_name).c_str());
+                } else {
+                    strlcpy(name, read_flash_string(dv.full_name).c_str(), sizeof(name));
+                }
+            } else {
+                strlcpy(name, read_flash_string(dv.short_name).c_str(), sizeof(name));
+            }
+            if (numeric && (dv.options_size == 1)) {
+                std::string s = read_flash_string(dv.options[0]);
+                if (s[0] == '*') {
+                    factor = Helpers::atoint(&s[1]);
+                } else {
+                    divider = Helpers::atoint(s.c_str());
+                }
+            }
+        }
+
+        sum += strlen(name) + name[0] + divider + factor + have_tag;
+    }
+
+    return sum;
+}
+#endif
+
 } // namespace emsesp
@@ -27,6 +27,7 @@
 #include "telegram.h"
 #include "mqtt.h"
 #include "helpers.h"
+#include "jsonwriter.h"
 
 namespace emsesp {
 
@@ -125,7 +126,8 @@ enum DeviceValueState : uint8_t {
     DV_DEFAULT           = 0,        // 0 - does not yet have a value
     DV_ACTIVE            = (1 << 0), // 1 - has a value
     DV_VISIBLE           = (1 << 1), // 2 - shown on web and console
-    DV_HA_CONFIG_CREATED = (1 << 2)  // 4 - set if the HA config has been created
+    DV_HA_CONFIG_CREATED = (1 << 2), // 4 - set if the HA config has been created
+    DV_CHANGED           = (1 << 3)  // 8 - value has changed since it was last published to MQTT
 
 };
 
@@ -157,6 +159,12 @@ class EMSdevice {
     static const std::string tag_to_string(uint8_t tag);
     static const std::string tag_to_mqtt(uint8_t tag);
 
+    // same as above, without copying the flash string
+    static const __FlashStringHelper * device_type_2_flash(const uint8_t device_type);
+    static const __FlashStringHelper * uom_to_flash(uint8_t uom);
+    static const __FlashStringHelper * tag_to_flash(uint8_t tag);
+    static const __FlashStringHelper * tag_to_mqtt_flash(uint8_t tag);
+
     inline uint8_t device_id() const {
         return device_id_;
     }
@@ -231,6 +239,43 @@ class EMSdevice {
         has_update_ |= has_update;
     }
 
+    // for values that are not read directly with a Telegram::read_* function
+    inline void has_update(void * value_p) {
+        has_update_ = true;
+        value_changed(value_p);
+    }
+
+    template <typename Value, typename NewValue>
+    inline void has_update(Value & value, const NewValue new_value) {
+        if (value != (Value)new_value) {
+            value = new_value;
+            has_update(&value);
+        }
+    }
+
+    inline void has_update(char * value, const char * new_value, size_t len) {
+        if (strcmp(value, new_value) != 0) {
+            strlcpy(value, new_value, len);
+            has_update(value);
+        }
+    }
+
+    void value_changed(const void * value_p);
+
+    // called by a telegram handler that couldn't use the data yet, e.g. a thermostat without the heating circuit
+    // the broadcast is then processed again when it's repeated with the same data
+    void telegram_unused() {
+        telegram_used_ = false;
+    }
+    bool telegram_used() const {
+        return telegram_used_;
+    }
+
+    // the device whose telegram handler is running, used by Telegram::read_* to flag changed values
+    static EMSdevice * handling_device() {
+        return handling_device_;
+    }
+
     const std::string brand_to_string() const;
     static uint8_t    decode_brand(uint8_t value);
 
@@ -242,17 +287,33 @@ class EMSdevice {
     void   show_mqtt_handlers(uuid::console::Shell & shell);
     void   list_device_entries(JsonObject & output);
 
-    using process_function_p = std::function<void(std::shared_ptr<const Telegram>)>;
+    using process_function_p = void (EMSdevice::*)(const Telegram &); // member function of the device class, see MAKE_PF_CB
 
     void register_telegram_type(const uint16_t telegram_type_id, const __FlashStringHelper * telegram_type_name, bool fetch, const process_function_p cb);
-    bool handle_telegram(std::shared_ptr<const Telegram> telegram);
+    bool handle_telegram(const Telegram & telegram, const bool unchanged = false);
+    bool has_telegram_type(const uint16_t telegram_type_id) const {
+        return find_telegram_function(telegram_type_id) != nullptr;
+    }
+
+#if defined(EMSESP_DEBUG)
+    // for the benchmarks, defined in test/test.cpp
+    bool     has_telegram_type_linear(const uint16_t telegram_type_id) const; // without the index
+    uint32_t resolve_values(const bool cached, const uint8_t output_target);  // resolves names and dividers
+#endif
 
     const std::string get_value_uom(const char * key);
     bool              get_value_info(JsonObject & root, const char * cmd, const int8_t id);
 
+    // the values are written by the telegram handlers in the main loop, so they must only be read from there
+    // the web and API requests get there through the command queue
     enum OUTPUT_TARGET : uint8_t { API_VERBOSE, API_SHORTNAMES, MQTT };
     bool generate_values_json(JsonObject & output, const uint8_t tag_filter, const bool nested, const uint8_t output_target);
-    void generate_values_json_web(JsonObject & output);
+    bool generate_values_json(JsonWriter & output, const uint8_t tag_filter, const bool nested, const uint8_t output_target);
+    size_t values_json_size() const {
+        return devicevalues_.size() * 16; // rough estimate of the payload, to reserve the buffer
+    }
+    void generate_values_json_web(JsonWriter & output);
+    void publish_changed_values();
 
     void register_device_value(uint8_t                             tag,
                                void *                              value_p,
@@ -295,12 +356,16 @@ class EMSdevice {
 
     void publish_mqtt_ha_entity_config();
 
-    const std::string telegram_type_name(std::shared_ptr<const Telegram> telegram);
+    const std::string telegram_type_name(const Telegram & telegram);
 
     void fetch_values();
+    bool fetch_next(const uint32_t now);
     void toggle_fetch(uint16_t telegram_id, bool toggle);
     bool is_fetch(uint16_t telegram_id);
 
+    static constexpr uint32_t FETCH_FREQUENCY    = 60000; // shortest time between two fetches of a telegram type
+    static constexpr uint8_t  FETCH_INTERVAL_MAX = 16;    // longest time between two fetches, in FETCH_FREQUENCY units
+
     bool ha_config_done() const {
         return ha_config_done_;
     }
@@ -310,6 +375,7 @@ class EMSdevice {
     }
 
     void ha_config_clear();
+    void ha_config_reset();
 
     enum Brand : uint8_t {
         NO_BRAND = 0, // 0
@@ -388,6 +454,7 @@ class EMSdevice {
 
     void reserve_telgram_functions(uint8_t elements) {
         telegram_functions_.reserve(elements);
+        telegram_index_.reserve(elements);
     }
 
   private:
@@ -402,17 +469,25 @@ class EMSdevice {
 
     bool ha_config_done_ = false;
     bool has_update_     = false;
+    bool values_changed_ = false; // a registered value changed while handling the current telegram
+    bool telegram_used_  = true;  // the handler of the current telegram used its data
+
+    static EMSdevice * handling_device_;
 
     struct TelegramFunction {
         uint16_t                    telegram_type_id_;   // it's type_id
         const __FlashStringHelper * telegram_type_name_; // e.g. RC20Message
         bool                        fetch_;              // if this type_id be queried automatically
+        uint8_t                     fetch_interval_;     // time between fetches in FETCH_FREQUENCY units, learned from how often the values change
+        uint32_t                    last_fetch_;         // uptime of the last read request or received telegram
         process_function_p          process_function_;
 
         TelegramFunction(uint16_t telegram_type_id, const __FlashStringHelper * telegram_type_name, bool fetch, const process_function_p process_function)
             : telegram_type_id_(telegram_type_id)
             , telegram_type_name_(telegram_type_name)
             , fetch_(fetch)
+            , fetch_interval_(1)
+            , last_fetch_(0)
             , process_function_(process_function) {
         }
     };
@@ -432,7 +507,12 @@ class EMSdevice {
         bool                                has_cmd;      // true if there is a Console/MQTT command which matches the short_name
         int32_t                             min;
         uint32_t                            max;
-        uint8_t                             state; // DeviceValueState::*
+        uint8_t                             state;          // DeviceValueState::*
+        uint8_t                             divider;        // resolved from the options, e.g. "10", 0 if none
+        uint8_t                             factor;         // resolved from the options, e.g. "*10", 1 if none
+        uint8_t                             tag_len;        // length of the tag name, 0 if the tag has no name
+        uint8_t                             short_name_len; // length of short_name
+        uint8_t                             full_name_len;  // length of full_name, 0 if not set
 
         DeviceValue(uint8_t                             device_type,
                     uint8_t                             tag,
@@ -461,7 +541,12 @@ class EMSdevice {
             , has_cmd(has_cmd)
             , min(min)
             , max(max)
-            , state(state) {
+            , state(state)
+            , divider(0)
+            , factor(1)
+            , tag_len(0)
+            , short_name_len(0)
+            , full_name_len(0) {
         }
 
         // state flags
@@ -481,7 +566,21 @@ class EMSdevice {
     const std::vector<DeviceValue> devicevalues() const;
 
     std::vector<TelegramFunction> telegram_functions_; // each EMS device has its own set of registered telegram types
-    std::vector<DeviceValue>      devicevalues_;
+    std::vector<uint32_t>         telegram_index_;     // sorted (type_id << 8 | position in telegram_functions_), for fast lookups
+
+    const TelegramFunction * find_telegram_function(const uint16_t telegram_type_id) const;
+    TelegramFunction *       find_telegram_function(const uint16_t telegram_type_id) {
+        return const_cast<TelegramFunction *>(static_cast<const EMSdevice *>(this)->find_telegram_function(telegram_type_id));
+    }
+
+    std::vector<DeviceValue>                       devicevalues_;
+    std::vector<std::pair<const void *, uint16_t>> devicevalue_index_; // sorted (value_p, position in devicevalues_), to find changed values
+
+    bool value_in_output(DeviceValue & dv, const uint8_t tag_filter, const uint8_t output_target);
+    void value_json_name(char * name, const size_t len, const DeviceValue & dv, const bool have_tag, const uint8_t output_target);
+
+    template <typename Output>
+    void value_to_json(Output & json, char * name, const DeviceValue & dv, const uint8_t output_target);
 
     const std::string device_entity_ha(DeviceValue const & dv);
 
@@ -489,6 +588,7 @@ class EMSdevice {
 
     void init_devicevalues(uint8_t size) {
         devicevalues_.reserve(size);
+        devicevalue_index_.reserve(size);
     }
 };
 
@@ -47,6 +47,7 @@ using DeviceType  = EMSdevice::DeviceType;
 
 std::vector<std::unique_ptr<EMSdevice>> EMSESP::emsdevices;      // array of all the detected EMS devices
 std::vector<EMSESP::Device_record>      EMSESP::device_library_; // library of all our known EMS devices, in heap
+uint8_t                                 EMSESP::device_index_[0x80]; // lookup of device_id to emsdevices
 
 uuid::log::Logger EMSESP::logger_{F_(emsesp), uuid::log::Facility::KERN};
 uuid::log::Logger EMSESP::logger() {
@@ -61,6 +62,7 @@ System       EMSESP::system_;       // core system services
 Console      EMSESP::console_;      // telnet and serial console
 DallasSensor EMSESP::dallassensor_; // Dallas sensors
 Shower       EMSESP::shower_;       // Shower logic
+CommandQueue EMSESP::commandqueue_; // commands from the web and MQTT
 
 // static/common variables
 uint8_t  EMSESP::actual_master_thermostat_ = EMSESP_DEFAULT_MASTER_THERMOSTAT; // which thermostat leads when multiple found
@@ -71,6 +73,7 @@ bool     EMSESP::read_next_                = false;
 uint16_t EMSESP::publish_id_               = 0;
 bool     EMSESP::tap_water_active_         = false; // for when Boiler states we having running warm water. used in Shower()
 uint32_t EMSESP::last_fetch_               = 0;
+uint8_t  EMSESP::fetch_device_idx_         = 0;
 uint8_t  EMSESP::publish_all_idx_          = 0;
 uint8_t  EMSESP::unique_id_count_          = 0;
 bool     EMSESP::trace_raw_                = false;
@@ -79,6 +82,14 @@ uint8_t  EMSESP::enum_format_              = 1;
 uint16_t EMSESP::wait_validate_            = 0;
 bool     EMSESP::wait_km_                  = true;
 
+std::vector<EMSESP::Pretty_prefix> EMSESP::pretty_cache_;
+uint8_t                            EMSESP::pretty_cache_next_   = 0;
+uint8_t                            EMSESP::pretty_cache_bus_id_ = 0;
+
+std::vector<EMSESP::Rx_fingerprint> EMSESP::rx_fingerprints_;
+uint8_t                             EMSESP::rx_fingerprint_next_ = 0;
+uint32_t                            EMSESP::rx_skip_count_       = 0;
+
 // for a specific EMS device go and request data values
 // or if device_id is 0 it will fetch from all our known and active devices
 void EMSESP::fetch_device_values(const uint8_t device_id) {
@@ -94,6 +105,23 @@ void EMSESP::fetch_device_values(const uint8_t device_id) {
     }
 }
 
+// send the next due read request, taking turns between the devices
+// a new read is only added when the previous one has been sent, so the reads are spread over the polls of the bus master
+// instead of filling the Tx queue every minute
+void EMSESP::fetch_next_value() {
+    if (emsdevices.empty() || txservice_.lane_size(TxService::Lane::FETCH)) {
+        return;
+    }
+
+    uint32_t now = uuid::get_uptime();
+    for (uint8_t i = 0; i < emsdevices.size(); i++) {
+        fetch_device_idx_ = (fetch_device_idx_ + 1) % emsdevices.size();
+        if (emsdevices[fetch_device_idx_] && emsdevices[fetch_device_idx_]->fetch_next(now)) {
+            return;
+        }
+    }
+}
+
 // see if the device ID exists
 bool EMSESP::valid_device(const uint8_t device_id) {
     for (const auto & emsdevice : emsdevices) {
@@ -173,6 +201,11 @@ uint8_t EMSESP::check_master_device(const uint8_t device_id, const uint16_t type
 }
 
 void EMSESP::actual_master_thermostat(const uint8_t device_id) {
+    if (device_id != actual_master_thermostat_) {
+        // the thermostats only process their broadcasts while they are the master
+        rx_fingerprint_clear(actual_master_thermostat_);
+        rx_fingerprint_clear(device_id);
+    }
     actual_master_thermostat_ = device_id;
 }
 
@@ -268,7 +301,10 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
         shell.printfln(F("  #telegrams received: %d"), rxservice_.telegram_count());
         shell.printfln(F("  #read requests sent: %d"), txservice_.telegram_read_count());
         shell.printfln(F("  #write requests sent: %d"), txservice_.telegram_write_count());
+        shell.printfln(F("  #tx requests merged: %d"), txservice_.telegram_merge_count());
         shell.printfln(F("  #incomplete telegrams: %d"), rxservice_.telegram_error_count());
+        shell.printfln(F("  #rx queue overflows: %d (max depth %d of %d)"), rxservice_.telegram_overflow_count(), rxservice_.queue_high_water(), MAX_RX_TELEGRAMS);
+        shell.printfln(F("  #unchanged telegrams skipped: %d"), rx_skip_count_);
         shell.printfln(F("  #tx fails (after %d retries): %d"), TxService::MAXIMUM_TX_RETRIES, txservice_.telegram_fail_count());
         shell.printfln(F("  Rx line quality: %d%%"), rxservice_.quality());
         shell.printfln(F("  Tx line quality: %d%%"), txservice_.quality());
@@ -282,7 +318,7 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
     } else {
         shell.printfln(F("Rx Queue (%ld telegram%s):"), rx_telegrams.size(), rx_telegrams.size() == 1 ? "" : "s");
         for (const auto & it : rx_telegrams) {
-            shell.printfln(F(" [%02d] %s"), it.id_, pretty_telegram(it.telegram_).c_str());
+            shell.printfln(F(" [%02d] %s"), it.id_, pretty_telegram(*it.telegram_).c_str());
         }
     }
 
@@ -304,10 +340,24 @@ void EMSESP::show_ems(uuid::console::Shell & shell) {
             } else if ((it.telegram_->operation) == Telegram::Operation::TX_WRITE) {
                 op = read_flash_string(F("WRITE"));
             }
-            shell.printfln(F(" [%02d%c] %s %s"), it.id_, ((it.retry_) ? '*' : ' '), op.c_str(), pretty_telegram(it.telegram_).c_str());
+            shell.printfln(F(" [%02d%c] %-8s %s %s"),
+                           it.id_,
+                           ((it.retry_) ? '*' : ' '),
+                           read_flash_string(TxService::lane_name(it.lane_)).c_str(),
+                           op.c_str(),
+                           pretty_telegram(*it.telegram_).c_str());
         }
     }
 
+    shell.println();
+    shell.printfln(F("Tx lanes:"));
+    for (uint8_t lane = 0; lane < TxService::TX_LANES; lane++) {
+        shell.printfln(F("  %-8s queued: %d, dropped: %d"),
+                       read_flash_string(TxService::lane_name(lane)).c_str(),
+                       txservice_.lane_size(lane),
+                       txservice_.lane_drop_count(lane));
+    }
+
     shell.println();
 }
 
@@ -445,38 +495,51 @@ void EMSESP::publish_all_loop() {
 }
 
 // force HA to re-create all the devices
-void EMSESP::reset_mqtt_ha() {
+// without remove the configs are only sent again if they have changed, e.g. after a reconnect
+void EMSESP::reset_mqtt_ha(bool remove) {
     if (!Mqtt::ha_enabled()) {
         return;
     }
 
+    if (remove) {
+        Mqtt::clear_ha_hashes();
+    }
+
     for (const auto & emsdevice : emsdevices) {
-        emsdevice->ha_config_clear();
+        if (remove) {
+            emsdevice->ha_config_clear();
+        } else {
+            emsdevice->ha_config_reset();
+        }
     }
     dallassensor_.reload();
 }
 
-// create json doc for the devices values and add to MQTT publish queue
-// generate_values_json is called to build the device value (dv) object array
+// create json payload for the devices values and add to MQTT publish queue
+// generate_values_json is called to stream the device values (dv) straight into the payload buffer
+// which is then moved into the queue, so there is no json document and no copy of the payload
 void EMSESP::publish_device_values(uint8_t device_type) {
-    DynamicJsonDocument doc(EMSESP_JSON_SIZE_XLARGE_DYN); // use max size
-    JsonObject          json         = doc.to<JsonObject>();
-    bool                need_publish = false;
+    std::string payload;
+    JsonWriter  json(payload, Mqtt::payload_format());
+    bool        need_publish = false;
 
     bool nested = (Mqtt::nested_format() == 1); // 1 is nested, 2 is single
 
     // group by device type
     for (const auto & emsdevice : emsdevices) {
         if (emsdevice && (emsdevice->device_type() == device_type)) {
+            json.reserve(emsdevice->values_json_size());
+
             // if its a boiler, generate json for each group and publish it directly. not nested
             if (device_type == DeviceType::BOILER) {
-                if (emsdevice->generate_values_json(json, DeviceValueTAG::TAG_BOILER_DATA, false, EMSdevice::OUTPUT_TARGET::MQTT)) {
-                    Mqtt::publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_BOILER_DATA), json);
+                if (emsdevice->generate_values_json(json, DeviceValueTAG::TAG_BOILER_DATA, false, EMSdevice::OUTPUT_TARGET::MQTT) && json.end()) {
+                    Mqtt::publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_BOILER_DATA), std::move(payload));
                 }
-                doc.clear();
-                if (emsdevice->generate_values_json(json, DeviceValueTAG::TAG_DEVICE_DATA_WW, false, EMSdevice::OUTPUT_TARGET::MQTT)) {
-                    Mqtt::publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_DEVICE_DATA_WW), json);
+                json.clear();
+                if (emsdevice->generate_values_json(json, DeviceValueTAG::TAG_DEVICE_DATA_WW, false, EMSdevice::OUTPUT_TARGET::MQTT) && json.end()) {
+                    Mqtt::publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_DEVICE_DATA_WW), std::move(payload));
                 }
+                json.clear();
                 need_publish = false;
             }
 
@@ -487,16 +550,17 @@ void EMSESP::publish_device_values(uint8_t device_type) {
                     if (nested) {
                         need_publish |= emsdevice->generate_values_json(json, DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT); // nested
                     } else {
-                        if (emsdevice->generate_values_json(json, DeviceValueTAG::TAG_THERMOSTAT_DATA, false, EMSdevice::OUTPUT_TARGET::MQTT)) { // not nested
-                            Mqtt::publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_NONE), json);
+                        if (emsdevice->generate_values_json(json, DeviceValueTAG::TAG_THERMOSTAT_DATA, false, EMSdevice::OUTPUT_TARGET::MQTT)
+                            && json.end()) { // not nested
+                            Mqtt::publish(Mqtt::tag_to_topic(device_type, DeviceValueTAG::TAG_NONE), std::move(payload));
                         }
-                        doc.clear();
+                        json.clear();
 
                         for (uint8_t hc_tag = TAG_HC1; hc_tag <= DeviceValueTAG::TAG_HC4; hc_tag++) {
-                            if (emsdevice->generate_values_json(json, hc_tag, false, EMSdevice::OUTPUT_TARGET::MQTT)) { // not nested
-                                Mqtt::publish(Mqtt::tag_to_topic(device_type, hc_tag), json);
+                            if (emsdevice->generate_values_json(json, hc_tag, false, EMSdevice::OUTPUT_TARGET::MQTT) && json.end()) { // not nested
+                                Mqtt::publish(Mqtt::tag_to_topic(device_type, hc_tag), std::move(payload));
                             }
-                            doc.clear();
+                            json.clear();
                         }
                         need_publish = false;
                     }
@@ -509,10 +573,10 @@ void EMSESP::publish_device_values(uint8_t device_type) {
                     need_publish |= emsdevice->generate_values_json(json, DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT); // nested
                 } else {
                     for (uint8_t hc_tag = TAG_HC1; hc_tag <= DeviceValueTAG::TAG_WWC4; hc_tag++) {
-                        if (emsdevice->generate_values_json(json, hc_tag, false, EMSdevice::OUTPUT_TARGET::MQTT)) { // not nested
-                            Mqtt::publish(Mqtt::tag_to_topic(device_type, hc_tag), json);
+                        if (emsdevice->generate_values_json(json, hc_tag, false, EMSdevice::OUTPUT_TARGET::MQTT) && json.end()) { // not nested
+                            Mqtt::publish(Mqtt::tag_to_topic(device_type, hc_tag), std::move(payload));
                         }
-                        doc.clear();
+                        json.clear();
                     }
                     need_publish = false;
                 }
@@ -533,10 +597,21 @@ void EMSESP::publish_device_values(uint8_t device_type) {
     if (need_publish) {
         char topic[Mqtt::MQTT_TOPIC_MAX_SIZE];
         snprintf(topic, sizeof(topic), "%s_data", EMSdevice::device_type_2_device_name(device_type).c_str());
-        Mqtt::publish(topic, json);
+        if (json.end()) {
+            Mqtt::publish(topic, std::move(payload));
+        }
     }
 }
 
+// MQTT publish the values that changed to their own topics, for a single device
+void EMSESP::publish_changed_values(EMSdevice * emsdevice) {
+    // only publish the single master thermostat
+    if ((emsdevice->device_type() == DeviceType::THERMOSTAT) && (emsdevice->device_id() != actual_master_thermostat())) {
+        return;
+    }
+    emsdevice->publish_changed_values();
+}
+
 // call the devices that don't need special attention
 void EMSESP::publish_other_values() {
     publish_device_values(EMSdevice::DeviceType::SWITCH);
@@ -554,21 +629,21 @@ void EMSESP::publish_sensor_values(const bool time, const bool force) {
 }
 
 // MQTT publish a telegram as raw data to the topic 'response'
-void EMSESP::publish_response(std::shared_ptr<const Telegram> telegram) {
+void EMSESP::publish_response(const Telegram & telegram) {
     StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> doc;
 
     char buffer[100];
-    doc["src"]    = Helpers::hextoa(buffer, telegram->src);
-    doc["dest"]   = Helpers::hextoa(buffer, telegram->dest);
-    doc["type"]   = Helpers::hextoa(buffer, telegram->type_id);
-    doc["offset"] = Helpers::hextoa(buffer, telegram->offset);
-    strcpy(buffer, Helpers::data_to_hex(telegram->message_data, telegram->message_length).c_str()); // telegram is without crc
+    doc["src"]    = Helpers::hextoa(buffer, telegram.src);
+    doc["dest"]   = Helpers::hextoa(buffer, telegram.dest);
+    doc["type"]   = Helpers::hextoa(buffer, telegram.type_id);
+    doc["offset"] = Helpers::hextoa(buffer, telegram.offset);
+    strcpy(buffer, Helpers::data_to_hex(telegram.message_data, telegram.message_length).c_str()); // telegram is without crc
     doc["data"] = buffer;
 
-    if (telegram->message_length <= 4) {
+    if (telegram.message_length <= 4) {
         uint32_t value = 0;
-        for (uint8_t i = 0; i < telegram->message_length; i++) {
-            value = (value << 8) + telegram->message_data[i];
+        for (uint8_t i = 0; i < telegram.message_length; i++) {
+            value = (value << 8) + telegram.message_data[i];
         }
         doc["value"] = value;
     }
@@ -622,10 +697,57 @@ std::string EMSESP::device_tostring(const uint8_t device_id) {
 
 // created a pretty print telegram as a text string
 // e.g. Boiler(0x08) -> Me(0x0B), Version(0x02), data: 7B 06 01 00 00 00 00 00 00 04 (offset 1)
-std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
-    uint8_t src    = telegram->src & 0x7F;
-    uint8_t dest   = telegram->dest & 0x7F;
-    uint8_t offset = telegram->offset;
+// the part before the data only depends on src, dest, direction and type, so it is cached
+std::string EMSESP::pretty_telegram(const Telegram & telegram, const bool cached) {
+    std::string str = cached ? pretty_prefix(telegram) : pretty_prefix_build(telegram);
+    str.reserve(str.size() + 3 * telegram.message_length + 20);
+    str += telegram.to_string_message();
+    if (telegram.offset) {
+        char buffer[20];
+        snprintf(buffer, sizeof(buffer), " (offset %d)", telegram.offset);
+        str += buffer;
+    }
+    return str;
+}
+
+// returns the prefix from the cache, building it if it's not there
+// the cache is small and replaced round-robin, on a busy bus only a handful of telegram types are seen
+std::string EMSESP::pretty_prefix(const Telegram & telegram) {
+    uint32_t key = ((uint32_t)(telegram.operation == Telegram::Operation::RX_READ) << 30) | ((uint32_t)(telegram.src & 0x7F) << 23)
+                   | ((uint32_t)(telegram.dest & 0x7F) << 16) | telegram.type_id;
+
+    // Me depends on our bus id
+    if (pretty_cache_bus_id_ != rxservice_.ems_bus_id()) {
+        pretty_cache_clear();
+        pretty_cache_bus_id_ = rxservice_.ems_bus_id();
+    }
+
+    for (const auto & entry : pretty_cache_) {
+        if (entry.key == key) {
+            return entry.prefix;
+        }
+    }
+
+    std::string prefix = pretty_prefix_build(telegram);
+    if (pretty_cache_.size() < PRETTY_CACHE_SIZE) {
+        pretty_cache_.push_back({key, prefix});
+    } else {
+        pretty_cache_[pretty_cache_next_] = {key, prefix};
+        pretty_cache_next_                = (pretty_cache_next_ + 1) % PRETTY_CACHE_SIZE;
+    }
+    return prefix;
+}
+
+// names change when a device is added
+void EMSESP::pretty_cache_clear() {
+    pretty_cache_.clear();
+    pretty_cache_next_ = 0;
+}
+
+// builds the prefix, e.g. Boiler(0x08) -> Me(0x0B), Version(0x02), data:
+std::string EMSESP::pretty_prefix_build(const Telegram & telegram) {
+    uint8_t src  = telegram.src & 0x7F;
+    uint8_t dest = telegram.dest & 0x7F;
 
     // find name for src and dest by looking up known devices
     std::string src_name("");
@@ -657,9 +779,9 @@ std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
     }
 
     // check for global/common types like Version & UBADevices
-    if (telegram->type_id == EMSdevice::EMS_TYPE_VERSION) {
+    if (telegram.type_id == EMSdevice::EMS_TYPE_VERSION) {
         type_name = read_flash_string(F("Version"));
-    } else if (telegram->type_id == EMSdevice::EMS_TYPE_UBADevices) {
+    } else if (telegram.type_id == EMSdevice::EMS_TYPE_UBADevices) {
         type_name = read_flash_string(F("UBADevices"));
     }
 
@@ -668,41 +790,25 @@ std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
         type_name = read_flash_string(F("?"));
     }
 
-    if (telegram->operation == Telegram::Operation::RX_READ) {
+    if (telegram.operation == Telegram::Operation::RX_READ) {
         direction = read_flash_string(F("<-"));
     } else {
         direction = read_flash_string(F("->"));
     }
 
-    std::string str(200, '\0');
-    if (offset) {
-        snprintf(&str[0],
-                 str.capacity() + 1,
-                 "%s(0x%02X) %s %s(0x%02X), %s(0x%02X), data: %s (offset %d)",
-                 src_name.c_str(),
-                 src,
-                 direction.c_str(),
-                 dest_name.c_str(),
-                 dest,
-                 type_name.c_str(),
-                 telegram->type_id,
-                 telegram->to_string_message().c_str(),
-                 offset);
-    } else {
-        snprintf(&str[0],
-                 str.capacity() + 1,
-                 "%s(0x%02X) %s %s(0x%02X), %s(0x%02X), data: %s",
-                 src_name.c_str(),
-                 src,
-                 direction.c_str(),
-                 dest_name.c_str(),
-                 dest,
-                 type_name.c_str(),
-                 telegram->type_id,
-                 telegram->to_string_message().c_str());
-    }
+    char buffer[120];
+    snprintf(buffer,
+             sizeof(buffer),
+             "%s(0x%02X) %s %s(0x%02X), %s(0x%02X), data: ",
+             src_name.c_str(),
+             src,
+             direction.c_str(),
+             dest_name.c_str(),
+             dest,
+             type_name.c_str(),
+             telegram.type_id);
 
-    return str;
+    return std::string(buffer);
 }
 
 /*
@@ -714,15 +820,15 @@ std::string EMSESP::pretty_telegram(std::shared_ptr<const Telegram> telegram) {
  * e.g. in example above 1st byte = x0B = b1011 so we have device ids 0x08, 0x09, 0x011
  * and 2nd byte = x80 = b1000 b0000 = device id 0x17
  */
-void EMSESP::process_UBADevices(std::shared_ptr<const Telegram> telegram) {
+void EMSESP::process_UBADevices(const Telegram & telegram) {
     // exit it length is incorrect (must be 13 or 15 bytes long)
-    if (telegram->message_length > 15) {
+    if (telegram.message_length > 15) {
         return;
     }
 
     // for each byte, check the bits and determine the device_id
-    for (uint8_t data_byte = 0; data_byte < telegram->message_length; data_byte++) {
-        uint8_t next_byte = telegram->message_data[data_byte];
+    for (uint8_t data_byte = 0; data_byte < telegram.message_length; data_byte++) {
+        uint8_t next_byte = telegram.message_data[data_byte];
 
         if (next_byte) {
             for (uint8_t bit = 0; bit < 8; bit++) {
@@ -743,22 +849,22 @@ void EMSESP::process_UBADevices(std::shared_ptr<const Telegram> telegram) {
 
 // process the Version telegram (type 0x02), which is a common type
 // e.g. 09 0B 02 00 PP V1 V2
-void EMSESP::process_version(std::shared_ptr<const Telegram> telegram) {
+void EMSESP::process_version(const Telegram & telegram) {
     // check for valid telegram, just in case
-    if (telegram->message_length < 3) {
+    if (telegram.message_length < 3) {
         // for empty telegram add device with empty product, version and brand
-        if (!telegram->message_length) {
+        if (!telegram.message_length) {
             std::string version = "00.00";
-            (void)add_device(telegram->src, 0, version, 0);
+            (void)add_device(telegram.src, 0, version, 0);
         }
         return;
     }
 
     // check for 2nd subscriber, e.g. 18 0B 02 00 00 00 00 5E 02 01
     uint8_t offset = 0;
-    if (telegram->message_data[0] == 0x00) {
+    if (telegram.message_data[0] == 0x00) {
         // see if we have a 2nd subscriber
-        if (telegram->message_data[3] != 0x00) {
+        if (telegram.message_data[3] != 0x00) {
             offset = 3;
         } else {
             return; // ignore whole telegram
@@ -766,17 +872,17 @@ void EMSESP::process_version(std::shared_ptr<const Telegram> telegram) {
     }
 
     // extra details from the telegram
-    uint8_t device_id  = telegram->src;                  // device ID
-    uint8_t product_id = telegram->message_data[offset]; // product ID
+    uint8_t device_id  = telegram.src;                  // device ID
+    uint8_t product_id = telegram.message_data[offset]; // product ID
 
     // get version as XX.XX
     std::string version(6, '\0');
-    snprintf(&version[0], version.capacity() + 1, "%02d.%02d", telegram->message_data[offset + 1], telegram->message_data[offset + 2]);
+    snprintf(&version[0], version.capacity() + 1, "%02d.%02d", telegram.message_data[offset + 1], telegram.message_data[offset + 2]);
 
     // some devices store the protocol type (HT3, Buderus) in the last byte
     uint8_t brand;
-    if (telegram->message_length >= 10) {
-        brand = EMSdevice::decode_brand(telegram->message_data[9]);
+    if (telegram.message_length >= 10) {
+        brand = EMSdevice::decode_brand(telegram.message_data[9]);
     } else {
         brand = EMSdevice::Brand::NO_BRAND; // unknown
     }
@@ -785,13 +891,67 @@ void EMSESP::process_version(std::shared_ptr<const Telegram> telegram) {
     (void)add_device(device_id, product_id, version, brand);
 }
 
+// the masters broadcast the same telegrams every few seconds, mostly with the same data
+// returns true if the data of a broadcast is the same as the last time it was processed
+// the data is compared byte for byte, so a change can't be missed
+bool EMSESP::rx_fingerprint_match(const Telegram & telegram) {
+    uint32_t key = ((uint32_t)(telegram.src & 0x7F) << 24) | ((uint32_t)telegram.offset << 16) | telegram.type_id;
+    for (const auto & entry : rx_fingerprints_) {
+        if (entry.key == key) {
+            return (entry.length == telegram.message_length) && !memcmp(entry.data, telegram.message_data, telegram.message_length);
+        }
+    }
+    return false;
+}
+
+// keeps the data of a processed broadcast. The cache is replaced round-robin like the pretty print cache
+void EMSESP::rx_fingerprint_store(const Telegram & telegram) {
+    uint32_t       key = ((uint32_t)(telegram.src & 0x7F) << 24) | ((uint32_t)telegram.offset << 16) | telegram.type_id;
+    Rx_fingerprint fingerprint;
+    fingerprint.key    = key;
+    fingerprint.length = telegram.message_length;
+    memcpy(fingerprint.data, telegram.message_data, telegram.message_length);
+
+    for (auto & entry : rx_fingerprints_) {
+        if (entry.key == key) {
+            entry = fingerprint;
+            return;
+        }
+    }
+    if (rx_fingerprints_.size() < RX_FINGERPRINT_SIZE) {
+        rx_fingerprints_.push_back(fingerprint);
+    } else {
+        rx_fingerprints_[rx_fingerprint_next_] = fingerprint;
+        rx_fingerprint_next_                   = (rx_fingerprint_next_ + 1) % RX_FINGERPRINT_SIZE;
+    }
+}
+
+void EMSESP::rx_fingerprint_clear() {
+    rx_fingerprints_.clear();
+    rx_fingerprint_next_ = 0;
+}
+
+void EMSESP::rx_fingerprint_clear(const uint8_t device_id) {
+    uint8_t src = device_id & 0x7F;
+    for (auto it = rx_fingerprints_.begin(); it != rx_fingerprints_.end();) {
+        if ((it->key >> 24) == src) {
+            it = rx_fingerprints_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (rx_fingerprint_next_ >= rx_fingerprints_.size()) {
+        rx_fingerprint_next_ = 0;
+    }
+}
+
 // find the device object that matches the device ID and see if it has a matching telegram type handler
 // but only process if the telegram is sent to us or it's a broadcast (dest=0x00=all)
 // We also check for common telgram types, like the Version(0x02)
 // returns false if there are none found
-bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
+bool EMSESP::process_telegram(const Telegram & telegram) {
     // if watching or reading...
-    if ((telegram->type_id == read_id_) && (telegram->dest == txservice_.ems_bus_id())) {
+    if ((telegram.type_id == read_id_) && (telegram.dest == txservice_.ems_bus_id())) {
         LOG_NOTICE(F("%s"), pretty_telegram(telegram).c_str());
         if (Mqtt::send_response()) {
             publish_response(telegram);
@@ -802,26 +962,26 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
         }
         read_next_ = false;
     } else if (watch() == WATCH_ON) {
-        if ((watch_id_ == WATCH_ID_NONE) || (telegram->type_id == watch_id_)
-            || ((watch_id_ < 0x80) && ((telegram->src == watch_id_) || (telegram->dest == watch_id_)))) {
+        if ((watch_id_ == WATCH_ID_NONE) || (telegram.type_id == watch_id_)
+            || ((watch_id_ < 0x80) && ((telegram.src == watch_id_) || (telegram.dest == watch_id_)))) {
             LOG_NOTICE(F("%s"), pretty_telegram(telegram).c_str());
-        } else if (!trace_raw_) {
+        } else if (!trace_raw_ && logger_.enabled(uuid::log::Level::TRACE)) {
             LOG_TRACE(F("%s"), pretty_telegram(telegram).c_str());
         }
-    } else if (!trace_raw_) {
-        LOG_TRACE(F("%s"), pretty_telegram(telegram).c_str());
+    } else if (!trace_raw_ && logger_.enabled(uuid::log::Level::TRACE)) {
+        LOG_TRACE(F("%s"), pretty_telegram(telegram).c_str()); // only decoded if someone is listening
     }
 
     // only process broadcast telegrams or ones sent to us on request
-    if ((telegram->dest != 0x00) && (telegram->dest != rxservice_.ems_bus_id())) {
+    if ((telegram.dest != 0x00) && (telegram.dest != rxservice_.ems_bus_id())) {
         return false;
     }
 
     // check for common types, like the Version(0x02)
-    if (telegram->type_id == EMSdevice::EMS_TYPE_VERSION) {
+    if (telegram.type_id == EMSdevice::EMS_TYPE_VERSION) {
         process_version(telegram);
         return true;
-    } else if (telegram->type_id == EMSdevice::EMS_TYPE_UBADevices) {
+    } else if (telegram.type_id == EMSdevice::EMS_TYPE_UBADevices) {
         // do not flood tx-queue with version requests while waiting for km200
         if (!wait_km_) {
             process_UBADevices(telegram);
@@ -829,49 +989,76 @@ bool EMSESP::process_telegram(std::shared_ptr<const Telegram> telegram) {
         return true;
     }
 
-    // match device_id and type_id
+    // match device_id and type_id, both are looked up with an index
     // calls the associated process function for that EMS device
     // returns false if the device_id doesn't recognize it
     // after the telegram has been processed, call see if there have been values changed and we need to do a MQTT publish
     bool found       = false;
     bool knowndevice = false;
-    for (const auto & emsdevice : emsdevices) {
-        if (emsdevice) {
-            if (emsdevice->is_device_id(telegram->src)) {
-                knowndevice = true;
-                found       = emsdevice->handle_telegram(telegram);
-                // if we correctly processes the telegram follow up with sending it via MQTT if needed
-                if (found && Mqtt::connected()) {
-                    if ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
-                        || (telegram->type_id == publish_id_ && telegram->dest == txservice_.ems_bus_id())) {
-                        if (telegram->type_id == publish_id_) {
-                            publish_id_ = 0;
-                        }
-                        emsdevice->has_update(false);                    // reset flag
-                        publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
-                    }
+    auto emsdevice   = find_device(telegram.src);
+    if (emsdevice) {
+        knowndevice = true;
+        // a repeated broadcast has nothing new, it's only counted as fresh data for the fetch
+        bool unchanged = (telegram.dest == 0x00) && rx_fingerprint_match(telegram);
+        found          = emsdevice->handle_telegram(telegram, unchanged);
+        if (unchanged) {
+            rx_skip_count_++;
+        } else if (found && (telegram.dest == 0x00) && (telegram.message_length > 0) && emsdevice->telegram_used()) {
+            rx_fingerprint_store(telegram);
+        }
+        // if we correctly processes the telegram follow up with sending it via MQTT if needed
+        if (found && Mqtt::connected()) {
+            if ((mqtt_.get_publish_onchange(emsdevice->device_type()) && emsdevice->has_update())
+                || (telegram.type_id == publish_id_ && telegram.dest == txservice_.ems_bus_id())) {
+                if (telegram.type_id == publish_id_) {
+                    publish_id_ = 0;
                 }
-                if (wait_validate_ == telegram->type_id) {
-                    wait_validate_ = 0;
+                emsdevice->has_update(false); // reset flag
+                if (Mqtt::publish_single()) {
+                    publish_changed_values(emsdevice); // only the values that changed, each to their own topic
+                } else {
+                    publish_device_values(emsdevice->device_type()); // publish to MQTT if we explicitly have too
                 }
-                break;
+            } else if (Mqtt::publish_single() && emsdevice->has_update()) {
+                emsdevice->has_update(false);
+                publish_changed_values(emsdevice); // changes are published straight away, the full payload stays on the timer
             }
         }
+        if (wait_validate_ == telegram.type_id) {
+            wait_validate_ = 0;
+        }
     }
 
     if (!found) {
-        LOG_DEBUG(F("No telegram type handler found for ID 0x%02X (src 0x%02X)"), telegram->type_id, telegram->src);
+        LOG_DEBUG(F("No telegram type handler found for ID 0x%02X (src 0x%02X)"), telegram.type_id, telegram.src);
         if (watch() == WATCH_UNKNOWN) {
             LOG_NOTICE(F("%s"), pretty_telegram(telegram).c_str());
         }
-        if (!wait_km_ && !knowndevice && (telegram->src != EMSbus::ems_bus_id()) && (telegram->message_length > 0)) {
-            send_read_request(EMSdevice::EMS_TYPE_VERSION, telegram->src);
+        if (!wait_km_ && !knowndevice && (telegram.src != EMSbus::ems_bus_id()) && (telegram.message_length > 0)) {
+            send_read_request(EMSdevice::EMS_TYPE_VERSION, telegram.src);
         }
     }
 
     return found;
 }
 
+// returns the device object for a device_id, using the index. The MSB is ignored
+// if there are more devices with the same device_id the first one added is returned
+EMSdevice * EMSESP::find_device(const uint8_t device_id) {
+    uint8_t pos = device_index_[device_id & 0x7F];
+    return pos ? emsdevices[pos - 1].get() : nullptr;
+}
+
+// add the last added device to the device_id index
+void EMSESP::add_device_index() {
+    auto & emsdevice = emsdevices.back();
+    if (emsdevice && !device_index_[emsdevice->device_id() & 0x7F]) {
+        device_index_[emsdevice->device_id() & 0x7F] = emsdevices.size();
+    }
+    pretty_cache_clear(); // the new device may be named in a cached telegram
+    rx_fingerprint_clear();
+}
+
 // return true if we have this device already registered
 bool EMSESP::device_exists(const uint8_t device_id) {
     for (const auto & emsdevice : emsdevices) {
@@ -984,6 +1171,7 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, std::
         std::string name("unknown");
         emsdevices.push_back(
             EMSFactory::add(DeviceType::GENERIC, device_id, product_id, version, name, DeviceFlags::EMS_DEVICE_FLAG_NONE, EMSdevice::Brand::NO_BRAND));
+        add_device_index();
         return false; // not found
     }
 
@@ -1028,6 +1216,10 @@ bool EMSESP::add_device(const uint8_t device_id, const uint8_t product_id, std::
     LOG_DEBUG(F("Adding new device %s (device ID 0x%02X, product ID %d, version %s)"), name.c_str(), device_id, product_id, version.c_str());
     emsdevices.push_back(EMSFactory::add(device_type, device_id, product_id, version, name, flags, brand));
     emsdevices.back()->unique_id(++unique_id_count_);
+    add_device_index();
+#if defined(EMSESP_DEBUG)
+    system_.show_mem(name.c_str()); // heap used per device, including its telegram handler table
+#endif
 
     fetch_device_values(device_id); // go and fetch its data
 
@@ -1126,7 +1318,7 @@ void EMSESP::send_write_request(const uint16_t type_id,
                                 uint8_t *      message_data,
                                 const uint8_t  message_length,
                                 const uint16_t validate_typeid) {
-    txservice_.add(Telegram::Operation::TX_WRITE, dest, type_id, offset, message_data, message_length, validate_typeid, true);
+    txservice_.add(Telegram::Operation::TX_WRITE, dest, type_id, offset, message_data, message_length, validate_typeid, TxService::Lane::WRITE);
 }
 
 void EMSESP::send_write_request(const uint16_t type_id, const uint8_t dest, const uint8_t offset, const uint8_t value) {
@@ -1147,6 +1339,8 @@ void EMSESP::incoming_telegram(uint8_t * data, const uint8_t length) {
 #ifdef EMSESP_UART_DEBUG
     static uint32_t rx_time_ = 0;
 #endif
+    Capture::record(data, length); // if recording, keep the raw frame for a replay
+
     // check first for echo
     uint8_t first_value = data[0];
     if (((first_value & 0x7F) == txservice_.ems_bus_id()) && (length > 1)) {
@@ -1308,17 +1502,19 @@ void EMSESP::loop() {
 
     // if we're doing an OTA upload, skip MQTT and EMS
     if (!system_.upload_status()) {
-        webLogService.loop(); // log in Web UI
-        rxservice_.loop();    // process any incoming Rx telegrams
-        shower_.loop();       // check for shower on/off
-        dallassensor_.loop(); // read dallas sensor temperatures
-        publish_all_loop();   // with HA messages in parts to avoid flooding the mqtt queue
-        mqtt_.loop();         // sends out anything in the MQTT queue
-
-        // force a query on the EMS devices to fetch latest data at a set interval (1 min)
-        if ((uuid::get_uptime() - last_fetch_ > EMS_FETCH_FREQUENCY)) {
+        webLogService.loop();  // log in Web UI
+        rxservice_.loop();     // process any incoming Rx telegrams
+        commandqueue_.loop();  // run the commands from the web and MQTT
+        webDataService.loop(); // answer the device data requests waiting for a write
+        shower_.loop();        // check for shower on/off
+        dallassensor_.loop();  // read dallas sensor temperatures
+        publish_all_loop();    // with HA messages in parts to avoid flooding the mqtt queue
+        mqtt_.loop();          // sends out anything in the MQTT queue
+
+        // query the EMS devices for the latest data, spreading the reads over time
+        if ((uuid::get_uptime() - last_fetch_ > EMS_FETCH_SLOT)) {
             last_fetch_ = uuid::get_uptime();
-            fetch_device_values();
+            fetch_next_value();
         }
     }
 
@@ -50,7 +50,9 @@
 #include "console.h"
 #include "shower.h"
 #include "roomcontrol.h"
+#include "capture.h"
 #include "command.h"
+#include "commandqueue.h"
 #include "version.h"
 
 #define WATCH_ID_NONE 0 // no watch id set
@@ -71,8 +73,8 @@
 #define EMSESP_JSON_SIZE_XXLARGE_DYN 16384 // for extra very very large json docs, using DynamicJsonDocument
 
 // helpers for callback functions
-#define MAKE_PF_CB(__f) [&](std::shared_ptr<const Telegram> t) { __f(t); }                  // for Process Function callbacks to EMSDevice::process_function_p
-#define MAKE_CF_CB(__f) [&](const char * value, const int8_t id) { return __f(value, id); } // for Command Function callbacks Command::cmd_function_p
+#define MAKE_PF_CB(__f) static_cast<EMSdevice::process_function_p>(&std::remove_pointer<decltype(this)>::type::__f) // for Process Function callbacks to EMSDevice::process_function_p
+#define MAKE_CF_CB(__f) [&](const char * value, const int8_t id) { return __f(value, id); }                         // for Command Function callbacks Command::cmd_function_p
 
 namespace emsesp {
 
@@ -84,10 +86,11 @@ class EMSESP {
     static void loop();
 
     static void publish_device_values(uint8_t device_type);
+    static void publish_changed_values(EMSdevice * emsdevice);
     static void publish_other_values();
     static void publish_sensor_values(const bool time, const bool force = false);
     static void publish_all(bool force = false);
-    static void reset_mqtt_ha();
+    static void reset_mqtt_ha(bool remove = true);
 
 #ifdef EMSESP_STANDALONE
     static void run_test(uuid::console::Shell & shell, const std::string & command); // only for testing
@@ -96,8 +99,18 @@ class EMSESP {
     static void uart_telegram(const std::vector<uint8_t> & rx_data);
 #endif
 
-    static bool        process_telegram(std::shared_ptr<const Telegram> telegram);
-    static std::string pretty_telegram(std::shared_ptr<const Telegram> telegram);
+    static bool        process_telegram(const Telegram & telegram);
+    static std::string pretty_telegram(const Telegram & telegram, const bool cached = true);
+
+    // forget the last data of the broadcasts, so they are all processed again
+    // e.g. after a command that may have changed device values without a telegram
+    static void rx_fingerprint_clear();
+    static void rx_fingerprint_clear(const uint8_t device_id); // only the broadcasts of one device
+
+    // # broadcasts not processed because their data didn't change
+    static uint32_t rx_skip_count() {
+        return rx_skip_count_;
+    }
 
     static void send_read_request(const uint16_t type_id, const uint8_t dest, const uint8_t offset = 0, const uint8_t length = 0);
     static void send_write_request(const uint16_t type_id,
@@ -214,7 +227,8 @@ class EMSESP {
     static void fetch_device_values_type(const uint8_t device_type);
     static bool valid_device(const uint8_t device_id);
 
-    static bool add_device(const uint8_t device_id, const uint8_t product_id, std::string & version, const uint8_t brand);
+    static bool        add_device(const uint8_t device_id, const uint8_t product_id, std::string & version, const uint8_t brand);
+    static EMSdevice * find_device(const uint8_t device_id);
     static void scan_devices();
     static void clear_all_devices();
 
@@ -228,6 +242,7 @@ class EMSESP {
     static Shower       shower_;
     static RxService    rxservice_;
     static TxService    txservice_;
+    static CommandQueue commandqueue_;
 
     // web controllers
     static ESP8266React       esp8266React;
@@ -245,17 +260,27 @@ class EMSESP {
     static uuid::log::Logger logger_;
 
     static std::string device_tostring(const uint8_t device_id);
-
-    static void process_UBADevices(std::shared_ptr<const Telegram> telegram);
-    static void process_version(std::shared_ptr<const Telegram> telegram);
-    static void publish_response(std::shared_ptr<const Telegram> telegram);
+    static std::string pretty_prefix(const Telegram & telegram);
+    static std::string pretty_prefix_build(const Telegram & telegram);
+    static void        pretty_cache_clear();
+    static bool        rx_fingerprint_match(const Telegram & telegram);
+    static void        rx_fingerprint_store(const Telegram & telegram);
+
+    static void process_UBADevices(const Telegram & telegram);
+    static void process_version(const Telegram & telegram);
+    static void publish_response(const Telegram & telegram);
     static void publish_all_loop();
     static bool command_info(uint8_t device_type, JsonObject & output, const int8_t id, const uint8_t output_target);
     static bool command_commands(uint8_t device_type, JsonObject & output, const int8_t id);
     static bool command_entities(uint8_t device_type, JsonObject & output, const int8_t id);
 
-    static constexpr uint32_t EMS_FETCH_FREQUENCY = 60000; // check every minute
+    static void add_device_index();
+
+    static void fetch_next_value();
+
+    static constexpr uint32_t EMS_FETCH_SLOT = 250; // check for a due fetch every 250ms
     static uint32_t           last_fetch_;
+    static uint8_t            fetch_device_idx_;
 
     struct Device_record {
         uint8_t                     product_id;
@@ -264,6 +289,7 @@ class EMSESP {
         uint8_t                     flags;
     };
     static std::vector<Device_record> device_library_;
+    static uint8_t                    device_index_[0x80]; // position+1 in emsdevices of the first device with this device_id, 0 if none
 
     static uint8_t  actual_master_thermostat_;
     static uint16_t watch_id_;
@@ -281,6 +307,27 @@ class EMSESP {
     static bool     wait_km_;
 
     static constexpr uint8_t EMS_WAIT_KM_TIMEOUT = 60; // wait one minute
+
+    // prebuilt start of a pretty printed telegram, keyed by direction, src, dest and type_id
+    struct Pretty_prefix {
+        uint32_t    key;
+        std::string prefix;
+    };
+    static constexpr uint8_t          PRETTY_CACHE_SIZE = 16;
+    static std::vector<Pretty_prefix> pretty_cache_;
+    static uint8_t                    pretty_cache_next_;   // next entry to replace when the cache is full
+    static uint8_t                    pretty_cache_bus_id_; // bus id the cached names were built with
+
+    // last data of a broadcast telegram, keyed by src, type_id and offset
+    struct Rx_fingerprint {
+        uint32_t key;
+        uint8_t  length;
+        uint8_t  data[EMS_MAX_TELEGRAM_MESSAGE_LENGTH];
+    };
+    static constexpr uint8_t           RX_FINGERPRINT_SIZE = 32;
+    static std::vector<Rx_fingerprint> rx_fingerprints_;
+    static uint8_t                     rx_fingerprint_next_; // next entry to replace when the cache is full
+    static uint32_t                    rx_skip_count_;
 };
 
 } // namespace emsesp
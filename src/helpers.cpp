@@ -318,7 +318,7 @@ std::string Helpers::data_to_hex(const uint8_t * data, const uint8_t length) {
         *p++ = buffer[1];
         *p++ = ' '; // space
     }
-    *--p = '\0'; // null terminate just in case, loosing the trailing space
+    str.resize(p - &str[0] - 1); // loosing the trailing space, so it can be appended to
 
     return str;
 }
@@ -376,6 +376,15 @@ uint32_t Helpers::abs(const int32_t i) {
     return (i < 0 ? -i : i);
 }
 
+// 32-bit FNV-1a hash, pass the previous hash to continue over more data
+uint32_t Helpers::hash(const char * data, const size_t length, uint32_t hash) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 // for booleans, use isBool true (EMS_VALUE_BOOL)
 bool Helpers::hasValue(const uint8_t & v, const uint8_t isBool) {
     if (isBool == EMS_VALUE_BOOL) {
@@ -51,6 +51,7 @@ class Helpers {
     static bool        check_abs(const int32_t i);
     static uint32_t    abs(const int32_t i);
     static float       round2(float value, const uint8_t divider);
+    static uint32_t    hash(const char * data, const size_t length, uint32_t hash = 2166136261UL);
     static std::string toLower(std::string const & s);
     static std::string toUpper(std::string const & s);
 
@@ -0,0 +1,327 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonwriter.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace emsesp {
+
+JsonWriter::JsonWriter(std::string & output, const uint8_t format)
+    : output_(output)
+    , msgpack_(format == Format::MSGPACK) {
+    open(false);
+}
+
+void JsonWriter::nested(const char * key) {
+    while (depth_ > 1) {
+        close();
+    }
+    write_key(key);
+    open(false);
+}
+
+void JsonWriter::nested(const __FlashStringHelper * key) {
+    nested(reinterpret_cast<const char *>(key));
+}
+
+void JsonWriter::nested_array(const char * key) {
+    write_key(key);
+    open(true);
+}
+
+void JsonWriter::nested_object() {
+    write_element();
+    open(false);
+}
+
+void JsonWriter::close() {
+    if (depth_ == 0) {
+        return;
+    }
+    const Level & level = levels_[--depth_];
+    if (msgpack_) {
+        // small ones, like the elements of an array, get a single byte fixmap or fixarray header
+        if (level.count < 16) {
+            output_[level.pos] = (char)((level.array ? 0x90 : 0x80) | level.count);
+            output_.erase(level.pos + 1, 4);
+        } else {
+            write_count(level.pos, level.count);
+        }
+    } else {
+        output_ += level.array ? ']' : '}';
+    }
+}
+
+void JsonWriter::add(const char * value) {
+    write_element();
+    write_string(value);
+}
+
+void JsonWriter::add(const __FlashStringHelper * value) {
+    add(reinterpret_cast<const char *>(value));
+}
+
+void JsonWriter::add(const char * key, const char * value) {
+    write_key(key);
+    write_string(value);
+}
+
+void JsonWriter::add(const char * key, const __FlashStringHelper * value) {
+    write_key(key);
+    write_string(reinterpret_cast<const char *>(value));
+}
+
+void JsonWriter::add(const char * key, const std::string & value) {
+    write_key(key);
+    write_string(value.c_str());
+}
+
+void JsonWriter::add(const char * key, const bool value) {
+    write_key(key);
+    if (msgpack_) {
+        output_ += (char)(value ? 0xC3 : 0xC2);
+    } else {
+        output_ += value ? "true" : "false";
+    }
+}
+
+// values are already rounded to 2 decimals, trailing zeros are not shown like in ArduinoJson
+void JsonWriter::add(const char * key, const double value) {
+    write_key(key);
+    if (std::isnan(value) || std::isinf(value)) {
+        if (msgpack_) {
+            output_ += (char)0xC0; // nil
+        } else {
+            output_ += "null";
+        }
+        return;
+    }
+
+    // whole numbers as integers, otherwise a float32 which is precise enough for 2 decimals
+    if (msgpack_) {
+        if ((value > -2147483648.0) && (value < 2147483648.0) && (value == (int32_t)value)) {
+            write_int((int32_t)value);
+        } else {
+            float    f = value;
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            output_ += (char)0xCA;
+            write_be(bits, 4);
+        }
+        return;
+    }
+
+    // format as fixed point, which is a lot faster than snprintf with %f
+    int64_t fixed = std::llround(value * 100);
+    if (fixed < 0) {
+        output_ += '-';
+        fixed = -fixed;
+    }
+    char s[24];
+    int  len = snprintf(s, sizeof(s), "%llu", (unsigned long long)(fixed / 100));
+    output_.append(s, len);
+
+    uint8_t decimals = fixed % 100;
+    if (decimals) {
+        output_ += '.';
+        output_ += (char)('0' + decimals / 10);
+        if (decimals % 10) {
+            output_ += (char)('0' + decimals % 10);
+        }
+    }
+}
+
+bool JsonWriter::end() {
+    bool has_members = (depth_ > 0) && (levels_[0].count > 0);
+    while (depth_ > 0) {
+        close();
+    }
+    return has_members;
+}
+
+void JsonWriter::clear() {
+    output_.clear();
+    output_.reserve(reserve_);
+    depth_ = 0;
+    open(false);
+}
+
+void JsonWriter::reserve(const size_t size) {
+    reserve_ = size;
+    output_.reserve(output_.size() + size);
+}
+
+void JsonWriter::open(const bool array) {
+    if (depth_ == MAX_DEPTH) {
+        return; // too deep, only used with fixed layouts so this can't happen
+    }
+    levels_[depth_++] = {output_.size(), 0, array};
+    if (msgpack_) {
+        output_ += (char)(array ? 0xDD : 0xDF); // array32 or map32
+        write_be(0, 4);
+    } else {
+        output_ += array ? '[' : '{';
+    }
+}
+
+void JsonWriter::write_key(const char * key) {
+    write_element();
+    write_string(key);
+    if (!msgpack_) {
+        output_ += ':';
+    }
+}
+
+// counts the member or element in the current object or array, and separates it from the previous one
+void JsonWriter::write_element() {
+    if (depth_ == 0) {
+        return;
+    }
+    if ((levels_[depth_ - 1].count++ > 0) && !msgpack_) {
+        output_ += ',';
+    }
+}
+
+// quote and escape a string, which can also be in flash
+// in MessagePack it's prefixed with the length instead
+void JsonWriter::write_string(const char * s) {
+    if (msgpack_) {
+        size_t len = 0;
+        if (s) {
+            while (pgm_read_byte(s + len) != 0) {
+                len++;
+            }
+        }
+        if (len < 32) {
+            output_ += (char)(0xA0 | len); // fixstr
+        } else if (len < 256) {
+            output_ += (char)0xD9;
+            write_be(len, 1);
+        } else {
+            output_ += (char)0xDA;
+            write_be(len, 2);
+        }
+        for (size_t i = 0; i < len; i++) {
+            output_ += (char)pgm_read_byte(s + i);
+        }
+        return;
+    }
+
+    output_ += '"';
+    if (s) {
+        uint8_t c;
+        while ((c = pgm_read_byte(s++)) != 0) {
+            switch (c) {
+            case '"':
+                output_ += "\\\"";
+                break;
+            case '\\':
+                output_ += "\\\\";
+                break;
+            case '\b':
+                output_ += "\\b";
+                break;
+            case '\f':
+                output_ += "\\f";
+                break;
+            case '\n':
+                output_ += "\\n";
+                break;
+            case '\r':
+                output_ += "\\r";
+                break;
+            case '\t':
+                output_ += "\\t";
+                break;
+            default:
+                if (c < 0x20) {
+                    // other control characters are not allowed in a json string
+                    char u[7];
+                    snprintf(u, sizeof(u), "\\u%04X", c);
+                    output_ += u;
+                } else {
+                    output_ += (char)c;
+                }
+                break;
+            }
+        }
+    }
+    output_ += '"';
+}
+
+void JsonWriter::write_int(int32_t value) {
+    if (msgpack_) {
+        if (value >= 0) {
+            write_uint(value);
+        } else if (value >= -32) {
+            output_ += (char)value; // negative fixint
+        } else if (value >= -128) {
+            output_ += (char)0xD0;
+            write_be(value, 1);
+        } else if (value >= -32768) {
+            output_ += (char)0xD1;
+            write_be(value, 2);
+        } else {
+            output_ += (char)0xD2;
+            write_be(value, 4);
+        }
+        return;
+    }
+
+    char s[12];
+    output_.append(s, snprintf(s, sizeof(s), "%ld", (long)value));
+}
+
+void JsonWriter::write_uint(uint32_t value) {
+    if (msgpack_) {
+        if (value < 128) {
+            output_ += (char)value; // positive fixint
+        } else if (value < 256) {
+            output_ += (char)0xCC;
+            write_be(value, 1);
+        } else if (value < 65536) {
+            output_ += (char)0xCD;
+            write_be(value, 2);
+        } else {
+            output_ += (char)0xCE;
+            write_be(value, 4);
+        }
+        return;
+    }
+
+    char s[12];
+    output_.append(s, snprintf(s, sizeof(s), "%lu", (unsigned long)value));
+}
+
+void JsonWriter::write_count(const size_t pos, const uint32_t count) {
+    output_[pos + 1] = count >> 24;
+    output_[pos + 2] = count >> 16;
+    output_[pos + 3] = count >> 8;
+    output_[pos + 4] = count;
+}
+
+// big-endian, as used by MessagePack
+void JsonWriter::write_be(const uint32_t value, const uint8_t bytes) {
+    for (int8_t i = bytes - 1; i >= 0; i--) {
+        output_ += (char)(value >> (i * 8));
+    }
+}
+
+} // namespace emsesp
@@ -0,0 +1,136 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_JSONWRITER_H
+#define EMSESP_JSONWRITER_H
+
+#include <Arduino.h>
+
+#include <string>
+#include <type_traits>
+
+namespace emsesp {
+
+// writes a json object with nested objects and arrays straight into a string buffer
+// used for large payloads like the device values, so no ArduinoJson document needs to be allocated
+// the caller owns the buffer and should reserve() it, so it can be moved into the MQTT queue afterwards
+// the same object can also be written as MessagePack, which is smaller and quicker to parse
+class JsonWriter {
+  public:
+    // same values as the MQTT payload_format setting
+    enum Format : uint8_t { JSON = 1, MSGPACK = 2 };
+
+    JsonWriter(std::string & output, const uint8_t format = Format::JSON);
+
+    // opens a nested object under the root, closing any previous nested object
+    void nested(const char * key);
+    void nested(const __FlashStringHelper * key);
+
+    // opens an array as a member of the current object, or an object as the next element of the current array
+    // both stay open until close()
+    void nested_array(const char * key);
+    void nested_object();
+    void close();
+
+    // adds a string element to the current array
+    void add(const char * value);
+    void add(const __FlashStringHelper * value);
+
+    void add(const char * key, const char * value);
+    void add(const char * key, const __FlashStringHelper * value);
+    void add(const char * key, const std::string & value);
+    void add(const char * key, const bool value);
+    void add(const char * key, const double value);
+
+    // all integer types, signed and unsigned
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value>::type add(const char * key, const T value) {
+        write_key(key);
+        if (std::is_signed<T>::value) {
+            write_int(static_cast<int32_t>(value));
+        } else {
+            write_uint(static_cast<uint32_t>(value));
+        }
+    }
+
+    // so writer["key"] = value can be used like a JsonObject
+    class Member {
+      public:
+        Member(JsonWriter & writer, const char * key)
+            : writer_(writer)
+            , key_(key) {
+        }
+
+        template <typename T>
+        void operator=(const T & value) {
+            writer_.add(key_, value);
+        }
+
+      private:
+        JsonWriter & writer_;
+        const char * key_;
+    };
+
+    Member operator[](const char * key) {
+        return Member(*this, key);
+    }
+
+    // closes all open objects. Returns false if nothing was added
+    bool end();
+
+    // starts a new object in the same buffer, e.g. after the payload has been moved away
+    void clear();
+
+    // reserves room for size more bytes, also used again on clear()
+    void reserve(const size_t size);
+
+    size_t size() const {
+        return output_.size();
+    }
+
+  private:
+    static constexpr uint8_t MAX_DEPTH = 4; // root, array, element, array of options
+
+    // an open object or array
+    struct Level {
+        size_t   pos;   // where the header is, for MessagePack
+        uint32_t count; // members or elements written so far
+        bool     array;
+    };
+
+    void open(const bool array);
+    void write_key(const char * key);
+    void write_element();
+    void write_string(const char * s);
+    void write_int(int32_t value);
+    void write_uint(uint32_t value);
+
+    // MessagePack maps and arrays need the number of members up front, so a 32 bit header is written and filled in when it is closed
+    void write_count(const size_t pos, const uint32_t count);
+    void write_be(const uint32_t value, const uint8_t bytes);
+
+    std::string & output_;
+    size_t        reserve_ = 0;
+    bool          msgpack_ = false;
+    Level         levels_[MAX_DEPTH];
+    uint8_t       depth_ = 0; // number of open levels, including the root
+};
+
+} // namespace emsesp
+
+#endif
@@ -46,6 +46,7 @@ MAKE_PSTR_WORD(restart)
 MAKE_PSTR_WORD(format)
 MAKE_PSTR_WORD(raw)
 MAKE_PSTR_WORD(watch)
+MAKE_PSTR_WORD(capture)
 MAKE_PSTR_WORD(syslog_level)
 MAKE_PSTR_WORD(send)
 MAKE_PSTR_WORD(telegram)
@@ -127,6 +128,11 @@ MAKE_PSTR(deep_optional, "[deep]")
 MAKE_PSTR(watchid_optional, "[ID]")
 MAKE_PSTR(watch_format_optional, "[off | on | raw | unknown]")
 MAKE_PSTR(invalid_watch, "Invalid watch type")
+#if defined(EMSESP_STANDALONE)
+MAKE_PSTR(capture_action_mandatory, "<start | stop | show | save | load | replay | wire>")
+#else
+MAKE_PSTR(capture_action_mandatory, "<start | stop | show | save>")
+#endif
 MAKE_PSTR(data_mandatory, "\"XX XX ...\"")
 MAKE_PSTR(asterisks, "********")
 MAKE_PSTR(n_mandatory, "<n>")
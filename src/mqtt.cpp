@@ -17,6 +17,7 @@
  */
 
 #include "mqtt.h"
+#include "jsonwriter.h"
 #include "emsesp.h"
 #include "version.h"
 
@@ -34,20 +35,39 @@ uint32_t    Mqtt::publish_time_solar_;
 uint32_t    Mqtt::publish_time_mixer_;
 uint32_t    Mqtt::publish_time_sensor_;
 uint32_t    Mqtt::publish_time_other_;
+uint16_t    Mqtt::publish_budget_;
+int32_t     Mqtt::publish_tokens_;
+std::string Mqtt::ha_config_;
 bool        Mqtt::mqtt_enabled_;
 uint8_t     Mqtt::ha_climate_format_;
 bool        Mqtt::ha_enabled_;
 uint8_t     Mqtt::nested_format_;
+uint8_t     Mqtt::payload_format_;
+bool        Mqtt::publish_single_;
 bool        Mqtt::send_response_;
 
-std::deque<Mqtt::QueuedMqttMessage> Mqtt::mqtt_messages_;
-std::vector<Mqtt::MQTTSubFunction>  Mqtt::mqtt_subfunctions_;
-
-uint16_t Mqtt::mqtt_publish_fails_ = 0;
-bool     Mqtt::connecting_         = false;
-bool     Mqtt::initialized_        = false;
-uint8_t  Mqtt::connectcount_       = 0;
-uint16_t Mqtt::mqtt_message_id_    = 0;
+std::deque<Mqtt::QueuedMqttMessage>  Mqtt::mqtt_messages_;
+std::vector<Mqtt::MQTTSubFunction>   Mqtt::mqtt_subfunctions_;
+TopicTrie                            Mqtt::topics_;
+std::vector<Mqtt::HaConfigHash>      Mqtt::ha_hashes_;
+std::vector<Mqtt::QueuedClientEvent> Mqtt::client_events_;
+std::mutex                           Mqtt::client_events_mutex_;
+
+uint16_t Mqtt::mqtt_publish_fails_    = 0;
+bool     Mqtt::connecting_            = false;
+bool     Mqtt::clean_session_         = true;
+bool     Mqtt::initialized_           = false;
+uint8_t  Mqtt::connectcount_          = 0;
+uint16_t Mqtt::mqtt_message_id_       = 0;
+uint32_t Mqtt::mqtt_publish_drops_    = 0;
+uint32_t Mqtt::mqtt_publish_replaced_ = 0;
+uint16_t Mqtt::mqtt_queue_max_        = 0;
+uint16_t Mqtt::mqtt_inflight_         = 0;
+uint16_t Mqtt::mqtt_drain_rate_       = 0;
+uint32_t Mqtt::mqtt_drain_bytes_      = 0;
+bool     Mqtt::ha_hashes_changed_     = false;
+bool     Mqtt::ha_resend_             = false;
+uint32_t Mqtt::ha_configs_skipped_    = 0;
 char     will_topic_[Mqtt::MQTT_TOPIC_MAX_SIZE]; // because MQTT library keeps only char pointer
 
 uuid::log::Logger Mqtt::logger_{F_(mqtt), uuid::log::Facility::DAEMON};
@@ -58,17 +78,20 @@ uuid::log::Logger Mqtt::logger_{F_(mqtt), uuid::log::Facility::DAEMON};
 void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_sub_function_p cb) {
     // check if we already have the topic subscribed for this specific device type, if so don't add it again
     // add the function (in case its not there) and quit because it already exists
-    if (!mqtt_subfunctions_.empty()) {
-        for (auto & mqtt_subfunction : mqtt_subfunctions_) {
-            if ((mqtt_subfunction.device_type_ == device_type) && (strcmp(mqtt_subfunction.topic_.c_str(), topic.c_str()) == 0)) {
-                if (cb) {
-                    mqtt_subfunction.mqtt_subfunction_ = cb;
-                }
-                return; // exit - don't add
+    for (uint16_t i = 0; i < mqtt_subfunctions_.size(); i++) {
+        auto & mqtt_subfunction = mqtt_subfunctions_[i];
+        if ((mqtt_subfunction.device_type_ == device_type) && (strcmp(mqtt_subfunction.topic_.c_str(), topic.c_str()) == 0)) {
+            if (cb) {
+                mqtt_subfunction.mqtt_subfunction_ = cb;
+                topics_.add(topic.c_str(), ROUTE_CALLBACK | i);
             }
+            return; // exit - don't add
         }
     }
 
+    // a callback gets the messages of exactly this topic, otherwise they are commands for the device
+    topics_.add(topic.c_str(), cb ? (ROUTE_CALLBACK | mqtt_subfunctions_.size()) : device_type);
+
     // register in our libary with the callback function.
     // We store the original topic string without base
     mqtt_subfunctions_.emplace_back(device_type, std::move(topic), std::move(cb));
@@ -81,6 +104,16 @@ void Mqtt::subscribe(const uint8_t device_type, const std::string & topic, mqtt_
     queue_subscribe_message(topic);
 }
 
+// route the topic <device>/... to the commands of the device, unless there is a callback on it
+void Mqtt::add_command_topic(const uint8_t device_type) {
+    char topic[30];
+    strlcpy(topic, EMSdevice::device_type_2_device_name(device_type).c_str(), sizeof(topic));
+    const char * rest;
+    if (topics_.find(topic, rest) == TopicTrie::NONE || *rest) {
+        topics_.add(topic, device_type);
+    }
+}
+
 // resubscribe to all MQTT topics
 // if it's already in the queue, ignore it
 void Mqtt::resubscribe() {
@@ -102,6 +135,9 @@ void Mqtt::resubscribe() {
 
 // Main MQTT loop - sends out top item on publish queue
 void Mqtt::loop() {
+    // ACKs and (dis)connects from the MQTT client task
+    process_client_events();
+
     // exit if MQTT is not enabled or if there is no network connection
     if (!connected()) {
         return;
@@ -109,11 +145,8 @@ void Mqtt::loop() {
 
     uint32_t currentMillis = uuid::get_uptime();
 
-    // publish top item from MQTT queue to stop flooding
-    if ((uint32_t)(currentMillis - last_mqtt_poll_) > MQTT_PUBLISH_WAIT) {
-        last_mqtt_poll_ = currentMillis;
-        process_queue();
-    }
+    // publish from the MQTT queue, paced by the TCP send window and the byte budget
+    process_queue();
 
     // dallas publish on change
     if (!publish_time_sensor_) {
@@ -124,6 +157,22 @@ void Mqtt::loop() {
         return;
     }
 
+    // a config was dropped from the queue, create them again. Those the broker already has are skipped
+    if (ha_resend_) {
+        ha_resend_ = false;
+        if (ha_enabled_) {
+            ha_status();
+            EMSESP::reset_mqtt_ha(false);
+        }
+        return;
+    }
+
+    // the queue is empty, so all HA configs have been sent
+    if (ha_hashes_changed_ && (currentMillis - last_save_ha_hashes_ > HA_HASHES_SAVE_WAIT)) {
+        last_save_ha_hashes_ = currentMillis;
+        save_ha_hashes();
+    }
+
     // create publish messages for each of the EMS device values, adding to queue, only one device per loop
     if (publish_time_boiler_ && (currentMillis - last_publish_boiler_ > publish_time_boiler_)) {
         last_publish_boiler_ = (currentMillis / publish_time_boiler_) * publish_time_boiler_;
@@ -160,7 +209,24 @@ void Mqtt::loop() {
 void Mqtt::show_mqtt(uuid::console::Shell & shell) {
     shell.printfln(F("MQTT is %s"), connected() ? read_flash_string(F_(connected)).c_str() : read_flash_string(F_(disconnected)).c_str());
 
-    shell.printfln(F("MQTT publish errors: %lu"), mqtt_publish_fails_);
+    shell.printfln(F("MQTT publish errors: %u"), (unsigned int)mqtt_publish_fails_);
+    shell.printfln(F("MQTT queue: %u messages (max %u), %u in flight, %lu replaced, %lu dropped"),
+                   (unsigned int)mqtt_messages_.size(),
+                   (unsigned int)mqtt_queue_max_,
+                   (unsigned int)mqtt_inflight_,
+                   (unsigned long)mqtt_publish_replaced_,
+                   (unsigned long)mqtt_publish_drops_);
+    if (publish_budget_) {
+        shell.printfln(F("MQTT drain rate: %u messages/s, %lu bytes/s (budget %u bytes/s)"),
+                       (unsigned int)mqtt_drain_rate_,
+                       (unsigned long)mqtt_drain_bytes_,
+                       (unsigned int)publish_budget_);
+    } else {
+        shell.printfln(F("MQTT drain rate: %u messages/s, %lu bytes/s (no budget)"), (unsigned int)mqtt_drain_rate_, (unsigned long)mqtt_drain_bytes_);
+    }
+    if (ha_enabled_) {
+        shell.printfln(F("MQTT HA configs: %u sent, %lu unchanged and skipped"), (unsigned int)ha_hashes_.size(), (unsigned long)ha_configs_skipped_);
+    }
     shell.println();
 
     // show subscriptions
@@ -177,7 +243,7 @@ void Mqtt::show_mqtt(uuid::console::Shell & shell) {
         return;
     }
 
-    shell.printfln(F("MQTT queue (%d/%d messages):"), mqtt_messages_.size(), MAX_MQTT_MESSAGES);
+    shell.printfln(F("MQTT queue (%u/%u messages):"), (unsigned int)mqtt_messages_.size(), (unsigned int)MAX_MQTT_MESSAGES);
 
     for (const auto & message : mqtt_messages_) {
         auto content = message.content_;
@@ -217,18 +283,30 @@ void Mqtt::show_mqtt(uuid::console::Shell & shell) {
 void Mqtt::incoming(const char * topic, const char * payload) {
     on_message(topic, payload, strlen(payload));
 }
+
+// simulate receiving an ACK for a QoS 1 or 2 publish, used only for testing
+void Mqtt::incoming_ack(uint16_t packet_id) {
+    on_publish(packet_id);
+}
 #endif
 
 // received an MQTT message that we subscribed too
 // topic is the full path
 // payload is json or a single string and converted to a json with key 'value'
 void Mqtt::on_message(const char * topic, const char * payload, size_t len) {
-    // sometimes the payload is not terminated correctly, so make a copy
-    // convert payload to a null-terminated char string
-    char message[len + 2] = {'\0'};
+    // the payload is not null terminated, so make a copy
+    char message[MQTT_PAYLOAD_MAX_SIZE];
+    if (len >= sizeof(message)) {
+        LOG_ERROR(F("error: payload too long (%d bytes) for topic %s"), len, topic);
+        if (send_response_) {
+            Mqtt::publish(F_(response), "error: payload too long");
+        }
+        return;
+    }
     if (payload != nullptr) {
-        strlcpy(message, payload, len + 1);
+        memcpy(message, payload, len);
     }
+    message[len] = '\0';
 
 #if defined(EMSESP_DEBUG)
     if (len) {
@@ -238,22 +316,27 @@ void Mqtt::on_message(const char * topic, const char * payload, size_t len) {
     }
 #endif
 
+    // strip the base and look up the rest of the topic
+    uint16_t     route    = TopicTrie::NONE;
+    const char * command  = nullptr;
+    size_t       base_len = mqtt_base_.length();
+    if (!strncmp(topic, mqtt_base_.c_str(), base_len) && (topic[base_len] == '/')) {
+        route = topics_.find(topic + base_len + 1, command);
+    }
+
     // check first againts any of our subscribed topics
-    for (const auto & mf : mqtt_subfunctions_) {
-        // add the base back
-        char full_topic[MQTT_TOPIC_MAX_SIZE];
-        snprintf(full_topic, sizeof(full_topic), "%s/%s", mqtt_base_.c_str(), mf.topic_.c_str());
-        if (!strcmp(topic, full_topic)) {
-            if (mf.mqtt_subfunction_) {
-                if (!(mf.mqtt_subfunction_)(message)) {
-                    LOG_ERROR(F("error: invalid payload %s for this topic %s"), message, topic);
-                    if (send_response_) {
-                        Mqtt::publish(F_(response), "error: invalid data");
-                    }
+    if ((route != TopicTrie::NONE) && (route & ROUTE_CALLBACK)) {
+        auto & mf = mqtt_subfunctions_[route & ~ROUTE_CALLBACK];
+        if (!*command && mf.mqtt_subfunction_) {
+            if (!(mf.mqtt_subfunction_)(message)) {
+                LOG_ERROR(F("error: invalid payload %s for this topic %s"), message, topic);
+                if (send_response_) {
+                    Mqtt::publish(F_(response), "error: invalid data");
                 }
-                return;
             }
+            return;
         }
+        route = TopicTrie::NONE;
     }
 
     StaticJsonDocument<EMSESP_JSON_SIZE_SMALL>     input_doc;
@@ -271,9 +354,15 @@ void Mqtt::on_message(const char * topic, const char * payload, size_t len) {
     }
 
     // parse and call the command
-    input               = input_doc.as<JsonObject>();
-    output              = output_doc.to<JsonObject>();
-    uint8_t return_code = Command::process(topic, true, input, output); // mqtt is always authenticated
+    input  = input_doc.as<JsonObject>();
+    output = output_doc.to<JsonObject>();
+
+    uint8_t return_code;
+    if (route != TopicTrie::NONE) {
+        return_code = Command::process(route, command, true, input, output); // mqtt is always authenticated
+    } else {
+        return_code = Command::process(topic, true, input, output); // unknown topic, this gives the error
+    }
 
     if (return_code != CommandRet::OK) {
         char error[100];
@@ -317,34 +406,83 @@ void Mqtt::show_topic_handlers(uuid::console::Shell & shell, const uint8_t devic
 // check if ACK matches the last Publish we sent, if not report an error. Only if qos is 1 or 2
 // and always remove from queue
 void Mqtt::on_publish(uint16_t packetId) {
-    // find the MQTT message in the queue and remove it
-    if (mqtt_messages_.empty()) {
+    // find the in-flight MQTT message in the queue and remove it
+    for (auto it = mqtt_messages_.begin(); it != mqtt_messages_.end(); ++it) {
+        if (it->packet_id_ == packetId) {
 #if defined(EMSESP_DEBUG)
-        LOG_DEBUG(F("[DEBUG] No message stored for ACK pid %d"), packetId);
+            LOG_DEBUG(F("[DEBUG] ACK pid %d"), packetId);
 #endif
-        return;
+            ha_config_sent(*it->content_);
+            mqtt_messages_.erase(it);
+            mqtt_inflight_--;
+            return;
+        }
     }
 
-    auto mqtt_message = mqtt_messages_.front();
-
-    // if the last published failed, don't bother checking it. wait for the next retry
-    if (mqtt_message.packet_id_ == 0) {
 #if defined(EMSESP_DEBUG)
-        LOG_DEBUG(F("[DEBUG] ACK for failed message pid 0"));
+    LOG_DEBUG(F("[DEBUG] No message stored for ACK pid %d"), packetId);
 #endif
-        return;
-    }
+}
 
-    if (mqtt_message.packet_id_ != packetId) {
-        LOG_ERROR(F("Mismatch, expecting PID %d, got %d"), mqtt_message.packet_id_, packetId);
-        mqtt_publish_fails_++; // increment error count
+// called from the MQTT client task, the event is handled in the main loop
+void Mqtt::post_client_event(const uint8_t event, const uint16_t value) {
+    std::lock_guard<std::mutex> lock(client_events_mutex_);
+    client_events_.push_back({event, value});
+}
+
+void Mqtt::process_client_events() {
+    std::vector<QueuedClientEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(client_events_mutex_);
+        if (client_events_.empty()) {
+            return;
+        }
+        events.swap(client_events_);
     }
 
-#if defined(EMSESP_DEBUG)
-    LOG_DEBUG(F("[DEBUG] ACK pid %d"), packetId);
-#endif
+    for (const auto & event : events) {
+        if (event.event == EVENT_CONNECT) {
+            on_connect(event.value);
+        } else if (event.event == EVENT_DISCONNECT) {
+            on_disconnect(static_cast<AsyncMqttClientDisconnectReason>(event.value));
+        } else {
+            on_publish(event.value);
+        }
+    }
+}
 
-    mqtt_messages_.pop_front(); // always remove from queue, regardless if there was a successful ACK
+// MQTT onDisconnect, the messages waiting for an ACK will not get one
+void Mqtt::on_disconnect(const AsyncMqttClientDisconnectReason reason) {
+    if (!connecting_) {
+        return;
+    }
+    connecting_ = false;
+    if (reason == AsyncMqttClientDisconnectReason::TCP_DISCONNECTED) {
+        LOG_INFO(F("MQTT disconnected: TCP"));
+    }
+    if (reason == AsyncMqttClientDisconnectReason::MQTT_IDENTIFIER_REJECTED) {
+        LOG_INFO(F("MQTT disconnected: Identifier Rejected"));
+    }
+    if (reason == AsyncMqttClientDisconnectReason::MQTT_SERVER_UNAVAILABLE) {
+        LOG_INFO(F("MQTT disconnected: Server unavailable"));
+    }
+    if (reason == AsyncMqttClientDisconnectReason::MQTT_MALFORMED_CREDENTIALS) {
+        LOG_INFO(F("MQTT disconnected: Malformed credentials"));
+    }
+    if (reason == AsyncMqttClientDisconnectReason::MQTT_NOT_AUTHORIZED) {
+        LOG_INFO(F("MQTT disconnected: Not authorized"));
+    }
+    // remove messages with pending ack
+    for (auto it = mqtt_messages_.begin(); it != mqtt_messages_.end();) {
+        if (it->packet_id_ != 0) {
+            ha_config_dropped(*it->content_);
+            it = mqtt_messages_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    mqtt_inflight_ = 0;
+    // mqtt_messages_.clear();
 }
 
 // called when MQTT settings have changed via the Web forms
@@ -353,6 +491,8 @@ void Mqtt::reset_mqtt() {
         return;
     }
 
+    clear_ha_hashes(); // the topics and configs may have changed, so send them all again
+
     if (mqttClient_->connected()) {
         mqttClient_->disconnect(true); // force a disconnect
     }
@@ -367,7 +507,12 @@ void Mqtt::load_settings() {
         ha_enabled_        = mqttSettings.ha_enabled;
         ha_climate_format_ = mqttSettings.ha_climate_format;
         nested_format_     = mqttSettings.nested_format;
+        payload_format_    = mqttSettings.payload_format;
+        publish_single_    = mqttSettings.publish_single;
         send_response_     = mqttSettings.send_response;
+        clean_session_     = mqttSettings.cleanSession;
+        publish_budget_    = mqttSettings.publish_budget;
+        publish_tokens_    = publish_budget_;
 
         // convert to milliseconds
         publish_time_boiler_     = mqttSettings.publish_time_boiler * 1000;
@@ -394,37 +539,11 @@ void Mqtt::start() {
     }
     initialized_ = true;
 
-    mqttClient_->onConnect([this](bool sessionPresent) { on_connect(); });
+    load_ha_hashes();
 
-    mqttClient_->onDisconnect([this](AsyncMqttClientDisconnectReason reason) {
-        if (!connecting_) {
-            return;
-        }
-        connecting_ = false;
-        if (reason == AsyncMqttClientDisconnectReason::TCP_DISCONNECTED) {
-            LOG_INFO(F("MQTT disconnected: TCP"));
-        }
-        if (reason == AsyncMqttClientDisconnectReason::MQTT_IDENTIFIER_REJECTED) {
-            LOG_INFO(F("MQTT disconnected: Identifier Rejected"));
-        }
-        if (reason == AsyncMqttClientDisconnectReason::MQTT_SERVER_UNAVAILABLE) {
-            LOG_INFO(F("MQTT disconnected: Server unavailable"));
-        }
-        if (reason == AsyncMqttClientDisconnectReason::MQTT_MALFORMED_CREDENTIALS) {
-            LOG_INFO(F("MQTT disconnected: Malformed credentials"));
-        }
-        if (reason == AsyncMqttClientDisconnectReason::MQTT_NOT_AUTHORIZED) {
-            LOG_INFO(F("MQTT disconnected: Not authorized"));
-        }
-        // remove message with pending ack
-        if (!mqtt_messages_.empty()) {
-            auto mqtt_message = mqtt_messages_.front();
-            if (mqtt_message.packet_id_ != 0) {
-                mqtt_messages_.pop_front();
-            }
-        }
-        // mqtt_messages_.clear();
-    });
+    mqttClient_->onConnect([](bool sessionPresent) { post_client_event(EVENT_CONNECT, sessionPresent); });
+
+    mqttClient_->onDisconnect([](AsyncMqttClientDisconnectReason reason) { post_client_event(EVENT_DISCONNECT, static_cast<uint16_t>(reason)); });
 
     // create will_topic with the base prefixed. It has to be static because asyncmqttclient destroys the reference
     static char will_topic[MQTT_TOPIC_MAX_SIZE];
@@ -432,11 +551,14 @@ void Mqtt::start() {
     mqttClient_->setWill(will_topic, 1, true, "offline"); // with qos 1, retain true
 
     mqttClient_->onMessage([this](char * topic, char * payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total) {
-        on_message(topic, payload, len); // receiving mqtt
+        // receiving mqtt, in the MQTT client task so the command is run from the main loop
+        std::string t(topic);
+        std::string p(payload ? payload : "", payload ? len : 0);
+        (void)EMSESP::commandqueue_.post([this, t, p]() { on_message(t.c_str(), p.c_str(), p.length()); });
     });
 
-    mqttClient_->onPublish([this](uint16_t packetId) {
-        on_publish(packetId); // publish
+    mqttClient_->onPublish([](uint16_t packetId) {
+        post_client_event(EVENT_ACK, packetId); // publish
     });
 }
 
@@ -464,6 +586,11 @@ void Mqtt::set_publish_time_sensor(uint16_t publish_time) {
     publish_time_sensor_ = publish_time * 1000; // convert to milliseconds
 }
 
+void Mqtt::set_publish_budget(uint16_t publish_budget) {
+    publish_budget_ = publish_budget; // bytes per second, 0 is no limit
+    publish_tokens_ = publish_budget;
+}
+
 bool Mqtt::get_publish_onchange(uint8_t device_type) {
     if (device_type == EMSdevice::DeviceType::BOILER) {
         if (!publish_time_boiler_) {
@@ -489,7 +616,8 @@ bool Mqtt::get_publish_onchange(uint8_t device_type) {
 
 // MQTT onConnect - when an MQTT connect is established
 // send out some inital MQTT messages
-void Mqtt::on_connect() {
+// session_present is false if the broker has no session for us
+void Mqtt::on_connect(const bool session_present) {
     if (connecting_) { // prevent duplicated connections
         return;
     }
@@ -501,6 +629,12 @@ void Mqtt::on_connect() {
 
     load_settings(); // reload MQTT settings - in case they have changes
 
+    // without a session the broker may have lost the retained HA configs as well, e.g. after a restart, so send them all
+    // a clean session never has one, then only the first connect after our own restart relies on the stored hashes
+    if (!session_present && (!clean_session_ || (connectcount_ > 1))) {
+        clear_ha_hashes();
+    }
+
     // send info topic appended with the version information as JSON
     StaticJsonDocument<EMSESP_JSON_SIZE_MEDIUM> doc;
     // first time to connect
@@ -551,7 +685,7 @@ void Mqtt::on_connect() {
     // re-subscribe to all custom registered MQTT topics
     resubscribe();
 
-    EMSESP::reset_mqtt_ha(); // re-create all HA devices if there are any
+    EMSESP::reset_mqtt_ha(false); // re-create all HA devices if there are any, the broker has the unchanged ones retained
 
     publish_retain(F("status"), "online", true); // say we're alive to the Last Will topic, with retain on
 
@@ -631,10 +765,16 @@ void Mqtt::ha_status() {
     publish_ha_sensor_config(DeviceValueType::INT, DeviceValueTAG::TAG_HEARTBEAT, F("Tx fails"), EMSdevice::DeviceType::SYSTEM, F("txfails"), DeviceValueUOM::TIMES);
 }
 
+// topics of events like command responses, where each message counts and a later one must not replace an earlier one
+static bool is_event_topic(const std::string & topic) {
+    return (topic == read_flash_string(F_(response))) || (topic == read_flash_string(F_(info))) || (topic == "message") || (topic == "shower_data");
+}
+
 // add sub or pub task to the queue.
 // returns a pointer to the message created
 // the base is not included in the topic
-std::shared_ptr<const MqttMessage> Mqtt::queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain) {
+// the payload is moved into the message, so callers passing a temporary avoid a copy
+std::shared_ptr<const MqttMessage> Mqtt::queue_message(const uint8_t operation, const std::string & topic, std::string payload, bool retain) {
     if (topic.empty()) {
         return nullptr;
     }
@@ -651,7 +791,23 @@ std::shared_ptr<const MqttMessage> Mqtt::queue_message(const uint8_t operation,
 
     // take the topic and prefix the base, unless its for HA
     std::shared_ptr<MqttMessage> message;
-    message = std::make_shared<MqttMessage>(operation, topic, payload, retain);
+    message = std::make_shared<MqttMessage>(operation, topic, std::move(payload), retain);
+
+    // if the topic of a state is still waiting on the queue, only the latest payload is useful. Replace it in place to keep the order
+    // messages already published and waiting for their ACK are left alone
+    // ACKs and disconnects are applied in loop() too, so the entry can't be erased while it is replaced
+    if ((operation == Operation::PUBLISH) && !is_event_topic(topic)) {
+        for (auto & queued_message : mqtt_messages_) {
+            if ((queued_message.packet_id_ == 0) && (queued_message.content_->operation == Operation::PUBLISH) && (queued_message.content_->topic == topic)) {
+#ifdef EMSESP_DEBUG
+                LOG_INFO("[DEBUG] Replacing in queue: (Publish) topic='%s' payload=%s", message->topic.c_str(), message->payload.c_str());
+#endif
+                queued_message.content_ = std::move(message);
+                mqtt_publish_replaced_++;
+                return queued_message.content_;
+            }
+        }
+    }
 
 #ifdef EMSESP_DEBUG
     if (operation == Operation::PUBLISH) {
@@ -667,19 +823,27 @@ std::shared_ptr<const MqttMessage> Mqtt::queue_message(const uint8_t operation,
 
     // if the queue is full, make room but removing the last one
     if (mqtt_messages_.size() >= MAX_MQTT_MESSAGES) {
+        if (mqtt_messages_.front().packet_id_ != 0) {
+            mqtt_inflight_--;
+        }
+        ha_config_dropped(*mqtt_messages_.front().content_);
         mqtt_messages_.pop_front();
+        mqtt_publish_drops_++;
     }
     mqtt_messages_.emplace_back(mqtt_message_id_++, std::move(message));
+    if (mqtt_messages_.size() > mqtt_queue_max_) {
+        mqtt_queue_max_ = mqtt_messages_.size();
+    }
 
     return mqtt_messages_.back().content_; // this is because the message has been moved
 }
 
 // add MQTT message to queue, payload is a string
-std::shared_ptr<const MqttMessage> Mqtt::queue_publish_message(const std::string & topic, const std::string & payload, bool retain) {
+std::shared_ptr<const MqttMessage> Mqtt::queue_publish_message(const std::string & topic, std::string payload, bool retain) {
     if (!enabled()) {
         return nullptr;
     };
-    return queue_message(Operation::PUBLISH, topic, payload, retain);
+    return queue_message(Operation::PUBLISH, topic, std::move(payload), retain);
 }
 
 // add MQTT subscribe message to queue
@@ -692,6 +856,11 @@ void Mqtt::publish(const std::string & topic, const std::string & payload) {
     queue_publish_message(topic, payload, mqtt_retain_);
 }
 
+// MQTT Publish, using a user's retain flag. The payload buffer is handed over to the queue without a copy
+void Mqtt::publish(const std::string & topic, std::string && payload) {
+    queue_publish_message(topic, std::move(payload), mqtt_retain_);
+}
+
 // MQTT Publish, using a user's retain flag - except for char * strings
 void Mqtt::publish(const __FlashStringHelper * topic, const char * payload) {
     queue_publish_message(read_flash_string(topic), payload, mqtt_retain_);
@@ -726,7 +895,7 @@ void Mqtt::publish_retain(const std::string & topic, const JsonObject & payload,
     if (enabled() && payload.size()) {
         std::string payload_text;
         serializeJson(payload, payload_text); // convert json to string
-        queue_publish_message(topic, payload_text, retain);
+        queue_publish_message(topic, std::move(payload_text), retain);
     }
 }
 
@@ -749,6 +918,8 @@ void Mqtt::publish_ha(const std::string & topic) {
     LOG_DEBUG(F("[DEBUG] Publishing empty HA topic=%s"), fulltopic.c_str());
 #endif
 
+    ha_config_removed(fulltopic.c_str());
+
     publish(fulltopic); // call it immediately, don't queue it
 }
 
@@ -763,6 +934,10 @@ void Mqtt::publish_ha(const std::string & topic, const JsonObject & payload) {
     serializeJson(payload, payload_text); // convert json to string
 
     std::string fulltopic = read_flash_string(F_(homeassistant)) + topic;
+    if (ha_config_unchanged(fulltopic.c_str(), payload_text)) {
+        return;
+    }
+
 #if defined(EMSESP_STANDALONE)
     LOG_DEBUG(F("Publishing HA topic=%s, payload=%s"), fulltopic.c_str(), payload_text.c_str());
 #elif defined(EMSESP_DEBUG)
@@ -770,85 +945,228 @@ void Mqtt::publish_ha(const std::string & topic, const JsonObject & payload) {
 #endif
 
     // queue messages if the MQTT connection is not yet established. to ensure we don't miss messages
-    queue_publish_message(fulltopic, payload_text, true); // with retain true
+    queue_publish_message(fulltopic, std::move(payload_text), true); // with retain true
 }
 
-// take top from queue and perform the publish or subscribe action
-// assumes there is an MQTT connection
-void Mqtt::process_queue() {
-    if (mqtt_messages_.empty()) {
+// a retained HA config, not the removal of one
+static bool is_ha_config(const MqttMessage & message) {
+    return message.retain && !message.payload.empty() && (strncmp(message.topic.c_str(), "homeassistant/", 14) == 0);
+}
+
+// returns true if the broker already has this HA config retained, so it doesn't need to be sent
+bool Mqtt::ha_config_unchanged(const char * topic, const std::string & payload) {
+    uint32_t topic_hash = Helpers::hash(topic, strlen(topic));
+
+    auto it = std::lower_bound(ha_hashes_.begin(), ha_hashes_.end(), topic_hash, [](const HaConfigHash & h, uint32_t t) { return h.topic_ < t; });
+    if ((it != ha_hashes_.end()) && (it->topic_ == topic_hash) && (it->config_ == Helpers::hash(payload.c_str(), payload.size()))) {
+        ha_configs_skipped_++;
+        return true;
+    }
+
+    return false;
+}
+
+// the HA config is published, or with QoS 1 and 2 acknowledged, so remember it as retained by the broker
+void Mqtt::ha_config_sent(const MqttMessage & message) {
+    if (!is_ha_config(message)) {
         return;
     }
 
-    // fetch first from queue and create the full topic name
-    auto mqtt_message = mqtt_messages_.front();
-    auto message      = mqtt_message.content_;
-    char topic[MQTT_TOPIC_MAX_SIZE];
+    uint32_t topic_hash  = Helpers::hash(message.topic.c_str(), message.topic.size());
+    uint32_t config_hash = Helpers::hash(message.payload.c_str(), message.payload.size());
 
-    if (message->topic.find(read_flash_string(F_(homeassistant))) == 0) {
-        strcpy(topic, message->topic.c_str()); // leave topic as it is
+    auto it = std::lower_bound(ha_hashes_.begin(), ha_hashes_.end(), topic_hash, [](const HaConfigHash & h, uint32_t t) { return h.topic_ < t; });
+    if ((it != ha_hashes_.end()) && (it->topic_ == topic_hash)) {
+        if (it->config_ == config_hash) {
+            return;
+        }
+        it->config_ = config_hash;
     } else {
-        snprintf(topic, MQTT_TOPIC_MAX_SIZE, "%s/%s", mqtt_base_.c_str(), message->topic.c_str());
+        if (ha_hashes_.size() >= HA_HASHES_MAX) {
+            ha_hashes_.clear(); // mostly old topics, e.g. after changing the base
+            it = ha_hashes_.end();
+        }
+        ha_hashes_.insert(it, {topic_hash, config_hash});
     }
 
-    // if we're subscribing...
-    if (message->operation == Operation::SUBSCRIBE) {
-        LOG_DEBUG(F("Subscribing to topic '%s'"), topic);
-        uint16_t packet_id = mqttClient_->subscribe(topic, mqtt_qos_);
-        if (!packet_id) {
-            LOG_ERROR(F("Error subscribing to topic '%s'"), topic);
-        }
+    ha_hashes_changed_ = true;
+}
+
+// the HA config was removed from the queue without reaching the broker, so it has to be sent again
+void Mqtt::ha_config_dropped(const MqttMessage & message) {
+    if (!is_ha_config(message)) {
+        return;
+    }
 
-        mqtt_messages_.pop_front(); // remove the message from the queue
+    ha_config_removed(message.topic.c_str());
+    ha_resend_ = true;
+}
+
+// the HA config is removed from the broker
+void Mqtt::ha_config_removed(const char * topic) {
+    uint32_t topic_hash = Helpers::hash(topic, strlen(topic));
+
+    auto it = std::lower_bound(ha_hashes_.begin(), ha_hashes_.end(), topic_hash, [](const HaConfigHash & h, uint32_t t) { return h.topic_ < t; });
+    if ((it != ha_hashes_.end()) && (it->topic_ == topic_hash)) {
+        ha_hashes_.erase(it);
+        ha_hashes_changed_ = true;
+    }
+}
+
+// forget all HA configs, so they will be sent again
+void Mqtt::clear_ha_hashes() {
+    if (!ha_hashes_.empty()) {
+        ha_hashes_.clear();
+        ha_hashes_changed_ = true;
+    }
+}
+
+// reads the hashes of the HA configs sent before the restart
+void Mqtt::load_ha_hashes() {
+    ha_hashes_.clear();
+    ha_hashes_changed_ = false;
 
+#ifndef EMSESP_STANDALONE
+    File file = LITTLEFS.open(HA_HASHES_FILENAME, "r");
+    if (!file) {
         return;
     }
+    size_t count = file.size() / sizeof(HaConfigHash);
+    if (count <= HA_HASHES_MAX) {
+        ha_hashes_.resize(count);
+        if (file.read(reinterpret_cast<uint8_t *>(ha_hashes_.data()), count * sizeof(HaConfigHash)) != count * sizeof(HaConfigHash)) {
+            ha_hashes_.clear();
+        }
+    }
+    file.close();
+    LOG_DEBUG(F("Loaded %d HA config hashes"), ha_hashes_.size());
+#endif
+}
 
-    // if this has already been published and we're waiting for an ACK, don't publish again
-    // it will have a real packet ID
-    if (mqtt_message.packet_id_ > 0) {
-#if defined(EMSESP_DEBUG)
-        LOG_DEBUG(F("[DEBUG] Waiting for QOS-ACK"));
+// writes the hashes of the HA configs, called when all have been sent
+void Mqtt::save_ha_hashes() {
+    ha_hashes_changed_ = false;
+
+#ifndef EMSESP_STANDALONE
+    File file = LITTLEFS.open(HA_HASHES_FILENAME, "w");
+    if (!file) {
+        LOG_ERROR(F("Failed to save HA config hashes"));
+        return;
+    }
+    file.write(reinterpret_cast<const uint8_t *>(ha_hashes_.data()), ha_hashes_.size() * sizeof(HaConfigHash));
+    file.close();
 #endif
+}
+
+// take messages from the queue and perform the publish or subscribe action
+// as many as the TCP send window, the byte budget and the in-flight window for QoS 1 and 2 allow
+// assumes there is an MQTT connection
+void Mqtt::process_queue() {
+    uint32_t now = uuid::get_uptime();
+
+    // refill the byte budget, allowing a burst of up to one second
+    // the loop runs every few ms, so what doesn't make up a whole byte yet is kept for the next time
+    if (publish_budget_) {
+        uint32_t refill = std::min(now - last_mqtt_poll_, (uint32_t)1000) * publish_budget_ + publish_tokens_fraction_;
+        publish_tokens_ += refill / 1000;
+        publish_tokens_fraction_ = refill % 1000;
+        if (publish_tokens_ > publish_budget_) {
+            publish_tokens_          = publish_budget_;
+            publish_tokens_fraction_ = 0;
+        }
+    }
+    last_mqtt_poll_ = now;
+
+    // update the drain rate every second
+    if (now - last_drain_time_ >= 1000) {
+        mqtt_drain_rate_  = drain_count_ * 1000 / (now - last_drain_time_);
+        mqtt_drain_bytes_ = drain_bytes_ * 1000 / (now - last_drain_time_);
+        drain_count_      = 0;
+        drain_bytes_      = 0;
+        last_drain_time_  = now;
+    }
+
+    // after a failed publish wait a bit before trying again
+    if ((int32_t)(now - publish_wait_until_) < 0) {
         return;
     }
 
-    // else try and publish it
-    uint16_t packet_id = mqttClient_->publish(topic, mqtt_qos_, message->retain, message->payload.c_str(), message->payload.size(), false, mqtt_message.id_);
-    LOG_DEBUG(F("Publishing topic %s (#%02d, retain=%d, retry=%d, size=%d, pid=%d)"),
-              topic,
-              mqtt_message.id_,
-              message->retain,
-              mqtt_message.retry_count_ + 1,
-              message->payload.size(),
-              packet_id);
-
-    if (packet_id == 0) {
-        // it failed. if we retried n times, give up. remove from queue
-        if (mqtt_message.retry_count_ == (MQTT_PUBLISH_MAX_RETRY - 1)) {
-            LOG_ERROR(F("Failed to publish to %s after %d attempts"), topic, mqtt_message.retry_count_ + 1);
-            mqtt_publish_fails_++;      // increment failure counter
-            mqtt_messages_.pop_front(); // delete
-            return;
+    // publish as many as possible, messages waiting for an ACK stay on the queue and are skipped
+    auto it = mqtt_messages_.begin();
+    while ((it != mqtt_messages_.end()) && (mqtt_inflight_ < MQTT_MAX_INFLIGHT) && (!publish_budget_ || (publish_tokens_ > 0))) {
+        if (it->packet_id_ > 0) {
+            ++it;
+            continue;
+        }
+
+        // create the full topic name
+        auto message = it->content_;
+        char topic[MQTT_TOPIC_MAX_SIZE];
+
+        if (message->topic.find(read_flash_string(F_(homeassistant))) == 0) {
+            strcpy(topic, message->topic.c_str()); // leave topic as it is
         } else {
-            // update the record
-            mqtt_messages_.front().retry_count_++;
-            LOG_DEBUG(F("Failed to publish to %s. Trying again, #%d"), topic, mqtt_message.retry_count_ + 1);
-            return; // leave on queue for next time so it gets republished
+            snprintf(topic, MQTT_TOPIC_MAX_SIZE, "%s/%s", mqtt_base_.c_str(), message->topic.c_str());
         }
-    }
 
-    // if we have ACK set with QOS 1 or 2, leave on queue and let the ACK process remove it
-    // but add the packet_id so we can check it later
-    if (mqtt_qos_ != 0) {
-        mqtt_messages_.front().packet_id_ = packet_id;
+        // if we're subscribing...
+        if (message->operation == Operation::SUBSCRIBE) {
+            LOG_DEBUG(F("Subscribing to topic '%s'"), topic);
+            uint16_t packet_id = mqttClient_->subscribe(topic, mqtt_qos_);
+            if (!packet_id) {
+                LOG_ERROR(F("Error subscribing to topic '%s'"), topic);
+            }
+
+            it = mqtt_messages_.erase(it); // remove the message from the queue
+            continue;
+        }
+
+        // else try and publish it
+        uint16_t packet_id = mqttClient_->publish(topic, mqtt_qos_, message->retain, message->payload.c_str(), message->payload.size(), false, it->id_);
+        LOG_DEBUG(F("Publishing topic %s (#%02d, retain=%d, retry=%d, size=%d, pid=%d)"),
+                  topic,
+                  it->id_,
+                  message->retain,
+                  it->retry_count_ + 1,
+                  message->payload.size(),
+                  packet_id);
+
+        if (packet_id == 0) {
+            // it failed, most likely the TCP send window is full. if we retried n times, give up. remove from queue
+            publish_wait_until_ = now + MQTT_PUBLISH_WAIT;
+            if (it->retry_count_ == (MQTT_PUBLISH_MAX_RETRY - 1)) {
+                LOG_ERROR(F("Failed to publish to %s after %d attempts"), topic, it->retry_count_ + 1);
+                mqtt_publish_fails_++; // increment failure counter
+                ha_config_dropped(*message);
+                mqtt_messages_.erase(it); // delete
+            } else {
+                // update the record
+                it->retry_count_++;
+                LOG_DEBUG(F("Failed to publish to %s. Trying again, #%d"), topic, it->retry_count_ + 1);
+            }
+            return; // leave the rest on queue for next time so it gets republished
+        }
+
+        size_t size = strlen(topic) + message->payload.size();
+        publish_tokens_ -= size;
+        drain_count_++;
+        drain_bytes_ += size;
+
+        // if we have ACK set with QOS 1 or 2, leave on queue and let the ACK process remove it
+        // but add the packet_id so we can check it later
+        if (mqtt_qos_ != 0) {
+            it->packet_id_ = packet_id;
+            mqtt_inflight_++;
 #if defined(EMSESP_DEBUG)
-        LOG_DEBUG(F("[DEBUG] Setting packetID for ACK to %d"), packet_id);
+            LOG_DEBUG(F("[DEBUG] Setting packetID for ACK to %d"), packet_id);
 #endif
-        return;
-    }
+            ++it;
+            continue;
+        }
 
-    mqtt_messages_.pop_front(); // remove the message from the queue
+        ha_config_sent(*message);
+        it = mqtt_messages_.erase(it); // remove the message from the queue
+    }
 }
 
 void Mqtt::publish_ha_sensor_config(uint8_t                     type, // EMSdevice::DeviceValueType
@@ -861,9 +1179,26 @@ void Mqtt::publish_ha_sensor_config(uint8_t                     type, // EMSdevi
 }
 
 
+// appends a string, which can be in flash, to a char buffer and returns the new length
+static size_t append_string(char * dest, const size_t size, size_t pos, const char * src) {
+    if (src) {
+        uint8_t c;
+        while ((pos < size - 1) && ((c = pgm_read_byte(src++)) != 0)) {
+            dest[pos++] = c;
+        }
+    }
+    dest[pos] = '\0';
+    return pos;
+}
+
+static size_t append_string(char * dest, const size_t size, size_t pos, const __FlashStringHelper * src) {
+    return append_string(dest, size, pos, reinterpret_cast<const char *>(src));
+}
+
 // HA config for a sensor and binary_sensor entity
 // entity must match the key/value pair in the *_data topic
-// note: some string copying here into chars, it looks messy but does help with heap fragmentation issues
+// the config is written straight from the flash strings into a reused buffer, so nothing is allocated until it's queued
+// the dev block only has the identifier, the full device is in the config of the device itself
 void Mqtt::publish_ha_sensor_config(uint8_t                     type, // EMSdevice::DeviceValueType
                                     uint8_t                     tag,  // EMSdevice::DeviceValueTAG
                                     const __FlashStringHelper * name,
@@ -877,79 +1212,99 @@ void Mqtt::publish_ha_sensor_config(uint8_t                     type, // EMSdevi
         return;
     }
 
-    // create the device name
-    char device_name[50];
-    strlcpy(device_name, EMSdevice::device_type_2_device_name(device_type).c_str(), sizeof(device_name));
+    const __FlashStringHelper * device_name = EMSdevice::device_type_2_flash(device_type);
+    const __FlashStringHelper * tag_name    = EMSdevice::tag_to_flash(tag);
+    bool                        have_tag    = pgm_read_byte(reinterpret_cast<const char *>(tag_name)) != '\0';
 
     // create entity by add the hc/wwc tag if present, seperating with a .
-    char new_entity[50];
+    char   new_entity[50];
+    size_t pos = 0;
     if (tag >= DeviceValueTAG::TAG_HC1) {
-        snprintf(new_entity, sizeof(new_entity), "%s.%s", EMSdevice::tag_to_string(tag).c_str(), read_flash_string(entity).c_str());
-    } else {
-        snprintf(new_entity, sizeof(new_entity), "%s", read_flash_string(entity).c_str());
+        pos = append_string(new_entity, sizeof(new_entity), pos, tag_name);
+        pos = append_string(new_entity, sizeof(new_entity), pos, ".");
     }
+    append_string(new_entity, sizeof(new_entity), pos, entity);
 
     // build unique identifier which will be used in the topic, replacing all . with _ as not to break HA
-    std::string uniq(50, '\0');
-    snprintf(&uniq[0], uniq.capacity() + 1, "%s_%s", device_name, new_entity);
-    std::replace(uniq.begin(), uniq.end(), '.', '_');
+    char uniq[70];
+    pos = append_string(uniq, sizeof(uniq), 0, device_name);
+    pos = append_string(uniq, sizeof(uniq), pos, "_");
+    append_string(uniq, sizeof(uniq), pos, new_entity);
+    std::replace(uniq, uniq + strlen(uniq), '.', '_');
 
     // create the topic
     char topic[MQTT_TOPIC_MAX_SIZE];
-    if (type == DeviceValueType::BOOL) {
-        snprintf(topic, sizeof(topic), "binary_sensor/%s/%s/config", mqtt_base_.c_str(), uniq.c_str()); // binary sensor
-    } else {
-        snprintf(topic, sizeof(topic), "sensor/%s/%s/config", mqtt_base_.c_str(), uniq.c_str()); // normal HA sensor, not a boolean one
-    }
+    pos = append_string(topic, sizeof(topic), 0, F_(homeassistant));
+    pos = append_string(topic, sizeof(topic), pos, (type == DeviceValueType::BOOL) ? "binary_sensor/" : "sensor/"); // binary sensor or normal HA sensor
+    pos = append_string(topic, sizeof(topic), pos, mqtt_base_.c_str());
+    pos = append_string(topic, sizeof(topic), pos, "/");
+    pos = append_string(topic, sizeof(topic), pos, uniq);
+    append_string(topic, sizeof(topic), pos, "/config");
 
     // if we're asking to remove this topic, send an empty payload
     // https://github.com/emsesp/EMS-ESP32/issues/196
     if (remove) {
-        LOG_WARNING(F("Lost device value for %s. Removing HA config"), uniq.c_str());
-        publish_ha(topic);
+        LOG_WARNING(F("Lost device value for %s. Removing HA config"), uniq);
+        ha_config_removed(topic);
+        publish(topic); // call it immediately, don't queue it
         return;
     }
 
-    bool have_tag = !EMSdevice::tag_to_string(tag).empty();
-
     // nested_format is 1 if nested, otherwise 2 for single topics
     bool is_nested = (nested_format_ == 1);
 
-    DynamicJsonDocument doc(EMSESP_JSON_SIZE_HA_CONFIG);
-    doc["~"]       = mqtt_base_;
-    doc["uniq_id"] = uniq;
+    ha_config_.clear();
+    JsonWriter doc(ha_config_);
+    doc.add("~", mqtt_base_.c_str());
+    doc.add("uniq_id", uniq);
+
+    // with publish_single the EMS device values have their own topic, otherwise it's taken from the json payload
+    bool is_single = publish_single_ && (device_type != EMSdevice::DeviceType::SYSTEM);
 
     // state topic
     char stat_t[MQTT_TOPIC_MAX_SIZE];
-    snprintf(stat_t, sizeof(stat_t), "~/%s", tag_to_topic(device_type, tag).c_str());
-    doc["stat_t"] = stat_t;
+    stat_t[0] = '~';
+    stat_t[1] = '/';
+    if (is_single) {
+        single_topic(&stat_t[2], sizeof(stat_t) - 2, device_type, tag, entity);
+    } else {
+        tag_to_topic(&stat_t[2], sizeof(stat_t) - 2, device_type, tag);
+    }
+    doc.add("stat_t", stat_t);
 
     // name = <device> <tag> <name>
     char new_name[80];
+    pos = append_string(new_name, sizeof(new_name), 0, device_name);
     if (have_tag) {
-        snprintf(new_name, sizeof(new_name), "%s %s %s", device_name, EMSdevice::tag_to_string(tag).c_str(), read_flash_string(name).c_str());
-    } else {
-        snprintf(new_name, sizeof(new_name), "%s %s", device_name, read_flash_string(name).c_str());
+        pos = append_string(new_name, sizeof(new_name), pos, " ");
+        pos = append_string(new_name, sizeof(new_name), pos, tag_name);
     }
+    pos         = append_string(new_name, sizeof(new_name), pos, " ");
+    pos         = append_string(new_name, sizeof(new_name), pos, name);
     new_name[0] = toupper(new_name[0]); // capitalize first letter
-    doc["name"] = new_name;
+    doc.add("name", new_name);
 
     // value template
     // if its nested mqtt format then use the appended entity name, otherwise take the original
-    char val_tpl[50];
-    if (is_nested) {
-        snprintf(val_tpl, sizeof(val_tpl), "{{value_json.%s}}", new_entity);
-    } else {
-        snprintf(val_tpl, sizeof(val_tpl), "{{value_json.%s}}", read_flash_string(entity).c_str());
+    // single topics have the plain value as payload, so no template is needed
+    if (!is_single) {
+        char val_tpl[70];
+        pos = append_string(val_tpl, sizeof(val_tpl), 0, "{{value_json.");
+        if (is_nested) {
+            pos = append_string(val_tpl, sizeof(val_tpl), pos, new_entity);
+        } else {
+            pos = append_string(val_tpl, sizeof(val_tpl), pos, entity);
+        }
+        append_string(val_tpl, sizeof(val_tpl), pos, "}}");
+        doc.add("val_tpl", val_tpl);
     }
-    doc["val_tpl"] = val_tpl;
 
     // look at the device value type
     if (type == DeviceValueType::BOOL) {
         // how to render boolean. HA only accepts String values
         char result[10];
-        doc[F("payload_on")]  = Helpers::render_boolean(result, true);
-        doc[F("payload_off")] = Helpers::render_boolean(result, false);
+        doc.add("pl_on", Helpers::render_boolean(result, true));
+        doc.add("pl_off", Helpers::render_boolean(result, false));
     } else {
         // set default state and device class for HA
         auto set_state_class  = State_class::NONE;
@@ -957,61 +1312,61 @@ void Mqtt::publish_ha_sensor_config(uint8_t                     type, // EMSdevi
 
         // unit of measure and map the HA icon
         if (uom != DeviceValueUOM::NONE) {
-            doc["unit_of_meas"] = EMSdevice::uom_to_string(uom);
+            doc.add("unit_of_meas", EMSdevice::uom_to_flash(uom));
         }
 
         switch (uom) {
         case DeviceValueUOM::DEGREES:
-            doc["ic"]        = F_(icondegrees);
+            doc.add("ic", F_(icondegrees));
             set_device_class = Device_class::TEMPERATURE;
             break;
         case DeviceValueUOM::PERCENT:
-            doc["ic"]        = F_(iconpercent);
+            doc.add("ic", F_(iconpercent));
             set_device_class = Device_class::POWER_FACTOR;
             break;
         case DeviceValueUOM::SECONDS:
         case DeviceValueUOM::MINUTES:
         case DeviceValueUOM::HOURS:
-            doc["ic"] = F_(icontime);
+            doc.add("ic", F_(icontime));
             break;
         case DeviceValueUOM::KB:
-            doc["ic"] = F_(iconkb);
+            doc.add("ic", F_(iconkb));
             break;
         case DeviceValueUOM::LMIN:
-            doc["ic"] = F_(iconlmin);
+            doc.add("ic", F_(iconlmin));
             break;
         case DeviceValueUOM::WH:
         case DeviceValueUOM::KWH:
-            doc["ic"]        = F_(iconkwh);
+            doc.add("ic", F_(iconkwh));
             set_state_class  = State_class::TOTAL_INCREASING;
             set_device_class = Device_class::ENERGY;
             break;
         case DeviceValueUOM::UA:
-            doc["ic"] = F_(iconua);
+            doc.add("ic", F_(iconua));
             break;
         case DeviceValueUOM::BAR:
-            doc["ic"]        = F_(iconbar);
+            doc.add("ic", F_(iconbar));
             set_device_class = Device_class::PRESSURE;
             break;
         case DeviceValueUOM::W:
         case DeviceValueUOM::KW:
-            doc["ic"]        = F_(iconkw);
+            doc.add("ic", F_(iconkw));
             set_state_class  = State_class::MEASUREMENT;
             set_device_class = Device_class::POWER;
             break;
         case DeviceValueUOM::DBM:
-            doc["ic"]        = F_(icondbm);
+            doc.add("ic", F_(icondbm));
             set_device_class = Device_class::SIGNAL_STRENGTH;
             break;
         case DeviceValueUOM::NONE:
             if (type == DeviceValueType::INT || type == DeviceValueType::UINT || type == DeviceValueType::SHORT || type == DeviceValueType::USHORT
                 || type == DeviceValueType::ULONG) {
-                doc["ic"] = F_(iconnum);
+                doc.add("ic", F_(iconnum));
             }
             break;
         case DeviceValueUOM::TIMES:
             set_state_class = State_class::TOTAL_INCREASING;
-            doc["ic"]       = F_(iconnum);
+            doc.add("ic", F_(iconnum));
             break;
         default:
             break;
@@ -1022,30 +1377,30 @@ void Mqtt::publish_ha_sensor_config(uint8_t                     type, // EMSdevi
         if (!has_cmd) {
             // state class
             if (set_state_class == State_class::MEASUREMENT) {
-                doc["state_class"] = F("measurement");
+                doc.add("stat_cla", F("measurement"));
             } else if (set_state_class == State_class::TOTAL_INCREASING) {
-                doc["state_class"] = F("total_increasing");
+                doc.add("stat_cla", F("total_increasing"));
             }
 
             // device class
             switch (set_device_class) {
             case Device_class::ENERGY:
-                doc["device_class"] = F("energy");
+                doc.add("dev_cla", F("energy"));
                 break;
             case Device_class::POWER:
-                doc["device_class"] = F("power");
+                doc.add("dev_cla", F("power"));
                 break;
             case Device_class::POWER_FACTOR:
-                doc["device_class"] = F("power_factor");
+                doc.add("dev_cla", F("power_factor"));
                 break;
             case Device_class::PRESSURE:
-                doc["device_class"] = F("pressure");
+                doc.add("dev_cla", F("pressure"));
                 break;
             case Device_class::SIGNAL_STRENGTH:
-                doc["device_class"] = F("signal_strength");
+                doc.add("dev_cla", F("signal_strength"));
                 break;
             case Device_class::TEMPERATURE:
-                doc["device_class"] = F("temperature");
+                doc.add("dev_cla", F("temperature"));
                 break;
             default:
                 break;
@@ -1053,36 +1408,71 @@ void Mqtt::publish_ha_sensor_config(uint8_t                     type, // EMSdevi
         }
     }
 
-    JsonObject dev = doc.createNestedObject("dev");
-    JsonArray  ids = dev.createNestedArray("ids");
-
     // for System commands we'll use the ID EMS-ESP
-    if (device_type == EMSdevice::DeviceType::SYSTEM) {
-        ids.add("ems-esp");
-    } else {
-        char ha_device[40];
-        snprintf(ha_device, sizeof(ha_device), "ems-esp-%s", device_name);
-        ids.add(ha_device);
+    char ha_device[40];
+    pos = append_string(ha_device, sizeof(ha_device), 0, "ems-esp");
+    if (device_type != EMSdevice::DeviceType::SYSTEM) {
+        pos = append_string(ha_device, sizeof(ha_device), pos, "-");
+        append_string(ha_device, sizeof(ha_device), pos, device_name);
+    }
+    doc.nested("dev");
+    doc.add("ids", ha_device);
+    doc.end();
+
+    if (ha_config_unchanged(topic, ha_config_)) {
+        return;
     }
 
-    publish_ha(topic, doc.as<JsonObject>());
+#if defined(EMSESP_STANDALONE)
+    LOG_DEBUG(F("Publishing HA topic=%s, payload=%s"), topic, ha_config_.c_str());
+#elif defined(EMSESP_DEBUG)
+    LOG_DEBUG(F("[debug] Publishing HA topic=%s, payload=%s"), topic, ha_config_.c_str());
+#endif
+
+    // the queue gets its own copy, the buffer is kept for the next config
+    queue_publish_message(topic, ha_config_, true); // with retain true
 }
 
 // based on the device and tag, create the MQTT topic name (without the basename)
 // differs based on whether MQTT nested is enabled
 // tag = EMSdevice::DeviceValueTAG
 const std::string Mqtt::tag_to_topic(uint8_t device_type, uint8_t tag) {
+    char topic[MQTT_TOPIC_MAX_SIZE];
+    return tag_to_topic(topic, sizeof(topic), device_type, tag);
+}
+
+const char * Mqtt::tag_to_topic(char * topic, size_t len, uint8_t device_type, uint8_t tag) {
+    const __FlashStringHelper * tag_mqtt = EMSdevice::tag_to_mqtt_flash(tag);
+
     // the system device is treated differently. The topic is 'heartbeat' and doesn't follow the usual convention
     if (device_type == EMSdevice::DeviceType::SYSTEM) {
-        return EMSdevice::tag_to_mqtt(tag);
+        append_string(topic, len, 0, tag_mqtt);
+        return topic;
     }
 
     // if there is a tag add it
-    if ((EMSdevice::tag_to_mqtt(tag).empty()) || ((nested_format_ == 1) && (device_type != EMSdevice::DeviceType::BOILER))) {
-        return EMSdevice::device_type_2_device_name(device_type) + "_data";
-    } else {
-        return EMSdevice::device_type_2_device_name(device_type) + "_data_" + EMSdevice::tag_to_mqtt(tag);
+    size_t pos = append_string(topic, len, 0, EMSdevice::device_type_2_flash(device_type));
+    pos        = append_string(topic, len, pos, "_data");
+    if ((pgm_read_byte(reinterpret_cast<const char *>(tag_mqtt)) != '\0') && !((nested_format_ == 1) && (device_type != EMSdevice::DeviceType::BOILER))) {
+        pos = append_string(topic, len, pos, "_");
+        append_string(topic, len, pos, tag_mqtt);
+    }
+    return topic;
+}
+
+// create the MQTT topic name (without the basename) for a single device value
+// e.g. boiler/selflowtemp or thermostat/hc1/seltemp
+const char * Mqtt::single_topic(char * topic, size_t len, uint8_t device_type, uint8_t tag, const __FlashStringHelper * name) {
+    const __FlashStringHelper * tag_mqtt = EMSdevice::tag_to_mqtt_flash(tag);
+
+    size_t pos = append_string(topic, len, 0, EMSdevice::device_type_2_flash(device_type));
+    pos        = append_string(topic, len, pos, "/");
+    if (pgm_read_byte(reinterpret_cast<const char *>(tag_mqtt)) != '\0') {
+        pos = append_string(topic, len, pos, tag_mqtt);
+        pos = append_string(topic, len, pos, "/");
     }
+    append_string(topic, len, pos, name);
+    return topic;
 }
 
 } // namespace emsesp
@@ -26,6 +26,7 @@
 #include <vector>
 #include <deque>
 #include <functional>
+#include <mutex>
 
 #include <AsyncMqttClient.h>
 
@@ -33,6 +34,7 @@
 #include "system.h"
 #include "console.h"
 #include "command.h"
+#include "topictrie.h"
 
 #include <uuid/log.h>
 
@@ -55,10 +57,10 @@ struct MqttMessage {
     const std::string payload;
     const bool        retain;
 
-    MqttMessage(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain)
+    MqttMessage(const uint8_t operation, const std::string & topic, std::string payload, bool retain)
         : operation(operation)
         , topic(topic)
-        , payload(payload)
+        , payload(std::move(payload))
         , retain(retain) {
     }
     ~MqttMessage() = default;
@@ -77,6 +79,7 @@ class Mqtt {
     void set_publish_time_mixer(uint16_t publish_time);
     void set_publish_time_other(uint16_t publish_time);
     void set_publish_time_sensor(uint16_t publish_time);
+    void set_publish_budget(uint16_t publish_budget);
     bool get_publish_onchange(uint8_t device_type);
 
     enum Operation { PUBLISH, SUBSCRIBE };
@@ -92,14 +95,17 @@ class Mqtt {
     enum class State_class { NONE, MEASUREMENT, TOTAL_INCREASING };
     enum class Device_class { NONE, TEMPERATURE, POWER_FACTOR, ENERGY, PRESSURE, POWER, SIGNAL_STRENGTH };
 
-    static constexpr uint8_t MQTT_TOPIC_MAX_SIZE = 128; // note this should really match the user setting in mqttSettings.maxTopicLength
+    static constexpr uint8_t  MQTT_TOPIC_MAX_SIZE   = 128; // note this should really match the user setting in mqttSettings.maxTopicLength
+    static constexpr uint16_t MQTT_PAYLOAD_MAX_SIZE = 256; // for incoming messages, commands are small
 
-    static void on_connect();
+    static void on_connect(const bool session_present = true);
 
     static void subscribe(const uint8_t device_type, const std::string & topic, mqtt_sub_function_p cb);
     static void resubscribe();
+    static void add_command_topic(const uint8_t device_type);
 
     static void publish(const std::string & topic, const std::string & payload);
+    static void publish(const std::string & topic, std::string && payload);
     static void publish(const __FlashStringHelper * topic, const char * payload);
     static void publish(const std::string & topic, const JsonObject & payload);
     static void publish(const __FlashStringHelper * topic, const JsonObject & payload);
@@ -139,6 +145,7 @@ class Mqtt {
 
 #if defined(EMSESP_DEBUG)
     void incoming(const char * topic, const char * payload = ""); // for testing only
+    void incoming_ack(uint16_t packet_id);                        // for testing only
 #endif
 
     static bool connected() {
@@ -177,6 +184,10 @@ class Mqtt {
         return mqtt_publish_fails_;
     }
 
+    static uint32_t publish_drops() {
+        return mqtt_publish_drops_;
+    }
+
     static void reset_mqtt();
 
     static uint8_t ha_climate_format() {
@@ -192,6 +203,24 @@ class Mqtt {
         nested_format_ = nested_format;
     }
 
+    // payload_format is 1 for json, 2 for MessagePack. Only used for the device values
+    static uint8_t payload_format() {
+        return payload_format_;
+    }
+
+    static void payload_format(uint8_t payload_format) {
+        payload_format_ = payload_format;
+    }
+
+    // publish_single is true if changed device values are also published to their own topic
+    static bool publish_single() {
+        return publish_single_;
+    }
+
+    static void publish_single(bool publish_single) {
+        publish_single_ = publish_single;
+    }
+
     static void ha_climate_format(uint8_t ha_climate_format) {
         ha_climate_format_ = ha_climate_format;
     }
@@ -224,13 +253,21 @@ class Mqtt {
         return mqtt_messages_.empty();
     }
 
+    // hashes of the HA configs already on the broker, kept in the filesystem so they are not sent again after a restart
+    static void load_ha_hashes();
+    static void save_ha_hashes();
+    static void clear_ha_hashes();
+
     static const std::string tag_to_topic(uint8_t device_type, uint8_t tag);
+    static const char *      tag_to_topic(char * topic, size_t len, uint8_t device_type, uint8_t tag);
+    static const char *      single_topic(char * topic, size_t len, uint8_t device_type, uint8_t tag, const __FlashStringHelper * name);
 
+    // not const, so in-flight messages can be removed from the middle of the queue when their ACK comes in
     struct QueuedMqttMessage {
-        const uint16_t                           id_;
-        const std::shared_ptr<const MqttMessage> content_;
-        uint8_t                                  retry_count_;
-        uint16_t                                 packet_id_;
+        uint16_t                           id_;
+        std::shared_ptr<const MqttMessage> content_;
+        uint8_t                            retry_count_;
+        uint16_t                           packet_id_;
 
         ~QueuedMqttMessage() = default;
         QueuedMqttMessage(uint16_t id, std::shared_ptr<MqttMessage> && content)
@@ -249,17 +286,39 @@ class Mqtt {
     static AsyncMqttClient * mqttClient_;
     static uint16_t          mqtt_message_id_;
 
-    static constexpr uint32_t MQTT_PUBLISH_WAIT      = 100; // delay between sending publishes, to account for large payloads
+    static constexpr uint32_t MQTT_PUBLISH_WAIT      = 100; // delay before trying again when a publish failed, e.g. the TCP send window is full
     static constexpr uint8_t  MQTT_PUBLISH_MAX_RETRY = 3;   // max retries for giving up on publishing
+    static constexpr uint8_t  MQTT_MAX_INFLIGHT      = 8;   // max messages waiting for their ACK with QoS 1 and 2
 
-    static std::shared_ptr<const MqttMessage> queue_message(const uint8_t operation, const std::string & topic, const std::string & payload, bool retain);
-    static std::shared_ptr<const MqttMessage> queue_publish_message(const std::string & topic, const std::string & payload, bool retain);
+    static std::shared_ptr<const MqttMessage> queue_message(const uint8_t operation, const std::string & topic, std::string payload, bool retain);
+    static std::shared_ptr<const MqttMessage> queue_publish_message(const std::string & topic, std::string payload, bool retain);
     static std::shared_ptr<const MqttMessage> queue_subscribe_message(const std::string & topic);
 
+    static bool ha_config_unchanged(const char * topic, const std::string & payload);
+    static void ha_config_sent(const MqttMessage & message);
+    static void ha_config_dropped(const MqttMessage & message);
+    static void ha_config_removed(const char * topic);
+
     void on_publish(uint16_t packetId);
+    void on_disconnect(const AsyncMqttClientDisconnectReason reason);
     void on_message(const char * topic, const char * payload, size_t len);
     void process_queue();
 
+    // the MQTT client calls back from its own task. The events are kept in order and handled in loop(),
+    // so the queue is only changed from the main loop
+    enum ClientEvent : uint8_t { EVENT_CONNECT, EVENT_DISCONNECT, EVENT_ACK };
+
+    struct QueuedClientEvent {
+        uint8_t  event;
+        uint16_t value; // the packet ID of an ACK or the disconnect reason
+    };
+
+    static void post_client_event(const uint8_t event, const uint16_t value = 0);
+    void        process_client_events();
+
+    static std::vector<QueuedClientEvent> client_events_;
+    static std::mutex                     client_events_mutex_;
+
     // function handlers for MQTT subscriptions
     struct MQTTSubFunction {
         uint8_t             device_type_;      // which device type, from DeviceType::
@@ -275,19 +334,53 @@ class Mqtt {
 
     static std::vector<MQTTSubFunction> mqtt_subfunctions_; // list of mqtt subscribe callbacks for all devices
 
+    // the topics of incoming messages without the base, routed to a subscription callback or to the commands of a device type
+    static constexpr uint16_t ROUTE_CALLBACK = 0x8000; // the rest of the value is the position in mqtt_subfunctions_
+    static TopicTrie          topics_;
+
+    // the retained HA config of a topic, as a hash of the topic and of the payload
+    struct HaConfigHash {
+        uint32_t topic_;
+        uint32_t config_;
+    };
+
+    static constexpr const char * HA_HASHES_FILENAME  = "/config/haHashes.bin";
+    static constexpr uint32_t     HA_HASHES_SAVE_WAIT = 60000; // write at most once a minute, to spare the flash
+    static constexpr uint16_t     HA_HASHES_MAX       = 1000;  // beyond that they're all forgotten and sent again
+
+    static std::vector<HaConfigHash> ha_hashes_; // sorted on the topic hash
+    static bool                      ha_hashes_changed_;
+    static bool                      ha_resend_; // a config was dropped, so send the ones the broker doesn't have again
+    static uint32_t                  ha_configs_skipped_;
+
     uint32_t last_mqtt_poll_          = 0;
+    uint16_t publish_tokens_fraction_ = 0; // elapsed ms * budget not yet making up a whole byte, so a small budget still refills
+    uint32_t publish_wait_until_      = 0;
+    uint32_t last_drain_time_         = 0;
+    uint16_t drain_count_             = 0;
+    uint32_t drain_bytes_             = 0;
     uint32_t last_publish_boiler_     = 0;
     uint32_t last_publish_thermostat_ = 0;
     uint32_t last_publish_solar_      = 0;
     uint32_t last_publish_mixer_      = 0;
     uint32_t last_publish_other_      = 0;
     uint32_t last_publish_sensor_     = 0;
+    uint32_t last_save_ha_hashes_     = 0;
 
     static bool     connecting_;
+    static bool     clean_session_;
     static bool     initialized_;
     static uint16_t mqtt_publish_fails_;
     static uint8_t  connectcount_;
 
+    // queue statistics
+    static uint32_t mqtt_publish_drops_;    // messages removed from a full queue
+    static uint32_t mqtt_publish_replaced_; // queued payloads replaced by a newer one for the same topic
+    static uint16_t mqtt_queue_max_;        // high-water mark of the queue
+    static uint16_t mqtt_inflight_;         // messages waiting for their ACK
+    static uint16_t mqtt_drain_rate_;       // messages per second published
+    static uint32_t mqtt_drain_bytes_;      // bytes per second published
+
     // settings, copied over
     static std::string mqtt_base_;
     static uint8_t     mqtt_qos_;
@@ -299,10 +392,15 @@ class Mqtt {
     static uint32_t    publish_time_mixer_;
     static uint32_t    publish_time_other_;
     static uint32_t    publish_time_sensor_;
+    static uint16_t    publish_budget_;
+    static int32_t     publish_tokens_; // bytes which can be published now, refilled from the budget
+    static std::string ha_config_;      // reused buffer for the HA config payloads
     static bool        mqtt_enabled_;
     static uint8_t     ha_climate_format_;
     static bool        ha_enabled_;
     static uint8_t     nested_format_;
+    static uint8_t     payload_format_;
+    static bool        publish_single_;
     static bool        send_response_;
 };
 
@@ -837,6 +837,7 @@ void System::show_system(uuid::console::Shell & shell) {
         shell.print(F(" "));
         shell.printfln(F_(mark_interval_fmt), syslog_mark_interval_);
         shell.printfln(F(" Queued: %d"), syslog_.queued());
+        shell.printfln(F(" Lost: %lu"), syslog_.overruns());
     }
 
 #endif
@@ -907,7 +908,10 @@ bool System::command_settings(const char * value, const int8_t id, JsonObject &
         node["ha_enabled"]              = settings.ha_enabled;
         node["mqtt_qos"]                = settings.mqtt_qos;
         node["mqtt_retain"]             = settings.mqtt_retain;
+        node["payload_format"]          = settings.payload_format;
+        node["publish_single"]          = settings.publish_single;
         node["send_response"]           = settings.send_response;
+        node["publish_budget"]          = settings.publish_budget;
     });
 
 #ifndef EMSESP_STANDALONE
@@ -1034,8 +1038,17 @@ bool System::command_info(const char * value, const int8_t id, JsonObject & outp
         node["telegrams received"]   = EMSESP::rxservice_.telegram_count();
         node["read requests sent"]   = EMSESP::txservice_.telegram_read_count();
         node["write requests sent"]  = EMSESP::txservice_.telegram_write_count();
+        node["tx requests merged"]   = EMSESP::txservice_.telegram_merge_count();
         node["incomplete telegrams"] = EMSESP::rxservice_.telegram_error_count();
+        node["rx queue overflows"]   = EMSESP::rxservice_.telegram_overflow_count();
+        node["rx queue max depth"]   = EMSESP::rxservice_.queue_high_water();
+        node["rx unchanged skipped"] = EMSESP::rx_skip_count();
         node["tx fails"]             = EMSESP::txservice_.telegram_fail_count();
+        for (uint8_t lane = 0; lane < TxService::TX_LANES; lane++) {
+            std::string lane_name = read_flash_string(TxService::lane_name(lane));
+            node["tx " + lane_name + " queued"]  = EMSESP::txservice_.lane_size(lane);
+            node["tx " + lane_name + " dropped"] = EMSESP::txservice_.lane_drop_count(lane);
+        }
         node["rx line quality"]      = EMSESP::rxservice_.quality();
         node["tx line quality"]      = EMSESP::txservice_.quality();
         if (Mqtt::enabled()) {
@@ -125,16 +125,65 @@ std::string Telegram::to_string_message() const {
     return Helpers::data_to_hex(this->message_data, this->message_length);
 }
 
+// called from the read_* functions when a value has changed
+void Telegram::value_changed(const void * value_p) {
+    EMSdevice * emsdevice = EMSdevice::handling_device();
+    if (emsdevice) {
+        emsdevice->value_changed(value_p);
+    }
+}
+
 // checks if we have an Rx telegram that needs processing
 void RxService::loop() {
-    while (!rx_telegrams_.empty()) {
-        auto telegram = rx_telegrams_.front().telegram_;
-        (void)EMSESP::process_telegram(telegram); // further process the telegram
-        increment_telegram_count();               // increase rx count
-        rx_telegrams_.pop_front();                // remove it from the queue
+    uint8_t tail = rx_tail_.load(std::memory_order_relaxed);
+    while (tail != rx_head_.load(std::memory_order_acquire)) {
+        (void)EMSESP::process_telegram(*rx_slots_[tail].telegram()); // further process the telegram, it's not copied
+        increment_telegram_count();                                  // increase rx count
+        tail = (tail + 1) % RX_QUEUE_SLOTS;
+        rx_tail_.store(tail, std::memory_order_release); // free the slot for the producer
     }
 }
 
+// copies the telegram into the next free slot of the Rx queue
+// returns false if the queue is full and the telegram is dropped
+bool RxService::push(const uint8_t   operation,
+                     const uint8_t   src,
+                     const uint8_t   dest,
+                     const uint16_t  type_id,
+                     const uint8_t   offset,
+                     const uint8_t * message_data,
+                     const uint8_t   message_length) {
+    uint8_t head = rx_head_.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % RX_QUEUE_SLOTS;
+    if (next == rx_tail_.load(std::memory_order_acquire)) {
+        telegram_overflow_count_++;
+        return false;
+    }
+
+    // Telegram is trivially destructible, so the slot can be overwritten in place
+    rx_slots_[head].id_ = rx_telegram_id_++;
+    new (&rx_slots_[head].telegram_) Telegram(operation, src, dest, type_id, offset, message_data, message_length);
+    rx_head_.store(next, std::memory_order_release); // publish to the consumer
+
+    uint8_t size = queue_size();
+    if (size > rx_high_water_) {
+        rx_high_water_ = size;
+    }
+
+    return true;
+}
+
+// snapshot of the telegrams waiting in the Rx queue
+// the slots between tail and head are owned by the consumer, so the producer won't touch them
+const std::deque<RxService::QueuedRxTelegram> RxService::queue() const {
+    std::deque<QueuedRxTelegram> rx_telegrams;
+    uint8_t                      head = rx_head_.load(std::memory_order_acquire);
+    for (uint8_t i = rx_tail_.load(std::memory_order_acquire); i != head; i = (i + 1) % RX_QUEUE_SLOTS) {
+        rx_telegrams.emplace_back(rx_slots_[i].id_, std::make_shared<Telegram>(*rx_slots_[i].telegram()));
+    }
+    return rx_telegrams;
+}
+
 // add a new rx telegram object
 // data is the whole telegram, assuming last byte holds the CRC
 // length includes the CRC
@@ -223,24 +272,98 @@ void RxService::add(uint8_t * data, uint8_t length) {
     // if we receive a hc2.. telegram from 0x19.. match it to master_thermostat if master is 0x18
     src = EMSESP::check_master_device(src, type_id, true);
 
-    // create the telegram
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length);
-
-    // check if queue is full, if so remove top item to make space
-    if (rx_telegrams_.size() >= MAX_RX_TELEGRAMS) {
-        rx_telegrams_.pop_front();
+    // add to queue, without allocating. If the queue is full the telegram is dropped and counted
+    if (!push(operation, src, dest, type_id, offset, message_data, message_length)) {
+        LOG_DEBUG(F("Rx queue full, dropped telegram type 0x%02X from 0x%02X"), type_id, src);
     }
-
-    rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
 }
 
 // add empty telegram to rx-queue
 void RxService::add_empty(const uint8_t src, const uint8_t dest, const uint16_t type_id) {
-    auto telegram = std::make_shared<Telegram>(Telegram::Operation::RX, src, dest, type_id, 0, nullptr, 0);
-    // only if queue is  not full
-    if (rx_telegrams_.size() < MAX_RX_TELEGRAMS) {
-        rx_telegrams_.emplace_back(rx_telegram_id_++, std::move(telegram)); // add to queue
+    // only if queue is not full
+    (void)push(Telegram::Operation::RX, src, dest, type_id, 0, nullptr, 0);
+}
+
+TxService::TxService() {
+    // all entries in the pool are free
+    for (uint8_t i = 0; i < MAX_TX_TELEGRAMS; i++) {
+        tx_free_[i] = i;
+    }
+}
+
+const __FlashStringHelper * TxService::lane_name(const uint8_t lane) {
+    switch (lane) {
+    case Lane::VALIDATE:
+        return F("validate");
+    case Lane::WRITE:
+        return F("write");
+    case Lane::RAW:
+        return F("raw");
+    case Lane::FETCH:
+    default:
+        return F("fetch");
+    }
+}
+
+// copies the telegram into a free entry of the pool and adds it to the lane
+// if the pool is full the oldest telegram of the lowest priority lane (not higher than this lane) is dropped to make room,
+// so fetches go first. A user write is only pushed out by another write, a validate read is of no use without it
+// returns false if there was no room, then the new telegram is dropped
+bool TxService::push(const Telegram & telegram, const bool retry, const uint16_t validateid, const uint8_t lane, const bool front) {
+    if (tx_free_count_ == 0) {
+        uint8_t victim = TX_LANES;
+        for (uint8_t l = TX_LANES; l-- > lane;) {
+            if ((l == Lane::WRITE) && (lane != Lane::WRITE)) {
+                continue;
+            }
+            if (tx_lanes_[l].size_) {
+                victim = l;
+                break;
+            }
+        }
+        if (victim == TX_LANES) {
+            tx_lanes_[lane].drop_count_++;
+            LOG_WARNING(F("Tx queue full, dropping %s telegram: %s"), lane_name(lane), telegram.to_string().c_str());
+            return false;
+        }
+        uint8_t slot = tx_lanes_[victim].pop_front();
+        tx_lanes_[victim].drop_count_++;
+        LOG_DEBUG(F("Tx queue full, dropping %s telegram: %s"), lane_name(victim), tx_pool_[slot].telegram()->to_string().c_str());
+        release_slot(slot);
     }
+
+    uint8_t  slot  = tx_free_[--tx_free_count_];
+    TxSlot & entry = tx_pool_[slot];
+    entry.id_         = tx_telegram_id_++;
+    entry.retry_      = retry;
+    entry.validateid_ = validateid;
+    new (&entry.telegram_) Telegram(telegram); // Telegram is trivially destructible, so the entry can be overwritten in place
+
+    if (front) {
+        tx_lanes_[lane].push_front(slot);
+    } else {
+        tx_lanes_[lane].push_back(slot);
+    }
+
+    return true;
+}
+
+// give an entry back to the pool
+void TxService::release_slot(const uint8_t slot) {
+    tx_free_[tx_free_count_++] = slot;
+}
+
+// snapshot of the Tx queue in the order the telegrams will be sent
+const std::deque<TxService::QueuedTxTelegram> TxService::queue() const {
+    std::lock_guard<std::mutex>  lock(tx_mutex_);
+    std::deque<QueuedTxTelegram> tx_telegrams;
+    for (uint8_t lane = 0; lane < TX_LANES; lane++) {
+        for (uint8_t i = 0; i < tx_lanes_[lane].size_; i++) {
+            const TxSlot & entry = tx_pool_[tx_lanes_[lane].at(i)];
+            tx_telegrams.emplace_back(entry.id_, std::make_shared<Telegram>(*entry.telegram()), entry.retry_, entry.validateid_, lane);
+        }
+    }
+    return tx_telegrams;
 }
 
 // start and initialize Tx
@@ -279,26 +402,43 @@ void TxService::send() {
     }
 
     // if there's nothing in the queue to transmit or sending should be delayed, send back a poll and quit
-    if (tx_telegrams_.empty() || (delayed_send_ && uuid::get_uptime() < delayed_send_)) {
+    if ((queue_size() == 0) || (delayed_send_ && uuid::get_uptime() < delayed_send_)) {
         send_poll();
         return;
     }
     delayed_send_ = 0;
 
+    // take the first telegram from the highest priority lane
+    // once it's off the lane and not yet released, the main loop can't touch the entry
+    uint8_t slot;
+    {
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        uint8_t                     lane = 0;
+        while ((lane < TX_LANES) && !tx_lanes_[lane].size_) {
+            lane++;
+        }
+        if (lane == TX_LANES) {
+            send_poll();
+            return;
+        }
+        slot = tx_lanes_[lane].pop_front(); // remove the telegram from the queue
+    }
+
     // if we're in read-only mode (tx_mode 0) forget the Tx call
     if (tx_mode() != 0) {
-        send_telegram(tx_telegrams_.front());
+        send_telegram(tx_pool_[slot]);
     }
 
-    tx_telegrams_.pop_front(); // remove the telegram from the queue
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    release_slot(slot);
 }
 
 // process a Tx telegram
-void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
+void TxService::send_telegram(const TxSlot & tx_telegram) {
     static uint8_t telegram_raw[EMS_MAX_TELEGRAM_LENGTH];
 
     // build the header
-    auto telegram = tx_telegram.telegram_;
+    auto telegram = tx_telegram.telegram();
 
     // src - set MSB if it's Junkers/HT3
     uint8_t src = telegram->src;
@@ -361,7 +501,7 @@ void TxService::send_telegram(const QueuedTxTelegram & tx_telegram) {
 
     uint8_t length = message_p;
 
-    telegram_last_ = std::make_shared<Telegram>(*telegram); // make a copy of the telegram
+    telegram_last_ = new (&telegram_last_buf_) Telegram(*telegram); // make a copy of the telegram
 
     telegram_raw[length] = calculate_crc(telegram_raw, length); // generate and append CRC to the end
 
@@ -417,33 +557,130 @@ void TxService::add(const uint8_t  operation,
                     uint8_t *      message_data,
                     const uint8_t  message_length,
                     const uint16_t validateid,
-                    const bool     front) {
-    auto telegram = std::make_shared<Telegram>(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length);
-
+                    const Lane     lane) {
+    {
+        std::lock_guard<std::mutex> lock(tx_mutex_);
 #ifdef EMSESP_DEBUG
-    LOG_DEBUG(F("[DEBUG] New Tx [#%d] telegram, length %d"), tx_telegram_id_, message_length);
+        LOG_DEBUG(F("[DEBUG] New Tx [#%d] telegram, length %d"), tx_telegram_id_, message_length);
 #endif
 
-    // if the queue is full, make room but removing the last one
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        tx_telegrams_.pop_front();
-    }
-
-    if (front) {
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validateid); // add to front of queue
-    } else {
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validateid); // add to back of queue
+        // a slider in the web UI or an automation can send many writes in a row, only the last values need to go on the bus
+        if (operation == Telegram::Operation::TX_WRITE) {
+            if (merge_write(dest, type_id, offset, message_data, message_length, validateid, lane)) {
+                telegram_merge_count_++;
+            } else if (!push(Telegram(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length), false, validateid, lane)) {
+                return;
+            }
+        } else if (operation == Telegram::Operation::TX_READ) {
+            uint8_t length = message_data[0]; // a read has the # bytes to return as its only data
+            if (merge_read(dest, type_id, offset, length, lane)) {
+                telegram_merge_count_++;
+            } else if (!push(Telegram(operation, ems_bus_id(), dest, type_id, offset, &length, 1), false, validateid, lane)) {
+                return;
+            }
+        } else if (!push(Telegram(operation, ems_bus_id(), dest, type_id, offset, message_data, message_length), false, validateid, lane)) {
+            return;
+        }
     }
     if (validateid != 0) {
         EMSESP::wait_validate(validateid);
     }
 }
 
+// merges a write into the last queued write to the same dest and type_id, if they overlap
+// a later value replaces an earlier one. Adjacent writes aren't combined, a device may not take a
+// multi-byte write where it only expects single values
+// only the last one is used, so the bytes still go out in the order they were written
+// it's not merged past another telegram to the same dest, that would change the order the device sees them in
+// returns true if it was merged, then the write doesn't need to be queued
+bool TxService::merge_write(const uint8_t   dest,
+                            const uint16_t  type_id,
+                            const uint8_t   offset,
+                            const uint8_t * message_data,
+                            const uint8_t   message_length,
+                            const uint16_t  validateid,
+                            const uint8_t   lane) {
+    const TxLane & tx_lane    = tx_lanes_[lane];
+    uint8_t        max_length = EMS_MAX_TELEGRAM_LENGTH - 1 - ((type_id > 0xFF) ? 6 : 4); // without the header and CRC
+
+    for (uint8_t i = tx_lane.size_; i-- > 0;) {
+        TxSlot &         entry  = tx_pool_[tx_lane.at(i)];
+        const Telegram * queued = entry.telegram();
+        if (queued->dest != dest) {
+            continue;
+        }
+
+        if (entry.retry_ || (queued->operation != Telegram::Operation::TX_WRITE) || (queued->type_id != type_id)) {
+            return false;
+        }
+
+        uint16_t queued_end = queued->offset + queued->message_length;
+        uint16_t end        = offset + message_length;
+        if ((offset >= queued_end) || (queued->offset >= end)) {
+            return false; // they don't overlap
+        }
+        uint8_t start  = std::min(queued->offset, offset);
+        uint8_t length = std::max(queued_end, end) - start;
+        if (length > max_length) {
+            return false;
+        }
+
+        uint8_t data[EMS_MAX_TELEGRAM_MESSAGE_LENGTH];
+        memcpy(data + queued->offset - start, queued->message_data, queued->message_length);
+        memcpy(data + offset - start, message_data, message_length);
+        uint8_t src = queued->src;
+        new (&entry.telegram_) Telegram(Telegram::Operation::TX_WRITE, src, dest, type_id, start, data, length);
+        if (validateid != 0) {
+            entry.validateid_ = validateid;
+        }
+        LOG_DEBUG(F("Tx write to device 0x%02X for type ID 0x%02X merged into [#%d]"), dest, type_id, entry.id_);
+        return true;
+    }
+
+    return false;
+}
+
+// returns true if the same read is already queued in this or a higher priority lane, then it doesn't need to be queued again
+// a queued copy in a lower priority lane is taken out, so the new one can be sent earlier
+// length is raised to what the queued copy asked for, so the new one still returns all of it
+bool TxService::merge_read(const uint8_t dest, const uint16_t type_id, const uint8_t offset, uint8_t & length, const uint8_t lane) {
+    for (uint8_t l = 0; l < TX_LANES; l++) {
+        TxLane & tx_lane = tx_lanes_[l];
+        for (uint8_t i = 0; i < tx_lane.size_; i++) {
+            uint8_t          slot   = tx_lane.at(i);
+            TxSlot &         entry  = tx_pool_[slot];
+            const Telegram * queued = entry.telegram();
+            if (entry.retry_ || (queued->operation != Telegram::Operation::TX_READ) || (queued->dest != dest) || (queued->type_id != type_id)
+                || (queued->offset != offset)) {
+                continue;
+            }
+
+            if (l <= lane) {
+                // ask for the most bytes of the two
+                if (length > queued->message_data[0]) {
+                    uint8_t src = queued->src;
+                    new (&entry.telegram_) Telegram(Telegram::Operation::TX_READ, src, dest, type_id, offset, &length, 1);
+                }
+                return true;
+            }
+
+            // the queued one is in a lower priority lane, the new one replaces it
+            length = std::max(length, queued->message_data[0]);
+            tx_lane.erase(i);
+            release_slot(slot);
+            telegram_merge_count_++;
+            return false;
+        }
+    }
+
+    return false;
+}
+
 // builds a Tx telegram and adds to queue
 // this is used by the retry() function to put the last failed Tx back into the queue
 // format is EMS 1.0 (src, dest, type_id, offset, data)
 // length is the length of the whole telegram data, excluding the CRC
-void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t length, const uint16_t validateid, const bool front) {
+void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t length, const uint16_t validateid, const Lane lane) {
     // check length
     if (length < 5) {
         return;
@@ -495,23 +732,16 @@ void TxService::add(uint8_t operation, const uint8_t * data, const uint8_t lengt
         EMSESP::set_read_id(type_id);
     }
 
-    auto telegram = std::make_shared<Telegram>(operation, src, dest, type_id, offset, message_data, message_length); // operation is TX_WRITE or TX_READ
-
-    // if the queue is full, make room but removing the last one
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        tx_telegrams_.pop_front();
-    }
-
 #ifdef EMSESP_DEBUG
     LOG_DEBUG(F("[DEBUG] New Tx [#%d] telegram, length %d"), tx_telegram_id_, message_length);
 #endif
 
-    if (front) {
-        // tx_telegrams_.push_front(qtxt); // add to front of queue
-        tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to front of queue
-    } else {
-        // tx_telegrams_.push_back(qtxt); // add to back of queue
-        tx_telegrams_.emplace_back(tx_telegram_id_++, std::move(telegram), false, validate_id); // add to back of queue
+    // operation is TX_WRITE or TX_READ
+    {
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        if (!push(Telegram(operation, src, dest, type_id, offset, message_data, message_length), false, validate_id, lane)) {
+            return;
+        }
     }
     if (validate_id != 0) {
         EMSESP::wait_validate(validate_id);
@@ -523,12 +753,12 @@ void TxService::read_request(const uint16_t type_id, const uint8_t dest, const u
     LOG_DEBUG(F("Tx read request to device 0x%02X for type ID 0x%02X"), dest, type_id);
 
     uint8_t message_data[1] = {EMS_MAX_TELEGRAM_LENGTH}; // request all data, 32 bytes
-    // if length set, publish result and set telegram to front
+    // if length set, publish result and send it before the periodic fetches
     if (length) {
         message_data[0] = length;
         EMSESP::set_read_id(type_id);
     }
-    add(Telegram::Operation::TX_READ, dest, type_id, offset, message_data, 1, 0, length != 0);
+    add(Telegram::Operation::TX_READ, dest, type_id, offset, message_data, 1, 0, length ? Lane::VALIDATE : Lane::FETCH);
 }
 
 // Send a raw telegram to the bus, telegram is a text string of hex values
@@ -569,7 +799,7 @@ void TxService::send_raw(const char * telegram_data) {
         return; // nothing to send
     }
 
-    add(Telegram::Operation::TX_RAW, data, count + 1, 0, true); // add to top/front of Tx queue
+    add(Telegram::Operation::TX_RAW, data, count + 1, 0, Lane::RAW);
 }
 
 // add last Tx to tx queue and increment count
@@ -599,21 +829,18 @@ void TxService::retry_tx(const uint8_t operation, const uint8_t * data, const ui
               Helpers::data_to_hex(data, length - 1).c_str());
 #endif
 
-    // add to the top of the queue
-    if (tx_telegrams_.size() >= MAX_TX_TELEGRAMS) {
-        tx_telegrams_.pop_back();
-    }
-
-    tx_telegrams_.emplace_front(tx_telegram_id_++, std::move(telegram_last_), true, get_post_send_query());
+    // add to the front of the highest priority lane, so it's sent next
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    (void)push(*telegram_last_, true, get_post_send_query(), Lane::VALIDATE, true);
 }
 
 uint16_t TxService::read_next_tx(uint8_t offset) {
-    // add to the top/front of the queue
+    // add to the validate lane, so the rest is read before any other queued telegrams
     uint8_t message_data[1] = {EMS_MAX_TELEGRAM_LENGTH}; // request all data, 32 bytes
     if (telegram_last_->offset != offset) {
         return 0;
     }
-    add(Telegram::Operation::TX_READ, telegram_last_->dest, telegram_last_->type_id, telegram_last_->offset + 25, message_data, 1, 0, true);
+    add(Telegram::Operation::TX_READ, telegram_last_->dest, telegram_last_->type_id, telegram_last_->offset + 25, message_data, 1, 0, Lane::VALIDATE);
     return telegram_last_->type_id;
 }
 
@@ -636,7 +863,7 @@ uint16_t TxService::post_send_query() {
         // when set a value with large offset before and validate on same type, we have to add offset 0, 26, 52, ...
         uint8_t offset          = (this->telegram_last_->type_id == post_typeid) ? ((this->telegram_last_->offset / 26) * 26) : 0;
         uint8_t message_data[1] = {EMS_MAX_TELEGRAM_LENGTH};                                          // request all data, 32 bytes
-        this->add(Telegram::Operation::TX_READ, dest, post_typeid, offset, message_data, 1, 0, true); // add to top/front of queue
+        this->add(Telegram::Operation::TX_READ, dest, post_typeid, offset, message_data, 1, 0, Lane::VALIDATE);
         // read_request(telegram_last_post_send_query_, dest, 0); // no offset
         LOG_DEBUG(F("Sending post validate read, type ID 0x%02X to dest 0x%02X"), post_typeid, dest);
         set_post_send_query(0); // reset
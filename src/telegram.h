@@ -21,6 +21,9 @@
 
 #include <string>
 #include <deque>
+#include <atomic>
+#include <mutex>
+#include <new>
 
 // UART drivers
 #if defined(ESP32)
@@ -92,7 +95,7 @@ class Telegram {
         }
         uint8_t val = value;
         value       = (uint8_t)(((this->message_data[abs_index]) >> (bit)) & 0x01);
-        return (val != value);
+        return changed(val != value, &value);
     }
 
     // read a value from a telegram. We always store the value, regardless if its garbage
@@ -113,7 +116,7 @@ class Telegram {
         for (uint8_t i = 0; i < num_bytes; i++) {
             value = (value << 8) + this->message_data[index - this->offset + i]; // shift by byte
         }
-        return (val != value);
+        return changed(val != value, &value);
     }
 
     bool read_enumvalue(uint8_t & value, const uint8_t index, uint8_t start = 0) const {
@@ -122,11 +125,21 @@ class Telegram {
         }
         uint8_t val = value;
         value       = this->message_data[index - this->offset] - start;
-        return (val != value);
+        return changed(val != value, &value);
     }
 
   private:
     int8_t _getDataPosition(const uint8_t index, const uint8_t size) const;
+
+    // flags the device value as changed on the device handling this telegram, see EMSdevice::handle_telegram
+    static void value_changed(const void * value_p);
+
+    static inline bool changed(const bool has_changed, const void * value_p) {
+        if (has_changed) {
+            value_changed(value_p);
+        }
+        return has_changed;
+    }
 };
 
 class EMSbus {
@@ -236,6 +249,20 @@ class RxService : public EMSbus {
         return (q <= EMS_BUS_QUALITY_RX_THRESHOLD ? 100 : 100 - q);
     }
 
+    // number of valid telegrams dropped because the Rx queue was full
+    uint32_t telegram_overflow_count() const {
+        return telegram_overflow_count_;
+    }
+
+    // highest number of telegrams waiting in the Rx queue
+    uint8_t queue_high_water() const {
+        return rx_high_water_;
+    }
+
+    uint8_t queue_size() const {
+        return (rx_head_.load(std::memory_order_acquire) + RX_QUEUE_SLOTS - rx_tail_.load(std::memory_order_acquire)) % RX_QUEUE_SLOTS;
+    }
+
     struct QueuedRxTelegram {
       public:
         const uint16_t                        id_;
@@ -248,18 +275,43 @@ class RxService : public EMSbus {
         }
     };
 
-    const std::deque<QueuedRxTelegram> queue() const {
-        return rx_telegrams_;
-    }
+    // snapshot of the Rx queue, only used for showing in the console
+    const std::deque<QueuedRxTelegram> queue() const;
 
   private:
     static constexpr uint8_t EMS_BUS_QUALITY_RX_THRESHOLD = 5; // % threshold before reporting quality issues
 
-    uint8_t                         rx_telegram_id_       = 0; // queue counter
-    uint32_t                        telegram_count_       = 0; // # Rx received
-    uint32_t                        telegram_error_count_ = 0; // # Rx CRC errors
-    std::shared_ptr<const Telegram> rx_telegram;               // the incoming Rx telegram
-    std::deque<QueuedRxTelegram>    rx_telegrams_;             // the Rx Queue
+    // the Rx queue is a single-producer/single-consumer ring of preallocated telegram slots
+    // add() and add_empty() are the producer, called from the UART task (or the main loop in standalone)
+    // loop() is the consumer, called from the main loop
+    // one slot is always kept free to tell a full queue from an empty one
+    static constexpr uint8_t RX_QUEUE_SLOTS = MAX_RX_TELEGRAMS + 1;
+
+    struct RxSlot {
+        uint16_t id_;
+        typename std::aligned_storage<sizeof(Telegram), alignof(Telegram)>::type telegram_;
+
+        const Telegram * telegram() const {
+            return reinterpret_cast<const Telegram *>(&telegram_);
+        }
+    };
+
+    bool push(const uint8_t   operation,
+              const uint8_t   src,
+              const uint8_t   dest,
+              const uint16_t  type_id,
+              const uint8_t   offset,
+              const uint8_t * message_data,
+              const uint8_t   message_length);
+
+    RxSlot               rx_slots_[RX_QUEUE_SLOTS];     // the Rx queue
+    std::atomic<uint8_t> rx_head_{0};                   // next slot to write, only changed by the producer
+    std::atomic<uint8_t> rx_tail_{0};                   // next slot to read, only changed by the consumer
+    uint8_t              rx_high_water_           = 0;  // max queue depth seen
+    uint8_t              rx_telegram_id_          = 0;  // queue counter
+    uint32_t             telegram_count_          = 0;  // # Rx received
+    uint32_t             telegram_error_count_    = 0;  // # Rx CRC errors
+    uint32_t             telegram_overflow_count_ = 0;  // # Rx dropped because the queue was full
 };
 
 class TxService : public EMSbus {
@@ -267,7 +319,16 @@ class TxService : public EMSbus {
     static constexpr uint8_t TX_WRITE_FAIL    = 4; // EMS return code for fail
     static constexpr uint8_t TX_WRITE_SUCCESS = 1; // EMS return code for success
 
-    TxService()  = default;
+    // the Tx queue is split into lanes, in order of priority. Each lane is FIFO, a retry goes to the front of the first lane
+    enum Lane : uint8_t {
+        VALIDATE = 0, // post-send validation reads and reads requested by the user
+        WRITE,        // user writes
+        RAW,          // raw telegrams from the console/API
+        FETCH,        // periodic fetch reads
+    };
+    static constexpr uint8_t TX_LANES = 4;
+
+    TxService();
     ~TxService() = default;
 
     void     start();
@@ -279,8 +340,8 @@ class TxService : public EMSbus {
                  uint8_t *      message_data,
                  const uint8_t  message_length,
                  const uint16_t validateid,
-                 const bool     front = false);
-    void     add(const uint8_t operation, const uint8_t * data, const uint8_t length, const uint16_t validateid, const bool front = false);
+                 const Lane     lane = Lane::FETCH);
+    void     add(const uint8_t operation, const uint8_t * data, const uint8_t length, const uint16_t validateid, const Lane lane = Lane::FETCH);
     void     read_request(const uint16_t type_id, const uint8_t dest, const uint8_t offset = 0, const uint8_t length = 0);
     void     send_raw(const char * telegram_data);
     void     send_poll();
@@ -351,24 +412,48 @@ class TxService : public EMSbus {
         telegram_write_count_++;
     }
 
+    // number of telegrams merged into one already queued, instead of being queued themselves
+    uint32_t telegram_merge_count() const {
+        return telegram_merge_count_;
+    }
+
+    // number of telegrams waiting in a lane
+    uint8_t lane_size(const uint8_t lane) const {
+        return tx_lanes_[lane].size_;
+    }
+
+    // number of telegrams dropped from a lane because the queue was full
+    uint32_t lane_drop_count(const uint8_t lane) const {
+        return tx_lanes_[lane].drop_count_;
+    }
+
+    // from any task, send() checks it when the bus polls us
+    uint8_t queue_size() const {
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        return MAX_TX_TELEGRAMS - tx_free_count_;
+    }
+
+    static const __FlashStringHelper * lane_name(const uint8_t lane);
+
     struct QueuedTxTelegram {
         const uint16_t                        id_;
         const std::shared_ptr<const Telegram> telegram_;
         const bool                            retry_; // true if its a retry
         const uint16_t                        validateid_;
+        const uint8_t                         lane_;
 
         ~QueuedTxTelegram() = default;
-        QueuedTxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram, bool retry, uint16_t validateid)
+        QueuedTxTelegram(uint16_t id, std::shared_ptr<Telegram> && telegram, bool retry, uint16_t validateid, uint8_t lane)
             : id_(id)
             , telegram_(std::move(telegram))
             , retry_(retry)
-            , validateid_(validateid) {
+            , validateid_(validateid)
+            , lane_(lane) {
         }
     };
 
-    const std::deque<QueuedTxTelegram> queue() const {
-        return tx_telegrams_;
-    }
+    // snapshot of the Tx queue in the order it will be sent, only used for showing in the console
+    const std::deque<QueuedTxTelegram> queue() const;
 
 #if defined(EMSESP_DEBUG)
     static constexpr uint8_t MAXIMUM_TX_RETRIES = 0; // when compiled with EMSESP_DEBUG don't retry
@@ -379,21 +464,87 @@ class TxService : public EMSbus {
     static constexpr uint32_t POST_SEND_DELAY = 2000;
 
   private:
-    std::deque<QueuedTxTelegram> tx_telegrams_; // the Tx queue
+    // a preallocated Tx queue entry, the telegram is stored inline
+    struct TxSlot {
+        uint16_t id_;
+        bool     retry_; // true if its a retry
+        uint16_t validateid_;
+        typename std::aligned_storage<sizeof(Telegram), alignof(Telegram)>::type telegram_;
+
+        const Telegram * telegram() const {
+            return reinterpret_cast<const Telegram *>(&telegram_);
+        }
+    };
+
+    // a lane is a ring of indices into the slot pool
+    struct TxLane {
+        uint8_t  slots_[MAX_TX_TELEGRAMS];
+        uint8_t  head_       = 0; // position of the first entry
+        uint8_t  size_       = 0; // # entries
+        uint32_t drop_count_ = 0; // # entries dropped because the queue was full
+
+        uint8_t front() const {
+            return slots_[head_];
+        }
+        uint8_t at(const uint8_t i) const {
+            return slots_[(head_ + i) % MAX_TX_TELEGRAMS];
+        }
+        void push_back(const uint8_t slot) {
+            slots_[(head_ + size_++) % MAX_TX_TELEGRAMS] = slot;
+        }
+        void push_front(const uint8_t slot) {
+            head_         = (head_ + MAX_TX_TELEGRAMS - 1) % MAX_TX_TELEGRAMS;
+            slots_[head_] = slot;
+            size_++;
+        }
+        uint8_t pop_front() {
+            uint8_t slot = slots_[head_];
+            head_        = (head_ + 1) % MAX_TX_TELEGRAMS;
+            size_--;
+            return slot;
+        }
+        void erase(const uint8_t i) {
+            for (uint8_t j = i; j + 1 < size_; j++) {
+                slots_[(head_ + j) % MAX_TX_TELEGRAMS] = slots_[(head_ + j + 1) % MAX_TX_TELEGRAMS];
+            }
+            size_--;
+        }
+    };
+
+    // these change the lanes and the pool, tx_mutex_ must be locked
+    bool push(const Telegram & telegram, const bool retry, const uint16_t validateid, const uint8_t lane, const bool front = false);
+    void release_slot(const uint8_t slot);
+    bool merge_write(const uint8_t   dest,
+                     const uint16_t  type_id,
+                     const uint8_t   offset,
+                     const uint8_t * message_data,
+                     const uint8_t   message_length,
+                     const uint16_t  validateid,
+                     const uint8_t   lane);
+    bool merge_read(const uint8_t dest, const uint16_t type_id, const uint8_t offset, uint8_t & length, const uint8_t lane);
+
+    TxSlot  tx_pool_[MAX_TX_TELEGRAMS];                  // the Tx queue entries
+    uint8_t tx_free_[MAX_TX_TELEGRAMS];                  // stack of free entries in the pool
+    uint8_t tx_free_count_ = MAX_TX_TELEGRAMS;           // # free entries
+    TxLane  tx_lanes_[TX_LANES];                         // the Tx queue, one per lane
+
+    mutable std::mutex tx_mutex_; // telegrams are queued by the main loop and taken off the queue by the UART task on a poll
 
     uint32_t telegram_read_count_  = 0; // # Tx successful reads
     uint32_t telegram_write_count_ = 0; // # Tx successful writes
     uint32_t telegram_fail_count_  = 0; // # Tx unsuccessful transmits
+    uint32_t telegram_merge_count_ = 0; // # Tx merged into a queued telegram
 
-    std::shared_ptr<Telegram> telegram_last_;
-    uint16_t                  telegram_last_post_send_query_; // which type ID to query after a successful send, to read back the values just written
-    uint8_t                   retry_count_  = 0;              // count for # Tx retries
-    uint32_t                  delayed_send_ = 0;              // manage delay for post send query
+    typename std::aligned_storage<sizeof(Telegram), alignof(Telegram)>::type telegram_last_buf_; // copy of the last Tx sent
 
-    uint8_t tx_telegram_id_ = 0; // queue counter
+    const Telegram * telegram_last_ = nullptr;
+    uint16_t         telegram_last_post_send_query_; // which type ID to query after a successful send, to read back the values just written
+    uint8_t          retry_count_  = 0;              // count for # Tx retries
+    uint32_t         delayed_send_ = 0;              // manage delay for post send query
 
+    uint8_t tx_telegram_id_ = 0; // queue counter
 
-    void send_telegram(const QueuedTxTelegram & tx_telegram);
+    void send_telegram(const TxSlot & tx_telegram);
     // void send_telegram(const uint8_t * data, const uint8_t length);
 };
 
@@ -374,20 +374,21 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd) {
                 Serial.print(COLOR_RESET);
 
 
-                doc.clear();
-                JsonObject root = doc.to<JsonObject>();
-                emsdevice->generate_values_json_web(root);
+                std::string web_json;
+                JsonWriter  web(web_json);
+                emsdevice->generate_values_json_web(web);
+                std::string web_msgpack;
+                JsonWriter  web_packed(web_msgpack, JsonWriter::Format::MSGPACK);
+                emsdevice->generate_values_json_web(web_packed);
 
                 Serial.print(COLOR_BRIGHT_MAGENTA);
-                serializeJson(doc, Serial);
+                Serial.print(web_json.c_str());
                 Serial.print(COLOR_RESET);
                 Serial.println();
-                Serial.print("** memoryUsage=");
-                Serial.print(doc.memoryUsage());
-                Serial.print(" measureMsgPack=");
-                Serial.print(measureMsgPack(doc));
-                Serial.print(" measureJson=");
-                Serial.print(measureJson(doc));
+                Serial.print("** MsgPack=");
+                Serial.print(web_msgpack.size());
+                Serial.print(" Json=");
+                Serial.print(web_json.size());
                 Serial.println(" **");
             }
         }
@@ -808,6 +809,21 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd) {
         shell.invoke_command("show mqtt");
     }
 
+    if (command == "mqtt_single") {
+        shell.printfln(F("Testing MQTT publishing only changed values"));
+        Mqtt::ha_enabled(false); // turn off HA Discovery to stop the chatter
+        Mqtt::publish_single(true);
+
+        run_test("boiler");
+
+        // same UBAParameterWW(0x33) as in the boiler test, with only wwseltemp changed from 52 to 53
+        // only ems-esp/boiler/ww/wwseltemp should be added to the queue
+        uart_telegram({0x08, 0x0B, 0x33, 0x00, 0x08, 0xFF, 0x35, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00, 0xFF, 0xFF, 0x00});
+        shell.invoke_command("show mqtt");
+
+        Mqtt::publish_single(false);
+    }
+
     if (command == "thermostat") {
         shell.printfln(F("Testing adding a thermostat FW120..."));
 
@@ -970,6 +986,19 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd) {
         }
     }
 
+    if (command == "rx_overflow") {
+        shell.printfln(F("Testing Rx queue overflow..."));
+        // fill the Rx queue without processing it, the last ones should be dropped and counted
+        uint8_t data[] = {0x08, 0x0B, 0x33, 0x00, 0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00, 0xFF, 0xFF, 0x00, 0x00};
+        data[sizeof(data) - 1] = EMSESP::rxservice_.calculate_crc(data, sizeof(data) - 1);
+        for (uint8_t i = 0; i < MAX_RX_TELEGRAMS + 5; i++) {
+            EMSESP::rxservice_.add(data, sizeof(data));
+        }
+        EMSESP::show_ems(shell);
+        EMSESP::rxservice_.loop(); // drain the queue
+        shell.printfln(F("Rx queue size %d, overflows %d"), EMSESP::rxservice_.queue_size(), EMSESP::rxservice_.telegram_overflow_count());
+    }
+
     if (command == "rx") {
         shell.printfln(F("Testing Rx..."));
 
@@ -1064,6 +1093,1022 @@ void Test::run_test(uuid::console::Shell & shell, const std::string & cmd) {
         }
     }
 
+    if (command == "tx_lanes") {
+        shell.printfln(F("Testing Tx lanes..."));
+
+        // fill the Tx queue with periodic fetch reads
+        for (uint8_t i = 0; i < MAX_TX_TELEGRAMS; i++) {
+            EMSESP::send_read_request(0x18 + i, 0x08);
+        }
+
+        // a write and a raw send should push out the oldest fetches and go first
+        uint8_t t18[] = {0x52, 0x79};
+        EMSESP::send_write_request(0x91, 0x17, 0x00, t18, sizeof(t18), 0x00);
+        EMSESP::txservice_.send_raw("0B 08 63 03 64");
+
+        EMSESP::show_ems(shell);
+
+        // send the first two, should be the write and the raw
+        EMSESP::txservice_.send();
+        EMSESP::txservice_.send();
+        shell.printfln(F("Tx queue size %d, fetch dropped %d"), EMSESP::txservice_.queue_size(), EMSESP::txservice_.lane_drop_count(TxService::Lane::FETCH));
+
+        // with the pool full of user writes a validate read doesn't push one out, the read is dropped
+        for (uint8_t i = 0; i < MAX_TX_TELEGRAMS; i++) {
+            EMSESP::send_write_request(0x40 + i, 0x17, 0x00, i);
+        }
+        uint32_t write_dropped    = EMSESP::txservice_.lane_drop_count(TxService::Lane::WRITE);
+        uint32_t validate_dropped = EMSESP::txservice_.lane_drop_count(TxService::Lane::VALIDATE);
+        EMSESP::txservice_.read_request(0x18, 0x08, 0, 27);
+        write_dropped    = EMSESP::txservice_.lane_drop_count(TxService::Lane::WRITE) - write_dropped;
+        validate_dropped = EMSESP::txservice_.lane_drop_count(TxService::Lane::VALIDATE) - validate_dropped;
+        shell.printfln(F("%s validate read with the queue full of writes: %lu writes dropped, %lu validate dropped"),
+                       ((write_dropped == 0) && (validate_dropped == 1)) ? "ok  " : "FAIL",
+                       (unsigned long)write_dropped,
+                       (unsigned long)validate_dropped);
+    }
+
+#if defined(EMSESP_STANDALONE)
+    if (command == "dispatch") {
+        shell.printfln(F("Benchmarking telegram dispatch..."));
+
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC300
+        add_device(0x20, 160); // MM100
+        add_device(0x21, 160); // MM100
+        add_device(0x30, 164); // SM200
+        add_device(0x48, 189); // KM200
+
+        // collect all registered (src, type_id) pairs from the devices, plus some unknown ones
+        std::vector<std::pair<uint8_t, uint16_t>> telegrams;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            // probed through the index, the text list of show_telegram_handlers() is cut off for the RC300
+            for (uint32_t type_id = 1; type_id <= 0xFFFF; type_id++) {
+                if (emsdevice->has_telegram_type(type_id)) {
+                    telegrams.emplace_back(emsdevice->device_id(), (uint16_t)type_id);
+                }
+            }
+        }
+        telegrams.emplace_back(0x08, 0x0999); // unknown type
+        telegrams.emplace_back(0x44, 0x0123); // unknown device
+
+        const uint32_t loops = 10000;
+        uint32_t       found = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            for (const auto & t : telegrams) {
+                for (const auto & emsdevice : EMSESP::emsdevices) {
+                    if (emsdevice && emsdevice->is_device_id(t.first)) {
+                        found += emsdevice->has_telegram_type_linear(t.second);
+                        break;
+                    }
+                }
+            }
+        }
+        auto linear_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            for (const auto & t : telegrams) {
+                auto emsdevice = EMSESP::find_device(t.first);
+                if (emsdevice) {
+                    found += emsdevice->has_telegram_type(t.second);
+                }
+            }
+        }
+        auto index_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t lookups = loops * telegrams.size();
+        shell.printfln(F("%u telegram types on %u devices, %lu lookups (%lu found)"),
+                       (unsigned int)telegrams.size(),
+                       (unsigned int)EMSESP::emsdevices.size(),
+                       (unsigned long)lookups,
+                       (unsigned long)found);
+        shell.printfln(F("linear scan: %.1f ns/telegram"), (double)linear_ns / lookups);
+        shell.printfln(F("index:       %.1f ns/telegram"), (double)index_ns / lookups);
+    }
+
+    if (command == "pretty") {
+        shell.printfln(F("Benchmarking pretty printing telegrams, built each time vs cached prefix..."));
+
+        add_device(0x08, 123); // GB072
+        add_device(0x10, 158); // RC300
+        add_device(0x30, 164); // SM200
+
+        uint8_t               data[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A};
+        std::vector<Telegram> telegrams;
+        telegrams.emplace_back(Telegram::Operation::RX, 0x08, 0x00, 0x18, 0, data, sizeof(data));
+        telegrams.emplace_back(Telegram::Operation::RX, 0x08, 0x00, 0x19, 0, data, sizeof(data));
+        telegrams.emplace_back(Telegram::Operation::RX, 0x10, 0x00, 0x06, 0, data, sizeof(data));
+        telegrams.emplace_back(Telegram::Operation::RX, 0x10, 0x0B, 0x02A5, 2, data, sizeof(data));
+        telegrams.emplace_back(Telegram::Operation::RX, 0x30, 0x00, 0x0362, 0, data, sizeof(data));
+        telegrams.emplace_back(Telegram::Operation::RX_READ, 0x0B, 0x08, 0x02, 0, data, 1);
+        telegrams.emplace_back(Telegram::Operation::RX, 0x44, 0x0B, 0x0999, 0, data, sizeof(data)); // unknown device and type
+
+        bool same = true;
+        for (const auto & telegram : telegrams) {
+            same &= (EMSESP::pretty_telegram(telegram, false) == EMSESP::pretty_telegram(telegram));
+        }
+        shell.printfln(F("%s"), EMSESP::pretty_telegram(telegrams[3]).c_str());
+
+        const uint32_t loops = 10000;
+        size_t         size  = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            for (const auto & telegram : telegrams) {
+                size += EMSESP::pretty_telegram(telegram, false).size();
+            }
+        }
+        auto build_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            for (const auto & telegram : telegrams) {
+                size += EMSESP::pretty_telegram(telegram).size();
+            }
+        }
+        auto cached_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        uint32_t count = loops * telegrams.size();
+        shell.printfln(F("%lu telegrams (%s)"), (unsigned long)count, same ? "same result" : "different result");
+        shell.printfln(F("built:  %.1f ns/telegram"), (double)build_ns / count);
+        shell.printfln(F("cached: %.1f ns/telegram"), (double)cached_ns / count);
+
+        // with no handler at TRACE the telegram isn't decoded at all
+        shell.log_level(uuid::log::Level::NOTICE);
+        shell.printfln(F("decoded when not traced: %s"), uuid::log::Logger::enabled(uuid::log::Level::TRACE) ? "yes" : "no");
+    }
+
+    if (command == "device_data") {
+        shell.printfln(F("Load testing device data requests from the web while a write is waiting to be validated..."));
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        add_device(0x08, 123); // GB072, unique id 1
+
+        const uint8_t rounds  = 10;
+        const uint8_t parked  = 8;  // MAX_PENDING_REQUESTS
+        const uint8_t clients = 10; // two more than can be parked
+
+        DynamicJsonDocument doc(100);
+        deserializeJson(doc, "{\"id\":1}");
+        JsonVariant json = doc.as<JsonVariant>();
+
+        std::vector<double> latencies; // ms, from the request to the response
+        uint64_t            blocked_max = 0;
+        uint16_t            rejected    = 0;
+
+        for (uint8_t round = 0; round < rounds; round++) {
+            EMSESP::wait_validate(0x33); // a write to UBAParameterWW is waiting for its validate read
+
+            std::vector<AsyncWebServerRequest>                 requests(clients);
+            std::vector<std::chrono::steady_clock::time_point> start(clients);
+            for (uint8_t i = 0; i < clients; i++) {
+                start[i] = std::chrono::steady_clock::now();
+                EMSESP::webDataService.device_data(&requests[i], json);
+                uint64_t blocked = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start[i]).count();
+                blocked_max      = std::max(blocked_max, blocked);
+                rejected += requests[i].sent(); // only the ones that couldn't be parked are answered straight away
+            }
+
+            // the main loop keeps running, the validate telegram arrives after about 5 ms
+            // the responses aren't polled, so they only count if the main loop sent them
+            std::vector<bool> done(clients);
+            for (uint8_t i = 0; i < clients; i++) {
+                done[i] = requests[i].sent();
+            }
+            for (uint8_t loop = 0; loop < 50; loop++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                if (loop == 5) {
+                    uart_telegram({0x08, 0x0B, 0x33, 0x00, 0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00});
+                } else {
+                    EMSESP::loop();
+                }
+                for (uint8_t i = 0; i < clients; i++) {
+                    if (!done[i] && requests[i].finished()) {
+                        done[i] = true;
+                        latencies.push_back((double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start[i]).count()
+                                            / 1000);
+                    }
+                }
+            }
+        }
+
+        // clients that go away while waiting delete their response, the main loop must not touch them
+        EMSESP::wait_validate(0x33);
+        {
+            std::vector<AsyncWebServerRequest> requests(parked);
+            for (auto & request : requests) {
+                EMSESP::webDataService.device_data(&request, json);
+            }
+        }
+        uart_telegram({0x08, 0x0B, 0x33, 0x00, 0x08, 0xFF, 0x34, 0xFB, 0x00, 0x28, 0x00, 0x00, 0x46, 0x00});
+        EMSESP::loop();
+
+        std::sort(latencies.begin(), latencies.end());
+        shell.printfln(F("%d requests, %d answered after the validate, %d rejected as busy"), rounds * clients, latencies.size(), rejected);
+        shell.printfln(F("%d requests from clients that disconnected, dropped"), parked);
+        shell.printfln(F("web server task blocked: max %.1f us per request"), (double)blocked_max / 1000);
+        shell.printfln(F("latency: p50 %.1f ms, p99 %.1f ms, max %.1f ms"),
+                       latencies[latencies.size() / 2],
+                       latencies[latencies.size() * 99 / 100],
+                       latencies.back());
+    }
+
+    if (command == "command_queue") {
+        shell.printfln(F("Posting commands from several tasks to the main loop..."));
+        shell.log_level(uuid::log::Level::ERR); // not the warnings about the full queue
+
+        const uint8_t  producers = 4;
+        const uint16_t jobs      = 500; // per producer
+
+        // each producer numbers its jobs, which must be run in the same order
+        std::vector<uint16_t>   next(producers, 0);
+        uint32_t                run          = 0;
+        uint32_t                out_of_order = 0;
+        std::atomic<uint32_t>   full{0};
+        std::atomic<uint8_t>    finished{0};
+        std::vector<std::thread> threads;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint8_t p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                for (uint16_t i = 0; i < jobs; i++) {
+                    while (!EMSESP::commandqueue_.post([&, p, i]() {
+                        out_of_order += (next[p]++ != i);
+                        run++;
+                    })) {
+                        full++;
+                        std::this_thread::yield(); // the queue is full, wait for the main loop
+                    }
+                }
+                finished++;
+            });
+        }
+
+        // the main loop
+        while ((finished < producers) || (run < producers * jobs)) {
+            EMSESP::commandqueue_.loop();
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        for (auto & thread : threads) {
+            thread.join();
+        }
+
+        shell.printfln(F("%lu commands from %d tasks run by the main loop, %lu out of order, %s"),
+                       (unsigned long)run,
+                       producers,
+                       (unsigned long)out_of_order,
+                       (run == producers * jobs) ? "none lost" : "some lost");
+        shell.printfln(F("queue was full %lu times (%lu counted as dropped), %.2f us per command"),
+                       (unsigned long)full.load(),
+                       (unsigned long)EMSESP::commandqueue_.dropped(),
+                       (double)ns / run / 1000);
+
+        // from the main loop itself a command is run straight away
+        bool direct = false;
+        EMSESP::commandqueue_.post([&]() { direct = true; });
+        shell.printfln(F("posted from the main loop: %s"), direct ? "run straight away" : "queued");
+    }
+
+    if (command == "rx_skip") {
+        shell.printfln(F("Processing repeated broadcasts, the ones with unchanged data are skipped..."));
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        add_device(0x08, 123); // GB072
+        EMSdevice * boiler = EMSESP::find_device(0x08);
+
+        // UBAMonitorSlow with the burner starts set to n
+        auto monitor_slow = [](uint32_t n, uint8_t dest) {
+            uint8_t data[22] = {0};
+            data[10]         = n >> 16;
+            data[11]         = n >> 8;
+            data[12]         = n;
+            return Telegram(Telegram::Operation::RX, 0x08, dest, 0x19, 0, data, sizeof(data));
+        };
+        auto burnstarts = [&]() {
+            DynamicJsonDocument doc(EMSESP_JSON_SIZE_XLARGE_DYN);
+            JsonObject          output = doc.to<JsonObject>();
+            boiler->generate_values_json(output, DeviceValueTAG::TAG_NONE, false, EMSdevice::OUTPUT_TARGET::API_SHORTNAMES);
+            return output["burnstarts"].as<uint32_t>();
+        };
+
+        uint32_t skipped = EMSESP::rx_skip_count();
+        for (uint8_t i = 0; i < 10; i++) {
+            EMSESP::process_telegram(monitor_slow(1000, 0x00));
+        }
+        shell.printfln(F("10 x the same broadcast: %lu skipped, burnstarts %lu"), (unsigned long)(EMSESP::rx_skip_count() - skipped), (unsigned long)burnstarts());
+
+        skipped = EMSESP::rx_skip_count();
+        EMSESP::process_telegram(monitor_slow(2000, 0x00));
+        shell.printfln(F("changed broadcast: %lu skipped, burnstarts %lu"), (unsigned long)(EMSESP::rx_skip_count() - skipped), (unsigned long)burnstarts());
+
+        skipped = EMSESP::rx_skip_count();
+        EMSESP::process_telegram(monitor_slow(2000, 0x0B));
+        shell.printfln(F("same data sent to us: %lu skipped"), (unsigned long)(EMSESP::rx_skip_count() - skipped));
+
+        skipped = EMSESP::rx_skip_count();
+        Command::call(EMSdevice::DeviceType::BOILER, "wwseltemp", "52");
+        EMSESP::process_telegram(monitor_slow(2000, 0x00));
+        shell.printfln(F("same broadcast after a command: %lu skipped"), (unsigned long)(EMSESP::rx_skip_count() - skipped));
+
+        // the thermostat can't use the hc1 settings until hc1 is known from its monitor telegram
+        add_device(0x10, 158); // RC300
+        uint8_t  set_data[]     = {0x01, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00};
+        uint8_t  monitor_data[] = {0x00, 0xD7, 0x21, 0x00, 0x00, 0x00, 0x00, 0x30, 0x01, 0x84, 0x01, 0x01, 0x03,
+                                   0x01, 0x84, 0x01, 0xF1, 0x00, 0x00, 0x11, 0x01, 0x00, 0x08, 0x63, 0x00};
+        Telegram set_hc1(Telegram::Operation::RX, 0x10, 0x00, 0x02B9, 0, set_data, sizeof(set_data));
+        skipped = EMSESP::rx_skip_count();
+        EMSESP::process_telegram(set_hc1);
+        EMSESP::process_telegram(set_hc1);
+        shell.printfln(F("same broadcast without the heating circuit: %lu skipped"), (unsigned long)(EMSESP::rx_skip_count() - skipped));
+
+        skipped = EMSESP::rx_skip_count();
+        EMSESP::process_telegram(Telegram(Telegram::Operation::RX, 0x10, 0x00, 0x02A5, 0, monitor_data, sizeof(monitor_data)));
+        EMSESP::process_telegram(set_hc1);
+        EMSESP::process_telegram(set_hc1);
+        shell.printfln(F("same broadcast after the heating circuit was found: %lu skipped"), (unsigned long)(EMSESP::rx_skip_count() - skipped));
+
+        // UBAMonitorFast, the busiest broadcast
+        uint8_t        data[] = {0x00, 0x02, 0x5A, 0x73, 0x3D, 0x0A, 0x10, 0x65, 0x40, 0x02, 0x1A, 0x80, 0x00,
+                                 0x01, 0xE1, 0x01, 0x76, 0x0E, 0x3D, 0x48, 0x00, 0xC9, 0x44, 0x02, 0x00};
+        Telegram       telegram(Telegram::Operation::RX, 0x08, 0x00, 0x18, 0, data, sizeof(data));
+        const uint32_t loops = 10000;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            EMSESP::rx_fingerprint_clear();
+            EMSESP::process_telegram(telegram);
+        }
+        auto processed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            EMSESP::process_telegram(telegram);
+        }
+        auto skipped_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        shell.printfln(F("processed: %.1f ns/telegram"), (double)processed_ns / loops);
+        shell.printfln(F("skipped:   %.1f ns/telegram"), (double)skipped_ns / loops);
+    }
+
+    if (command == "tx_merge") {
+        shell.printfln(F("Merging queued Tx writes and reads..."));
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        add_device(0x08, 123); // GB072
+
+        auto show_queue = [&](uint16_t type_id) {
+            for (const auto & it : EMSESP::txservice_.queue()) {
+                if (it.telegram_->type_id == type_id) {
+                    shell.printfln(F(" [%02d] %s lane %s"), it.id_, it.telegram_->to_string().c_str(), read_flash_string(TxService::lane_name(it.lane_)).c_str());
+                }
+            }
+        };
+
+        // a slider in the web UI, only the last value is sent
+        uint32_t merged = EMSESP::txservice_.telegram_merge_count();
+        for (uint8_t value = 30; value < 80; value++) {
+            EMSESP::send_write_request(0x33, 0x08, 2, value, 0x33);
+        }
+        shell.printfln(F("50 writes to the same offset: %lu merged"), (unsigned long)(EMSESP::txservice_.telegram_merge_count() - merged));
+        show_queue(0x33);
+
+        // an overlapping write is combined into one, the next offset isn't
+        uint8_t data[] = {0x01, 0x50};
+        EMSESP::send_write_request(0x33, 0x08, 1, data, sizeof(data), 0x33);
+        EMSESP::send_write_request(0x33, 0x08, 3, 0x0A, 0x33);
+        shell.printfln(F("writes to offset 1-2 and 3:"));
+        show_queue(0x33);
+
+        // not merged past a write to another type of the same device, it gets them in the order they were written
+        EMSESP::send_write_request(0x35, 0x08, 0, 0x11, 0x35);
+        EMSESP::send_write_request(0x33, 0x08, 3, 0x02, 0x33);
+        shell.printfln(F("a write to type 0x35, then to offset 3 again:"));
+        show_queue(0x33);
+
+        // a read that is already waiting is sent once, a user read replaces a fetch and asks for at least as many bytes
+        EMSESP::txservice_.read_request(0x18, 0x08);
+        EMSESP::txservice_.read_request(0x18, 0x08);
+        shell.printfln(F("2 fetch reads:"));
+        show_queue(0x18);
+        EMSESP::txservice_.read_request(0x18, 0x08, 0, 27);
+        shell.printfln(F("and a user read:"));
+        show_queue(0x18);
+    }
+
+    if (command == "json_writer") {
+        shell.printfln(F("Benchmarking device values json, ArduinoJson document vs streaming..."));
+        Mqtt::ha_enabled(false); // turn off HA Discovery to stop the chatter
+
+        run_test("boiler");
+        run_test("thermostat");
+        run_test("solar");
+        run_test("mixer");
+
+        const uint32_t loops = 2000;
+
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            size_t doc_size    = 0;
+            size_t writer_size = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                DynamicJsonDocument doc(EMSESP_JSON_SIZE_XLARGE_DYN);
+                JsonObject          json = doc.to<JsonObject>();
+                std::string         payload;
+                emsdevice->generate_values_json(json, DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT);
+                serializeJson(json, payload);
+                doc_size = payload.size();
+            }
+            auto doc_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                std::string payload;
+                JsonWriter  json(payload);
+                json.reserve(emsdevice->values_json_size());
+                emsdevice->generate_values_json(json, DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT);
+                json.end();
+                writer_size = payload.size();
+            }
+            auto writer_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            shell.printfln(F("%s: document %d bytes %.1f us, writer %d bytes %.1f us"),
+                           emsdevice->device_type_name().c_str(),
+                           doc_size,
+                           (double)doc_ns / loops / 1000,
+                           writer_size,
+                           (double)writer_ns / loops / 1000);
+        }
+
+        // strings with control characters, e.g. a service code, must still give valid json
+        const char  text[] = "A\x01\"b\\\t\x1F";
+        std::string payload;
+        JsonWriter  json(payload);
+        json.add("text", text);
+        json.end();
+        StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> doc;
+        DeserializationError                       error = deserializeJson(doc, payload);
+        bool                                       raw   = false; // ArduinoJson reads them unescaped too, so check for them
+        for (char c : payload) {
+            raw |= ((uint8_t)c < 0x20);
+        }
+        shell.printfln(F("%s escaped string: %s"), (!error && !raw && (doc["text"] == text)) ? "ok  " : "FAIL", payload.c_str());
+    }
+
+    if (command == "ha_config") {
+        shell.printfln(F("Benchmarking HA discovery configs..."));
+        Mqtt::ha_enabled(true);
+
+        run_test("boiler");
+        run_test("thermostat");
+        run_test("mixer");
+        EMSESP::publish_all(); // marks the values which have data
+
+        // skip the logging of each config
+        uuid::log::Level log_level = shell.log_level();
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        const uint32_t loops = 200;
+
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            uint32_t configs = 0;
+            uint32_t bytes   = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                emsdevice->ha_config_clear();
+                Mqtt::mqtt_messages_.clear(); // drop the removes
+                emsdevice->publish_mqtt_ha_entity_config();
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            for (const auto & message : Mqtt::mqtt_messages_) {
+                configs++;
+                bytes += message.content_->payload.size();
+            }
+
+            shell.printfln(F("%s: %lu configs, %lu bytes, %.1f us"),
+                           emsdevice->device_type_name().c_str(),
+                           (unsigned long)configs,
+                           (unsigned long)bytes,
+                           (double)ns / loops / 1000);
+        }
+
+        Mqtt::mqtt_messages_.clear();
+        shell.log_level(log_level);
+    }
+
+    if (command == "ha_hashes") {
+        shell.printfln(F("Testing HA configs not being sent again when unchanged..."));
+        Mqtt::ha_enabled(true);
+
+        run_test("boiler");
+        run_test("thermostat");
+        EMSESP::publish_all(); // marks the values which have data
+
+        shell.log_level(uuid::log::Level::NOTICE); // skip the logging of each config
+
+        // first time, all configs are sent
+        EMSESP::reset_mqtt_ha();
+        Mqtt::mqtt_messages_.clear(); // drop the removes
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            emsdevice->publish_mqtt_ha_entity_config();
+        }
+        size_t configs = Mqtt::mqtt_messages_.size();
+        shell.printfln(F("%s after first start: %u messages queued"), configs ? "ok  " : "FAIL", (unsigned int)configs);
+        EMSESP::mqtt_.set_publish_budget(0);
+        EMSESP::mqtt_.loop(); // only once they are published the broker has them
+
+        // like after a reconnect or restart, nothing has changed so nothing is sent
+        EMSESP::reset_mqtt_ha(false);
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            emsdevice->publish_mqtt_ha_entity_config();
+        }
+        shell.printfln(F("%s after restart: %u messages queued"), Mqtt::mqtt_messages_.empty() ? "ok  " : "FAIL", (unsigned int)Mqtt::mqtt_messages_.size());
+
+        // configs dropped from a full queue never reached the broker, so they are sent again
+        EMSESP::reset_mqtt_ha();
+        Mqtt::mqtt_messages_.clear();
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            emsdevice->publish_mqtt_ha_entity_config();
+        }
+        char topic[20];
+        for (uint16_t i = 0; i < MAX_MQTT_MESSAGES; i++) {
+            snprintf(topic, sizeof(topic), "flood/%d", i);
+            Mqtt::publish(topic, "x");
+        }
+        EMSESP::mqtt_.loop(); // publishes the flood
+        EMSESP::mqtt_.loop(); // the queue is empty, create the dropped configs again
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            emsdevice->publish_mqtt_ha_entity_config();
+        }
+        shell.printfln(F("%s after dropping them from a full queue: %u messages queued"),
+                       (Mqtt::mqtt_messages_.size() == configs) ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size());
+
+        // forced, everything is removed and sent again, so there are more than the configs
+        Mqtt::mqtt_messages_.clear();
+        EMSESP::reset_mqtt_ha();
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            emsdevice->publish_mqtt_ha_entity_config();
+        }
+        shell.printfln(F("%s after forced reset: %u messages queued"),
+                       (Mqtt::mqtt_messages_.size() > configs) ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size());
+
+        shell.log_level(uuid::log::Level::DEBUG);
+        Mqtt::show_mqtt(shell);
+    }
+
+    if (command == "msgpack") {
+        shell.printfln(F("Benchmarking device values payload, json vs MessagePack..."));
+        Mqtt::ha_enabled(false); // turn off HA Discovery to stop the chatter
+
+        run_test("boiler");
+        run_test("thermostat");
+        run_test("solar");
+        run_test("mixer");
+
+        const uint32_t loops = 2000;
+
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            std::string json_payload;
+            std::string msgpack_payload;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                json_payload.clear();
+                JsonWriter json(json_payload);
+                json.reserve(emsdevice->values_json_size());
+                emsdevice->generate_values_json(json, DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT);
+                json.end();
+            }
+            auto json_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                msgpack_payload.clear();
+                JsonWriter json(msgpack_payload, JsonWriter::Format::MSGPACK);
+                json.reserve(emsdevice->values_json_size());
+                emsdevice->generate_values_json(json, DeviceValueTAG::TAG_NONE, true, EMSdevice::OUTPUT_TARGET::MQTT);
+                json.end();
+            }
+            auto msgpack_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            // both should decode to the same values, floats are only float32 in MessagePack
+            DynamicJsonDocument json_doc(EMSESP_JSON_SIZE_XLARGE_DYN);
+            DynamicJsonDocument msgpack_doc(EMSESP_JSON_SIZE_XLARGE_DYN);
+            deserializeJson(json_doc, json_payload);
+            bool same = !deserializeMsgPack(msgpack_doc, msgpack_payload.data(), msgpack_payload.size());
+
+            std::function<bool(JsonVariant, JsonVariant)> compare = [&](JsonVariant a, JsonVariant b) {
+                if (a.is<JsonObject>()) {
+                    if (!b.is<JsonObject>() || (a.size() != b.size())) {
+                        return false;
+                    }
+                    for (JsonPair kv : a.as<JsonObject>()) {
+                        if (!compare(kv.value(), b[kv.key()])) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+                if (a.is<JsonArray>()) {
+                    if (!b.is<JsonArray>() || (a.size() != b.size())) {
+                        return false;
+                    }
+                    for (size_t i = 0; i < a.size(); i++) {
+                        if (!compare(a[i], b[i])) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+                if (a.is<float>() && !a.is<int>()) {
+                    return std::fabs(a.as<float>() - b.as<float>()) <= 0.001;
+                }
+                return a == b;
+            };
+            same = same && compare(json_doc.as<JsonVariant>(), msgpack_doc.as<JsonVariant>());
+
+            // the same for the arrays of the web UI
+            std::string web_json;
+            std::string web_msgpack;
+            JsonWriter  web(web_json);
+            JsonWriter  web_packed(web_msgpack, JsonWriter::Format::MSGPACK);
+            emsdevice->generate_values_json_web(web);
+            emsdevice->generate_values_json_web(web_packed);
+            json_doc.clear();
+            msgpack_doc.clear();
+            same = same && !deserializeJson(json_doc, web_json) && !deserializeMsgPack(msgpack_doc, web_msgpack.data(), web_msgpack.size());
+            same = same && compare(json_doc.as<JsonVariant>(), msgpack_doc.as<JsonVariant>());
+
+            shell.printfln(F("%s: json %d bytes %.1f us, MessagePack %d bytes %.1f us, %s"),
+                           emsdevice->device_type_name().c_str(),
+                           json_payload.size(),
+                           (double)json_ns / loops / 1000,
+                           msgpack_payload.size(),
+                           (double)msgpack_ns / loops / 1000,
+                           same ? "same values" : "values differ");
+        }
+    }
+
+    if (command == "render_cache") {
+        shell.printfln(F("Benchmarking resolving value names and dividers, flash strings vs cached..."));
+
+        run_test("boiler");
+        run_test("thermostat");
+        run_test("solar");
+        run_test("mixer");
+
+        const uint32_t loops = 2000;
+
+        for (uint8_t output_target : {EMSdevice::OUTPUT_TARGET::MQTT, EMSdevice::OUTPUT_TARGET::API_VERBOSE}) {
+            uint32_t flash_sum  = 0;
+            uint32_t cached_sum = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                for (const auto & emsdevice : EMSESP::emsdevices) {
+                    flash_sum += emsdevice->resolve_values(false, output_target);
+                }
+            }
+            auto flash_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                for (const auto & emsdevice : EMSESP::emsdevices) {
+                    cached_sum += emsdevice->resolve_values(true, output_target);
+                }
+            }
+            auto cached_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            shell.printfln(F("%s: flash strings %.1f us, cached %.1f us per pass over all devices (%s)"),
+                           (output_target == EMSdevice::OUTPUT_TARGET::MQTT) ? "mqtt" : "verbose",
+                           (double)flash_ns / loops / 1000,
+                           (double)cached_ns / loops / 1000,
+                           (flash_sum == cached_sum) ? "same result" : "different result");
+        }
+    }
+
+    if (command == "mqtt_drain") {
+        shell.printfln(F("Testing MQTT queue draining..."));
+
+        // fill the queue beyond its size, the oldest messages are dropped
+        char topic[20];
+        for (uint16_t i = 0; i < MAX_MQTT_MESSAGES + 50; i++) {
+            snprintf(topic, sizeof(topic), "drain/%d", i);
+            Mqtt::publish(topic, std::string(100, 'x'));
+        }
+        uint32_t drops = Mqtt::publish_drops();
+        shell.printfln(F("%s queued %u messages, %lu dropped"),
+                       ((Mqtt::mqtt_messages_.size() == MAX_MQTT_MESSAGES) && (drops == 50)) ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size(),
+                       (unsigned long)drops);
+
+        // QoS 0 publishes until the budget is used up, a message is 116 or 117 bytes so 18 go out
+        EMSESP::mqtt_.set_publish_budget(2000);
+        EMSESP::mqtt_.loop();
+        shell.printfln(F("%s QoS 0 with a budget of 2000 bytes: %u messages left"),
+                       (Mqtt::mqtt_messages_.size() == MAX_MQTT_MESSAGES - 18) ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size());
+
+        // QoS 1 publishes until the in-flight window is full, the standalone client always returns packet ID 1
+        // the messages stay on the queue until they are ACKed
+        EMSESP::mqtt_.set_publish_budget(0);
+        EMSESP::mqtt_.set_qos(1);
+        EMSESP::mqtt_.loop();
+        size_t inflight = std::count_if(Mqtt::mqtt_messages_.begin(), Mqtt::mqtt_messages_.end(), [](const Mqtt::QueuedMqttMessage & m) { return m.packet_id_; });
+        shell.printfln(F("%s QoS 1 without a budget: %u messages left, %u in flight"),
+                       ((Mqtt::mqtt_messages_.size() == MAX_MQTT_MESSAGES - 18) && (inflight == 8)) ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size(),
+                       (unsigned int)inflight);
+        EMSESP::mqtt_.incoming_ack(1);
+        EMSESP::mqtt_.loop();
+        shell.printfln(F("%s QoS 1 after one ACK: %u messages left"),
+                       (Mqtt::mqtt_messages_.size() == MAX_MQTT_MESSAGES - 19) ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size());
+
+        // ACK all and drain the rest
+        EMSESP::mqtt_.set_qos(0);
+        while (Mqtt::mqtt_messages_.size() && Mqtt::mqtt_messages_.front().packet_id_) {
+            EMSESP::mqtt_.incoming_ack(1);
+        }
+        EMSESP::mqtt_.loop();
+        shell.printfln(F("%s QoS 0 without a budget: %u messages left"),
+                       Mqtt::mqtt_messages_.empty() ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size());
+    }
+
+    if (command == "mqtt_coalesce") {
+        shell.printfln(F("Testing MQTT queue replacing payloads for the same topic..."));
+
+        Mqtt::mqtt_messages_.clear();
+        Mqtt::publish("coalesce_data", "{\"temp\":20}");
+        Mqtt::publish("coalesce_other", "{\"on\":true}");
+        Mqtt::publish("coalesce_data", "{\"temp\":21}");
+        Mqtt::publish("coalesce_data", "{\"temp\":22}"); // only this one should be on the queue, in the first place
+        Mqtt::show_mqtt(shell);
+
+        // a message waiting for its ACK is not replaced
+        EMSESP::mqtt_.set_publish_budget(0);
+        EMSESP::mqtt_.set_qos(1);
+        EMSESP::mqtt_.loop();
+        Mqtt::publish("coalesce_data", "{\"temp\":23}");
+        Mqtt::show_mqtt(shell);
+
+        EMSESP::mqtt_.set_qos(0);
+        EMSESP::mqtt_.incoming_ack(1);
+        EMSESP::mqtt_.incoming_ack(1);
+
+        // command responses are events, every one of them is sent
+        Mqtt::mqtt_messages_.clear();
+        Mqtt::publish(F_(response), "{\"message\":\"ok\"}");
+        Mqtt::publish(F_(response), "{\"message\":\"unknown command\"}");
+        Mqtt::publish(F_(info), "{\"wwseltemp\":52}");
+        Mqtt::publish(F_(info), "{\"wwseltemp\":53}");
+        shell.printfln(F("%s 2 responses and 2 infos: %u messages queued"),
+                       (Mqtt::mqtt_messages_.size() == 4) ? "ok  " : "FAIL",
+                       (unsigned int)Mqtt::mqtt_messages_.size());
+        Mqtt::mqtt_messages_.clear();
+    }
+
+    if (command == "capture") {
+        shell.printfln(F("Testing telegram capture and replay..."));
+
+        const char * filename = "capture_test.bin";
+
+        // a frame is recorded as it came from the UART, with its CRC
+        Capture::start();
+        uart_telegram({0x08, 0x00, 0x07, 0x00, 0x0B});
+        Capture::stop();
+        Capture::save(filename);
+        uint8_t record[32] = {0};
+        FILE *  file       = fopen(filename, "rb");
+        size_t  len        = file ? fread(record, 1, sizeof(record), file) : 0;
+        if (file) {
+            fclose(file);
+        }
+        uint8_t frame[] = {0x08, 0x00, 0x07, 0x00, 0x0B, 0};
+        frame[5]        = EMSESP::rxservice_.calculate_crc(frame, 5);
+        shell.printfln(F("%s one frame recorded: %u bytes saved"),
+                       ((len == 16) && !memcmp(record, "EMSC", 4) && (record[9] == sizeof(frame)) && !memcmp(&record[10], frame, sizeof(frame))) ? "ok  " : "FAIL",
+                       (unsigned int)len);
+
+        // record the frames of the device tests, including the device discovery
+        uint32_t rx_start = EMSESP::rxservice_.telegram_count();
+        Capture::start();
+        run_test("boiler");
+        run_test("thermostat");
+        run_test("solar");
+        run_test("mixer");
+        Capture::stop();
+        uint32_t frames      = Capture::frames();
+        uint32_t rx_recorded = EMSESP::rxservice_.telegram_count() - rx_start;
+        shell.printfln(F("Captured %lu frames, %lu bytes"), (unsigned long)frames, (unsigned long)Capture::size());
+
+        // saving gives back the memory, loading it again gives the same frames
+        size_t size = Capture::size();
+        bool   ok   = Capture::save(filename) && (Capture::size() == 0) && Capture::load(filename);
+        shell.printfln(F("%s saved and loaded: %lu bytes, %lu frames"),
+                       (ok && (Capture::size() == size) && (Capture::frames() == frames)) ? "ok  " : "FAIL",
+                       (unsigned long)Capture::size(),
+                       (unsigned long)Capture::frames());
+        remove(filename);
+
+        // the replay gives the Rx service the same telegrams again
+        rx_start             = EMSESP::rxservice_.telegram_count();
+        uint32_t replayed    = Capture::replay(shell, false);
+        uint32_t rx_replayed = EMSESP::rxservice_.telegram_count() - rx_start;
+        shell.printfln(F("%s replayed %lu of %lu frames, %lu telegrams received (%lu when recorded)"),
+                       ((replayed == frames) && (rx_replayed == rx_recorded)) ? "ok  " : "FAIL",
+                       (unsigned long)replayed,
+                       (unsigned long)frames,
+                       (unsigned long)rx_replayed,
+                       (unsigned long)rx_recorded);
+
+        replayed = Capture::replay(shell, false, 100);
+        shell.printfln(F("%s replayed 100 times: %lu frames"), (replayed == frames * 100) ? "ok  " : "FAIL", (unsigned long)replayed);
+    }
+#endif
+
+    if (command == "mqtt_route") {
+        shell.printfln(F("Testing routing of incoming MQTT topics..."));
+        Mqtt::ha_enabled(true);
+        Mqtt::send_response(true);
+
+        run_test("boiler");
+        run_test("thermostat");
+        EMSESP::publish_all(); // creates the thermostat_hc1 HA topic
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        // shows the response of each message
+        auto incoming = [&](const char * topic, const char * payload) {
+            Mqtt::mqtt_messages_.clear();
+            EMSESP::mqtt_.incoming(topic, payload);
+            shell.printfln(F("%s %s => %s"), topic, payload, Mqtt::mqtt_messages_.empty() ? "" : Mqtt::mqtt_messages_.back().content_->payload.c_str());
+        };
+
+        incoming("ems-esp/boiler/wwseltemp", "52");                                      // device command
+        incoming("ems-esp/boiler/wwseltemp", "");                                        // query
+        incoming("ems-esp/thermostat/hc2/mode", "auto");                                 // with hc
+        incoming("ems-esp/thermostat/hc1.seltemp", "20");                                // with hc in the command
+        incoming("ems-esp/thermostat", "{\"cmd\":\"mode\",\"data\":\"heat\",\"id\":1}"); // command in the payload
+        incoming("ems-esp/thermostat", "");                                              // defaults to values
+        incoming("ems-esp/thermostat_hc1", "21");                                        // HA subscription callback
+        incoming("ems-esp/system/send", "0B 08 1C 00");                                  // system
+        incoming("ems-esp/thermostate/mode", "auto");                                    // unknown device
+        incoming("ems-esp/thermostat/modee", "auto");                                    // unknown command
+        incoming("ems-esp/thermostat/xyz/mode", "auto");                                 // bad hc
+        incoming("home/boiler/wwseltemp", "52");                                         // wrong base
+
+        shell.log_level(uuid::log::Level::DEBUG);
+    }
+
+    if (command == "log") {
+        shell.printfln(F("Testing log messages formatted on first use..."));
+        shell.log_level(uuid::log::Level::NOTICE);
+
+        // reads the log buffer like a handler that hasn't output anything yet
+        struct Reader : public uuid::log::Handler {
+            using Handler::peek_message;
+            using Handler::pop_message;
+        } handler;
+        uuid::log::Logger::register_handler(&handler, uuid::log::Level::DEBUG);
+        uuid::log::Logger logger(F("test"));
+
+        auto last = [&]() { return handler.peek_message(1); }; // the newest message, formatted and copied out
+
+        auto check = [&](const char * expected) {
+            const std::string & text = last()->text();
+            shell.printfln(F("%s %s"), text == expected ? "ok  " : "FAIL", text.c_str());
+        };
+
+        char name[] = "boiler";
+        logger.debug(F("%d %u %02X %s"), -5, 7u, 0xAB, name);
+        name[0] = 'B'; // the arguments are copied, so changes after the call don't show
+        check("-5 7 AB boiler");
+        logger.debug(F("%.1f %5.2f %%"), 21.55, 3.14159);
+        check("21.6  3.14 %");
+        logger.debug(F("%lu %lld %zu"), 4000000000UL, -1234567890123LL, (size_t)42);
+        check("4000000000 -1234567890123 42");
+        logger.debug(F("%-8s|%c|%s"), "ab", 'x', (const char *)nullptr);
+        check("ab      |x|(null)");
+        logger.debug(F("%*d"), 4, 2); // not copied, formatted straight away
+        check("   2");
+        logger.debug(F("%s"), "a string that is too long to be copied into the message, so it is formatted straight away");
+        check("a string that is too long to be copied into the message, so it is formatted straight away");
+
+        const uint32_t loops = 100000;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            logger.debug(F("Rx: %s (0x%02X) type 0x%02X, %d"), name, 0x08, 0x18, i);
+        }
+        auto deferred_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            logger.debug(F("Rx: %s (0x%02X) type 0x%02X, %d"), name, 0x08, 0x18, i);
+            last()->text();
+        }
+        auto formatted_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            logger.debug("Rx: %s (0x%02X) type 0x%02X, %d", name, 0x08, 0x18, i); // not a flash string, formatted straight away
+        }
+        auto eager_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < loops; i++) {
+            logger.trace(F("Rx: %s (0x%02X) type 0x%02X, %d"), name, 0x08, 0x18, i);
+        }
+        auto disabled_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        shell.printfln(F("trace enabled: %s"), uuid::log::Logger::enabled(uuid::log::Level::TRACE) ? "yes" : "no");
+        shell.printfln(F("log call: %.0f ns, with formatting %.0f ns, formatted straight away %.0f ns, disabled level %.1f ns"),
+                       (double)deferred_ns / loops,
+                       (double)formatted_ns / loops,
+                       (double)eager_ns / loops,
+                       (double)disabled_ns / loops);
+
+        // the buffer is shared, a handler that falls behind loses the oldest messages
+        size_t buffer_size = uuid::log::Logger::maximum_log_messages();
+        uuid::log::Logger::maximum_log_messages(10);
+        while (handler.peek_message()) {
+            handler.pop_message();
+        }
+        unsigned long overruns = handler.overruns();
+        for (uint8_t i = 0; i < 25; i++) {
+            logger.debug(F("message %d"), i);
+        }
+        shell.printfln(F("lag before reading: %lu"), handler.lag());
+        uint8_t count = 0;
+        for (const uuid::log::Message * message = handler.peek_message(); message != nullptr; message = handler.peek_message()) {
+            if (count++ == 0) {
+                shell.printfln(F("first message read: %s"), message->text().c_str());
+            }
+            handler.pop_message();
+        }
+        shell.printfln(F("read: %d, lag: %lu, overruns: %lu"), count, handler.lag(), handler.overruns() - overruns);
+        uuid::log::Logger::maximum_log_messages(buffer_size);
+
+        uuid::log::Logger::unregister_handler(&handler);
+        shell.log_level(uuid::log::Level::DEBUG);
+    }
+
+    if (command == "weblog") {
+        shell.printfln(F("Testing web log events..."));
+        shell.log_level(uuid::log::Level::NOTICE);
+        EMSESP::webLogService.log_level(uuid::log::Level::INFO);
+        EMSESP::webLogService.transmit(); // whatever was logged before
+
+        for (uint8_t i = 0; i < 40; i++) {
+            EMSESP::logger().info(F("web log message %d with some text to make it a bit longer"), i);
+        }
+
+        // all pending messages are sent in as few events as fit
+        size_t  count;
+        uint8_t events = 0;
+        while ((count = EMSESP::webLogService.transmit()) > 0) {
+            shell.printfln(F("event %d: %d messages"), ++events, count);
+        }
+
+        shell.log_level(uuid::log::Level::DEBUG);
+    }
+
+    if (command == "fetch_schedule") {
+        shell.printfln(F("Testing adaptive fetch schedule..."));
+
+        run_test("boiler");
+
+        // all fetch types were read when the device was added, so nothing is due yet
+        uint32_t now   = uuid::get_uptime();
+        uint8_t  count = 0;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            while (emsdevice->fetch_next(now)) {
+                count++;
+            }
+        }
+        shell.printfln(F("reads due now: %d"), count);
+
+        // a minute later only the types that changed or were never received are due, one read per call
+        count = 0;
+        for (const auto & emsdevice : EMSESP::emsdevices) {
+            while (emsdevice->fetch_next(now + 61000)) {
+                count++;
+            }
+        }
+        shell.printfln(F("reads due after a minute: %d"), count);
+
+        EMSESP::show_ems(shell);
+        EMSESP::show_devices(shell);
+    }
+
     if (command == "poll") {
         shell.printfln(F("Testing Poll..."));
 
@@ -24,6 +24,13 @@
 #include "emsesp.h"
 #include <ESPAsyncWebServer.h>
 
+#if defined(EMSESP_STANDALONE)
+#include <chrono> // for the benchmarks
+#include <cmath>
+#include <functional>
+#include <thread>
+#endif
+
 namespace emsesp {
 
 // #define EMSESP_DEBUG_DEFAULT "thermostat"
@@ -34,6 +41,24 @@ namespace emsesp {
 // #define EMSESP_DEBUG_DEFAULT "boiler"
 // #define EMSESP_DEBUG_DEFAULT "mqtt2"
 // #define EMSESP_DEBUG_DEFAULT "mqtt_nested"
+// #define EMSESP_DEBUG_DEFAULT "mqtt_single"
+// #define EMSESP_DEBUG_DEFAULT "json_writer"
+// #define EMSESP_DEBUG_DEFAULT "render_cache"
+// #define EMSESP_DEBUG_DEFAULT "pretty"
+// #define EMSESP_DEBUG_DEFAULT "device_data"
+// #define EMSESP_DEBUG_DEFAULT "command_queue"
+// #define EMSESP_DEBUG_DEFAULT "rx_skip"
+// #define EMSESP_DEBUG_DEFAULT "tx_merge"
+// #define EMSESP_DEBUG_DEFAULT "fetch_schedule"
+// #define EMSESP_DEBUG_DEFAULT "capture"
+// #define EMSESP_DEBUG_DEFAULT "mqtt_drain"
+// #define EMSESP_DEBUG_DEFAULT "mqtt_coalesce"
+// #define EMSESP_DEBUG_DEFAULT "ha_config"
+// #define EMSESP_DEBUG_DEFAULT "ha_hashes"
+// #define EMSESP_DEBUG_DEFAULT "msgpack"
+// #define EMSESP_DEBUG_DEFAULT "mqtt_route"
+// #define EMSESP_DEBUG_DEFAULT "log"
+// #define EMSESP_DEBUG_DEFAULT "weblog"
 // #define EMSESP_DEBUG_DEFAULT "ha"
 // #define EMSESP_DEBUG_DEFAULT "board_profile"
 // #define EMSESP_DEBUG_DEFAULT "shower_alert"
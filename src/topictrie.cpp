@@ -0,0 +1,99 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "topictrie.h"
+
+namespace emsesp {
+
+void TopicTrie::add(const char * topic, const uint16_t value) {
+    if (nodes_.empty()) {
+        nodes_.emplace_back(); // root
+    }
+
+    uint16_t node = 0;
+    while (*topic) {
+        const char * end = strchr(topic, '/');
+        size_t       len = end ? (size_t)(end - topic) : strlen(topic);
+        if ((len == 1) && (*topic == '#')) {
+            break; // wildcard
+        }
+
+        uint16_t child = find_child(node, topic, len);
+        if (child == NONE) {
+            Node n;
+            n.key_     = keys_.size();
+            n.key_len_ = len;
+            n.sibling_ = nodes_[node].child_;
+            keys_.append(topic, len);
+            child               = nodes_.size();
+            nodes_[node].child_ = child;
+            nodes_.push_back(n);
+        }
+        node = child;
+
+        topic += len;
+        if (*topic == '/') {
+            topic++;
+        }
+    }
+
+    if (node) {
+        nodes_[node].value_ = value;
+    }
+}
+
+uint16_t TopicTrie::find(const char * topic, const char *& rest) const {
+    uint16_t value = NONE;
+    rest           = topic;
+    if (nodes_.empty()) {
+        return value;
+    }
+
+    uint16_t node = 0;
+    while (*topic) {
+        const char * end = strchr(topic, '/');
+        size_t       len = end ? (size_t)(end - topic) : strlen(topic);
+
+        node = find_child(node, topic, len);
+        if (node == NONE) {
+            break;
+        }
+
+        topic += len;
+        if (*topic == '/') {
+            topic++;
+        }
+        if (nodes_[node].value_ != NONE) {
+            value = nodes_[node].value_;
+            rest  = topic;
+        }
+    }
+
+    return value;
+}
+
+uint16_t TopicTrie::find_child(const uint16_t node, const char * key, const size_t key_len) const {
+    for (uint16_t child = nodes_[node].child_; child != NONE; child = nodes_[child].sibling_) {
+        if ((nodes_[child].key_len_ == key_len) && !strncmp(&keys_[nodes_[child].key_], key, key_len)) {
+            return child;
+        }
+    }
+    return NONE;
+}
+
+} // namespace emsesp
@@ -0,0 +1,62 @@
+/*
+ * EMS-ESP - https://github.com/emsesp/EMS-ESP
+ * Copyright 2020  Paul Derbyshire
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMSESP_TOPICTRIE_H
+#define EMSESP_TOPICTRIE_H
+
+#include <Arduino.h>
+
+#include <string>
+#include <vector>
+
+namespace emsesp {
+
+// maps topics like 'boiler' or 'thermostat_hc1' to a value, with one node per topic level
+// a topic is matched level by level in a single pass, comparing in place without copying it
+class TopicTrie {
+  public:
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    // the levels are separated by /, a trailing /# is ignored
+    void add(const char * topic, const uint16_t value);
+
+    // returns the value of the longest matching topic, and in rest what's left of the topic after it
+    uint16_t find(const char * topic, const char *& rest) const;
+
+    size_t size() const {
+        return nodes_.size();
+    }
+
+  private:
+    struct Node {
+        uint16_t child_   = NONE; // first child
+        uint16_t sibling_ = NONE; // next child of the same parent
+        uint16_t value_   = NONE;
+        uint16_t key_     = 0; // position of the level name in keys_
+        uint8_t  key_len_ = 0;
+    };
+
+    uint16_t find_child(const uint16_t node, const char * key, const size_t key_len) const;
+
+    std::vector<Node> nodes_; // the root is created with the first topic
+    std::string       keys_;
+};
+
+} // namespace emsesp
+
+#endif
@@ -26,8 +26,8 @@ namespace emsesp {
 
 WebAPIService::WebAPIService(AsyncWebServer * server, SecurityManager * securityManager)
     : _securityManager(securityManager)
-    , _apiHandler("/api", std::bind(&WebAPIService::webAPIService_post, this, _1, _2), 256) { // for POSTS, must use 'Content-Type: application/json' in header
-    server->on("/api", HTTP_GET, std::bind(&WebAPIService::webAPIService_get, this, _1));     // for GETS
+    , _apiHandler("/api", std::bind(&WebAPIService::webAPIService_post, this, _1, _2), API_BODY_SIZE) { // for POSTS, must use 'Content-Type: application/json' in header
+    server->on("/api", HTTP_GET, std::bind(&WebAPIService::webAPIService_get, this, _1));               // for GETS
     server->addHandler(&_apiHandler);
 }
 
@@ -66,12 +66,35 @@ void WebAPIService::parse(AsyncWebServerRequest * request, JsonObject & input) {
         is_admin                      = settings.notoken_api | AuthenticationPredicates::IS_ADMIN(authentication);
     });
 
+    // the command is run from the main loop, by then the request and its json body have gone
+    std::string url(request->url().c_str());
+    std::string body;
+    serializeJson(input, body);
+    auto completion = std::make_shared<CommandQueue::Completion>();
+    if (!EMSESP::commandqueue_.post([url, body, is_admin, completion]() mutable { call(url, body, is_admin, *completion); })) {
+        request->send(503);
+        return;
+    }
+    completion->respond(request);
+}
+
+// calls the command and sends back the response, from the main loop
+// the body is parsed in place, so it fits in a document of the same size as the one of the POST handler
+void WebAPIService::call(const std::string & url, std::string & body, const bool is_admin, CommandQueue::Completion & completion) {
+    StaticJsonDocument<API_BODY_SIZE> input_doc;
+    if (deserializeJson(input_doc, &body[0]) != DeserializationError::Ok) {
+        emsesp::EMSESP::logger().err(F("API call failed, invalid json body"));
+        completion.send(400);
+        return;
+    }
+    JsonObject input = input_doc.as<JsonObject>();
+
     // output json buffer
-    PrettyAsyncJsonResponse * response = new PrettyAsyncJsonResponse(false, EMSESP_JSON_SIZE_XXLARGE_DYN);
-    JsonObject                output   = response->getRoot();
+    DynamicJsonDocument output_doc(EMSESP_JSON_SIZE_XXLARGE_DYN);
+    JsonObject          output = output_doc.to<JsonObject>();
 
     // call command
-    uint8_t return_code = Command::process(request->url().c_str(), is_admin, input, output);
+    uint8_t return_code = Command::process(url.c_str(), is_admin, input, output);
 
     if (return_code != CommandRet::OK) {
         char error[100];
@@ -91,11 +114,9 @@ void WebAPIService::parse(AsyncWebServerRequest * request, JsonObject & input) {
 
     // send the json that came back from the command call
     // FAIL, OK, NOT_FOUND, ERROR, NOT_ALLOWED = 400 (bad request), 200 (OK), 400 (not found), 400 (bad request), 401 (unauthorized)
-    int ret_codes[5] = {400, 200, 400, 400, 401};
-    response->setCode(ret_codes[return_code]);
-    response->setLength();
-    response->setContentType("application/json");
-    request->send(response);
+    int         ret_codes[5] = {400, 200, 400, 400, 401};
+    std::string content;
+    serializeJsonPretty(output, content);
 
 #if defined(EMSESP_STANDALONE)
     Serial.print(COLOR_YELLOW);
@@ -107,6 +128,8 @@ void WebAPIService::parse(AsyncWebServerRequest * request, JsonObject & input) {
     Serial.println();
     Serial.print(COLOR_RESET);
 #endif
+
+    completion.send(ret_codes[return_code], std::move(content));
 }
 
 } // namespace emsesp
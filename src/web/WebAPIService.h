@@ -23,6 +23,8 @@
 #include <AsyncJson.h>
 #include <ESPAsyncWebServer.h>
 
+#include "../commandqueue.h"
+
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -42,7 +44,10 @@ class WebAPIService {
     SecurityManager *           _securityManager;
     AsyncCallbackJsonWebHandler _apiHandler; // for POSTs
 
-    void parse(AsyncWebServerRequest * request, JsonObject & input);
+    static constexpr size_t API_BODY_SIZE = 256; // json document for the body of a POST
+
+    void        parse(AsyncWebServerRequest * request, JsonObject & input);
+    static void call(const std::string & url, std::string & body, const bool is_admin, CommandQueue::Completion & completion);
 };
 
 } // namespace emsesp
@@ -22,6 +22,9 @@ namespace emsesp {
 
 using namespace std::placeholders; // for `_1` etc
 
+std::vector<WebDataService::PendingRequest> WebDataService::pending_requests_;
+std::mutex                                  WebDataService::pending_mutex_;
+
 WebDataService::WebDataService(AsyncWebServer * server, SecurityManager * securityManager)
     : _device_dataHandler(DEVICE_DATA_SERVICE_PATH,
                           securityManager->wrapCallback(std::bind(&WebDataService::device_data, this, _1, _2), AuthenticationPredicates::IS_AUTHENTICATED))
@@ -93,38 +96,97 @@ void WebDataService::all_devices(AsyncWebServerRequest * request) {
 }
 
 // The unique_id is the unique record ID from the Web table to identify which device to load
-// Compresses the JSON using MsgPack https://msgpack.org/index.html
+// the response is built in the main loop, so the web server task isn't blocked while waiting
+// for a write to be validated and the values aren't read while they're being updated
 void WebDataService::device_data(AsyncWebServerRequest * request, JsonVariant & json) {
-    if (json.is<JsonObject>()) {
-        MsgpackAsyncJsonResponse * response = new MsgpackAsyncJsonResponse(false, EMSESP_JSON_SIZE_XXLARGE_DYN);
-        for (const auto & emsdevice : EMSESP::emsdevices) {
-            if (emsdevice) {
-                if (emsdevice->unique_id() == json["id"]) {
-                    // wait max 2.5 sec for updated data (post_send_delay is 2 sec)
-                    for (uint16_t i = 0; i < (emsesp::TxService::POST_SEND_DELAY + 500) && EMSESP::wait_validate(); i++) {
-                        delay(1);
-                    }
-                    EMSESP::wait_validate(0); // reset in case of timeout
-#ifndef EMSESP_STANDALONE
-                    JsonObject root = response->getRoot();
-                    emsdevice->generate_values_json_web(root);
-#endif
-                    response->setLength();
-                    request->send(response);
-                    return;
-                }
+    if (!json.is<JsonObject>()) {
+        AsyncWebServerResponse * response = request->beginResponse(200); // invalid
+        request->send(response);
+        return;
+    }
+
+    auto completion = std::make_shared<CommandQueue::Completion>();
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (pending_requests_.size() >= MAX_PENDING_REQUESTS) {
+            request->send(503);
+            return;
+        }
+        pending_requests_.push_back({completion, json["id"].as<uint8_t>(), uuid::get_uptime()});
+    }
+    completion->respond(request);
+}
+
+// answers the waiting device_data requests, once the last write has been validated
+// wait max 2.5 sec for updated data (post_send_delay is 2 sec)
+void WebDataService::loop() {
+    std::vector<PendingRequest> pending;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (pending_requests_.empty()) {
+            return;
+        }
+
+        if (EMSESP::wait_validate()) {
+            if (uuid::get_uptime() - pending_requests_.front().start < emsesp::TxService::POST_SEND_DELAY + 500) {
+                return;
             }
+            EMSESP::wait_validate(0); // reset in case of timeout
         }
+        pending.swap(pending_requests_);
     }
 
-    // invalid
-    AsyncWebServerResponse * response = request->beginResponse(200);
-    request->send(response);
+    for (const auto & request : pending) {
+        // if only this one is left, the client has gone and the response was deleted
+        if (request.completion.use_count() > 1) {
+            device_data_send(*request.completion, request.unique_id);
+        }
+    }
+}
+
+// Compresses the JSON using MsgPack https://msgpack.org/index.html
+// the values are written straight into the response buffer, without a json document
+void WebDataService::device_data_send(CommandQueue::Completion & completion, const uint8_t unique_id) {
+    for (const auto & emsdevice : EMSESP::emsdevices) {
+        if (emsdevice) {
+            if (emsdevice->unique_id() == unique_id) {
+                std::string content;
+                JsonWriter  json(content, JsonWriter::Format::MSGPACK);
+                json.reserve(emsdevice->values_json_size() * 4); // the web also gets the full names, units and commands
+                emsdevice->generate_values_json_web(json);
+                completion.send(200, std::move(content));
+                return;
+            }
+        }
+    }
+
+    completion.send(200); // invalid
 }
 
 // takes a command and its data value from a specific Device, from the Web
 // assumes the service has been checked for admin authentication
 void WebDataService::write_value(AsyncWebServerRequest * request, JsonVariant & json) {
+    // the command is run from the main loop, by then the request and its json body have gone
+    std::string body;
+    serializeJson(json, body);
+    auto completion = std::make_shared<CommandQueue::Completion>();
+    if (!EMSESP::commandqueue_.post([body, completion]() mutable {
+            // parsed in place, so it fits in a document of the same size as the one of the POST handler
+            StaticJsonDocument<DYNAMIC_JSON_DOCUMENT_SIZE> doc;
+            if (deserializeJson(doc, &body[0]) != DeserializationError::Ok) {
+                completion->send(400);
+                return;
+            }
+            write_value_call(doc.as<JsonVariant>(), *completion);
+        })) {
+        request->send(503);
+        return;
+    }
+    completion->respond(request);
+}
+
+// calls the command and sends back the response, from the main loop
+void WebDataService::write_value_call(JsonVariant json, CommandQueue::Completion & completion) {
     if (json.is<JsonObject>()) {
         JsonObject dv        = json["devicevalue"];
         uint8_t    unique_id = json["id"];
@@ -140,8 +202,8 @@ void WebDataService::write_value(AsyncWebServerRequest * request, JsonVariant &
                     cmd              = Command::parse_command_string(cmd, id); // extract hc or wwc
 
                     // create JSON for output
-                    AsyncJsonResponse * response = new AsyncJsonResponse(false, EMSESP_JSON_SIZE_SMALL);
-                    JsonObject          output   = response->getRoot();
+                    StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> output_doc;
+                    JsonObject                                 output = output_doc.to<JsonObject>();
 
                     // the data could be in any format, but we need string
                     // authenticated is always true
@@ -167,17 +229,16 @@ void WebDataService::write_value(AsyncWebServerRequest * request, JsonVariant &
                         EMSESP::logger().debug(F("Write command successful"));
                     }
 
-                    response->setCode((return_code == CommandRet::OK) ? 200 : 204);
-                    response->setLength();
-                    request->send(response);
+                    std::string content;
+                    serializeJson(output, content);
+                    completion.send((return_code == CommandRet::OK) ? 200 : 204, std::move(content));
                     return;
                 }
             }
         }
     }
 
-    AsyncWebServerResponse * response = request->beginResponse(204); // Write command failed
-    request->send(response);
+    completion.send(204); // Write command failed
 }
 
 // takes a sensorname and optional offset from the Web
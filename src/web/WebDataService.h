@@ -24,6 +24,12 @@
 #include <ESPAsyncWebServer.h>
 #include <SecurityManager.h>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../commandqueue.h"
+
 #define EMSESP_DATA_SERVICE_PATH "/rest/data"
 #define SCAN_DEVICES_SERVICE_PATH "/rest/scanDevices"
 #define DEVICE_DATA_SERVICE_PATH "/rest/deviceData"
@@ -36,6 +42,8 @@ class WebDataService {
   public:
     WebDataService(AsyncWebServer * server, SecurityManager * securityManager);
 
+    void loop();
+
 // make all functions public so we can test in the debug and standalone mode
 #ifndef EMSESP_STANDALONE
   private:
@@ -51,6 +59,22 @@ class WebDataService {
     void write_sensor(AsyncWebServerRequest * request, JsonVariant & json);
 
     AsyncCallbackJsonWebHandler _device_dataHandler, _writevalue_dataHandler, _writesensor_dataHandler;
+
+    // a device_data request waiting to be answered from the main loop
+    struct PendingRequest {
+        std::shared_ptr<CommandQueue::Completion> completion;
+        uint8_t                                   unique_id;
+        uint32_t                                  start;
+    };
+
+    static constexpr uint8_t MAX_PENDING_REQUESTS = 8;
+
+    static void device_data_send(CommandQueue::Completion & completion, const uint8_t unique_id);
+    static void write_value_call(JsonVariant json, CommandQueue::Completion & completion);
+
+    // requests are added from the web server task and answered from the main loop
+    static std::vector<PendingRequest> pending_requests_;
+    static std::mutex                  pending_mutex_;
 };
 
 } // namespace emsesp
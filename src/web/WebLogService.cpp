@@ -27,6 +27,7 @@ WebLogService::WebLogService(AsyncWebServer * server, SecurityManager * security
     , setValues_(LOG_SETTINGS_PATH, std::bind(&WebLogService::setValues, this, _1, _2), 256) { // for POSTS
 
     events_.setFilter(securityManager->filterRequest(AuthenticationPredicates::IS_ADMIN));
+    events_.onConnect(std::bind(&WebLogService::onConnect, this, _1));
     server->addHandler(&events_);
     server->on(EVENT_SOURCE_LOG_PATH, HTTP_GET, std::bind(&WebLogService::forbidden, this, _1));
 
@@ -44,11 +45,20 @@ void WebLogService::forbidden(AsyncWebServerRequest * request) {
     request->send(403);
 }
 
+// the browser reconnects with the id of the last message it has, so it can continue from there
+// this is called from the web server task, the cursor is moved in loop()
+void WebLogService::onConnect(AsyncEventSourceClient * client) {
+    if (client->lastId()) {
+        resume_id_ = client->lastId();
+    }
+}
+
 // start event source service
 void WebLogService::start() {
     EMSESP::webSettingsService.read([&](WebSettings & settings) {
         maximum_log_messages_ = settings.weblog_buffer;
         compact_              = settings.weblog_compact;
+        uuid::log::Logger::maximum_log_messages(std::max(maximum_log_messages_, (size_t)uuid::log::Logger::MAX_LOG_MESSAGES));
         uuid::log::Logger::register_handler(this, (uuid::log::Level)settings.weblog_level);
     });
 }
@@ -73,9 +83,7 @@ size_t WebLogService::maximum_log_messages() const {
 
 void WebLogService::maximum_log_messages(size_t count) {
     maximum_log_messages_ = std::max((size_t)1, count);
-    while (log_messages_.size() > maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
+    uuid::log::Logger::maximum_log_messages(std::max(maximum_log_messages_, (size_t)uuid::log::Logger::MAX_LOG_MESSAGES));
     EMSESP::webSettingsService.update(
         [&](WebSettings & settings) {
             settings.weblog_buffer = count;
@@ -98,18 +106,8 @@ void WebLogService::compact(bool compact) {
         "local");
 }
 
-WebLogService::QueuedLogMessage::QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content)
-    : id_(id)
-    , content_(std::move(content)) {
-}
-
-void WebLogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
-    if (log_messages_.size() >= maximum_log_messages_) {
-        log_messages_.pop_front();
-    }
-
-    log_messages_.emplace_back(log_message_id_++, std::move(message));
-
+// the log messages only have the uptime, so keep the offset to the real time up to date
+void WebLogService::update_time_offset() {
     EMSESP::esp8266React.getNTPSettingsService()->read([&](NTPSettings & settings) {
         if (!settings.enabled || (time(nullptr) < 1500000000L)) {
             time_offset_ = 0;
@@ -124,12 +122,18 @@ void WebLogService::operator<<(std::shared_ptr<uuid::log::Message> message) {
 }
 
 void WebLogService::loop() {
-    if (!events_.count() || log_messages_.empty()) {
-        return;
+    // go back to where a reconnected client was, if still in the log buffer
+    if (resume_id_) {
+        uint32_t resume_id = resume_id_;
+        resume_id_         = 0;
+        if (static_cast<long>(cursor_ - resume_id) > 0) {
+            cursor_ = resume_id;
+        }
     }
 
-    // see if we've advanced
-    if (log_messages_.back().id_ <= log_message_id_tail_) {
+    // nobody is listening, the log is fetched when the page is opened
+    if (!events_.count()) {
+        cursor_ = uuid::log::Logger::next_id();
         return;
     }
 
@@ -137,15 +141,9 @@ void WebLogService::loop() {
     if (uuid::get_uptime_ms() - last_transmit_ < REFRESH_SYNC) {
         return;
     }
-    last_transmit_ = uuid::get_uptime_ms();
-
-    // flush
-    for (const auto & message : log_messages_) {
-        if (message.id_ > log_message_id_tail_) {
-            log_message_id_tail_ = message.id_;
-            transmit(message);
-            return;
-        }
+
+    if (transmit()) {
+        last_transmit_ = uuid::get_uptime_ms();
     }
 }
 
@@ -155,52 +153,80 @@ char * WebLogService::messagetime(char * out, const uint64_t t) {
         strcpy(out, uuid::log::format_timestamp_ms(t, 3).c_str());
     } else {
         time_t t1 = time_offset_ + t / 1000ULL;
-        strftime(out, 25, "%F %T", localtime(&t1));
-        snprintf(out, 25, "%s.%03d", out, (uint16_t)(t % 1000));
+        size_t len = strftime(out, 25, "%F %T", localtime(&t1));
+        snprintf(out + len, 25 - len, ".%03d", (uint16_t)(t % 1000));
     }
     return out;
 }
 
-// send to web eventsource
-void WebLogService::transmit(const QueuedLogMessage & message) {
-    DynamicJsonDocument jsonDocument = DynamicJsonDocument(EMSESP_JSON_SIZE_MEDIUM);
-    JsonObject          logEvent     = jsonDocument.to<JsonObject>();
-    char                time_string[25];
+// sends all pending messages to the web eventsource as a json array in a single event, up to MAX_FRAME_SIZE bytes
+// the event id is the id of the last message, which the browser sends back as Last-Event-ID when reconnecting
+// returns the number of messages sent
+size_t WebLogService::transmit() {
+    const uuid::log::Message * message = peek_message(maximum_log_messages_);
+    if (message == nullptr) {
+        return 0;
+    }
 
-    logEvent["t"] = messagetime(time_string, message.content_->uptime_ms);
-    logEvent["l"] = message.content_->level;
-    logEvent["i"] = message.id_;
-    logEvent["n"] = message.content_->name;
-    logEvent["m"] = message.content_->text;
+    update_time_offset();
+
+    std::string frame;
+    frame.reserve(MAX_FRAME_SIZE + 2);
+    frame += '[';
+
+    size_t        count = 0;
+    unsigned long id    = 0;
+    for (; message != nullptr; message = peek_message(maximum_log_messages_)) {
+        StaticJsonDocument<EMSESP_JSON_SIZE_SMALL> jsonDocument;
+        JsonObject                                 logEvent = jsonDocument.to<JsonObject>();
+        char                                       time_string[25];
+
+        logEvent["t"] = messagetime(time_string, message->uptime_ms);
+        logEvent["l"] = message->level;
+        logEvent["i"] = cursor_ + 1;
+        logEvent["n"] = message->name;
+        logEvent["m"] = message->text().c_str(); // not copied
+
+        // always send at least one message
+        size_t len = measureJson(jsonDocument);
+        if (count && (frame.size() + len + 1 > MAX_FRAME_SIZE)) {
+            break;
+        }
+        if (count) {
+            frame += ',';
+        }
+        serializeJson(jsonDocument, frame);
 
-    size_t len    = measureJson(jsonDocument);
-    char * buffer = new char[len + 1];
-    if (buffer) {
-        serializeJson(jsonDocument, buffer, len + 1);
-        events_.send(buffer, "message", message.id_);
+        id = cursor_ + 1;
+        count++;
+        pop_message();
     }
-    delete[] buffer;
+
+    frame += ']';
+    events_.send(frame.c_str(), "message", id);
+    return count;
 }
 
-// send the complete log buffer to the API, not filtering on log level
+// send the complete log buffer to the API, at the log level of the web log
 void WebLogService::fetchLog(AsyncWebServerRequest * request) {
     MsgpackAsyncJsonResponse * response = new MsgpackAsyncJsonResponse(false, EMSESP_JSON_SIZE_XXLARGE_DYN); // 16kb buffer
     JsonObject                 root     = response->getRoot();
     JsonArray                  log      = root.createNestedArray("events");
 
-    log_message_id_tail_ = log_messages_.back().id_;
-    last_transmit_       = uuid::get_uptime_ms();
-    for (const auto & message : log_messages_) {
+    // runs on the web server task, so it reads with its own cursor and leaves the event source to loop()
+    update_time_offset();
+    unsigned long      cursor = uuid::log::Logger::next_id() - std::min(uuid::log::Logger::next_id() - uuid::log::Logger::first_id(), (unsigned long)maximum_log_messages_);
+    uuid::log::Message message;
+    for (; peek_message(cursor, message); cursor++) {
         JsonObject logEvent = log.createNestedObject();
         char       time_string[25];
 
-        logEvent["t"] = messagetime(time_string, message.content_->uptime_ms);
-        logEvent["l"] = message.content_->level;
-        logEvent["i"] = message.id_;
-        logEvent["n"] = message.content_->name;
-        logEvent["m"] = message.content_->text;
+        logEvent["t"] = messagetime(time_string, message.uptime_ms);
+        logEvent["l"] = message.level;
+        logEvent["i"] = cursor + 1;
+        logEvent["n"] = message.name;
+        logEvent["m"] = message.text();
     }
-    log_message_id_tail_ = log_messages_.back().id_;
     response->setLength();
     request->send(response);
 }
@@ -36,6 +36,7 @@ class WebLogService : public uuid::log::Handler {
   public:
     static constexpr size_t MAX_LOG_MESSAGES = 50;
     static constexpr size_t REFRESH_SYNC     = 50;
+    static constexpr size_t MAX_FRAME_SIZE   = 1024; // most bytes of log messages sent in one event
 
     WebLogService(AsyncWebServer * server, SecurityManager * securityManager);
 
@@ -47,24 +48,13 @@ class WebLogService : public uuid::log::Handler {
     bool             compact();
     void             compact(bool compact);
     void             loop();
-
-    virtual void operator<<(std::shared_ptr<uuid::log::Message> message);
+    size_t           transmit();
 
   private:
     AsyncEventSource events_;
 
-    class QueuedLogMessage {
-      public:
-        QueuedLogMessage(unsigned long id, std::shared_ptr<uuid::log::Message> && content);
-        ~QueuedLogMessage() = default;
-
-        unsigned long                                   id_;      // Sequential identifier for this log message
-        struct timeval                                  time_;    // Time message was received
-        const std::shared_ptr<const uuid::log::Message> content_; // Log message content
-    };
-
     void forbidden(AsyncWebServerRequest * request);
-    void transmit(const QueuedLogMessage & message);
+    void onConnect(AsyncEventSourceClient * client);
     void fetchLog(AsyncWebServerRequest * request);
     void getValues(AsyncWebServerRequest * request);
 
@@ -73,13 +63,13 @@ class WebLogService : public uuid::log::Handler {
     void                        setValues(AsyncWebServerRequest * request, JsonVariant & json);
     AsyncCallbackJsonWebHandler setValues_; // for POSTs
 
-    uint64_t                    last_transmit_        = 0;                // Last transmit time
-    size_t                      maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output
-    unsigned long               log_message_id_       = 0;                // The next identifier to use for queued log messages
-    unsigned long               log_message_id_tail_  = 0;                // last event shown on the screen after fetch
-    std::list<QueuedLogMessage> log_messages_;                            // Queued log messages, in the order they were received
-    time_t                      time_offset_ = 0;
-    bool                        compact_     = true;
+    void update_time_offset();
+
+    uint64_t          last_transmit_        = 0;                // Last transmit time
+    size_t            maximum_log_messages_ = MAX_LOG_MESSAGES; // Maximum number of log messages to buffer before they are output, a larger value also grows the shared log buffer
+    time_t            time_offset_          = 0;
+    bool              compact_              = true;
+    volatile uint32_t resume_id_            = 0;                // Last-Event-ID of a client that reconnected, set from the web server task
 };
 
 } // namespace emsesp